@@ -0,0 +1,139 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "apps.h"
+#include "progs.h"
+#include <openssl/err.h>
+#include <openssl/x509.h>
+
+typedef enum OPTION_choice {
+    OPT_COMMON,
+    OPT_OUT, OPT_VERBOSE,
+    OPT_PROV_ENUM
+} OPTION_CHOICE;
+
+const OPTIONS trustindex_options[] = {
+    {OPT_HELP_STR, 1, '-', "Usage: %s [options] file...\n"},
+
+    OPT_SECTION("General"),
+    {"help", OPT_HELP, '-', "Display this summary"},
+
+    OPT_SECTION("Output"),
+    {"out", OPT_OUT, '>', "Trust index file to write"},
+    {"v", OPT_VERBOSE, '-', "Verbose output"},
+
+    OPT_PROV_OPTIONS,
+
+    OPT_PARAMETERS(),
+    {"file", 0, 0, "Files or URIs containing the certificates to index"},
+    {NULL}
+};
+
+int trustindex_main(int argc, char **argv)
+{
+    STACK_OF(X509) *certs = NULL;
+    BIO *out = NULL;
+    char *outfile = NULL, *tmpfile = NULL, *prog;
+    int i, verbose = 0, ret = 1;
+    size_t len;
+    OPTION_CHOICE o;
+
+    prog = opt_init(argc, argv, trustindex_options);
+    while ((o = opt_next()) != OPT_EOF) {
+        switch (o) {
+        case OPT_EOF:
+        case OPT_ERR:
+opthelp:
+            BIO_printf(bio_err, "%s: Use -help for summary.\n", prog);
+            goto end;
+        case OPT_HELP:
+            opt_help(trustindex_options);
+            ret = 0;
+            goto end;
+        case OPT_OUT:
+            outfile = opt_arg();
+            break;
+        case OPT_VERBOSE:
+            verbose = 1;
+            break;
+        case OPT_PROV_CASES:
+            if (!opt_provider(o))
+                goto end;
+            break;
+        }
+    }
+
+    /* Remaining arguments are the certificate files. */
+    argc = opt_num_rest();
+    argv = opt_rest();
+    if (argc == 0) {
+        BIO_printf(bio_err, "%s: No certificate files given\n", prog);
+        goto opthelp;
+    }
+    if (outfile == NULL) {
+        BIO_printf(bio_err, "%s: No output file given\n", prog);
+        goto opthelp;
+    }
+
+    if ((certs = sk_X509_new_null()) == NULL)
+        goto end;
+    for (i = 0; i < argc; i++) {
+        int n = sk_X509_num(certs);
+
+        if (!load_certs(argv[i], 0, &certs, NULL, "certificates"))
+            goto end;
+        if (verbose)
+            BIO_printf(bio_err, "%s: %d certificates\n", argv[i],
+                       sk_X509_num(certs) - n);
+    }
+
+    /*
+     * Processes using an existing index may have it mapped into memory, so
+     * write the new one to a temporary file and replace the old one with it
+     * rather than overwriting it in place.
+     */
+    len = strlen(outfile) + sizeof(".tmp");
+    tmpfile = app_malloc(len, "temporary file name");
+    BIO_snprintf(tmpfile, len, "%s.tmp", outfile);
+    if ((out = bio_open_default(tmpfile, 'w', FORMAT_BINARY)) == NULL)
+        goto end;
+    if (!X509_trust_index_write(out, certs) || BIO_flush(out) <= 0) {
+        BIO_printf(bio_err, "%s: Error writing trust index\n", prog);
+        goto end;
+    }
+    BIO_free(out);
+    out = NULL;
+#ifdef OPENSSL_SYS_WINDOWS
+    /* rename() does not replace an existing file on Windows */
+    (void)remove(outfile);
+#endif
+    if (rename(tmpfile, outfile) != 0) {
+        BIO_printf(bio_err, "%s: Cannot rename %s to %s: %s\n", prog,
+                   tmpfile, outfile, strerror(errno));
+        goto end;
+    }
+    if (verbose)
+        BIO_printf(bio_err, "Wrote %d certificates to %s\n",
+                   sk_X509_num(certs), outfile);
+    ret = 0;
+
+ end:
+    if (ret != 0)
+        ERR_print_errors(bio_err);
+    BIO_free(out);
+    if (ret != 0 && tmpfile != NULL)
+        (void)remove(tmpfile);
+    OPENSSL_free(tmpfile);
+    OSSL_STACK_OF_X509_free(certs);
+    return ret;
+}
@@ -137,6 +137,62 @@
 #  endif
 # endif
 
+/* UDP segmentation offload (GSO) and receive coalescing (GRO), Linux only. */
+# if M_METHOD == M_METHOD_RECVMMSG && defined(OPENSSL_SYS_LINUX)
+#  include <netinet/udp.h>
+#  if defined(UDP_SEGMENT)
+#   define SUPPORT_UDP_GSO
+#  endif
+#  if defined(UDP_GRO)
+#   define SUPPORT_UDP_GRO
+#  endif
+# endif
+
+# if defined(SUPPORT_UDP_GSO)
+#  define BIO_SEG_OFFLOAD_CAP_TX    BIO_DGRAM_SEG_OFFLOAD_TX
+/*
+ * Limits on the datagrams coalesced into a single GSO send. The kernel accepts
+ * at most 64 segments, and the total must stay below the IP datagram limit.
+ */
+#  define BIO_GSO_MAX_SEGS          64
+#  define BIO_GSO_MAX_LEN           65000
+#  define BIO_CMSG_TX_ALLOC_LEN \
+        (BIO_CMSG_ALLOC_LEN + BIO_CMSG_SPACE(sizeof(uint16_t)))
+# else
+#  define BIO_SEG_OFFLOAD_CAP_TX    0
+#  define BIO_CMSG_TX_ALLOC_LEN     BIO_CMSG_ALLOC_LEN
+# endif
+
+# if defined(SUPPORT_UDP_GRO)
+#  define BIO_SEG_OFFLOAD_CAP_RX    BIO_DGRAM_SEG_OFFLOAD_RX
+/*
+ * With GRO enabled the kernel may return several datagrams from one sender as
+ * a single coalesced buffer. These are received into a set of slots and split
+ * back into datagrams over one or more BIO_recvmmsg() calls.
+ */
+#  define BIO_GRO_NUM_SLOTS         8
+#  define BIO_GRO_SLOT_LEN          65536
+#  define BIO_CMSG_RX_ALLOC_LEN \
+        (BIO_CMSG_ALLOC_LEN + BIO_CMSG_SPACE(sizeof(int)))
+
+typedef struct bio_dgram_gro_slot_st {
+    size_t len;             /* bytes received into this slot */
+    size_t seg_len;         /* size of each datagram but the last */
+    size_t off;             /* bytes already returned to the caller */
+    BIO_ADDR peer, local;
+} bio_dgram_gro_slot;
+
+typedef struct bio_dgram_gro_st {
+    unsigned char *buf;     /* BIO_GRO_NUM_SLOTS * BIO_GRO_SLOT_LEN bytes */
+    bio_dgram_gro_slot slot[BIO_GRO_NUM_SLOTS];
+    size_t num_slots, cur_slot;
+} bio_dgram_gro;
+# else
+#  define BIO_SEG_OFFLOAD_CAP_RX    0
+# endif
+
+# define BIO_SEG_OFFLOAD_CAP    (BIO_SEG_OFFLOAD_CAP_TX | BIO_SEG_OFFLOAD_CAP_RX)
+
 # define BIO_MSG_N(array, stride, n) (*(BIO_MSG *)((char *)(array) + (n)*(stride)))
 
 static int dgram_write(BIO *h, const char *buf, int num);
@@ -216,6 +272,10 @@ typedef struct bio_dgram_data_st {
     OSSL_TIME socket_timeout;
     unsigned int peekmode;
     char local_addr_enabled;
+    uint32_t seg_offload;
+# if defined(SUPPORT_UDP_GRO)
+    bio_dgram_gro *gro;
+# endif
 } bio_dgram_data;
 
 # ifndef OPENSSL_NO_SCTP
@@ -281,6 +341,12 @@ static int dgram_free(BIO *a)
         return 0;
 
     data = (bio_dgram_data *)a->ptr;
+# if defined(SUPPORT_UDP_GRO)
+    if (data->gro != NULL) {
+        OPENSSL_free(data->gro->buf);
+        OPENSSL_free(data->gro);
+    }
+# endif
     OPENSSL_free(data);
 
     return 1;
@@ -544,6 +610,76 @@ static int enable_local_addr(BIO *b, int enable) {
 }
 # endif
 
+/*
+ * Enables or disables segmentation offload on the socket. Returns 1 if all of
+ * the requested flags could be applied and 0 otherwise; in either case
+ * seg_offload reflects what is actually in effect.
+ */
+static int dgram_set_seg_offload(BIO *b, uint32_t flags)
+{
+    bio_dgram_data *data = (bio_dgram_data *)b->ptr;
+    int ok = 1;
+# if defined(SUPPORT_UDP_GSO) || defined(SUPPORT_UDP_GRO)
+    int v;
+# endif
+
+    if ((flags & ~(uint32_t)BIO_SEG_OFFLOAD_CAP) != 0) {
+        flags &= BIO_SEG_OFFLOAD_CAP;
+        ok = 0;
+    }
+
+    /* No socket yet; the flags are applied when one is set. */
+    if (!b->init) {
+        data->seg_offload = flags;
+        return ok;
+    }
+
+# if defined(SUPPORT_UDP_GSO)
+    /*
+     * The segment size is given per send in a control message, so this only
+     * checks that the kernel supports GSO on this socket.
+     */
+    if ((flags & BIO_DGRAM_SEG_OFFLOAD_TX) != 0) {
+        v = 0;
+        if (setsockopt(b->num, IPPROTO_UDP, UDP_SEGMENT,
+                       (void *)&v, sizeof(v)) < 0) {
+            flags &= ~BIO_DGRAM_SEG_OFFLOAD_TX;
+            ok = 0;
+        }
+    }
+# endif
+
+# if defined(SUPPORT_UDP_GRO)
+    v = (flags & BIO_DGRAM_SEG_OFFLOAD_RX) != 0;
+    if (v || (data->seg_offload & BIO_DGRAM_SEG_OFFLOAD_RX) != 0) {
+        if (v && data->gro == NULL) {
+            if ((data->gro = OPENSSL_zalloc(sizeof(*data->gro))) == NULL)
+                return 0;
+
+            data->gro->buf = OPENSSL_malloc(BIO_GRO_NUM_SLOTS * BIO_GRO_SLOT_LEN);
+            if (data->gro->buf == NULL) {
+                OPENSSL_free(data->gro);
+                data->gro = NULL;
+                return 0;
+            }
+        }
+
+        if (setsockopt(b->num, IPPROTO_UDP, UDP_GRO,
+                       (void *)&v, sizeof(v)) < 0) {
+            /* Whatever was in effect before still is. */
+            if (v)
+                flags &= ~BIO_DGRAM_SEG_OFFLOAD_RX;
+            else
+                flags |= BIO_DGRAM_SEG_OFFLOAD_RX;
+            ok = 0;
+        }
+    }
+# endif
+
+    data->seg_offload = flags;
+    return ok;
+}
+
 static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
 {
     long ret = 1;
@@ -589,6 +725,13 @@ static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
                 data->local_addr_enabled = 0;
         }
 # endif
+# if defined(SUPPORT_UDP_GRO)
+        /* Anything buffered came from the old socket. */
+        if (data->gro != NULL)
+            data->gro->num_slots = data->gro->cur_slot = 0;
+# endif
+        if (data->seg_offload != 0)
+            dgram_set_seg_offload(b, data->seg_offload);
         break;
     case BIO_C_GET_FD:
         if (b->init) {
@@ -999,6 +1142,18 @@ static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
         *(int *)ptr = data->local_addr_enabled;
         break;
 
+    case BIO_CTRL_DGRAM_GET_SEG_OFFLOAD_CAP:
+        ret = (long)BIO_SEG_OFFLOAD_CAP;
+        break;
+
+    case BIO_CTRL_DGRAM_GET_SEG_OFFLOAD:
+        ret = (long)data->seg_offload;
+        break;
+
+    case BIO_CTRL_DGRAM_SET_SEG_OFFLOAD:
+        ret = dgram_set_seg_offload(b, (uint32_t)num);
+        break;
+
     case BIO_CTRL_DGRAM_GET_EFFECTIVE_CAPS:
         ret = (long)(BIO_DGRAM_CAP_HANDLES_DST_ADDR
                      | BIO_DGRAM_CAP_HANDLES_SRC_ADDR
@@ -1311,6 +1466,98 @@ static int translate_flags(uint64_t flags) {
 }
 # endif
 
+# if defined(SUPPORT_UDP_GSO)
+static int dgram_addr_eq(const BIO_ADDR *a, const BIO_ADDR *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+
+    if (a->sa.sa_family != b->sa.sa_family)
+        return 0;
+
+    if (a->sa.sa_family == AF_INET)
+        return a->s_in.sin_port == b->s_in.sin_port
+            && a->s_in.sin_addr.s_addr == b->s_in.sin_addr.s_addr;
+#  if OPENSSL_USE_IPV6
+    if (a->sa.sa_family == AF_INET6)
+        return a->s_in6.sin6_port == b->s_in6.sin6_port
+            && a->s_in6.sin6_scope_id == b->s_in6.sin6_scope_id
+            && memcmp(&a->s_in6.sin6_addr, &b->s_in6.sin6_addr,
+                      sizeof(a->s_in6.sin6_addr)) == 0;
+#  endif
+    return 0;
+}
+
+/*
+ * Returns the number of messages at the start of msg which can be sent as one
+ * GSO send: they must have the same peer and local addresses, and every
+ * message but the last must be the same size, which the last must not exceed.
+ */
+static size_t dgram_gso_count(BIO_MSG *msg, size_t stride, size_t num_msg)
+{
+    const BIO_MSG *first = &BIO_MSG_N(msg, stride, 0), *m;
+    size_t i, total = first->data_len;
+
+    if (first->data_len == 0)
+        return 1;
+
+    for (i = 1; i < num_msg && i < BIO_GSO_MAX_SEGS; ++i) {
+        m = &BIO_MSG_N(msg, stride, i);
+        if (m->data_len == 0
+            || m->data_len > first->data_len
+            || total + m->data_len > BIO_GSO_MAX_LEN
+            || !dgram_addr_eq(m->peer, first->peer)
+            || !dgram_addr_eq(m->local, first->local))
+            break;
+
+        total += m->data_len;
+        if (m->data_len < first->data_len)
+            return i + 1;
+    }
+
+    return i;
+}
+
+/*
+ * Extends a msghdr already set up for the first of num_msg messages so that it
+ * sends all of them as a single GSO send.
+ */
+static void pack_gso(struct msghdr *mh, struct iovec *iov,
+                     unsigned char *control, BIO_MSG *msg, size_t stride,
+                     size_t num_msg)
+{
+    struct cmsghdr *cmsg;
+    uint16_t seg_len = (uint16_t)msg->data_len;
+    size_t i, off = mh->msg_control != NULL ? mh->msg_controllen : 0;
+
+    for (i = 1; i < num_msg; ++i) {
+        iov[i].iov_base = BIO_MSG_N(msg, stride, i).data;
+        iov[i].iov_len  = BIO_MSG_N(msg, stride, i).data_len;
+    }
+
+    mh->msg_iovlen = num_msg;
+
+    cmsg = (struct cmsghdr *)(control + off);
+    cmsg->cmsg_len   = BIO_CMSG_LEN(sizeof(seg_len));
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type  = UDP_SEGMENT;
+    memcpy(BIO_CMSG_DATA(cmsg), &seg_len, sizeof(seg_len));
+
+    mh->msg_control     = control;
+    mh->msg_controllen  = off + BIO_CMSG_SPACE(sizeof(seg_len));
+}
+
+/*
+ * Errors indicating that GSO cannot be used on this socket or path, for
+ * example because the egress device lacks checksum offload.
+ */
+static int dgram_gso_unusable(int err)
+{
+    return err == EIO || err == EINVAL || err == ENOPROTOOPT
+        || err == EOPNOTSUPP;
+}
+# endif
+
 static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
                           size_t num_msg, uint64_t flags, size_t *num_processed)
 {
@@ -1321,10 +1568,11 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
 #  define BIO_MAX_MSGS_PER_CALL   64
     int sysflags;
     bio_dgram_data *data = (bio_dgram_data *)b->ptr;
-    size_t i;
+    size_t i, j, n;
     struct mmsghdr mh[BIO_MAX_MSGS_PER_CALL];
     struct iovec iov[BIO_MAX_MSGS_PER_CALL];
-    unsigned char control[BIO_MAX_MSGS_PER_CALL][BIO_CMSG_ALLOC_LEN];
+    unsigned char control[BIO_MAX_MSGS_PER_CALL][BIO_CMSG_TX_ALLOC_LEN];
+    size_t seg_count[BIO_MAX_MSGS_PER_CALL];
     int have_local_enabled = data->local_addr_enabled;
 # elif M_METHOD == M_METHOD_RECVMSG
     int sysflags;
@@ -1369,41 +1617,73 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
     if (num_msg > BIO_MAX_MSGS_PER_CALL)
         num_msg = BIO_MAX_MSGS_PER_CALL;
 
-    for (i = 0; i < num_msg; ++i) {
-        translate_msg(b, &mh[i].msg_hdr, &iov[i],
-                      control[i], &BIO_MSG_N(msg, stride, i));
+    for (;;) {
+        /*
+         * Each mmsghdr normally carries one message. With GSO enabled, runs of
+         * equally sized messages to the same destination share one mmsghdr
+         * and go to the kernel as a single buffer which it splits on the wire.
+         */
+        for (i = 0, n = 0; i < num_msg; i += seg_count[n], ++n) {
+            translate_msg(b, &mh[n].msg_hdr, &iov[i],
+                          control[n], &BIO_MSG_N(msg, stride, i));
+
+            /* If local address was requested, it must have been enabled */
+            if (BIO_MSG_N(msg, stride, i).local != NULL) {
+                if (!have_local_enabled) {
+                    ERR_raise(ERR_LIB_BIO, BIO_R_LOCAL_ADDR_NOT_AVAILABLE);
+                    *num_processed = 0;
+                    return 0;
+                }
 
-        /* If local address was requested, it must have been enabled */
-        if (BIO_MSG_N(msg, stride, i).local != NULL) {
-            if (!have_local_enabled) {
-                ERR_raise(ERR_LIB_BIO, BIO_R_LOCAL_ADDR_NOT_AVAILABLE);
-                *num_processed = 0;
-                return 0;
+                if (pack_local(b, &mh[n].msg_hdr,
+                               BIO_MSG_N(msg, stride, i).local) < 1) {
+                    ERR_raise(ERR_LIB_BIO, BIO_R_LOCAL_ADDR_NOT_AVAILABLE);
+                    *num_processed = 0;
+                    return 0;
+                }
             }
 
-            if (pack_local(b, &mh[i].msg_hdr,
-                           BIO_MSG_N(msg, stride, i).local) < 1) {
-                ERR_raise(ERR_LIB_BIO, BIO_R_LOCAL_ADDR_NOT_AVAILABLE);
-                *num_processed = 0;
-                return 0;
-            }
+            seg_count[n] = 1;
+#  if defined(SUPPORT_UDP_GSO)
+            if ((data->seg_offload & BIO_DGRAM_SEG_OFFLOAD_TX) != 0)
+                seg_count[n] = dgram_gso_count(&BIO_MSG_N(msg, stride, i),
+                                               stride, num_msg - i);
+
+            if (seg_count[n] > 1)
+                pack_gso(&mh[n].msg_hdr, &iov[i], control[n],
+                         &BIO_MSG_N(msg, stride, i), stride, seg_count[n]);
+#  endif
+        }
+
+        /* Do the batch */
+        ret = sendmmsg(b->num, mh, n, sysflags);
+#  if defined(SUPPORT_UDP_GSO)
+        if (ret < 0 && seg_count[0] > 1
+            && dgram_gso_unusable(get_last_socket_error())) {
+            /* Stop using GSO on this BIO and send the batch without it. */
+            data->seg_offload &= ~BIO_DGRAM_SEG_OFFLOAD_TX;
+            continue;
         }
+#  endif
+        break;
     }
 
-    /* Do the batch */
-    ret = sendmmsg(b->num, mh, num_msg, sysflags);
     if (ret < 0) {
         ERR_raise(ERR_LIB_SYS, get_last_socket_error());
         *num_processed = 0;
         return 0;
     }
 
-    for (i = 0; i < (size_t)ret; ++i) {
-        BIO_MSG_N(msg, stride, i).data_len = mh[i].msg_len;
-        BIO_MSG_N(msg, stride, i).flags    = 0;
+    for (i = 0, n = 0; n < (size_t)ret; ++n) {
+        /* A GSO send is all or nothing, so each message was sent in full. */
+        if (seg_count[n] == 1)
+            BIO_MSG_N(msg, stride, i).data_len = mh[n].msg_len;
+
+        for (j = 0; j < seg_count[n]; ++j, ++i)
+            BIO_MSG_N(msg, stride, i).flags = 0;
     }
 
-    *num_processed = (size_t)ret;
+    *num_processed = i;
     return 1;
 
 # elif M_METHOD == M_METHOD_RECVMSG
@@ -1512,6 +1792,136 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
 # endif
 }
 
+# if defined(SUPPORT_UDP_GRO)
+/* Receives into the GRO slots. Only called once they have all been consumed. */
+static int dgram_gro_fill(BIO *b, int sysflags)
+{
+    bio_dgram_data *data = (bio_dgram_data *)b->ptr;
+    bio_dgram_gro *gro = data->gro;
+    bio_dgram_gro_slot *slot;
+    struct mmsghdr mh[BIO_GRO_NUM_SLOTS];
+    struct iovec iov[BIO_GRO_NUM_SLOTS];
+    unsigned char control[BIO_GRO_NUM_SLOTS][BIO_CMSG_RX_ALLOC_LEN];
+    struct cmsghdr *cmsg;
+    BIO_MSG m = {0};
+    size_t i;
+    int ret, seg_len;
+
+    for (i = 0; i < BIO_GRO_NUM_SLOTS; ++i) {
+        slot = &gro->slot[i];
+        BIO_ADDR_clear(&slot->peer);
+        BIO_ADDR_clear(&slot->local);
+
+        m.data      = gro->buf + i * BIO_GRO_SLOT_LEN;
+        m.data_len  = BIO_GRO_SLOT_LEN;
+        m.peer      = &slot->peer;
+        translate_msg(b, &mh[i].msg_hdr, &iov[i], control[i], &m);
+
+        /* The control buffer is always needed to learn the segment size. */
+        mh[i].msg_hdr.msg_control    = control[i];
+        mh[i].msg_hdr.msg_controllen = sizeof(control[i]);
+    }
+
+    /* Do not wait for more than one buffer, even on a blocking socket. */
+    ret = recvmmsg(b->num, mh, BIO_GRO_NUM_SLOTS, sysflags | MSG_WAITFORONE,
+                   NULL);
+    if (ret < 0) {
+        ERR_raise(ERR_LIB_SYS, get_last_socket_error());
+        return 0;
+    }
+
+    for (i = 0; i < (size_t)ret; ++i) {
+        slot = &gro->slot[i];
+        slot->len       = mh[i].msg_len;
+        slot->seg_len   = slot->len;
+        slot->off       = 0;
+
+        for (cmsg = BIO_CMSG_FIRSTHDR(&mh[i].msg_hdr); cmsg != NULL;
+             cmsg = BIO_CMSG_NXTHDR(&mh[i].msg_hdr, cmsg)) {
+            if (cmsg->cmsg_level != IPPROTO_UDP || cmsg->cmsg_type != UDP_GRO)
+                continue;
+
+            memcpy(&seg_len, BIO_CMSG_DATA(cmsg), sizeof(seg_len));
+            if (seg_len > 0)
+                slot->seg_len = (size_t)seg_len;
+        }
+
+        if (data->connected)
+            slot->peer = data->peer;
+
+        if (data->local_addr_enabled
+            && extract_local(b, &mh[i].msg_hdr, &slot->local) < 1)
+            BIO_ADDR_clear(&slot->local);
+    }
+
+    gro->num_slots  = (size_t)ret;
+    gro->cur_slot   = 0;
+    return 1;
+}
+
+/* Returns the next datagram buffered in the GRO slots. */
+static void dgram_gro_take(bio_dgram_gro *gro, BIO_MSG *msg)
+{
+    bio_dgram_gro_slot *slot = &gro->slot[gro->cur_slot];
+    size_t len = slot->len - slot->off;
+
+    if (len > slot->seg_len)
+        len = slot->seg_len;
+
+    /* As for an ordinary receive, silently truncate to the buffer given. */
+    if (msg->data_len > len)
+        msg->data_len = len;
+
+    memcpy(msg->data, gro->buf + gro->cur_slot * BIO_GRO_SLOT_LEN + slot->off,
+           msg->data_len);
+    msg->flags = 0;
+    if (msg->peer != NULL)
+        *msg->peer = slot->peer;
+    if (msg->local != NULL)
+        *msg->local = slot->local;
+
+    slot->off += len;
+    if (slot->off >= slot->len)
+        ++gro->cur_slot;
+}
+
+static int dgram_recvmmsg_gro(BIO *b, BIO_MSG *msg, size_t stride,
+                              size_t num_msg, int sysflags,
+                              size_t *num_processed)
+{
+    bio_dgram_data *data = (bio_dgram_data *)b->ptr;
+    bio_dgram_gro *gro = data->gro;
+    size_t i;
+
+    /* If local address was requested, it must have been enabled */
+    for (i = 0; i < num_msg; ++i)
+        if (BIO_MSG_N(msg, stride, i).local != NULL
+            && !data->local_addr_enabled) {
+            ERR_raise(ERR_LIB_BIO, BIO_R_LOCAL_ADDR_NOT_AVAILABLE);
+            *num_processed = 0;
+            return 0;
+        }
+
+    for (i = 0; i < num_msg; ++i) {
+        if (gro->cur_slot == gro->num_slots) {
+            /* Return what we have rather than make another syscall. */
+            if (i > 0)
+                break;
+
+            if (!dgram_gro_fill(b, sysflags)) {
+                *num_processed = 0;
+                return 0;
+            }
+        }
+
+        dgram_gro_take(gro, &BIO_MSG_N(msg, stride, i));
+    }
+
+    *num_processed = i;
+    return 1;
+}
+# endif
+
 static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
                           size_t stride, size_t num_msg,
                           uint64_t flags, size_t *num_processed)
@@ -1568,6 +1978,14 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
      * expectation that we will be called again if there were more messages to
      * be sent.
      */
+#  if defined(SUPPORT_UDP_GRO)
+    /* Datagrams may still be buffered after GRO has been disabled. */
+    if ((data->seg_offload & BIO_DGRAM_SEG_OFFLOAD_RX) != 0
+        || (data->gro != NULL && data->gro->cur_slot < data->gro->num_slots))
+        return dgram_recvmmsg_gro(b, msg, stride, num_msg, sysflags,
+                                  num_processed);
+#  endif
+
     if (num_msg > BIO_MAX_MSGS_PER_CALL)
         num_msg = BIO_MAX_MSGS_PER_CALL;
 
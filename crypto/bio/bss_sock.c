@@ -254,6 +254,9 @@ static long sock_ctrl(BIO *b, int cmd, long num, void *ptr)
         if (ret)
             BIO_set_ktls_zerocopy_sendfile_flag(b);
         break;
+    case BIO_CTRL_SET_KTLS_RX_EXPECT_NO_PAD:
+        ret = ktls_enable_rx_expect_no_pad(b->num);
+        break;
 # endif
     case BIO_CTRL_EOF:
         ret = (b->flags & BIO_FLAGS_IN_EOF) != 0;
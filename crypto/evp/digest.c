@@ -622,6 +622,30 @@ int EVP_MD_CTX_copy_ex(EVP_MD_CTX *out, const EVP_MD_CTX *in)
             || (in->flags & EVP_MD_CTX_FLAG_NO_INIT) != 0)
         goto legacy;
 
+    /*
+     * If |out| already holds a provider context for the same digest, let the
+     * provider copy the state over in place rather than allocating a fresh
+     * context.  This keeps snapshot/restore loops allocation free.  Providers
+     * may decline, in which case we fall back to duplicating the context.
+     */
+    if (in->digest->copyctx != NULL
+            && out->digest == in->digest
+            && out->fetched_digest == in->fetched_digest
+            && out->algctx != NULL && in->algctx != NULL
+            && out->pctx == NULL && in->pctx == NULL) {
+        int ok;
+
+        ERR_set_mark();
+        ok = in->digest->copyctx(out->algctx, in->algctx);
+        ERR_pop_to_mark();
+        if (ok) {
+            out->flags = in->flags;
+            out->update = in->update;
+            EVP_MD_CTX_clear_flags(out, EVP_MD_CTX_FLAG_KEEP_PKEY_CTX);
+            return 1;
+        }
+    }
+
     if (in->digest->dupctx == NULL) {
         ERR_raise(ERR_LIB_EVP, EVP_R_NOT_ABLE_TO_COPY_CTX);
         return 0;
@@ -738,6 +762,53 @@ int EVP_Digest(const void *data, size_t count,
     return ret;
 }
 
+int EVP_DigestBatch(const EVP_MD *type, size_t n,
+                    const unsigned char *const data[], const size_t count[],
+                    unsigned char *const md[], unsigned int *size)
+{
+    EVP_MD_CTX *ctx;
+    const EVP_MD *digest;
+    size_t i;
+    int mdsize, ret = 0;
+
+    if (n > 0 && (data == NULL || count == NULL || md == NULL)) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if ((ctx = EVP_MD_CTX_new()) == NULL)
+        return 0;
+
+    /*
+     * Let the init resolve engines and implicit fetches for us, then hand
+     * the whole lot to the provider if it can hash several messages at once.
+     * Otherwise, the same context is reinitialised for every message.
+     */
+    if (!EVP_DigestInit_ex(ctx, type, NULL))
+        goto err;
+    digest = ctx->digest;
+    if ((mdsize = EVP_MD_get_size(digest)) <= 0) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_INVALID_DIGEST);
+        goto err;
+    }
+
+    if (digest->prov != NULL && digest->digest_batch != NULL) {
+        ret = digest->digest_batch(ossl_provider_ctx(digest->prov), n,
+                                   data, count, md, (size_t)mdsize);
+    } else {
+        for (i = 0; i < n; i++)
+            if ((i > 0 && !EVP_DigestInit_ex(ctx, NULL, NULL))
+                    || !EVP_DigestUpdate(ctx, data[i], count[i])
+                    || !EVP_DigestFinal_ex(ctx, md[i], NULL))
+                goto err;
+        ret = 1;
+    }
+    if (ret && size != NULL)
+        *size = (unsigned int)mdsize;
+ err:
+    EVP_MD_CTX_free(ctx);
+    return ret;
+}
+
 int EVP_Q_digest(OSSL_LIB_CTX *libctx, const char *name, const char *propq,
                  const void *data, size_t datalen,
                  unsigned char *md, size_t *mdlen)
@@ -1082,6 +1153,15 @@ static void *evp_md_from_algorithm(int name_id,
             if (md->dupctx == NULL)
                 md->dupctx = OSSL_FUNC_digest_dupctx(fns);
             break;
+        case OSSL_FUNC_DIGEST_COPYCTX:
+            if (md->copyctx == NULL)
+                md->copyctx = OSSL_FUNC_digest_copyctx(fns);
+            break;
+        case OSSL_FUNC_DIGEST_DIGEST_BATCH:
+            if (md->digest_batch == NULL)
+                md->digest_batch = OSSL_FUNC_digest_digest_batch(fns);
+            /* We don't increment fnct for this as it is stand alone */
+            break;
         case OSSL_FUNC_DIGEST_GET_PARAMS:
             if (md->get_params == NULL)
                 md->get_params = OSSL_FUNC_digest_get_params(fns);
@@ -1464,6 +1464,30 @@ int EVP_CIPHER_CTX_copy(EVP_CIPHER_CTX *out, const EVP_CIPHER_CTX *in)
     if (in->cipher->prov == NULL)
         goto legacy;
 
+    /*
+     * Restoring a saved context into one that already holds a provider
+     * context for the same cipher: copy the state over in place, which
+     * avoids reallocating (and for some ciphers re-deriving) the key
+     * schedule.  Providers may decline, in which case we fall back to
+     * duplicating the context.
+     */
+    if (in->cipher->copyctx != NULL
+            && out->cipher == in->cipher
+            && out->fetched_cipher == in->fetched_cipher
+            && out->algctx != NULL && in->algctx != NULL) {
+        void *algctx = out->algctx;
+        int ok;
+
+        ERR_set_mark();
+        ok = in->cipher->copyctx(algctx, in->algctx);
+        ERR_pop_to_mark();
+        if (ok) {
+            *out = *in;
+            out->algctx = algctx;
+            return 1;
+        }
+    }
+
     if (in->cipher->dupctx == NULL) {
         ERR_raise(ERR_LIB_EVP, EVP_R_NOT_ABLE_TO_COPY_CTX);
         return 0;
@@ -1639,6 +1663,11 @@ static void *evp_cipher_from_algorithm(const int name_id,
                 break;
             cipher->dupctx = OSSL_FUNC_cipher_dupctx(fns);
             break;
+        case OSSL_FUNC_CIPHER_COPYCTX:
+            if (cipher->copyctx != NULL)
+                break;
+            cipher->copyctx = OSSL_FUNC_cipher_copyctx(fns);
+            break;
         case OSSL_FUNC_CIPHER_GET_PARAMS:
             if (cipher->get_params != NULL)
                 break;
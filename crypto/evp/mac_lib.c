@@ -74,6 +74,47 @@ EVP_MAC_CTX *EVP_MAC_CTX_dup(const EVP_MAC_CTX *src)
     return dst;
 }
 
+int EVP_MAC_CTX_copy(EVP_MAC_CTX *dst, const EVP_MAC_CTX *src)
+{
+    void *algctx;
+
+    if (dst == NULL || src == NULL || src->algctx == NULL) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if (dst == src)
+        return 1;
+
+    /* Same implementation on both sides: restore in place */
+    if (dst->meth == src->meth && dst->algctx != NULL
+            && src->meth->copyctx != NULL) {
+        int ok;
+
+        ERR_set_mark();
+        ok = src->meth->copyctx(dst->algctx, src->algctx);
+        ERR_pop_to_mark();
+        if (ok)
+            return 1;
+    }
+
+    if (src->meth->dupctx == NULL
+            || (algctx = src->meth->dupctx(src->algctx)) == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_NOT_ABLE_TO_COPY_CTX);
+        return 0;
+    }
+    if (!EVP_MAC_up_ref(src->meth)) {
+        src->meth->freectx(algctx);
+        ERR_raise(ERR_LIB_EVP, ERR_R_EVP_LIB);
+        return 0;
+    }
+    if (dst->algctx != NULL)
+        dst->meth->freectx(dst->algctx);
+    EVP_MAC_free(dst->meth);
+    dst->meth = src->meth;
+    dst->algctx = algctx;
+    return 1;
+}
+
 EVP_MAC *EVP_MAC_CTX_get0_mac(EVP_MAC_CTX *ctx)
 {
     return ctx->meth;
@@ -86,6 +86,11 @@ static void *evp_mac_from_algorithm(int name_id,
                 break;
             mac->dupctx = OSSL_FUNC_mac_dupctx(fns);
             break;
+        case OSSL_FUNC_MAC_COPYCTX:
+            if (mac->copyctx != NULL)
+                break;
+            mac->copyctx = OSSL_FUNC_mac_copyctx(fns);
+            break;
         case OSSL_FUNC_MAC_FREECTX:
             if (mac->freectx != NULL)
                 break;
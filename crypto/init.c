@@ -30,6 +30,7 @@
 #include "crypto/dso_conf.h"
 #include "internal/dso.h"
 #include "crypto/store.h"
+#include "internal/property.h"
 #include <openssl/cmp_util.h> /* for OSSL_CMP_log_close() */
 #include <openssl/trace.h>
 #include "crypto/ctype.h"
@@ -441,6 +442,9 @@ void OPENSSL_cleanup(void)
 
     ossl_cleanup_thread();
 
+    OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_method_store_tcache_cleanup()\n");
+    ossl_method_store_tcache_cleanup();
+
     OSSL_TRACE(INIT, "OPENSSL_cleanup: bio_cleanup()\n");
     bio_cleanup();
 
@@ -24,6 +24,7 @@
 #include "crypto/sparse_array.h"
 #include "property_local.h"
 #include "crypto/context.h"
+#include "crypto/cryptlib.h"
 
 /*
  * The number of elements in the query cache before we initiate a flush.
@@ -85,6 +86,17 @@ struct ossl_method_store_st {
 
     /* Flag: 1 if query cache entries for all algs need flushing */
     int cache_need_flush;
+
+#ifndef FIPS_MODULE
+    /*
+     * Incremented whenever query cache entries are invalidated, so that
+     * the per thread caches can tell that their copies are stale.
+     */
+    TSAN_QUALIFIER size_t generation;
+
+    /* Flag: 1 if any per thread cache may hold entries for this store */
+    TSAN_QUALIFIER int tcache_used;
+#endif
 };
 
 typedef struct {
@@ -183,6 +195,251 @@ static int ossl_property_unlock(OSSL_METHOD_STORE *p)
     return p != 0 ? CRYPTO_THREAD_unlock(p->lock) : 0;
 }
 
+#ifndef FIPS_MODULE
+/*
+ * Each thread keeps a small direct mapped cache in front of the query caches
+ * of the method stores, so that repeated fetches of the same method don't
+ * need to take the store lock, which is shared by all threads.  An entry holds
+ * a reference to its method and is valid while the generation of its store is
+ * unchanged.  The caches of all threads are linked together so that the
+ * entries for a store can be dropped when its methods are removed or the
+ * store is freed.  The lock of a thread's cache is only contended in these
+ * cases.
+ */
+# define METHOD_TCACHE_SIZE         32
+# define METHOD_TCACHE_QUERY_MAX    32
+
+typedef struct {
+    const OSSL_METHOD_STORE *store;
+    const OSSL_PROVIDER *provider;
+    int nid;
+    size_t generation;
+    METHOD method;
+    char query[METHOD_TCACHE_QUERY_MAX];
+} METHOD_TCACHE_ENTRY;
+
+typedef struct method_tcache_st METHOD_TCACHE;
+struct method_tcache_st {
+    CRYPTO_RWLOCK *lock;
+    METHOD_TCACHE *prev, *next;
+    METHOD_TCACHE_ENTRY entries[METHOD_TCACHE_SIZE];
+};
+
+static CRYPTO_ONCE tcache_init = CRYPTO_ONCE_STATIC_INIT;
+static CRYPTO_THREAD_LOCAL tcache_local;
+static CRYPTO_RWLOCK *tcache_lock = NULL;
+static METHOD_TCACHE *tcaches = NULL;
+static int tcache_inited = 0;
+
+DEFINE_RUN_ONCE_STATIC(do_tcache_init)
+{
+    if ((tcache_lock = CRYPTO_THREAD_lock_new()) == NULL)
+        return 0;
+    if (!CRYPTO_THREAD_init_local(&tcache_local, NULL)) {
+        CRYPTO_THREAD_lock_free(tcache_lock);
+        tcache_lock = NULL;
+        return 0;
+    }
+    tcache_inited = 1;
+    return 1;
+}
+
+static size_t tcache_index(const OSSL_METHOD_STORE *store,
+                           const OSSL_PROVIDER *prov, int nid)
+{
+    size_t h = (size_t)nid * 0x9e3779b1U;
+
+    h ^= (size_t)store >> 4;
+    h ^= (size_t)prov >> 4;
+    return (h ^ (h >> 7)) % METHOD_TCACHE_SIZE;
+}
+
+static void tcache_free(METHOD_TCACHE *tc)
+{
+    size_t i;
+
+    for (i = 0; i < METHOD_TCACHE_SIZE; i++)
+        if (tc->entries[i].method.method != NULL)
+            ossl_method_free(&tc->entries[i].method);
+    CRYPTO_THREAD_lock_free(tc->lock);
+    OPENSSL_free(tc);
+}
+
+static void tcache_unlink(METHOD_TCACHE *tc)
+{
+    if (tc->prev != NULL)
+        tc->prev->next = tc->next;
+    else
+        tcaches = tc->next;
+    if (tc->next != NULL)
+        tc->next->prev = tc->prev;
+}
+
+static void tcache_delete_thread_state(void *unused)
+{
+    METHOD_TCACHE *tc;
+
+    if (!tcache_inited
+            || (tc = CRYPTO_THREAD_get_local(&tcache_local)) == NULL)
+        return;
+    CRYPTO_THREAD_set_local(&tcache_local, NULL);
+    if (!CRYPTO_THREAD_write_lock(tcache_lock))
+        return;
+    tcache_unlink(tc);
+    CRYPTO_THREAD_unlock(tcache_lock);
+    tcache_free(tc);
+}
+
+static METHOD_TCACHE *tcache_get_local(int create)
+{
+    METHOD_TCACHE *tc;
+
+    /* Once cleaned up, the cache isn't set up again */
+    if ((create && !RUN_ONCE(&tcache_init, do_tcache_init)) || !tcache_inited)
+        return NULL;
+    if ((tc = CRYPTO_THREAD_get_local(&tcache_local)) != NULL || !create)
+        return tc;
+
+    if ((tc = OPENSSL_zalloc(sizeof(*tc))) == NULL)
+        return NULL;
+    if ((tc->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        OPENSSL_free(tc);
+        return NULL;
+    }
+    if (!CRYPTO_THREAD_write_lock(tcache_lock)) {
+        tcache_free(tc);
+        return NULL;
+    }
+    if (!ossl_init_thread_start(NULL, NULL, tcache_delete_thread_state)
+            || !CRYPTO_THREAD_set_local(&tcache_local, tc)) {
+        CRYPTO_THREAD_unlock(tcache_lock);
+        tcache_free(tc);
+        return NULL;
+    }
+    tc->next = tcaches;
+    if (tcaches != NULL)
+        tcaches->prev = tc;
+    tcaches = tc;
+    CRYPTO_THREAD_unlock(tcache_lock);
+    return tc;
+}
+
+static int tcache_get(const OSSL_METHOD_STORE *store,
+                      const OSSL_PROVIDER *prov, int nid,
+                      const char *prop_query, void **method)
+{
+    METHOD_TCACHE *tc = tcache_get_local(0);
+    METHOD_TCACHE_ENTRY *e;
+    int res = 0;
+
+    if (tc == NULL || !CRYPTO_THREAD_write_lock(tc->lock))
+        return 0;
+    e = &tc->entries[tcache_index(store, prov, nid)];
+    if (e->method.method != NULL
+            && e->store == store
+            && e->nid == nid
+            && e->provider == prov
+            && e->generation == tsan_load(&store->generation)
+            && strcmp(e->query, prop_query) == 0
+            && ossl_method_up_ref(&e->method)) {
+        *method = e->method.method;
+        res = 1;
+    }
+    CRYPTO_THREAD_unlock(tc->lock);
+    return res;
+}
+
+/*
+ * Cache |method|, found in the query cache of |store| while it had the
+ * generation |generation|, in the calling thread's cache.
+ */
+static void tcache_set(OSSL_METHOD_STORE *store, const OSSL_PROVIDER *prov,
+                       int nid, const char *prop_query, const METHOD *method,
+                       size_t generation)
+{
+    METHOD_TCACHE *tc;
+    METHOD_TCACHE_ENTRY *e;
+    METHOD old;
+    size_t len = strlen(prop_query);
+
+    if (len >= METHOD_TCACHE_QUERY_MAX
+            || (tc = tcache_get_local(1)) == NULL)
+        return;
+
+    old.method = NULL;
+    old.up_ref = NULL;
+    old.free = NULL;
+    if (!CRYPTO_THREAD_write_lock(tc->lock))
+        return;
+    e = &tc->entries[tcache_index(store, prov, nid)];
+    if (e->method.method != NULL)
+        old = e->method;
+    e->method = *method;
+    if (ossl_method_up_ref(&e->method)) {
+        e->store = store;
+        e->provider = prov;
+        e->nid = nid;
+        e->generation = generation;
+        memcpy(e->query, prop_query, len + 1);
+        tsan_store(&store->tcache_used, 1);
+    } else {
+        e->method.method = NULL;
+    }
+    CRYPTO_THREAD_unlock(tc->lock);
+    /* The old method is freed without holding any lock */
+    if (old.method != NULL)
+        ossl_method_free(&old);
+}
+
+/*
+ * Drop the entries for |store| from the caches of all threads.  This must not
+ * be called with the store lock held, as freeing a method may need it.
+ */
+static void tcache_flush_store(OSSL_METHOD_STORE *store)
+{
+    METHOD_TCACHE *tc;
+    METHOD freed[METHOD_TCACHE_SIZE];
+    size_t i, n;
+
+    if (!tcache_inited || !tsan_load(&store->tcache_used)
+            || !CRYPTO_THREAD_read_lock(tcache_lock))
+        return;
+    for (tc = tcaches; tc != NULL; tc = tc->next) {
+        if (!CRYPTO_THREAD_write_lock(tc->lock))
+            continue;
+        for (i = n = 0; i < METHOD_TCACHE_SIZE; i++) {
+            METHOD_TCACHE_ENTRY *e = &tc->entries[i];
+
+            if (e->method.method != NULL && e->store == store) {
+                freed[n++] = e->method;
+                e->method.method = NULL;
+                e->store = NULL;
+            }
+        }
+        CRYPTO_THREAD_unlock(tc->lock);
+        for (i = 0; i < n; i++)
+            ossl_method_free(&freed[i]);
+    }
+    CRYPTO_THREAD_unlock(tcache_lock);
+}
+
+void ossl_method_store_tcache_cleanup(void)
+{
+    METHOD_TCACHE *tc;
+
+    if (!tcache_inited)
+        return;
+    tcache_inited = 0;
+    while ((tc = tcaches) != NULL) {
+        tcaches = tc->next;
+        tcache_free(tc);
+    }
+    CRYPTO_THREAD_cleanup_local(&tcache_local);
+    CRYPTO_THREAD_lock_free(tcache_lock);
+    tcache_lock = NULL;
+}
+#endif
+
 static unsigned long query_hash(const QUERY *a)
 {
     return OPENSSL_LH_strhash(a->query);
@@ -259,6 +516,9 @@ OSSL_METHOD_STORE *ossl_method_store_new(OSSL_LIB_CTX *ctx)
 void ossl_method_store_free(OSSL_METHOD_STORE *store)
 {
     if (store != NULL) {
+#ifndef FIPS_MODULE
+        tcache_flush_store(store);
+#endif
         if (store->algs != NULL)
             ossl_sa_ALGORITHM_doall_arg(store->algs, &alg_cleanup, store);
         ossl_sa_ALGORITHM_free(store->algs);
@@ -453,6 +713,10 @@ int ossl_method_store_remove_all_provided(OSSL_METHOD_STORE *store,
     data.store = store;
     ossl_sa_ALGORITHM_doall_arg(store->algs, &alg_cleanup_by_provider, &data);
     ossl_property_unlock(store);
+#ifndef FIPS_MODULE
+    /* Don't keep the provider's methods alive in other threads */
+    tcache_flush_store(store);
+#endif
     return 1;
 }
 
@@ -592,6 +856,9 @@ static void ossl_method_cache_flush_alg(OSSL_METHOD_STORE *store,
 {
     store->cache_nelem -= lh_QUERY_num_items(alg->cache);
     impl_cache_flush_alg(0, alg);
+#ifndef FIPS_MODULE
+    tsan_counter(&store->generation);
+#endif
 }
 
 static void ossl_method_cache_flush(OSSL_METHOD_STORE *store, int nid)
@@ -608,7 +875,13 @@ int ossl_method_store_cache_flush_all(OSSL_METHOD_STORE *store)
         return 0;
     ossl_sa_ALGORITHM_doall(store->algs, &impl_cache_flush_alg);
     store->cache_nelem = 0;
+#ifndef FIPS_MODULE
+    tsan_counter(&store->generation);
+#endif
     ossl_property_unlock(store);
+#ifndef FIPS_MODULE
+    tcache_flush_store(store);
+#endif
     return 1;
 }
 
@@ -692,10 +965,19 @@ int ossl_method_store_cache_get(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
     ALGORITHM *alg;
     QUERY elem, *r;
     int res = 0;
+#ifndef FIPS_MODULE
+    METHOD found;
+    size_t generation = 0;
+#endif
 
     if (nid <= 0 || store == NULL || prop_query == NULL)
         return 0;
 
+#ifndef FIPS_MODULE
+    if (tcache_get(store, prov, nid, prop_query, method))
+        return 1;
+#endif
+
     if (!ossl_property_read_lock(store))
         return 0;
     alg = ossl_method_store_retrieve(store, nid);
@@ -710,9 +992,18 @@ int ossl_method_store_cache_get(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
     if (ossl_method_up_ref(&r->method)) {
         *method = r->method.method;
         res = 1;
+#ifndef FIPS_MODULE
+        found = r->method;
+        generation = tsan_load(&store->generation);
+#endif
     }
 err:
     ossl_property_unlock(store);
+#ifndef FIPS_MODULE
+    /* The reference returned to the caller keeps |found| alive */
+    if (res)
+        tcache_set(store, prov, nid, prop_query, &found, generation);
+#endif
     return res;
 }
 
@@ -746,6 +1037,9 @@ int ossl_method_store_cache_set(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
         if ((old = lh_QUERY_delete(alg->cache, &elem)) != NULL) {
             impl_cache_free(old);
             store->cache_nelem--;
+#ifndef FIPS_MODULE
+            tsan_counter(&store->generation);
+#endif
         }
         goto end;
     }
@@ -761,6 +1055,9 @@ int ossl_method_store_cache_set(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
         memcpy((char *)p->query, prop_query, len + 1);
         if ((old = lh_QUERY_insert(alg->cache, p)) != NULL) {
             impl_cache_free(old);
+#ifndef FIPS_MODULE
+            tsan_counter(&store->generation);
+#endif
             goto end;
         }
         if (!lh_QUERY_error(alg->cache)) {
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * SHA low level APIs are deprecated for public use, but still ok for
+ * internal use.
+ */
+#include "internal/deprecated.h"
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+#include "internal/cryptlib.h"
+#include "crypto/sha.h"
+
+/*
+ * Hashing of many independent messages at once.  On x86_64 the multi-buffer
+ * kernels from sha1-mb-x86_64.pl and sha256-mb-x86_64.pl interleave up to
+ * eight messages in the SIMD lanes, everywhere else we simply loop.
+ */
+
+#if defined(SHA1_ASM) && defined(SHA256_ASM) \
+    && (defined(__x86_64) || defined(_M_AMD64) || defined(_M_X64))
+# define SHA_MULTI_BLOCK
+#endif
+
+#ifdef SHA_MULTI_BLOCK
+
+# define MB_LANES 8
+/* Cap on blocks per kernel call, keeps HASH_DESC.blocks well inside an int */
+# define MB_MAX_BLOCKS (1 << 24)
+/* SSSE3, which all of the multi-buffer code paths require */
+# define MB_CAPABLE (OPENSSL_ia32cap_P[1] & (1 << (41 - 32)))
+
+typedef struct {
+    unsigned int A[8], B[8], C[8], D[8], E[8];
+} SHA1_MB_CTX;
+
+typedef struct {
+    unsigned int A[8], B[8], C[8], D[8], E[8], F[8], G[8], H[8];
+} SHA256_MB_CTX;
+
+typedef struct {
+    const unsigned char *ptr;
+    int blocks;
+} HASH_DESC;
+
+void sha1_multi_block(SHA1_MB_CTX *, const HASH_DESC *, int);
+void sha256_multi_block(SHA256_MB_CTX *, const HASH_DESC *, int);
+
+/* Lane state, one row per chaining variable, one column per lane */
+typedef SHA_LONG MB_STATE[8][MB_LANES];
+
+typedef void (*mb_block_fn)(MB_STATE st, const HASH_DESC *inp, int num);
+
+static void sha1_mb_block(MB_STATE st, const HASH_DESC *inp, int num)
+{
+    sha1_multi_block((SHA1_MB_CTX *)st, inp, num);
+}
+
+static void sha256_mb_block(MB_STATE st, const HASH_DESC *inp, int num)
+{
+    sha256_multi_block((SHA256_MB_CTX *)st, inp, num);
+}
+
+/*
+ * Hash up to MB_LANES messages in parallel.  The kernels give up at the first
+ * group of lanes that has nothing to do, so lanes are ordered by the number
+ * of full blocks, longest first, to keep idle lanes behind the active ones.
+ * Padding is done here, into a per lane buffer holding the last one or two
+ * blocks.
+ */
+static void sha_mb_group(mb_block_fn block, const SHA_LONG *iv, size_t words,
+                         size_t n, const unsigned char *const in[],
+                         const size_t inl[], unsigned char *const out[],
+                         size_t mdlen)
+{
+    MB_STATE st;
+    HASH_DESC desc[MB_LANES];
+    unsigned char pad[MB_LANES][2 * SHA_CBLOCK];
+    const unsigned char *ptr[MB_LANES];
+    size_t left[MB_LANES], lane[MB_LANES];
+    size_t i, j, active;
+
+    for (i = 0; i < n; i++) {
+        size_t blocks = inl[i] / SHA_CBLOCK;
+
+        for (j = i; j > 0 && left[j - 1] < blocks; j--) {
+            left[j] = left[j - 1];
+            lane[j] = lane[j - 1];
+        }
+        left[j] = blocks;
+        lane[j] = i;
+    }
+    for (i = 0; i < n; i++) {
+        ptr[i] = in[lane[i]];
+        for (j = 0; j < words; j++)
+            st[j][i] = iv[j];
+    }
+    memset(desc, 0, sizeof(desc));
+
+    /* Full blocks, taken straight from the caller's buffers */
+    for (;;) {
+        for (active = 0; active < n && left[active] > 0; active++) {
+            desc[active].ptr = ptr[active];
+            desc[active].blocks =
+                left[active] > MB_MAX_BLOCKS ? MB_MAX_BLOCKS : (int)left[active];
+        }
+        if (active == 0)
+            break;
+        for (i = active; i < MB_LANES; i++)
+            desc[i].blocks = 0;
+        block(st, desc, active > MB_LANES / 2 ? 2 : 1);
+        for (i = 0; i < active; i++) {
+            ptr[i] += (size_t)desc[i].blocks * SHA_CBLOCK;
+            left[i] -= desc[i].blocks;
+        }
+    }
+
+    /* The remainder, 0x80, zeroes and the 64-bit big endian bit count */
+    for (i = 0; i < n; i++) {
+        size_t len = inl[lane[i]];
+        size_t rem = len % SHA_CBLOCK;
+        size_t padlen = rem < SHA_CBLOCK - 8 ? SHA_CBLOCK : 2 * SHA_CBLOCK;
+        uint64_t bits = (uint64_t)len << 3;
+
+        if (rem > 0)
+            memcpy(pad[i], ptr[i], rem);
+        pad[i][rem] = 0x80;
+        memset(pad[i] + rem + 1, 0, padlen - rem - 9);
+        for (j = 0; j < 8; j++)
+            pad[i][padlen - 1 - j] = (unsigned char)(bits >> (8 * j));
+        desc[i].ptr = pad[i];
+        desc[i].blocks = (int)(padlen / SHA_CBLOCK);
+    }
+    for (; i < MB_LANES; i++)
+        desc[i].blocks = 0;
+    block(st, desc, n > MB_LANES / 2 ? 2 : 1);
+
+    for (i = 0; i < n; i++) {
+        unsigned char *md = out[lane[i]];
+
+        for (j = 0; j < mdlen / 4; j++, md += 4) {
+            md[0] = (unsigned char)(st[j][i] >> 24);
+            md[1] = (unsigned char)(st[j][i] >> 16);
+            md[2] = (unsigned char)(st[j][i] >> 8);
+            md[3] = (unsigned char)st[j][i];
+        }
+    }
+    OPENSSL_cleanse(pad, sizeof(pad));
+    OPENSSL_cleanse(st, sizeof(st));
+}
+
+static void sha_mb(mb_block_fn block, const SHA_LONG *iv, size_t words,
+                   size_t n, const unsigned char *const in[],
+                   const size_t inl[], unsigned char *const out[],
+                   size_t mdlen)
+{
+    size_t i;
+
+    for (i = 0; i < n; i += MB_LANES)
+        sha_mb_group(block, iv, words, n - i < MB_LANES ? n - i : MB_LANES,
+                     in + i, inl + i, out + i, mdlen);
+}
+#endif
+
+int ossl_sha1_batch(size_t n, const unsigned char *const in[],
+                    const size_t inl[], unsigned char *const out[])
+{
+    SHA_CTX c;
+    size_t i;
+
+#ifdef SHA_MULTI_BLOCK
+    if (n > 1 && MB_CAPABLE) {
+        SHA_LONG iv[5];
+
+        SHA1_Init(&c);
+        iv[0] = c.h0;
+        iv[1] = c.h1;
+        iv[2] = c.h2;
+        iv[3] = c.h3;
+        iv[4] = c.h4;
+        sha_mb(sha1_mb_block, iv, 5, n, in, inl, out, SHA_DIGEST_LENGTH);
+        return 1;
+    }
+#endif
+    for (i = 0; i < n; i++)
+        if (!SHA1_Init(&c)
+                || !SHA1_Update(&c, in[i], inl[i])
+                || !SHA1_Final(out[i], &c))
+            return 0;
+    return 1;
+}
+
+int ossl_sha256_batch(size_t n, const unsigned char *const in[],
+                      const size_t inl[], unsigned char *const out[],
+                      size_t mdlen)
+{
+    int (*init)(SHA256_CTX *c);
+    SHA256_CTX c;
+    size_t i;
+
+    if (mdlen == SHA224_DIGEST_LENGTH)
+        init = SHA224_Init;
+    else if (mdlen == SHA256_DIGEST_LENGTH)
+        init = SHA256_Init;
+    else
+        return 0;
+
+#ifdef SHA_MULTI_BLOCK
+    if (n > 1 && MB_CAPABLE) {
+        init(&c);
+        sha_mb(sha256_mb_block, c.h, 8, n, in, inl, out, mdlen);
+        return 1;
+    }
+#endif
+    for (i = 0; i < n; i++)
+        if (!init(&c)
+                || !SHA256_Update(&c, in[i], inl[i])
+                || !SHA256_Final(out[i], &c))
+            return 0;
+    return 1;
+}
@@ -25,6 +25,9 @@
 
 #ifndef OPENSSL_NO_POSIX_IO
 # include <sys/stat.h>
+# ifdef _WIN32
+#  define stat _stat
+# endif
 #endif
 
 #include <openssl/x509.h>
@@ -36,16 +39,41 @@ struct lookup_dir_hashes_st {
     int suffix;
 };
 
+/*
+ * The result of probing a directory for the files of one hash value: the
+ * number of consecutive files that were found and loaded into the store.
+ * A count of zero records a miss.
+ */
+typedef struct lookup_dir_scan_st {
+    unsigned long hash;
+    X509_LOOKUP_TYPE type;
+    int count;
+} BY_DIR_SCAN;
+
+DEFINE_LHASH_OF_EX(BY_DIR_SCAN);
+
+/* Upper bound on the number of scan results kept per directory */
+#define BY_DIR_SCAN_MAX 4096
+
 struct lookup_dir_entry_st {
     char *dir;
     int dir_type;
     STACK_OF(BY_DIR_HASH) *hashes;
+    /*
+     * Scan results remain valid for as long as the modification time of the
+     * directory is |mtime|, which was last checked at time |checked|.
+     */
+    LHASH_OF(BY_DIR_SCAN) *scans;
+    time_t mtime;
+    time_t checked;
 };
 
 typedef struct lookup_dir_st {
     BUF_MEM *buffer;
     STACK_OF(BY_DIR_ENTRY) *dirs;
     CRYPTO_RWLOCK *lock;
+    /* Seconds between directory checks, or -1 if scans are not cached */
+    long cache_timeout;
 } BY_DIR;
 
 static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
@@ -101,6 +129,13 @@ static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
         } else
             ret = add_cert_dir(ld, argp, (int)argl);
         break;
+    case X509_L_DIR_CACHE_TIMEOUT:
+        if (!CRYPTO_THREAD_write_lock(ld->lock))
+            break;
+        ld->cache_timeout = argl < 0 ? -1 : argl;
+        CRYPTO_THREAD_unlock(ld->lock);
+        ret = 1;
+        break;
     }
     return ret;
 }
@@ -117,6 +152,7 @@ static int new_dir(X509_LOOKUP *lu)
         goto err;
     }
     a->dirs = NULL;
+    a->cache_timeout = -1;
     a->lock = CRYPTO_THREAD_lock_new();
     if (a->lock == NULL) {
         BUF_MEM_free(a->buffer);
@@ -146,10 +182,37 @@ static int by_dir_hash_cmp(const BY_DIR_HASH *const *a,
     return 0;
 }
 
+static unsigned long by_dir_scan_hash(const BY_DIR_SCAN *scan)
+{
+    return scan->hash ^ (unsigned long)scan->type;
+}
+
+static int by_dir_scan_cmp(const BY_DIR_SCAN *a, const BY_DIR_SCAN *b)
+{
+    if (a->hash != b->hash)
+        return a->hash > b->hash ? 1 : -1;
+    return (int)a->type - (int)b->type;
+}
+
+static void by_dir_scan_free(BY_DIR_SCAN *scan)
+{
+    OPENSSL_free(scan);
+}
+
+static void by_dir_scans_flush(BY_DIR_ENTRY *ent)
+{
+    if (ent->scans == NULL)
+        return;
+    lh_BY_DIR_SCAN_doall(ent->scans, by_dir_scan_free);
+    lh_BY_DIR_SCAN_flush(ent->scans);
+}
+
 static void by_dir_entry_free(BY_DIR_ENTRY *ent)
 {
     OPENSSL_free(ent->dir);
     sk_BY_DIR_HASH_pop_free(ent->hashes, by_dir_hash_free);
+    by_dir_scans_flush(ent);
+    lh_BY_DIR_SCAN_free(ent->scans);
     OPENSSL_free(ent);
 }
 
@@ -204,8 +267,13 @@ static int add_cert_dir(BY_DIR *ctx, const char *dir, int type)
                 return 0;
             ent->dir_type = type;
             ent->hashes = sk_BY_DIR_HASH_new(by_dir_hash_cmp);
+            ent->scans = lh_BY_DIR_SCAN_new(by_dir_scan_hash,
+                                            by_dir_scan_cmp);
+            ent->mtime = 0;
+            ent->checked = 0;
             ent->dir = OPENSSL_strndup(ss, len);
-            if (ent->dir == NULL || ent->hashes == NULL) {
+            if (ent->dir == NULL || ent->hashes == NULL
+                    || ent->scans == NULL) {
                 by_dir_entry_free(ent);
                 return 0;
             }
@@ -219,34 +287,116 @@ static int add_cert_dir(BY_DIR *ctx, const char *dir, int type)
     return 1;
 }
 
+/*
+ * Returns the number of files found by an earlier scan of |ent| for hash |h|
+ * and |type|, or -1 if the directory has to be scanned.  The modification time
+ * the scan results are valid for is returned in |*mtime|.
+ */
+static int by_dir_cache_get(BY_DIR *ctx, BY_DIR_ENTRY *ent, unsigned long h,
+                            X509_LOOKUP_TYPE type, time_t *mtime)
+{
+    int ret = -1;
+#ifndef OPENSSL_NO_POSIX_IO
+    BY_DIR_SCAN tmp, *scan;
+    struct stat st;
+    time_t now;
+    int stale;
+#endif
+
+    *mtime = 0;
+#ifndef OPENSSL_NO_POSIX_IO
+    tmp.hash = h;
+    tmp.type = type;
+    if (!CRYPTO_THREAD_read_lock(ctx->lock))
+        return -1;
+    if (ctx->cache_timeout < 0) {
+        CRYPTO_THREAD_unlock(ctx->lock);
+        return -1;
+    }
+    now = time(NULL);
+    stale = ent->checked == 0 || now < ent->checked
+        || now - ent->checked >= ctx->cache_timeout;
+    if (!stale) {
+        *mtime = ent->mtime;
+        if ((scan = lh_BY_DIR_SCAN_retrieve(ent->scans, &tmp)) != NULL)
+            ret = scan->count;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+    if (!stale)
+        return ret;
+
+    /*
+     * Adding or removing a hash link updates the modification time of the
+     * directory.  That time only has a resolution of a second, so a directory
+     * modified during the current second might change again unnoticed and
+     * isn't cached until later.
+     */
+    if (stat(ent->dir, &st) < 0 || st.st_mtime >= now)
+        st.st_mtime = 0;
+
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        return -1;
+    if (st.st_mtime == 0 || st.st_mtime != ent->mtime)
+        by_dir_scans_flush(ent);
+    ent->mtime = st.st_mtime;
+    ent->checked = st.st_mtime == 0 ? 0 : now;
+    *mtime = ent->mtime;
+    if ((scan = lh_BY_DIR_SCAN_retrieve(ent->scans, &tmp)) != NULL)
+        ret = scan->count;
+    CRYPTO_THREAD_unlock(ctx->lock);
+#endif
+    return ret;
+}
+
+/*
+ * Records that scanning |ent| for hash |h| and |type| found |count| files,
+ * unless the directory was seen to change since |mtime|.
+ */
+static void by_dir_cache_put(BY_DIR *ctx, BY_DIR_ENTRY *ent, unsigned long h,
+                             X509_LOOKUP_TYPE type, int count, time_t mtime)
+{
+    BY_DIR_SCAN tmp, *scan;
+
+    if (mtime == 0 || !CRYPTO_THREAD_write_lock(ctx->lock))
+        return;
+    if (ctx->cache_timeout >= 0 && ent->mtime == mtime) {
+        tmp.hash = h;
+        tmp.type = type;
+        if ((scan = lh_BY_DIR_SCAN_retrieve(ent->scans, &tmp)) != NULL) {
+            scan->count = count;
+        } else {
+            if (lh_BY_DIR_SCAN_num_items(ent->scans) >= BY_DIR_SCAN_MAX)
+                by_dir_scans_flush(ent);
+            if ((scan = OPENSSL_malloc(sizeof(*scan))) != NULL) {
+                *scan = tmp;
+                scan->count = count;
+                (void)lh_BY_DIR_SCAN_insert(ent->scans, scan);
+                if (lh_BY_DIR_SCAN_error(ent->scans))
+                    OPENSSL_free(scan);
+            }
+        }
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+}
+
 static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                                   const X509_NAME *name, X509_OBJECT *ret,
                                   OSSL_LIB_CTX *libctx, const char *propq)
 {
     BY_DIR *ctx;
-    union {
-        X509 st_x509;
-        X509_CRL crl;
-    } data;
     int ok = 0;
     int i, j, k;
     unsigned long h;
     BUF_MEM *b = NULL;
-    X509_OBJECT stmp, *tmp;
+    X509_OBJECT *tmp;
     const char *postfix = "";
 
     if (name == NULL)
         return 0;
 
-    stmp.type = type;
-    if (type == X509_LU_X509) {
-        data.st_x509.cert_info.subject = (X509_NAME *)name; /* won't modify it */
-        stmp.data.x509 = &data.st_x509;
-    } else if (type == X509_LU_CRL) {
-        data.crl.crl.issuer = (X509_NAME *)name; /* won't modify it */
-        stmp.data.crl = &data.crl;
+    if (type == X509_LU_CRL) {
         postfix = "r";
-    } else {
+    } else if (type != X509_LU_X509) {
         ERR_raise(ERR_LIB_X509, X509_R_WRONG_LOOKUP_TYPE);
         goto finish;
     }
@@ -262,8 +412,9 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         goto finish;
     for (i = 0; i < sk_BY_DIR_ENTRY_num(ctx->dirs); i++) {
         BY_DIR_ENTRY *ent;
-        int idx;
+        int idx, cached;
         BY_DIR_HASH htmp, *hent;
+        time_t mtime;
 
         ent = sk_BY_DIR_ENTRY_value(ctx->dirs, i);
         j = strlen(ent->dir) + 1 + 8 + 6 + 1 + 1;
@@ -271,7 +422,12 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
             ERR_raise(ERR_LIB_X509, ERR_R_BUF_LIB);
             goto finish;
         }
-        if (type == X509_LU_CRL && ent->hashes) {
+        cached = by_dir_cache_get(ctx, ent, h, type, &mtime);
+        if (cached >= 0) {
+            /* Everything there is for this hash has been loaded already */
+            k = cached;
+            hent = NULL;
+        } else if (type == X509_LU_CRL && ent->hashes) {
             htmp.hash = h;
             if (!CRYPTO_THREAD_read_lock(ctx->lock))
                 goto finish;
@@ -288,7 +444,7 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
             k = 0;
             hent = NULL;
         }
-        for (;;) {
+        while (cached < 0) {
             char c = '/';
 
 #ifdef OPENSSL_SYS_VMS
@@ -319,9 +475,6 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                              "%s%c%08lx.%s%d", ent->dir, c, h, postfix, k);
             }
 #ifndef OPENSSL_NO_POSIX_IO
-# ifdef _WIN32
-#  define stat _stat
-# endif
             {
                 struct stat st;
                 if (stat(b->data, &st) < 0)
@@ -340,18 +493,14 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
             /* else case will caught higher up */
             k++;
         }
+        if (cached < 0)
+            by_dir_cache_put(ctx, ent, h, type, k, mtime);
 
-        /*
-         * we have added it to the cache so now pull it out again
-         *
-         * Note: quadratic time find here since the objects won't generally be
-         *       sorted and sorting the would result in O(n^2 log n) complexity.
-         */
+        /* we have added it to the cache so now pull it out again */
         if (k > 0) {
             if (!X509_STORE_lock(xl->store_ctx))
                 goto finish;
-            j = sk_X509_OBJECT_find(xl->store_ctx->objs, &stmp);
-            tmp = sk_X509_OBJECT_value(xl->store_ctx->objs, j);
+            tmp = ossl_x509_store_get0_by_subject(xl->store_ctx, type, name);
             X509_STORE_unlock(xl->store_ctx);
         } else {
             tmp = NULL;
@@ -362,7 +511,7 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
          * This avoids the need for a write lock and sort operation in the
          * simple case where no CRL is present for a hash.
          */
-        if (type == X509_LU_CRL && k > 0) {
+        if (type == X509_LU_CRL && k > 0 && cached < 0) {
             if (!CRYPTO_THREAD_write_lock(ctx->lock))
                 goto finish;
             /*
@@ -419,14 +568,6 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         }
     }
  finish:
-    /* If we changed anything, resort the objects for faster lookup */
-    if (X509_STORE_lock(xl->store_ctx)) {
-        if (!sk_X509_OBJECT_is_sorted(xl->store_ctx->objs)) {
-            sk_X509_OBJECT_sort(xl->store_ctx->objs);
-        }
-        X509_STORE_unlock(xl->store_ctx);
-    }
-
     BUF_MEM_free(b);
     return ok;
 }
@@ -0,0 +1,478 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/e_os.h"
+#include "internal/cryptlib.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+# define TRUST_INDEX_USE_MMAP
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+#endif
+
+#include <openssl/x509.h>
+#include "internal/packet.h"
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+/*
+ * Trust index files
+ * =================
+ *
+ * A trust index is a precompiled form of a set of trusted certificates which
+ * can be mapped into memory and searched without parsing any of them. Only the
+ * certificates with the subject name being looked up are decoded, and they are
+ * then added to the X509_STORE, so a process only pays for the trust anchors
+ * it actually uses. Where mmap() is available the file is mapped read-only and
+ * the pages are shared by all processes using the same index.
+ *
+ * All integers are big-endian. The file consists of:
+ *
+ *     magic       8 bytes, "OSSLTIDX"
+ *     version     uint32, currently 1
+ *     count       uint32, number of certificates
+ *     entries     count * { uint32 name hash, uint32 offset, uint32 length }
+ *     data        the DER encoded certificates
+ *
+ * The entries are sorted by name hash, which is the 32-bit FNV-1a hash of the
+ * canonical encoding of the subject name (so that equal names under
+ * X509_NAME_cmp() have equal hashes). The offset of each certificate is from
+ * the start of the file.
+ */
+
+#define TRUST_INDEX_MAGIC       "OSSLTIDX"
+#define TRUST_INDEX_MAGIC_LEN   8
+#define TRUST_INDEX_VERSION     1
+#define TRUST_INDEX_HDR_LEN     (TRUST_INDEX_MAGIC_LEN + 4 + 4)
+#define TRUST_INDEX_ENTRY_LEN   12
+
+typedef struct trust_index_st {
+    unsigned char *data;
+    size_t len;
+    int mapped;                 /* |data| is from mmap() rather than malloc */
+    uint32_t num;
+    const unsigned char *entries;
+    unsigned char *loaded;      /* Set for entries added to the store */
+} TRUST_INDEX;
+
+DEFINE_STACK_OF(TRUST_INDEX)
+
+typedef struct lookup_index_st {
+    STACK_OF(TRUST_INDEX) *indexes;
+    CRYPTO_RWLOCK *lock;
+} BY_INDEX;
+
+static int index_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
+                      char **retp);
+static int new_index(X509_LOOKUP *lu);
+static void free_index(X509_LOOKUP *lu);
+static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                               const X509_NAME *name, X509_OBJECT *ret);
+static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                                  const X509_NAME *name, X509_OBJECT *ret,
+                                  OSSL_LIB_CTX *libctx, const char *propq);
+
+static X509_LOOKUP_METHOD x509_index_lookup = {
+    "Load certs from a precompiled trust index",
+    new_index,                       /* new_item */
+    free_index,                      /* free */
+    NULL,                            /* init */
+    NULL,                            /* shutdown */
+    index_ctrl,                      /* ctrl */
+    get_cert_by_subject,             /* get_by_subject */
+    NULL,                            /* get_by_issuer_serial */
+    NULL,                            /* get_by_fingerprint */
+    NULL,                            /* get_by_alias */
+    get_cert_by_subject_ex,          /* get_by_subject_ex */
+    NULL,                            /* ctrl_ex */
+};
+
+X509_LOOKUP_METHOD *X509_LOOKUP_trust_index(void)
+{
+    return &x509_index_lookup;
+}
+
+static uint32_t get_u32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+        | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void trust_index_free(TRUST_INDEX *idx)
+{
+    if (idx == NULL)
+        return;
+#ifdef TRUST_INDEX_USE_MMAP
+    if (idx->mapped)
+        munmap(idx->data, idx->len);
+#endif
+    if (!idx->mapped)
+        OPENSSL_free(idx->data);
+    OPENSSL_free(idx->loaded);
+    OPENSSL_free(idx);
+}
+
+static int read_file(TRUST_INDEX *idx, const char *file)
+{
+#ifdef TRUST_INDEX_USE_MMAP
+    struct stat st;
+    void *p;
+    int fd;
+
+    if ((fd = open(file, O_RDONLY)) < 0) {
+        ERR_raise_data(ERR_LIB_SYS, errno, "calling open(%s)", file);
+        return 0;
+    }
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        ERR_raise_data(ERR_LIB_X509, X509_R_INVALID_TRUST_INDEX, "%s", file);
+        close(fd);
+        return 0;
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        ERR_raise_data(ERR_LIB_SYS, errno, "calling mmap(%s)", file);
+        return 0;
+    }
+    idx->data = p;
+    idx->len = (size_t)st.st_size;
+    idx->mapped = 1;
+    return 1;
+#else
+    BUF_MEM *buf = NULL;
+    BIO *in;
+    size_t len = 0;
+    int n, ok = 0;
+
+    if ((in = BIO_new_file(file, "rb")) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_BIO_LIB);
+        return 0;
+    }
+    if ((buf = BUF_MEM_new()) == NULL)
+        goto end;
+    for (;;) {
+        if (!BUF_MEM_grow(buf, len + 4096))
+            goto end;
+        if ((n = BIO_read(in, buf->data + len, 4096)) <= 0)
+            break;
+        len += n;
+    }
+    idx->data = (unsigned char *)buf->data;
+    idx->len = len;
+    buf->data = NULL;
+    ok = 1;
+ end:
+    BUF_MEM_free(buf);
+    BIO_free(in);
+    return ok;
+#endif
+}
+
+/* Check the header and that every entry is in range and in order */
+static int trust_index_check(TRUST_INDEX *idx)
+{
+    const unsigned char *e;
+    uint32_t i, prev = 0, hash, off, len;
+
+    if (idx->len < TRUST_INDEX_HDR_LEN
+        || memcmp(idx->data, TRUST_INDEX_MAGIC, TRUST_INDEX_MAGIC_LEN) != 0
+        || get_u32(idx->data + TRUST_INDEX_MAGIC_LEN) != TRUST_INDEX_VERSION)
+        return 0;
+
+    idx->num = get_u32(idx->data + TRUST_INDEX_MAGIC_LEN + 4);
+    if (idx->num > (idx->len - TRUST_INDEX_HDR_LEN) / TRUST_INDEX_ENTRY_LEN)
+        return 0;
+    idx->entries = idx->data + TRUST_INDEX_HDR_LEN;
+
+    for (i = 0, e = idx->entries; i < idx->num;
+         i++, e += TRUST_INDEX_ENTRY_LEN) {
+        hash = get_u32(e);
+        off = get_u32(e + 4);
+        len = get_u32(e + 8);
+        if (hash < prev || off > idx->len || len > idx->len - off)
+            return 0;
+        prev = hash;
+    }
+    return 1;
+}
+
+static int add_trust_index(BY_INDEX *ctx, const char *file)
+{
+    TRUST_INDEX *idx;
+
+    if (file == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if ((idx = OPENSSL_zalloc(sizeof(*idx))) == NULL)
+        return 0;
+    if (!read_file(idx, file))
+        goto err;
+    if (!trust_index_check(idx)) {
+        ERR_raise_data(ERR_LIB_X509, X509_R_INVALID_TRUST_INDEX, "%s", file);
+        goto err;
+    }
+    if (idx->num > 0 && (idx->loaded = OPENSSL_zalloc(idx->num)) == NULL)
+        goto err;
+
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        goto err;
+    if (!sk_TRUST_INDEX_push(ctx->indexes, idx)) {
+        CRYPTO_THREAD_unlock(ctx->lock);
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return 1;
+
+ err:
+    trust_index_free(idx);
+    return 0;
+}
+
+static int index_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
+                      char **retp)
+{
+    BY_INDEX *ld = (BY_INDEX *)ctx->method_data;
+
+    switch (cmd) {
+    case X509_L_LOAD_TRUST_INDEX:
+        return add_trust_index(ld, argp);
+    }
+    return 0;
+}
+
+static int new_index(X509_LOOKUP *lu)
+{
+    BY_INDEX *a = OPENSSL_zalloc(sizeof(*a));
+
+    if (a == NULL)
+        return 0;
+
+    if ((a->indexes = sk_TRUST_INDEX_new_null()) == NULL
+        || (a->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        sk_TRUST_INDEX_free(a->indexes);
+        OPENSSL_free(a);
+        return 0;
+    }
+    lu->method_data = a;
+    return 1;
+}
+
+static void free_index(X509_LOOKUP *lu)
+{
+    BY_INDEX *a = (BY_INDEX *)lu->method_data;
+
+    sk_TRUST_INDEX_pop_free(a->indexes, trust_index_free);
+    CRYPTO_THREAD_lock_free(a->lock);
+    OPENSSL_free(a);
+}
+
+/* Returns the first entry with the given hash, or idx->num if there is none */
+static uint32_t trust_index_find(const TRUST_INDEX *idx, uint32_t hash)
+{
+    uint32_t lo = 0, hi = idx->num, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (get_u32(idx->entries + mid * TRUST_INDEX_ENTRY_LEN) < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * Decode the certificates with a matching name hash that have not already
+ * been added to the store and add them. A certificate whose name only has a
+ * colliding hash is added too, as it is wanted by a later lookup of its own
+ * name. Returns the number of hash matches, or -1 on error.
+ */
+static int load_matches(X509_LOOKUP *xl, TRUST_INDEX *idx, uint32_t hash,
+                        OSSL_LIB_CTX *libctx, const char *propq)
+{
+    const unsigned char *e, *p;
+    uint32_t i;
+    X509 *x;
+    int n = 0;
+
+    for (i = trust_index_find(idx, hash); i < idx->num; i++, n++) {
+        e = idx->entries + i * TRUST_INDEX_ENTRY_LEN;
+        if (get_u32(e) != hash)
+            break;
+        if (idx->loaded[i])
+            continue;
+
+        p = idx->data + get_u32(e + 4);
+        if ((x = X509_new_ex(libctx, propq)) == NULL)
+            return -1;
+        if (d2i_X509(&x, &p, (long)get_u32(e + 8)) == NULL) {
+            X509_free(x);
+            ERR_raise(ERR_LIB_X509, X509_R_INVALID_TRUST_INDEX);
+            return -1;
+        }
+        if (!X509_STORE_add_cert(xl->store_ctx, x)) {
+            X509_free(x);
+            return -1;
+        }
+        X509_free(x);
+        idx->loaded[i] = 1;
+    }
+    return n;
+}
+
+static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                                  const X509_NAME *name, X509_OBJECT *ret,
+                                  OSSL_LIB_CTX *libctx, const char *propq)
+{
+    BY_INDEX *ctx = (BY_INDEX *)xl->method_data;
+    X509_OBJECT *tmp = NULL;
+    uint32_t hash;
+    int i, n, found = 0;
+
+    if (name == NULL || type != X509_LU_X509
+        || !ossl_x509_name_canon_hash(name, &hash))
+        return 0;
+
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        return 0;
+    for (i = 0; i < sk_TRUST_INDEX_num(ctx->indexes); i++) {
+        n = load_matches(xl, sk_TRUST_INDEX_value(ctx->indexes, i), hash,
+                         libctx, propq);
+        if (n < 0) {
+            CRYPTO_THREAD_unlock(ctx->lock);
+            return 0;
+        }
+        found += n;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+    if (found == 0)
+        return 0;
+
+    /* The certificates now in the store are the ones to return */
+    if (!X509_STORE_lock(xl->store_ctx))
+        return 0;
+    tmp = ossl_x509_store_get0_by_subject(xl->store_ctx, type, name);
+    X509_STORE_unlock(xl->store_ctx);
+    if (tmp == NULL)
+        return 0;
+
+    ret->type = tmp->type;
+    memcpy(&ret->data, &tmp->data, sizeof(ret->data));
+    return 1;
+}
+
+static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                               const X509_NAME *name, X509_OBJECT *ret)
+{
+    return get_cert_by_subject_ex(xl, type, name, ret, NULL, NULL);
+}
+
+typedef struct {
+    uint32_t hash;
+    int pos;
+    unsigned char *der;
+    int derlen;
+} INDEX_WRITE_ENTRY;
+
+static int index_write_entry_cmp(const void *a, const void *b)
+{
+    const INDEX_WRITE_ENTRY *ea = a, *eb = b;
+
+    if (ea->hash != eb->hash)
+        return ea->hash < eb->hash ? -1 : 1;
+    return ea->pos < eb->pos ? -1 : ea->pos > eb->pos;
+}
+
+int X509_trust_index_write(BIO *out, const STACK_OF(X509) *certs)
+{
+    INDEX_WRITE_ENTRY *ents = NULL;
+    BUF_MEM *buf = NULL;
+    WPACKET pkt;
+    uint64_t off;
+    size_t written, done, n;
+    int i, num = sk_X509_num(certs), ok = 0, pkt_init = 0;
+
+    if (out == NULL || certs == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    if (num > 0 && (ents = OPENSSL_zalloc(num * sizeof(*ents))) == NULL)
+        goto end;
+    off = TRUST_INDEX_HDR_LEN + (uint64_t)num * TRUST_INDEX_ENTRY_LEN;
+    for (i = 0; i < num; i++) {
+        X509 *x = sk_X509_value(certs, i);
+
+        ents[i].pos = i;
+        if (!ossl_x509_name_canon_hash(X509_get_subject_name(x),
+                                       &ents[i].hash)
+            || (ents[i].derlen = i2d_X509(x, &ents[i].der)) <= 0) {
+            ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
+            goto end;
+        }
+        off += ents[i].derlen;
+    }
+    if (off > UINT32_MAX) {
+        ERR_raise(ERR_LIB_X509, X509_R_INVALID_TRUST_INDEX);
+        goto end;
+    }
+    if (num > 1)
+        qsort(ents, num, sizeof(*ents), index_write_entry_cmp);
+
+    if ((buf = BUF_MEM_new()) == NULL || !WPACKET_init(&pkt, buf))
+        goto end;
+    pkt_init = 1;
+    off = TRUST_INDEX_HDR_LEN + (uint64_t)num * TRUST_INDEX_ENTRY_LEN;
+    if (!WPACKET_memcpy(&pkt, TRUST_INDEX_MAGIC, TRUST_INDEX_MAGIC_LEN)
+        || !WPACKET_put_bytes_u32(&pkt, TRUST_INDEX_VERSION)
+        || !WPACKET_put_bytes_u32(&pkt, num))
+        goto end;
+    for (i = 0; i < num; i++) {
+        if (!WPACKET_put_bytes_u32(&pkt, ents[i].hash)
+            || !WPACKET_put_bytes_u32(&pkt, off)
+            || !WPACKET_put_bytes_u32(&pkt, ents[i].derlen))
+            goto end;
+        off += ents[i].derlen;
+    }
+    for (i = 0; i < num; i++)
+        if (!WPACKET_memcpy(&pkt, ents[i].der, ents[i].derlen))
+            goto end;
+    if (!WPACKET_get_total_written(&pkt, &written)
+        || !WPACKET_finish(&pkt))
+        goto end;
+    pkt_init = 0;
+
+    /* The index may be larger than a single BIO_write() can handle */
+    for (done = 0; done < written; done += n) {
+        if (!BIO_write_ex(out, buf->data + done, written - done, &n)
+            || n == 0) {
+            ERR_raise(ERR_LIB_X509, ERR_R_BIO_LIB);
+            goto end;
+        }
+    }
+    ok = 1;
+
+ end:
+    if (pkt_init)
+        WPACKET_cleanup(&pkt);
+    BUF_MEM_free(buf);
+    for (i = 0; ents != NULL && i < num; i++)
+        OPENSSL_free(ents[i].der);
+    OPENSSL_free(ents);
+    return ok;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright 2003-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2003-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -33,7 +33,12 @@ static int do_i2r_name_constraints(const X509V3_EXT_METHOD *method,
                                    int ind, const char *name);
 static int print_nc_ipadd(BIO *bp, ASN1_OCTET_STRING *ip);
 
-static int nc_match(GENERAL_NAME *gen, NAME_CONSTRAINTS *nc);
+typedef struct nc_matcher_st NC_MATCHER;
+
+static int nc_match(GENERAL_NAME *gen, NAME_CONSTRAINTS *nc,
+                    const NC_MATCHER *m);
+static int nc_match_compiled(GENERAL_NAME *gen, const NC_MATCHER *m);
+static NC_MATCHER *nc_matcher_get(X509 *ca);
 static int nc_match_single(int effective_type, GENERAL_NAME *sub,
                            GENERAL_NAME *gen);
 static int nc_dn(const X509_NAME *sub, const X509_NAME *nm);
@@ -276,7 +281,7 @@ static int add_lengths(int *out, int a, int b)
  *  X509_V_ERR_UNSUPPORTED_NAME_SYNTAX: bad or unsupported syntax of name
  */
 
-int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
+static int nc_check(X509 *x, NAME_CONSTRAINTS *nc, const NC_MATCHER *m)
 {
     int r, i, name_count, constraint_count;
     X509_NAME *nm;
@@ -300,7 +305,7 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
         gntmp.type = GEN_DIRNAME;
         gntmp.d.directoryName = nm;
 
-        r = nc_match(&gntmp, nc);
+        r = nc_match(&gntmp, nc, m);
 
         if (r != X509_V_OK)
             return r;
@@ -320,7 +325,7 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
             if (gntmp.d.rfc822Name->type != V_ASN1_IA5STRING)
                 return X509_V_ERR_UNSUPPORTED_NAME_SYNTAX;
 
-            r = nc_match(&gntmp, nc);
+            r = nc_match(&gntmp, nc, m);
 
             if (r != X509_V_OK)
                 return r;
@@ -330,7 +335,7 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
 
     for (i = 0; i < sk_GENERAL_NAME_num(x->altname); i++) {
         GENERAL_NAME *gen = sk_GENERAL_NAME_value(x->altname, i);
-        r = nc_match(gen, nc);
+        r = nc_match(gen, nc, m);
         if (r != X509_V_OK)
             return r;
     }
@@ -339,6 +344,22 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
 
 }
 
+int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
+{
+    return nc_check(x, nc, NULL);
+}
+
+/*
+ * As NAME_CONSTRAINTS_check() for the constraints of |ca|, using the
+ * compiled form of the constraints cached on |ca|.
+ */
+int ossl_x509_name_constraints_check(X509 *x, X509 *ca)
+{
+    if (ca->nc == NULL)
+        return X509_V_OK;
+    return nc_check(x, ca->nc, nc_matcher_get(ca));
+}
+
 static int cn2dnsid(ASN1_STRING *cn, unsigned char **dnsid, size_t *idlen)
 {
     int utf8_length;
@@ -435,7 +456,7 @@ static int cn2dnsid(ASN1_STRING *cn, unsigned char **dnsid, size_t *idlen)
 /*
  * Check CN against DNS-ID name constraints.
  */
-int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
+static int nc_check_CN(X509 *x, NAME_CONSTRAINTS *nc, const NC_MATCHER *m)
 {
     int r, i;
     const X509_NAME *nm = X509_get_subject_name(x);
@@ -469,7 +490,7 @@ int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
 
         stmp.length = idlen;
         stmp.data = idval;
-        r = nc_match(&gntmp, nc);
+        r = nc_match(&gntmp, nc, m);
         OPENSSL_free(idval);
         if (r != X509_V_OK)
             return r;
@@ -477,6 +498,18 @@ int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
     return X509_V_OK;
 }
 
+int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
+{
+    return nc_check_CN(x, nc, NULL);
+}
+
+int ossl_x509_name_constraints_check_CN(X509 *x, X509 *ca)
+{
+    if (ca->nc == NULL)
+        return X509_V_OK;
+    return nc_check_CN(x, ca->nc, nc_matcher_get(ca));
+}
+
 /*
  * Return nonzero if the GeneralSubtree has valid 'minimum' field
  * (must be absent or 0) and valid 'maximum' field (must be absent).
@@ -498,12 +531,369 @@ static int nc_minmax_valid(GENERAL_SUBTREE *sub) {
     return ok;
 }
 
-static int nc_match(GENERAL_NAME *gen, NAME_CONSTRAINTS *nc)
+/*
+ * Compiled form of the DNS, email and IP address subtrees of a
+ * NAME_CONSTRAINTS, cached on the constraining certificate.  The subtrees of
+ * each type are kept in sorted sets so that a name is checked with one binary
+ * search per candidate suffix (or per distinct netmask) rather than by
+ * comparing it against every subtree in turn.  A type whose subtrees cannot
+ * be compiled, such as email constraints on a full mailbox, is left to the
+ * generic matching in nc_match().
+ */
+#define NC_TYPE_DNS     0
+#define NC_TYPE_EMAIL   1
+#define NC_TYPE_IPADD   2
+#define NC_TYPE_NUM     3
+
+typedef struct {
+    int length;                         /* Address length: 4 or 16 */
+    unsigned char mask[16];
+    STACK_OF(ASN1_STRING) *addrs;       /* Masked base addresses */
+} NC_IPGROUP;
+
+typedef struct {
+    int count;                          /* Number of subtrees */
+    int match_all;                      /* Empty DNS base present */
+    STACK_OF(ASN1_STRING) *names;       /* DNS bases, email hosts */
+    STACK_OF(ASN1_STRING) *domains;     /* Email ".domain" bases */
+    NC_IPGROUP *groups;                 /* IP bases by netmask */
+    int ngroups;
+} NC_SUBTREES;
+
+struct nc_matcher_st {
+    int compiled[NC_TYPE_NUM];
+    NC_SUBTREES trees[NC_TYPE_NUM][2];  /* Permitted, excluded */
+};
+
+static int nc_type_index(int type)
+{
+    switch (type) {
+    case GEN_DNS:
+        return NC_TYPE_DNS;
+    case GEN_EMAIL:
+        return NC_TYPE_EMAIL;
+    case GEN_IPADD:
+        return NC_TYPE_IPADD;
+    default:
+        return -1;
+    }
+}
+
+/* Case insensitive ordering consistent with the matching in nc_dns() */
+static int nc_name_cmp(const ASN1_STRING *const *a, const ASN1_STRING *const *b)
+{
+    int len = (*a)->length < (*b)->length ? (*a)->length : (*b)->length;
+    int r = ia5ncasecmp((const char *)(*a)->data, (const char *)(*b)->data,
+                        len);
+
+    if (r != 0)
+        return r;
+    return (*a)->length - (*b)->length;
+}
+
+static int nc_addr_cmp(const ASN1_STRING *const *a, const ASN1_STRING *const *b)
+{
+    return ASN1_STRING_cmp(*a, *b);
+}
+
+static int nc_set_add(STACK_OF(ASN1_STRING) **set, sk_ASN1_STRING_compfunc cmp,
+                      const unsigned char *data, int len)
+{
+    ASN1_STRING *str;
+
+    if (*set == NULL && (*set = sk_ASN1_STRING_new(cmp)) == NULL)
+        return 0;
+    if ((str = ASN1_STRING_new()) == NULL)
+        return 0;
+    if (!ASN1_STRING_set(str, data, len) || !sk_ASN1_STRING_push(*set, str)) {
+        ASN1_STRING_free(str);
+        return 0;
+    }
+    return 1;
+}
+
+static int nc_set_find(STACK_OF(ASN1_STRING) *set,
+                       const unsigned char *data, int len)
+{
+    ASN1_STRING key;
+
+    if (set == NULL)
+        return 0;
+    /* Matches the type of the stored strings for nc_addr_cmp() */
+    key.type = V_ASN1_OCTET_STRING;
+    key.flags = 0;
+    key.data = (unsigned char *)data;
+    key.length = len;
+    return sk_ASN1_STRING_find(set, &key) >= 0;
+}
+
+static int nc_ipgroup_add(NC_SUBTREES *st, ASN1_OCTET_STRING *base)
+{
+    NC_IPGROUP *group = NULL, *tmp;
+    unsigned char addr[16];
+    int i, len = base->length / 2;
+
+    for (i = 0; i < st->ngroups; i++) {
+        if (st->groups[i].length == len
+            && memcmp(st->groups[i].mask, base->data + len, len) == 0) {
+            group = &st->groups[i];
+            break;
+        }
+    }
+    if (group == NULL) {
+        tmp = OPENSSL_realloc(st->groups, (st->ngroups + 1) * sizeof(*tmp));
+        if (tmp == NULL)
+            return 0;
+        st->groups = tmp;
+        group = &st->groups[st->ngroups++];
+        group->length = len;
+        memcpy(group->mask, base->data + len, len);
+        group->addrs = NULL;
+    }
+    for (i = 0; i < len; i++)
+        addr[i] = base->data[i] & group->mask[i];
+    return nc_set_add(&group->addrs, nc_addr_cmp, addr, len);
+}
+
+/* Returns 0 on error or if the subtree cannot be compiled */
+static int nc_subtree_add(NC_SUBTREES *st, GENERAL_NAME *base)
+{
+    ASN1_IA5STRING *str;
+    const char *at;
+
+    switch (base->type) {
+    case GEN_DNS:
+        str = base->d.dNSName;
+        /* Empty matches everything */
+        if (str->length == 0) {
+            st->match_all = 1;
+            return 1;
+        }
+        return nc_set_add(&st->names, nc_name_cmp, str->data, str->length);
+
+    case GEN_EMAIL:
+        str = base->d.rfc822Name;
+        at = ia5memrchr(str, '@');
+        if (at == NULL && str->length > 0 && str->data[0] == '.')
+            return nc_set_add(&st->domains, nc_name_cmp,
+                              str->data, str->length);
+        if (at == NULL)
+            return nc_set_add(&st->names, nc_name_cmp,
+                              str->data, str->length);
+        /* "@host" is the same as "host", a local part is not compiled */
+        if (at == (char *)str->data)
+            return nc_set_add(&st->names, nc_name_cmp,
+                              str->data + 1, str->length - 1);
+        return 0;
+
+    case GEN_IPADD:
+        if (base->d.iPAddress->length != 8 && base->d.iPAddress->length != 32)
+            return 0;
+        return nc_ipgroup_add(st, base->d.iPAddress);
+
+    default:
+        return 0;
+    }
+}
+
+static void nc_subtrees_free(NC_SUBTREES *st)
+{
+    int i;
+
+    sk_ASN1_STRING_pop_free(st->names, ASN1_STRING_free);
+    sk_ASN1_STRING_pop_free(st->domains, ASN1_STRING_free);
+    for (i = 0; i < st->ngroups; i++)
+        sk_ASN1_STRING_pop_free(st->groups[i].addrs, ASN1_STRING_free);
+    OPENSSL_free(st->groups);
+    memset(st, 0, sizeof(*st));
+}
+
+static int nc_subtrees_compile(NC_SUBTREES *st, int type,
+                               STACK_OF(GENERAL_SUBTREE) *trees)
+{
+    GENERAL_SUBTREE *sub;
+    int i;
+
+    for (i = 0; i < sk_GENERAL_SUBTREE_num(trees); i++) {
+        sub = sk_GENERAL_SUBTREE_value(trees, i);
+        if (sub->base->type != type)
+            continue;
+        if (!nc_minmax_valid(sub) || !nc_subtree_add(st, sub->base))
+            return 0;
+        st->count++;
+    }
+
+    /* Sorted stacks are not modified by lookups and can be shared */
+    sk_ASN1_STRING_sort(st->names);
+    sk_ASN1_STRING_sort(st->domains);
+    for (i = 0; i < st->ngroups; i++)
+        sk_ASN1_STRING_sort(st->groups[i].addrs);
+    return 1;
+}
+
+void ossl_nc_matcher_free(NC_MATCHER *m)
+{
+    int i;
+
+    if (m == NULL)
+        return;
+    for (i = 0; i < NC_TYPE_NUM; i++) {
+        nc_subtrees_free(&m->trees[i][0]);
+        nc_subtrees_free(&m->trees[i][1]);
+    }
+    OPENSSL_free(m);
+}
+
+static NC_MATCHER *nc_matcher_new(NAME_CONSTRAINTS *nc)
+{
+    static const int types[NC_TYPE_NUM] = { GEN_DNS, GEN_EMAIL, GEN_IPADD };
+    NC_MATCHER *m = OPENSSL_zalloc(sizeof(*m));
+    int i;
+
+    if (m == NULL)
+        return NULL;
+    for (i = 0; i < NC_TYPE_NUM; i++) {
+        if (nc_subtrees_compile(&m->trees[i][0], types[i],
+                                nc->permittedSubtrees)
+            && nc_subtrees_compile(&m->trees[i][1], types[i],
+                                   nc->excludedSubtrees)) {
+            m->compiled[i] = 1;
+        } else {
+            /* Fall back to the generic matching for this type */
+            nc_subtrees_free(&m->trees[i][0]);
+            nc_subtrees_free(&m->trees[i][1]);
+        }
+    }
+    return m;
+}
+
+/*
+ * Return the compiled constraints of |ca|, building them on first use.
+ * Returns NULL on error, in which case the generic matching is used.
+ */
+static NC_MATCHER *nc_matcher_get(X509 *ca)
+{
+    NC_MATCHER *m, *ret;
+
+    if (!CRYPTO_THREAD_read_lock(ca->lock))
+        return NULL;
+    ret = ca->nc_matcher;
+    CRYPTO_THREAD_unlock(ca->lock);
+    if (ret != NULL)
+        return ret;
+
+    if ((m = nc_matcher_new(ca->nc)) == NULL)
+        return NULL;
+    if (!CRYPTO_THREAD_write_lock(ca->lock)) {
+        ossl_nc_matcher_free(m);
+        return NULL;
+    }
+    /* Another thread may have got here first */
+    if (ca->nc_matcher == NULL) {
+        ca->nc_matcher = m;
+        m = NULL;
+    }
+    ret = ca->nc_matcher;
+    CRYPTO_THREAD_unlock(ca->lock);
+    ossl_nc_matcher_free(m);
+    return ret;
+}
+
+/* Return nonzero if |gen| matches any of the compiled subtrees |st| */
+static int nc_subtrees_match(const NC_SUBTREES *st, GENERAL_NAME *gen)
+{
+    ASN1_STRING *str;
+    const unsigned char *host;
+    unsigned char addr[16];
+    int i, j, len;
+
+    switch (gen->type) {
+    case GEN_DNS:
+        if (st->match_all)
+            return 1;
+        /*
+         * Candidate bases are the whole name, the suffixes after each '.'
+         * and, for bases with a leading '.', the suffixes starting at each
+         * '.', as in nc_dns().
+         */
+        str = gen->d.dNSName;
+        for (i = 0; i < str->length; i++) {
+            if ((i == 0 || str->data[i - 1] == '.' || str->data[i] == '.')
+                && nc_set_find(st->names, str->data + i, str->length - i))
+                return 1;
+        }
+        return 0;
+
+    case GEN_EMAIL:
+        /* The caller has checked that there is an '@' */
+        str = gen->d.rfc822Name;
+        host = (unsigned char *)ia5memrchr(str, '@') + 1;
+        len = IA5_OFFSET_LEN(str, host);
+        if (nc_set_find(st->names, host, len))
+            return 1;
+        for (i = 0; i < len; i++) {
+            if (host[i] == '.' && nc_set_find(st->domains, host + i, len - i))
+                return 1;
+        }
+        return 0;
+
+    case GEN_IPADD:
+        str = gen->d.iPAddress;
+        for (i = 0; i < st->ngroups; i++) {
+            if (st->groups[i].length != str->length)
+                continue;
+            for (j = 0; j < str->length; j++)
+                addr[j] = str->data[j] & st->groups[i].mask[j];
+            if (nc_set_find(st->groups[i].addrs, addr, str->length))
+                return 1;
+        }
+        return 0;
+
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Match |gen| against the compiled constraints |m| with the same result as
+ * the generic matching in nc_match().  Returns -1 if the constraints on names
+ * of this type have not been compiled.
+ */
+static int nc_match_compiled(GENERAL_NAME *gen, const NC_MATCHER *m)
+{
+    const NC_SUBTREES *permitted, *excluded;
+    int t = nc_type_index(gen->type);
+
+    if (m == NULL || t < 0 || !m->compiled[t])
+        return -1;
+    permitted = &m->trees[t][0];
+    excluded = &m->trees[t][1];
+    if (permitted->count == 0 && excluded->count == 0)
+        return X509_V_OK;
+
+    if (gen->type == GEN_EMAIL && ia5memrchr(gen->d.rfc822Name, '@') == NULL)
+        return X509_V_ERR_UNSUPPORTED_NAME_SYNTAX;
+    if (gen->type == GEN_IPADD
+        && gen->d.iPAddress->length != 4 && gen->d.iPAddress->length != 16)
+        return X509_V_ERR_UNSUPPORTED_NAME_SYNTAX;
+
+    if (permitted->count > 0 && !nc_subtrees_match(permitted, gen))
+        return X509_V_ERR_PERMITTED_VIOLATION;
+    if (excluded->count > 0 && nc_subtrees_match(excluded, gen))
+        return X509_V_ERR_EXCLUDED_VIOLATION;
+    return X509_V_OK;
+}
+
+static int nc_match(GENERAL_NAME *gen, NAME_CONSTRAINTS *nc,
+                    const NC_MATCHER *m)
 {
     GENERAL_SUBTREE *sub;
     int i, r, match = 0;
     int effective_type = gen->type;
 
+    if ((r = nc_match_compiled(gen, m)) >= 0)
+        return r;
+
     /*
      * We need to compare not gen->type field but an "effective" type because
      * the otherName field may contain EAI email address treated specially
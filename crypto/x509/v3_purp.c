@@ -390,6 +390,42 @@ static int check_sig_alg_match(const EVP_PKEY *issuer_key, const X509 *subject)
 #define ns_reject(x, usage) \
     (((x)->ex_flags & EXFLAG_NSCERT) != 0 && ((x)->ex_nscert & (usage)) == 0)
 
+/* Fill in x->sha1_hash, or else set EXFLAG_NO_FINGERPRINT, with x->lock held */
+static void cache_fingerprint(X509 *x)
+{
+    if (x->sha1_cached)
+        return;
+    if (!X509_digest(x, EVP_sha1(), x->sha1_hash, NULL))
+        x->ex_flags |= EXFLAG_NO_FINGERPRINT;
+#ifdef tsan_st_rel
+    tsan_st_rel((TSAN_QUALIFIER int *)&x->sha1_cached, 1);
+#else
+    x->sha1_cached = 1;
+#endif
+}
+
+/*
+ * Cache the SHA1 digest of cert 'x' in x->sha1_hash like
+ * ossl_x509v3_cache_extensions() does, but without decoding any extensions.
+ * Those are left until something needs them, e.g., a purpose check.
+ * Returns 1 if the digest is available, 0 otherwise.
+ */
+int ossl_x509_cache_fingerprint(X509 *x)
+{
+#ifdef tsan_ld_acq
+    if (tsan_ld_acq((TSAN_QUALIFIER int *)&x->sha1_cached))
+        return (x->ex_flags & EXFLAG_NO_FINGERPRINT) == 0;
+#endif
+
+    if (!CRYPTO_THREAD_write_lock(x->lock))
+        return 0;
+    ERR_set_mark();
+    cache_fingerprint(x);
+    ERR_pop_to_mark();
+    CRYPTO_THREAD_unlock(x->lock);
+    return (x->ex_flags & EXFLAG_NO_FINGERPRINT) == 0;
+}
+
 /*
  * Cache info on various X.509v3 extensions and further derived information,
  * e.g., if cert 'x' is self-issued, in x->ex_flags and other internal fields.
@@ -423,8 +459,7 @@ int ossl_x509v3_cache_extensions(X509 *x)
     ERR_set_mark();
 
     /* Cache the SHA1 digest of the cert */
-    if (!X509_digest(x, EVP_sha1(), x->sha1_hash, NULL))
-        x->ex_flags |= EXFLAG_NO_FINGERPRINT;
+    cache_fingerprint(x);
 
     /* V1 should mean no extensions ... */
     if (X509_get_version(x) == X509_VERSION_1)
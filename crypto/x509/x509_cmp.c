@@ -160,8 +160,8 @@ int X509_cmp(const X509 *a, const X509 *b)
         return 0;
 
     /* attempt to compute cert hash */
-    (void)X509_check_purpose((X509 *)a, -1, 0);
-    (void)X509_check_purpose((X509 *)b, -1, 0);
+    (void)ossl_x509_cache_fingerprint((X509 *)a);
+    (void)ossl_x509_cache_fingerprint((X509 *)b);
 
     if ((a->ex_flags & EXFLAG_NO_FINGERPRINT) == 0
             && (b->ex_flags & EXFLAG_NO_FINGERPRINT) == 0)
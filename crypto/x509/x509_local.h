@@ -106,6 +106,20 @@ struct x509_lookup_st {
     X509_STORE *store_ctx;      /* who owns us */
 };
 
+typedef struct x509_vcache_st X509_VCACHE;
+typedef struct x509_vcache_entry_st X509_VCACHE_ENTRY;
+
+/* Lookup key for the verification cache, see x509_vcache.c */
+typedef struct x509_vcache_key_st {
+    unsigned char *data;
+    size_t len;
+    unsigned long hash;
+    uint64_t generation;        /* Store generation when verification began */
+} X509_VCACHE_KEY;
+
+/* All objects in an X509_STORE with the same type and name, see x509_lu.c */
+typedef struct x509_object_bucket_st X509_OBJECT_BUCKET;
+
 /*
  * This is used to hold everything.  It is used for all certificate
  * validation.  Once we have a certificate chain, the 'verify' function is
@@ -115,6 +129,8 @@ struct x509_store_st {
     /* The following is a cache of trusted certs */
     int cache;                  /* if true, stash any hits */
     STACK_OF(X509_OBJECT) *objs; /* Cache of all objects */
+    /* |objs| indexed by type and subject (or CRL issuer) name */
+    LHASH_OF(X509_OBJECT_BUCKET) *objs_by_name;
     /* These are external lookup methods */
     STACK_OF(X509_LOOKUP) *get_cert_methods;
     X509_VERIFY_PARAM *param;
@@ -146,6 +162,10 @@ struct x509_store_st {
     CRYPTO_EX_DATA ex_data;
     CRYPTO_REF_COUNT references;
     CRYPTO_RWLOCK *lock;
+    /* Incremented whenever a certificate or CRL is added to |objs| */
+    uint64_t generation;
+    /* Optional cache of successful verifications */
+    X509_VCACHE *vcache;
 };
 
 typedef struct lookup_dir_hashes_st BY_DIR_HASH;
@@ -155,5 +175,16 @@ DEFINE_STACK_OF(BY_DIR_ENTRY)
 typedef STACK_OF(X509_NAME_ENTRY) STACK_OF_X509_NAME_ENTRY;
 DEFINE_STACK_OF(STACK_OF_X509_NAME_ENTRY)
 
+int ossl_x509_vcache_key_init(X509_STORE_CTX *ctx, X509_VCACHE_KEY *key);
+void ossl_x509_vcache_key_cleanup(X509_VCACHE_KEY *key);
+int ossl_x509_vcache_get(X509_STORE_CTX *ctx, const X509_VCACHE_KEY *key);
+void ossl_x509_vcache_put(X509_STORE_CTX *ctx, const X509_VCACHE_KEY *key);
+void ossl_x509_vcache_free(X509_VCACHE *vc);
+
+int ossl_x509_name_canon_hash(const X509_NAME *name, uint32_t *hash);
+X509_OBJECT *ossl_x509_store_get0_by_subject(X509_STORE *store,
+                                             X509_LOOKUP_TYPE type,
+                                             const X509_NAME *name);
+
 int ossl_x509_likely_issued(X509 *issuer, X509 *subject);
 int ossl_x509_signing_allowed(const X509 *issuer, const X509 *subject);
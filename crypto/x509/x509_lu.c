@@ -179,6 +179,162 @@ static int x509_object_cmp(const X509_OBJECT *const *a,
     return ret;
 }
 
+/*
+ * The objects in a store are indexed by type and subject name (issuer name
+ * for CRLs), so that looking up the candidate issuers of a certificate is a
+ * hash table lookup rather than a search of |objs|, which would first need to
+ * be sorted under the write lock whenever anything had been added. The index
+ * is updated as each object is added, under the write lock, and may be read
+ * with just the read lock held.
+ */
+struct x509_object_bucket_st {
+    X509_LOOKUP_TYPE type;
+    const X509_NAME *name;          /* Owned by the first object */
+    unsigned long hash;
+    STACK_OF(X509_OBJECT) *objs;    /* In the order added, owned by |objs| */
+};
+
+DEFINE_LHASH_OF_EX(X509_OBJECT_BUCKET);
+
+static const X509_NAME *x509_object_get0_name(const X509_OBJECT *obj)
+{
+    switch (obj->type) {
+    case X509_LU_X509:
+        return X509_get_subject_name(obj->data.x509);
+    case X509_LU_CRL:
+        return X509_CRL_get_issuer(obj->data.crl);
+    case X509_LU_NONE:
+        break;
+    }
+    return NULL;
+}
+
+/*
+ * Names compare equal when their canonical encodings are identical, see
+ * X509_NAME_cmp(), so hash those, using 32-bit FNV-1a. The result is stored
+ * in trust index files (see by_index.c) and so must not change.
+ */
+int ossl_x509_name_canon_hash(const X509_NAME *name, uint32_t *hash)
+{
+    uint32_t h = 2166136261U;
+    int i;
+
+    /* Ensure canonical encoding is present and up to date */
+    if (name->modified && i2d_X509_NAME(name, NULL) < 0)
+        return 0;
+    for (i = 0; i < name->canon_enclen; i++) {
+        h ^= name->canon_enc[i];
+        h *= 16777619U;
+    }
+    *hash = h;
+    return 1;
+}
+
+static unsigned long x509_object_name_hash(X509_LOOKUP_TYPE type,
+                                           const X509_NAME *name)
+{
+    uint32_t h;
+
+    if (!ossl_x509_name_canon_hash(name, &h))
+        return 0;
+    return (unsigned long)h ^ (unsigned long)type;
+}
+
+static unsigned long x509_object_bucket_hash(const X509_OBJECT_BUCKET *b)
+{
+    return b->hash;
+}
+
+static int x509_object_bucket_cmp(const X509_OBJECT_BUCKET *a,
+                                  const X509_OBJECT_BUCKET *b)
+{
+    if (a->type != b->type)
+        return a->type < b->type ? -1 : 1;
+    return X509_NAME_cmp(a->name, b->name);
+}
+
+static void x509_object_bucket_free(X509_OBJECT_BUCKET *b)
+{
+    sk_X509_OBJECT_free(b->objs);
+    OPENSSL_free(b);
+}
+
+/* Assumes |store| is locked for read */
+static X509_OBJECT_BUCKET *x509_store_get0_bucket(X509_STORE *store,
+                                                  X509_LOOKUP_TYPE type,
+                                                  const X509_NAME *name)
+{
+    X509_OBJECT_BUCKET tmpl;
+
+    if (type != X509_LU_X509 && type != X509_LU_CRL)
+        return NULL;
+    tmpl.type = type;
+    tmpl.name = name;
+    tmpl.hash = x509_object_name_hash(type, name);
+    return lh_X509_OBJECT_BUCKET_retrieve(store->objs_by_name, &tmpl);
+}
+
+/* Assumes |store| is locked for read */
+X509_OBJECT *ossl_x509_store_get0_by_subject(X509_STORE *store,
+                                             X509_LOOKUP_TYPE type,
+                                             const X509_NAME *name)
+{
+    X509_OBJECT_BUCKET *b = x509_store_get0_bucket(store, type, name);
+
+    return b != NULL ? sk_X509_OBJECT_value(b->objs, 0) : NULL;
+}
+
+/* Assumes |store| is locked for read */
+static X509_OBJECT *x509_store_get0_match(X509_STORE *store,
+                                          const X509_OBJECT *x)
+{
+    X509_OBJECT_BUCKET *b;
+    X509_OBJECT *obj;
+    int i;
+
+    b = x509_store_get0_bucket(store, x->type, x509_object_get0_name(x));
+    if (b == NULL)
+        return NULL;
+    for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+        obj = sk_X509_OBJECT_value(b->objs, i);
+        if (x->type == X509_LU_X509) {
+            if (!X509_cmp(obj->data.x509, x->data.x509))
+                return obj;
+        } else if (X509_CRL_match(obj->data.crl, x->data.crl) == 0) {
+            return obj;
+        }
+    }
+    return NULL;
+}
+
+/* Assumes |store| is locked for write */
+static int x509_store_index_add(X509_STORE *store, X509_OBJECT *obj)
+{
+    X509_OBJECT_BUCKET tmpl, *b;
+
+    tmpl.type = obj->type;
+    tmpl.name = x509_object_get0_name(obj);
+    tmpl.hash = x509_object_name_hash(tmpl.type, tmpl.name);
+    b = lh_X509_OBJECT_BUCKET_retrieve(store->objs_by_name, &tmpl);
+    if (b != NULL)
+        return sk_X509_OBJECT_push(b->objs, obj) > 0;
+
+    if ((b = OPENSSL_malloc(sizeof(*b))) == NULL)
+        return 0;
+    *b = tmpl;
+    if ((b->objs = sk_X509_OBJECT_new_null()) == NULL
+        || !sk_X509_OBJECT_push(b->objs, obj))
+        goto err;
+    (void)lh_X509_OBJECT_BUCKET_insert(store->objs_by_name, b);
+    if (lh_X509_OBJECT_BUCKET_error(store->objs_by_name))
+        goto err;
+    return 1;
+
+ err:
+    x509_object_bucket_free(b);
+    return 0;
+}
+
 X509_STORE *X509_STORE_new(void)
 {
     X509_STORE *ret = OPENSSL_zalloc(sizeof(*ret));
@@ -189,6 +345,12 @@ X509_STORE *X509_STORE_new(void)
         ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
         goto err;
     }
+    ret->objs_by_name = lh_X509_OBJECT_BUCKET_new(x509_object_bucket_hash,
+                                                  x509_object_bucket_cmp);
+    if (ret->objs_by_name == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
     ret->cache = 1;
     if ((ret->get_cert_methods = sk_X509_LOOKUP_new_null()) == NULL) {
         ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
@@ -216,6 +378,7 @@ X509_STORE *X509_STORE_new(void)
 
 err:
     X509_VERIFY_PARAM_free(ret->param);
+    lh_X509_OBJECT_BUCKET_free(ret->objs_by_name);
     sk_X509_OBJECT_free(ret->objs);
     sk_X509_LOOKUP_free(ret->get_cert_methods);
     CRYPTO_THREAD_lock_free(ret->lock);
@@ -244,10 +407,13 @@ void X509_STORE_free(X509_STORE *xs)
         X509_LOOKUP_free(lu);
     }
     sk_X509_LOOKUP_free(sk);
+    lh_X509_OBJECT_BUCKET_doall(xs->objs_by_name, x509_object_bucket_free);
+    lh_X509_OBJECT_BUCKET_free(xs->objs_by_name);
     sk_X509_OBJECT_pop_free(xs->objs, X509_OBJECT_free);
 
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_X509_STORE, xs, &xs->ex_data);
     X509_VERIFY_PARAM_free(xs->param);
+    ossl_x509_vcache_free(xs->vcache);
     CRYPTO_THREAD_lock_free(xs->lock);
     CRYPTO_FREE_REF(&xs->references);
     OPENSSL_free(xs);
@@ -335,19 +501,7 @@ static int ossl_x509_store_ctx_get_by_subject(const X509_STORE_CTX *ctx,
 
     if (!x509_store_read_lock(store))
         return 0;
-    /* Should already be sorted...but just in case */
-    if (!sk_X509_OBJECT_is_sorted(store->objs)) {
-        X509_STORE_unlock(store);
-        /* Take a write lock instead of a read lock */
-        if (!X509_STORE_lock(store))
-            return 0;
-        /*
-         * Another thread might have sorted it in the meantime. But if so,
-         * sk_X509_OBJECT_sort() exits early.
-         */
-        sk_X509_OBJECT_sort(store->objs);
-    }
-    tmp = X509_OBJECT_retrieve_by_subject(store->objs, type, name);
+    tmp = ossl_x509_store_get0_by_subject(store, type, name);
     X509_STORE_unlock(store);
 
     if (tmp == NULL || type == X509_LU_CRL) {
@@ -387,6 +541,7 @@ static int x509_store_add(X509_STORE *store, void *x, int crl)
 {
     X509_OBJECT *obj;
     int ret = 0, added = 0;
+    uint64_t generation;
 
     if (x == NULL)
         return 0;
@@ -413,16 +568,22 @@ static int x509_store_add(X509_STORE *store, void *x, int crl)
         return 0;
     }
 
-    if (X509_OBJECT_retrieve_match(store->objs, obj)) {
+    if (x509_store_get0_match(store, obj) != NULL) {
         ret = 1;
-    } else {
-        added = sk_X509_OBJECT_push(store->objs, obj);
-        ret = added != 0;
+    } else if (sk_X509_OBJECT_push(store->objs, obj)) {
+        if (x509_store_index_add(store, obj))
+            added = 1;
+        else
+            (void)sk_X509_OBJECT_pop(store->objs);
+        ret = added;
     }
     X509_STORE_unlock(store);
 
     if (added == 0)             /* obj not pushed */
         X509_OBJECT_free(obj);
+    else if (!CRYPTO_atomic_add64(&store->generation, 1, &generation,
+                                  store->lock))
+        ret = 0;
 
     return ret;
 }
@@ -651,21 +812,21 @@ STACK_OF(X509) *X509_STORE_get1_all_certs(X509_STORE *store)
 STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
                                           const X509_NAME *nm)
 {
-    int i, idx, cnt;
+    int i;
     STACK_OF(X509) *sk = NULL;
     X509 *x;
     X509_OBJECT *obj;
+    X509_OBJECT_BUCKET *b;
     X509_STORE *store = ctx->store;
 
     if (store == NULL)
         return sk_X509_new_null();
 
-    if (!X509_STORE_lock(store))
+    if (!x509_store_read_lock(store))
         return NULL;
 
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_X509, nm, &cnt);
-    if (idx < 0) {
+    b = x509_store_get0_bucket(store, X509_LU_X509, nm);
+    if (b == NULL) {
         /*
          * Nothing found in cache: do lookup to possibly add new objects to
          * cache
@@ -681,11 +842,10 @@ STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
             return i < 0 ? NULL : sk_X509_new_null();
         }
         X509_OBJECT_free(xobj);
-        if (!X509_STORE_lock(store))
+        if (!x509_store_read_lock(store))
             return NULL;
-        sk_X509_OBJECT_sort(store->objs);
-        idx = x509_object_idx_cnt(store->objs, X509_LU_X509, nm, &cnt);
-        if (idx < 0) {
+        b = x509_store_get0_bucket(store, X509_LU_X509, nm);
+        if (b == NULL) {
             sk = sk_X509_new_null();
             goto end;
         }
@@ -694,8 +854,8 @@ STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
     sk = sk_X509_new_null();
     if (sk == NULL)
         goto end;
-    for (i = 0; i < cnt; i++, idx++) {
-        obj = sk_X509_OBJECT_value(store->objs, idx);
+    for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+        obj = sk_X509_OBJECT_value(b->objs, i);
         x = obj->data.x509;
         if (!X509_add_cert(sk, x, X509_ADD_FLAG_UP_REF)) {
             X509_STORE_unlock(store);
@@ -712,10 +872,11 @@ STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
 STACK_OF(X509_CRL) *X509_STORE_CTX_get1_crls(const X509_STORE_CTX *ctx,
                                              const X509_NAME *nm)
 {
-    int i = 1, idx, cnt;
+    int i = 1;
     STACK_OF(X509_CRL) *sk = sk_X509_CRL_new_null();
     X509_CRL *x;
     X509_OBJECT *obj, *xobj = X509_OBJECT_new();
+    X509_OBJECT_BUCKET *b;
     X509_STORE *store = ctx->store;
 
     /* Always do lookup to possibly add new CRLs to cache */
@@ -730,19 +891,18 @@ STACK_OF(X509_CRL) *X509_STORE_CTX_get1_crls(const X509_STORE_CTX *ctx,
     X509_OBJECT_free(xobj);
     if (i == 0)
         return sk;
-    if (!X509_STORE_lock(store)) {
+    if (!x509_store_read_lock(store)) {
         sk_X509_CRL_free(sk);
         return NULL;
     }
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_CRL, nm, &cnt);
-    if (idx < 0) {
+    b = x509_store_get0_bucket(store, X509_LU_CRL, nm);
+    if (b == NULL) {
         X509_STORE_unlock(store);
         return sk;
     }
 
-    for (i = 0; i < cnt; i++, idx++) {
-        obj = sk_X509_OBJECT_value(store->objs, idx);
+    for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+        obj = sk_X509_OBJECT_value(b->objs, i);
         x = obj->data.crl;
         if (!X509_CRL_up_ref(x)) {
             X509_STORE_unlock(store);
@@ -802,8 +962,9 @@ int X509_STORE_CTX_get1_issuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x)
 {
     const X509_NAME *xn;
     X509_OBJECT *obj = X509_OBJECT_new(), *pobj = NULL;
+    X509_OBJECT_BUCKET *b;
     X509_STORE *store = ctx->store;
-    int i, ok, idx, ret, nmatch = 0;
+    int i, ok, ret;
 
     if (obj == NULL)
         return -1;
@@ -836,18 +997,14 @@ int X509_STORE_CTX_get1_issuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x)
 
     /* Find index of first currently valid cert accepted by 'check_issued' */
     ret = 0;
-    if (!X509_STORE_lock(store))
+    if (!x509_store_read_lock(store))
         return 0;
 
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_X509, xn, &nmatch);
-    if (idx != -1) { /* should be true as we've had at least one match */
+    b = x509_store_get0_bucket(store, X509_LU_X509, xn);
+    if (b != NULL) { /* should be true as we've had at least one match */
         /* Look through all matching certs for suitable issuer */
-        for (i = idx; i < idx + nmatch; i++) {
-            pobj = sk_X509_OBJECT_value(store->objs, i);
-            /* See if we've run past the matches */
-            if (pobj->type != X509_LU_X509)
-                break;
+        for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+            pobj = sk_X509_OBJECT_value(b->objs, i);
             if (ctx->check_issued(ctx, x, pobj->data.x509)) {
                 ret = 1;
                 /* If times check fine, exit with match, else keep looking. */
@@ -0,0 +1,355 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <time.h>
+#include <openssl/err.h>
+#include <openssl/lhash.h>
+#include <openssl/x509v3.h>
+#include "internal/packet.h"
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+/*
+ * Cache of successful chain verifications
+ * =======================================
+ *
+ * An X509_STORE may optionally keep a cache of the chains it has verified
+ * successfully, so that repeatedly verifying the same peer certificates (for
+ * example the client certificates presented to a TLS server over many
+ * handshakes) only requires a hash table lookup.
+ *
+ * An entry is keyed by the SHA-1 fingerprints of the target certificate and of
+ * the untrusted certificates supplied with it, together with all of the
+ * verification parameters that can affect the outcome. Each entry also records
+ * the generation of the store at the time verification started; adding a
+ * certificate or CRL to the store increments its generation, so any entry
+ * created before the change is no longer used. Entries expire when the first
+ * certificate in the chain expires, when the first CRL used for revocation
+ * checking reaches its nextUpdate time or after the configured lifetime,
+ * whichever comes first.
+ *
+ * Entries are evicted in insertion order once the cache is full.
+ */
+
+struct x509_vcache_entry_st {
+    unsigned char *key;
+    size_t keylen;
+    unsigned long hash;
+    uint64_t generation;
+    time_t expires;
+    STACK_OF(X509) *chain;      /* The verified chain */
+    int num_untrusted;
+    char *peername;             /* As set by host name checks, if any */
+    X509_VCACHE_ENTRY *prev, *next; /* In insertion order, oldest first */
+};
+
+DEFINE_LHASH_OF_EX(X509_VCACHE_ENTRY);
+
+struct x509_vcache_st {
+    CRYPTO_RWLOCK *lock;
+    LHASH_OF(X509_VCACHE_ENTRY) *entries;
+    X509_VCACHE_ENTRY *oldest, *newest;
+    size_t num, max;
+    time_t lifetime;
+};
+
+static unsigned long vcache_entry_hash(const X509_VCACHE_ENTRY *e)
+{
+    return e->hash;
+}
+
+static int vcache_entry_cmp(const X509_VCACHE_ENTRY *a,
+                            const X509_VCACHE_ENTRY *b)
+{
+    if (a->keylen != b->keylen)
+        return a->keylen < b->keylen ? -1 : 1;
+    return memcmp(a->key, b->key, a->keylen);
+}
+
+static void vcache_entry_free(X509_VCACHE_ENTRY *e)
+{
+    if (e == NULL)
+        return;
+    OPENSSL_free(e->key);
+    OSSL_STACK_OF_X509_free(e->chain);
+    OPENSSL_free(e->peername);
+    OPENSSL_free(e);
+}
+
+static void vcache_unlink(X509_VCACHE *vc, X509_VCACHE_ENTRY *e)
+{
+    if (e->prev != NULL)
+        e->prev->next = e->next;
+    else
+        vc->oldest = e->next;
+    if (e->next != NULL)
+        e->next->prev = e->prev;
+    else
+        vc->newest = e->prev;
+    e->prev = e->next = NULL;
+    --vc->num;
+}
+
+static void vcache_flush(X509_VCACHE *vc)
+{
+    X509_VCACHE_ENTRY *e, *next;
+
+    for (e = vc->oldest; e != NULL; e = next) {
+        next = e->next;
+        (void)lh_X509_VCACHE_ENTRY_delete(vc->entries, e);
+        vcache_entry_free(e);
+    }
+    vc->oldest = vc->newest = NULL;
+    vc->num = 0;
+}
+
+void ossl_x509_vcache_free(X509_VCACHE *vc)
+{
+    if (vc == NULL)
+        return;
+    vcache_flush(vc);
+    lh_X509_VCACHE_ENTRY_free(vc->entries);
+    CRYPTO_THREAD_lock_free(vc->lock);
+    OPENSSL_free(vc);
+}
+
+int X509_STORE_set_verify_cache(X509_STORE *xs, size_t max_entries,
+                                time_t lifetime)
+{
+    X509_VCACHE *vc;
+
+    if (xs == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    if (max_entries == 0 || lifetime <= 0) {
+        ossl_x509_vcache_free(xs->vcache);
+        xs->vcache = NULL;
+        return 1;
+    }
+
+    if ((vc = xs->vcache) == NULL) {
+        if ((vc = OPENSSL_zalloc(sizeof(*vc))) == NULL)
+            return 0;
+        vc->lock = CRYPTO_THREAD_lock_new();
+        vc->entries = lh_X509_VCACHE_ENTRY_new(vcache_entry_hash,
+                                               vcache_entry_cmp);
+        if (vc->lock == NULL || vc->entries == NULL) {
+            ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+            ossl_x509_vcache_free(vc);
+            return 0;
+        }
+        xs->vcache = vc;
+    } else {
+        vcache_flush(vc);
+    }
+
+    vc->max = max_entries;
+    vc->lifetime = lifetime;
+    return 1;
+}
+
+static int add_fingerprint(WPACKET *pkt, X509 *x)
+{
+    if (!ossl_x509_cache_fingerprint(x))
+        return 0;
+    return WPACKET_memcpy(pkt, x->sha1_hash, sizeof(x->sha1_hash));
+}
+
+static int add_string(WPACKET *pkt, const void *data, size_t len)
+{
+    return WPACKET_sub_memcpy_u32(pkt, data != NULL ? data : "", len);
+}
+
+int ossl_x509_vcache_key_init(X509_STORE_CTX *ctx, X509_VCACHE_KEY *key)
+{
+    const X509_VERIFY_PARAM *vpm = ctx->param;
+    BUF_MEM *buf;
+    WPACKET pkt;
+    size_t len;
+    int i, n, ok = 0;
+
+    memset(key, 0, sizeof(*key));
+    if (ctx->store == NULL || ctx->store->vcache == NULL)
+        return 0;
+
+    if ((buf = BUF_MEM_new()) == NULL)
+        return 0;
+    if (!WPACKET_init(&pkt, buf)) {
+        BUF_MEM_free(buf);
+        return 0;
+    }
+
+    /* The stack functions return -1 for a NULL stack */
+    n = ctx->untrusted != NULL ? sk_X509_num(ctx->untrusted) : 0;
+    if (!add_fingerprint(&pkt, ctx->cert)
+        || !WPACKET_put_bytes_u32(&pkt, n))
+        goto end;
+    for (i = 0; i < n; ++i)
+        if (!add_fingerprint(&pkt, sk_X509_value(ctx->untrusted, i)))
+            goto end;
+
+    if (!WPACKET_put_bytes_u64(&pkt, vpm->flags)
+        || !WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->purpose)
+        || !WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->trust)
+        || !WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->depth)
+        || !WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->auth_level)
+        || !WPACKET_put_bytes_u32(&pkt, vpm->hostflags))
+        goto end;
+
+    n = vpm->hosts != NULL ? sk_OPENSSL_STRING_num(vpm->hosts) : 0;
+    if (!WPACKET_put_bytes_u32(&pkt, n))
+        goto end;
+    for (i = 0; i < n; ++i) {
+        const char *host = sk_OPENSSL_STRING_value(vpm->hosts, i);
+
+        if (!add_string(&pkt, host, strlen(host)))
+            goto end;
+    }
+    if (!add_string(&pkt, vpm->email, vpm->emaillen)
+        || !add_string(&pkt, vpm->ip, vpm->iplen)
+        || !WPACKET_get_total_written(&pkt, &len)
+        || !WPACKET_finish(&pkt))
+        goto end;
+
+    /*
+     * The first bytes are part of the target certificate's fingerprint and
+     * are well distributed.
+     */
+    key->data = (unsigned char *)buf->data;
+    key->len = len;
+    buf->data = NULL;
+    memcpy(&key->hash, key->data, sizeof(key->hash));
+
+    ok = CRYPTO_atomic_load(&ctx->store->generation, &key->generation,
+                            ctx->store->lock);
+ end:
+    if (!ok) {
+        WPACKET_cleanup(&pkt);
+        OPENSSL_free(key->data);
+        memset(key, 0, sizeof(*key));
+    }
+    BUF_MEM_free(buf);
+    return ok;
+}
+
+void ossl_x509_vcache_key_cleanup(X509_VCACHE_KEY *key)
+{
+    OPENSSL_free(key->data);
+    key->data = NULL;
+}
+
+int ossl_x509_vcache_get(X509_STORE_CTX *ctx, const X509_VCACHE_KEY *key)
+{
+    X509_VCACHE *vc = ctx->store->vcache;
+    X509_VCACHE_ENTRY tmpl, *e;
+    STACK_OF(X509) *chain = NULL;
+    char *peername = NULL;
+    int num_untrusted = 0, hit = 0;
+
+    tmpl.key = key->data;
+    tmpl.keylen = key->len;
+    tmpl.hash = key->hash;
+
+    if (!CRYPTO_THREAD_read_lock(vc->lock))
+        return 0;
+    e = lh_X509_VCACHE_ENTRY_retrieve(vc->entries, &tmpl);
+    if (e != NULL && e->generation == key->generation
+        && time(NULL) < e->expires
+        && (chain = X509_chain_up_ref(e->chain)) != NULL
+        && (e->peername == NULL
+            || (peername = OPENSSL_strdup(e->peername)) != NULL)) {
+        num_untrusted = e->num_untrusted;
+        hit = 1;
+    }
+    CRYPTO_THREAD_unlock(vc->lock);
+
+    if (!hit) {
+        OSSL_STACK_OF_X509_free(chain);
+        return 0;
+    }
+
+    ctx->chain = chain;
+    ctx->num_untrusted = num_untrusted;
+    OPENSSL_free(ctx->param->peername);
+    ctx->param->peername = peername;
+    return 1;
+}
+
+void ossl_x509_vcache_put(X509_STORE_CTX *ctx, const X509_VCACHE_KEY *key)
+{
+    X509_VCACHE *vc = ctx->store->vcache;
+    X509_VCACHE_ENTRY *e, *old;
+    time_t now = time(NULL);
+    int i, day, sec;
+
+    if ((e = OPENSSL_zalloc(sizeof(*e))) == NULL)
+        return;
+
+    e->expires = now + vc->lifetime;
+    for (i = 0; i < sk_X509_num(ctx->chain); ++i) {
+        if (!ASN1_TIME_diff(&day, &sec, NULL,
+                            X509_get0_notAfter(sk_X509_value(ctx->chain, i))))
+            goto err;
+        if (day < 0 || sec < 0)
+            goto err;
+        if ((time_t)day * 86400 + sec < e->expires - now)
+            e->expires = now + (time_t)day * 86400 + sec;
+    }
+    /* Revocation status is only known until the next update of each CRL */
+    if (ctx->crl_expires != 0 && ctx->crl_expires < e->expires)
+        e->expires = ctx->crl_expires;
+    if (e->expires <= now)
+        goto err;
+
+    if ((e->key = OPENSSL_memdup(key->data, key->len)) == NULL
+        || (e->chain = X509_chain_up_ref(ctx->chain)) == NULL
+        || (ctx->param->peername != NULL
+            && (e->peername = OPENSSL_strdup(ctx->param->peername)) == NULL))
+        goto err;
+    e->keylen = key->len;
+    e->hash = key->hash;
+    e->generation = key->generation;
+    e->num_untrusted = ctx->num_untrusted;
+
+    if (!CRYPTO_THREAD_write_lock(vc->lock))
+        goto err;
+
+    /* Replace any existing (most likely stale) entry with the same key. */
+    if ((old = lh_X509_VCACHE_ENTRY_delete(vc->entries, e)) != NULL) {
+        vcache_unlink(vc, old);
+        vcache_entry_free(old);
+    }
+
+    while (vc->num >= vc->max && (old = vc->oldest) != NULL) {
+        (void)lh_X509_VCACHE_ENTRY_delete(vc->entries, old);
+        vcache_unlink(vc, old);
+        vcache_entry_free(old);
+    }
+
+    (void)lh_X509_VCACHE_ENTRY_insert(vc->entries, e);
+    if (lh_X509_VCACHE_ENTRY_error(vc->entries)) {
+        CRYPTO_THREAD_unlock(vc->lock);
+        goto err;
+    }
+    e->prev = vc->newest;
+    if (vc->newest != NULL)
+        vc->newest->next = e;
+    else
+        vc->oldest = e;
+    vc->newest = e;
+    ++vc->num;
+    CRYPTO_THREAD_unlock(vc->lock);
+    return;
+
+ err:
+    vcache_entry_free(e);
+}
@@ -25,6 +25,7 @@
 #include <openssl/objects.h>
 #include <openssl/core_names.h>
 #include "internal/dane.h"
+#include "internal/thread.h"
 #include "crypto/x509.h"
 #include "x509_local.h"
 
@@ -76,6 +77,8 @@ static void crl_akid_check(X509_STORE_CTX *ctx, X509_CRL *crl, X509 **pissuer,
                            int *pcrl_score);
 static int crl_crldp_check(X509 *x, X509_CRL *crl, int crl_score,
                            unsigned int *preasons);
+static int check_crl(X509_STORE_CTX *ctx, X509_CRL *crl);
+static int cert_crl(X509_STORE_CTX *ctx, X509_CRL *crl, X509 *x);
 static int check_crl_path(X509_STORE_CTX *ctx, X509 *x);
 static int check_crl_chain(X509_STORE_CTX *ctx,
                            STACK_OF(X509) *cert_path,
@@ -321,13 +324,62 @@ static int x509_verify_rpk(X509_STORE_CTX *ctx)
     return ret;
 }
 
+/*
+ * The verification cache can only be used if the outcome depends on nothing
+ * but the certificates, the verification parameters and the contents of the
+ * store. This excludes any callbacks other than the verify callback, which is
+ * still invoked for each certificate of a cached chain.
+ */
+static int vcache_usable(const X509_STORE_CTX *ctx)
+{
+    return ctx->store != NULL && ctx->store->vcache != NULL
+        && !DANETLS_ENABLED(ctx->dane)
+        && ctx->parent == NULL
+        && ctx->crls == NULL
+        && ctx->other_ctx == NULL
+        && ctx->verify == internal_verify
+        && ctx->get_issuer == X509_STORE_CTX_get1_issuer
+        && ctx->check_issued == check_issued
+        && ctx->check_revocation == check_revocation
+        && ctx->get_crl == NULL
+        && ctx->check_crl == check_crl
+        && ctx->cert_crl == cert_crl
+        && ctx->lookup_certs == X509_STORE_CTX_get1_certs
+        && ctx->lookup_crls == X509_STORE_CTX_get1_crls
+        && (ctx->param->flags & (X509_V_FLAG_USE_CHECK_TIME
+                                 | X509_V_FLAG_NO_CHECK_TIME
+                                 | X509_V_FLAG_POLICY_CHECK)) == 0;
+}
+
+/*
+ * Report success for each certificate of a chain taken from the verification
+ * cache, in the same order as internal_verify().
+ * Sadly, returns 0 also on internal error in ctx->verify_cb().
+ */
+static int vcache_verified(X509_STORE_CTX *ctx)
+{
+    int n = sk_X509_num(ctx->chain) - 1;
+
+    for (; n >= 0; --n) {
+        ctx->current_cert = sk_X509_value(ctx->chain, n);
+        ctx->current_issuer = sk_X509_value(ctx->chain,
+                                            n < sk_X509_num(ctx->chain) - 1
+                                            ? n + 1 : n);
+        ctx->error_depth = n;
+        if (!ctx->verify_cb(1, ctx))
+            return 0;
+    }
+    return 1;
+}
+
 /*-
  * Returns -1 on internal error.
  * Sadly, returns 0 also on internal error in ctx->verify_cb().
  */
 static int x509_verify_x509(X509_STORE_CTX *ctx)
 {
-    int ret;
+    int ret, cacheable;
+    X509_VCACHE_KEY vkey;
 
     if (ctx->cert == NULL) {
         ERR_raise(ERR_LIB_X509, X509_R_NO_CERT_SET_FOR_US_TO_VERIFY);
@@ -345,18 +397,40 @@ static int x509_verify_x509(X509_STORE_CTX *ctx)
         return -1;
     }
 
+    cacheable = vcache_usable(ctx) && ossl_x509_vcache_key_init(ctx, &vkey);
+    if (cacheable && ossl_x509_vcache_get(ctx, &vkey)) {
+        ossl_x509_vcache_key_cleanup(&vkey);
+        return vcache_verified(ctx);
+    }
+
     if (!ossl_x509_add_cert_new(&ctx->chain, ctx->cert, X509_ADD_FLAG_UP_REF)) {
+        if (cacheable)
+            ossl_x509_vcache_key_cleanup(&vkey);
         ctx->error = X509_V_ERR_OUT_OF_MEM;
         return -1;
     }
     ctx->num_untrusted = 1;
 
     /* If the peer's public key is too weak, we can stop early. */
-    CB_FAIL_IF(!check_cert_key_level(ctx, ctx->cert),
-               ctx, ctx->cert, 0, X509_V_ERR_EE_KEY_TOO_SMALL);
+    if (!check_cert_key_level(ctx, ctx->cert)
+        && verify_cb_cert(ctx, ctx->cert, 0, X509_V_ERR_EE_KEY_TOO_SMALL) == 0) {
+        if (cacheable)
+            ossl_x509_vcache_key_cleanup(&vkey);
+        return 0;
+    }
 
     ret = DANETLS_ENABLED(ctx->dane) ? dane_verify(ctx) : verify_chain(ctx);
 
+    /*
+     * Only chains verified without any error, including errors overridden by
+     * the verify callback, are cached.
+     */
+    if (cacheable) {
+        if (ret > 0 && ctx->error == X509_V_OK && !ctx->bare_ta_signed)
+            ossl_x509_vcache_put(ctx, &vkey);
+        ossl_x509_vcache_key_cleanup(&vkey);
+    }
+
     /*
      * Safety-net.  If we are returning an error, we must also set ctx->error,
      * so that the chain is not considered verified should the error be ignored
@@ -795,10 +869,10 @@ static int check_name_constraints(X509_STORE_CTX *ctx)
          * to be obeyed.
          */
         for (j = sk_X509_num(ctx->chain) - 1; j > i; j--) {
-            NAME_CONSTRAINTS *nc = sk_X509_value(ctx->chain, j)->nc;
+            X509 *ca = sk_X509_value(ctx->chain, j);
 
-            if (nc) {
-                int rv = NAME_CONSTRAINTS_check(x, nc);
+            if (ca->nc != NULL) {
+                int rv = ossl_x509_name_constraints_check(x, ca);
                 int ret = 1;
 
                 /* If EE certificate check commonName too */
@@ -808,7 +882,7 @@ static int check_name_constraints(X509_STORE_CTX *ctx)
                     && ((ctx->param->hostflags
                          & X509_CHECK_FLAG_ALWAYS_CHECK_SUBJECT) != 0
                         || (ret = has_san_id(x, GEN_DNS)) == 0))
-                    rv = NAME_CONSTRAINTS_check_CN(x, nc);
+                    rv = ossl_x509_name_constraints_check_CN(x, ca);
                 if (ret < 0)
                     return ret;
 
@@ -993,6 +1067,27 @@ static int check_revocation(X509_STORE_CTX *ctx)
     return 1;
 }
 
+/*
+ * Note that the outcome of the verification relies on a CRL which is only
+ * valid until |next|, so that the verification cache does not keep the result
+ * for longer than that.
+ */
+static void note_crl_expiry(X509_STORE_CTX *ctx, const ASN1_TIME *next)
+{
+    time_t now, expires;
+    int day, sec;
+
+    if (next == NULL)
+        return;
+    now = time(NULL);
+    if (!ASN1_TIME_diff(&day, &sec, NULL, next) || day < 0 || sec < 0)
+        expires = now;
+    else
+        expires = now + (time_t)day * 86400 + sec;
+    if (ctx->crl_expires == 0 || expires < ctx->crl_expires)
+        ctx->crl_expires = expires;
+}
+
 /* Sadly, returns 0 also on internal error. */
 static int check_cert(X509_STORE_CTX *ctx)
 {
@@ -1026,11 +1121,13 @@ static int check_cert(X509_STORE_CTX *ctx)
         ok = ctx->check_crl(ctx, crl);
         if (!ok)
             goto done;
+        note_crl_expiry(ctx, X509_CRL_get0_nextUpdate(crl));
 
         if (dcrl != NULL) {
             ok = ctx->check_crl(ctx, dcrl);
             if (!ok)
                 goto done;
+            note_crl_expiry(ctx, X509_CRL_get0_nextUpdate(dcrl));
             ok = ctx->cert_crl(ctx, dcrl, x);
             if (!ok)
                 goto done;
@@ -1406,6 +1503,11 @@ static int check_crl_path(X509_STORE_CTX *ctx, X509 *x)
 
     /* Check chain is acceptable */
     ret = check_crl_chain(ctx, ctx->chain, crl_ctx.chain);
+
+    /* The CRL issuer's own revocation status is only as fresh as its CRLs */
+    if (crl_ctx.crl_expires != 0
+        && (ctx->crl_expires == 0 || crl_ctx.crl_expires < ctx->crl_expires))
+        ctx->crl_expires = crl_ctx.crl_expires;
  err:
     X509_STORE_CTX_cleanup(&crl_ctx);
     return ret;
@@ -1806,15 +1908,155 @@ int ossl_x509_check_cert_time(X509_STORE_CTX *ctx, X509 *x, int depth)
     return 1;
 }
 
+/*
+ * Do signature check for self-signed certificates only if explicitly
+ * asked for because it does not add any security and just wastes time.
+ */
+static int sig_check_needed(X509_STORE_CTX *ctx, X509 *xi, X509 *xs)
+{
+    return xi != NULL
+        && (xs != xi
+            || ((ctx->param->flags & X509_V_FLAG_CHECK_SS_SIGNATURE) != 0
+                && (xi->ex_flags & EXFLAG_SS) != 0));
+}
+
+/* A signature check of the certificate at some depth of the chain */
+typedef struct sig_check_st {
+    X509 *subject;
+    EVP_PKEY *pkey;
+    int ret;
+    void *task;
+    ERR_STATE *err;             /* Errors raised by the thread doing it */
+} SIG_CHECK;
+
+#ifndef OPENSSL_NO_THREAD_POOL
+static CRYPTO_THREAD_RETVAL sig_check_thread(void *arg)
+{
+    SIG_CHECK *check = arg;
+
+    check->ret = X509_verify(check->subject, check->pkey);
+    /* Hand any errors over to the calling thread, see sig_check_result() */
+    OSSL_ERR_STATE_save(check->err);
+    return 0;
+}
+#endif
+
+/*
+ * With X509_V_FLAG_PARALLEL_VERIFY, hand the signature checks of the chain
+ * from depth |n| downwards to the thread pool of the library context, as far as
+ * it has threads available.  Returns the checks indexed by depth, or NULL if
+ * they are all to be done by the calling thread.
+ */
+static SIG_CHECK *sig_checks_start(X509_STORE_CTX *ctx, int n,
+                                   X509 *xi, X509 *xs)
+{
+#ifndef OPENSSL_NO_THREAD_POOL
+    SIG_CHECK *checks;
+    uint64_t avail;
+    int depth, top = -1;
+
+    if ((ctx->param->flags & X509_V_FLAG_PARALLEL_VERIFY) == 0 || n < 1
+            || (avail = ossl_get_avail_threads(ctx->libctx)) == 0)
+        return NULL;
+    if ((checks = OPENSSL_zalloc((n + 1) * sizeof(*checks))) == NULL)
+        return NULL;
+
+    for (depth = n; depth >= 0; depth--) {
+        if (sig_check_needed(ctx, xi, xs)
+                && (checks[depth].pkey = X509_get0_pubkey(xi)) != NULL) {
+            checks[depth].subject = xs;
+            if (top < 0)
+                top = depth;
+        }
+        if (depth > 0) {
+            xi = xs;
+            xs = sk_X509_value(ctx->chain, depth - 1);
+        }
+    }
+
+    /*
+     * The calling thread works its way down from the top of the chain, so
+     * leave the topmost check to it and start the others from the bottom.
+     */
+    for (depth = 0; depth < top && avail > 0; depth++) {
+        if (checks[depth].pkey == NULL)
+            continue;
+        if ((checks[depth].err = OSSL_ERR_STATE_new()) == NULL)
+            break;
+        checks[depth].task = ossl_crypto_thread_start(ctx->libctx,
+                                                      sig_check_thread,
+                                                      &checks[depth]);
+        if (checks[depth].task == NULL)
+            break;
+        avail--;
+    }
+    return checks;
+#else
+    return NULL;
+#endif
+}
+
+/*
+ * Returns the result of the signature check at |depth|, waiting for it if it
+ * was started in the thread pool, and doing it here otherwise.  Errors raised
+ * by a check in the thread pool are added to the calling thread's error queue,
+ * as if the check had been done here.
+ */
+static int sig_check_result(SIG_CHECK *checks, int depth,
+                            X509 *xs, EVP_PKEY *pkey)
+{
+#ifndef OPENSSL_NO_THREAD_POOL
+    if (checks != NULL && checks[depth].task != NULL) {
+        SIG_CHECK *check = &checks[depth];
+        int joined = ossl_crypto_thread_join(check->task, NULL);
+
+        ossl_crypto_thread_clean(check->task);
+        check->task = NULL;
+        if (!joined)
+            return -1;
+        OSSL_ERR_STATE_restore(check->err);
+        return check->ret;
+    }
+#endif
+    return X509_verify(xs, pkey);
+}
+
+/*
+ * Waits for any checks still running after an early return and frees them.
+ * Their errors are dropped, a sequential verification would not have done
+ * those checks at all.
+ */
+static void sig_checks_end(SIG_CHECK *checks, int n)
+{
+#ifndef OPENSSL_NO_THREAD_POOL
+    int depth;
+
+    if (checks == NULL)
+        return;
+    for (depth = 0; depth <= n; depth++) {
+        if (checks[depth].task != NULL) {
+            ossl_crypto_thread_join(checks[depth].task, NULL);
+            ossl_crypto_thread_clean(checks[depth].task);
+        }
+        OSSL_ERR_STATE_free(checks[depth].err);
+    }
+    OPENSSL_free(checks);
+#endif
+}
+
+static int internal_verify_from(X509_STORE_CTX *ctx, int n,
+                                X509 *xi, X509 *xs, SIG_CHECK *checks);
+
 /*
  * Verify the issuer signatures and cert times of ctx->chain.
  * Sadly, returns 0 also on internal error in ctx->verify_cb().
  */
 static int internal_verify(X509_STORE_CTX *ctx)
 {
-    int n;
+    int n, ret;
     X509 *xi;
     X509 *xs;
+    SIG_CHECK *checks;
 
     /* For RPK: just do the verify callback */
     if (ctx->rpk != NULL) {
@@ -1851,6 +2093,19 @@ static int internal_verify(X509_STORE_CTX *ctx)
          */
     }
 
+    checks = sig_checks_start(ctx, n, xi, xs);
+    ret = internal_verify_from(ctx, n, xi, xs, checks);
+    sig_checks_end(checks, n);
+    return ret;
+}
+
+/*
+ * Verify the signatures and cert times of ctx->chain from depth |n| down,
+ * where |xs| is the cert at depth |n| and |xi| its issuer.
+ */
+static int internal_verify_from(X509_STORE_CTX *ctx, int n,
+                                X509 *xi, X509 *xs, SIG_CHECK *checks)
+{
     /*
      * Do not clear error (by ctx->error = X509_V_OK), it must be "sticky",
      * only the user's callback is allowed to reset errors (at its own peril).
@@ -1864,14 +2119,7 @@ static int internal_verify(X509_STORE_CTX *ctx)
          *       else the supposed issuer cert containing the public key to use
          * Initially xs == xi if the last cert in the chain is self-issued.
          */
-        /*
-         * Do signature check for self-signed certificates only if explicitly
-         * asked for because it does not add any security and just wastes time.
-         */
-        if (xi != NULL
-            && (xs != xi
-                || ((ctx->param->flags & X509_V_FLAG_CHECK_SS_SIGNATURE) != 0
-                    && (xi->ex_flags & EXFLAG_SS) != 0))) {
+        if (sig_check_needed(ctx, xi, xs)) {
             EVP_PKEY *pkey;
             /*
              * If the issuer's public key is not available or its key usage
@@ -1900,7 +2148,7 @@ static int internal_verify(X509_STORE_CTX *ctx)
                 CB_FAIL_IF(1, ctx, xi, issuer_depth,
                            X509_V_ERR_UNABLE_TO_DECODE_ISSUER_PUBLIC_KEY);
             } else {
-                CB_FAIL_IF(X509_verify(xs, pkey) <= 0,
+                CB_FAIL_IF(sig_check_result(checks, n, xs, pkey) <= 0,
                            ctx, xs, n, X509_V_ERR_CERT_SIGNATURE_FAILURE);
             }
         }
@@ -2455,6 +2703,7 @@ int X509_STORE_CTX_init(X509_STORE_CTX *ctx, X509_STORE *store, X509 *x509,
     ctx->parent = NULL;
     ctx->dane = NULL;
     ctx->bare_ta_signed = 0;
+    ctx->crl_expires = 0;
     ctx->rpk = NULL;
     /* Zero ex_data to make sure we're cleanup-safe */
     memset(&ctx->ex_data, 0, sizeof(ctx->ex_data));
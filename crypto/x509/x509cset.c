@@ -18,7 +18,7 @@
 
 int X509_CRL_set_version(X509_CRL *x, long version)
 {
-    if (x == NULL)
+    if (x == NULL || !ossl_x509_crl_expand(x))
         return 0;
     if (x->crl.version == NULL) {
         if ((x->crl.version = ASN1_INTEGER_new()) == NULL)
@@ -32,7 +32,7 @@ int X509_CRL_set_version(X509_CRL *x, long version)
 
 int X509_CRL_set_issuer_name(X509_CRL *x, const X509_NAME *name)
 {
-    if (x == NULL)
+    if (x == NULL || !ossl_x509_crl_expand(x))
         return 0;
     if (!X509_NAME_set(&x->crl.issuer, name))
         return 0;
@@ -42,14 +42,14 @@ int X509_CRL_set_issuer_name(X509_CRL *x, const X509_NAME *name)
 
 int X509_CRL_set1_lastUpdate(X509_CRL *x, const ASN1_TIME *tm)
 {
-    if (x == NULL || tm == NULL)
+    if (x == NULL || tm == NULL || !ossl_x509_crl_expand(x))
         return 0;
     return ossl_x509_set1_time(&x->crl.enc.modified, &x->crl.lastUpdate, tm);
 }
 
 int X509_CRL_set1_nextUpdate(X509_CRL *x, const ASN1_TIME *tm)
 {
-    if (x == NULL)
+    if (x == NULL || !ossl_x509_crl_expand(x))
         return 0;
     return ossl_x509_set1_time(&x->crl.enc.modified, &x->crl.nextUpdate, tm);
 }
@@ -59,6 +59,8 @@ int X509_CRL_sort(X509_CRL *c)
     int i;
     X509_REVOKED *r;
 
+    if (!ossl_x509_crl_expand(c))
+        return 0;
     /*
      * sort the data so it will be written in serial number order
      */
@@ -68,6 +70,7 @@ int X509_CRL_sort(X509_CRL *c)
         r->sequence = i;
     }
     c->crl.enc.modified = 1;
+    ossl_x509_crl_revoked_changed(c);
     return 1;
 }
 
@@ -122,6 +125,8 @@ const STACK_OF(X509_EXTENSION) *X509_CRL_get0_extensions(const X509_CRL *crl)
 
 STACK_OF(X509_REVOKED) *X509_CRL_get_REVOKED(X509_CRL *crl)
 {
+    if (!ossl_x509_crl_expand(crl))
+        return NULL;
     return crl->crl.revoked;
 }
 
@@ -176,6 +181,8 @@ const STACK_OF(X509_EXTENSION) *X509_REVOKED_get0_extensions(const
 
 int i2d_re_X509_CRL_tbs(X509_CRL *crl, unsigned char **pp)
 {
+    if (!ossl_x509_crl_expand(crl))
+        return 0;
     crl->crl.enc.modified = 1;
     return i2d_X509_CRL_INFO(&crl->crl, pp);
 }
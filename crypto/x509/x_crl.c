@@ -18,6 +18,8 @@
 static int X509_REVOKED_cmp(const X509_REVOKED *const *a,
                             const X509_REVOKED *const *b);
 static int setup_idp(X509_CRL *crl, ISSUING_DIST_POINT *idp);
+static void crl_revoked_index_free(struct x509_revoked_index_st *idx);
+static int crl_is_compact(X509_CRL *crl);
 
 ASN1_SEQUENCE(X509_REVOKED) = {
         ASN1_EMBED(X509_REVOKED, serialNumber, ASN1_INTEGER),
@@ -86,7 +88,7 @@ static int crl_set_issuers(X509_CRL *crl)
     GENERAL_NAMES *gens, *gtmp;
     STACK_OF(X509_REVOKED) *revoked;
 
-    revoked = X509_CRL_get_REVOKED(crl);
+    revoked = crl->crl.revoked;
 
     gens = NULL;
     for (i = 0; i < sk_X509_REVOKED_num(revoked); i++) {
@@ -174,6 +176,7 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         ASN1_INTEGER_free(crl->crl_number);
         ASN1_INTEGER_free(crl->base_crl_number);
         sk_GENERAL_NAMES_pop_free(crl->issuers, GENERAL_NAMES_free);
+        crl_revoked_index_free(crl->revoked_index);
         /* fall through */
 
     case ASN1_OP_NEW_POST:
@@ -185,6 +188,7 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         crl->meth = default_crl_method;
         crl->meth_data = NULL;
         crl->issuers = NULL;
+        crl->revoked_index = NULL;
         crl->crl_number = NULL;
         crl->base_crl_number = NULL;
         break;
@@ -270,6 +274,7 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         ASN1_INTEGER_free(crl->crl_number);
         ASN1_INTEGER_free(crl->base_crl_number);
         sk_GENERAL_NAMES_pop_free(crl->issuers, GENERAL_NAMES_free);
+        crl_revoked_index_free(crl->revoked_index);
         OPENSSL_free(crl->propq);
         break;
     case ASN1_OP_DUP_POST:
@@ -278,6 +283,8 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
 
             if (!ossl_x509_crl_set0_libctx(crl, old->libctx, old->propq))
                 return 0;
+            if (crl_is_compact(old) && !X509_CRL_compact(crl))
+                return 0;
         }
         break;
     }
@@ -362,6 +369,8 @@ int X509_CRL_add0_revoked(X509_CRL *crl, X509_REVOKED *rev)
 {
     X509_CRL_INFO *inf;
 
+    if (!ossl_x509_crl_expand(crl))
+        return 0;
     inf = &crl->crl;
     if (inf->revoked == NULL)
         inf->revoked = sk_X509_REVOKED_new(X509_REVOKED_cmp);
@@ -370,6 +379,7 @@ int X509_CRL_add0_revoked(X509_CRL *crl, X509_REVOKED *rev)
         return 0;
     }
     inf->enc.modified = 1;
+    ossl_x509_crl_revoked_changed(crl);
     return 1;
 }
 
@@ -431,35 +441,357 @@ static int crl_revoked_issuer_match(X509_CRL *crl, const X509_NAME *nm,
 
 }
 
+/*
+ * Index of the revoked entries of a CRL by serial number. Large CRLs may list
+ * hundreds of thousands of serial numbers, so rather than sorting the stack of
+ * entries and comparing each probe against a full ASN1_INTEGER, the index is a
+ * flat array of 64-bit hashes of the serial numbers, sorted so that a lookup
+ * is a binary search touching a single cache line per step. Only entries with
+ * an equal hash are compared in full. The stack itself is left in its original
+ * order.
+ *
+ * A compact CRL, see X509_CRL_compact(), has no stack of entries at all. Its
+ * index refers to the entries by their offset in the cached encoding of the
+ * CRL, and an entry is only decoded when a lookup finds it.
+ */
+typedef struct {
+    uint64_t key;
+    int pos;                    /* Stack position, or offset if compact */
+    int issuer;                 /* Compact: index in crl->issuers, or -1 */
+    X509_REVOKED *rev;          /* Compact: the entry, once decoded */
+} REVOKED_INDEX_ENTRY;
+
+struct x509_revoked_index_st {
+    int num;
+    int compact;
+    REVOKED_INDEX_ENTRY *entries;
+};
+
+static void crl_revoked_index_free(struct x509_revoked_index_st *idx)
+{
+    int i;
+
+    if (idx == NULL)
+        return;
+    if (idx->compact)
+        for (i = 0; i < idx->num; i++)
+            X509_REVOKED_free(idx->entries[i].rev);
+    OPENSSL_free(idx->entries);
+    OPENSSL_free(idx);
+}
+
+/*
+ * Serial numbers compare equal under ASN1_INTEGER_cmp() when their signs and
+ * content octets are identical, so hash those.
+ */
+static uint64_t serial_hash(const ASN1_INTEGER *serial)
+{
+    uint64_t h = UINT64_C(14695981039346656037);
+    int i;
+
+    /* FNV-1a */
+    h ^= (serial->type & V_ASN1_NEG) != 0;
+    h *= UINT64_C(1099511628211);
+    for (i = 0; i < serial->length; i++) {
+        h ^= serial->data[i];
+        h *= UINT64_C(1099511628211);
+    }
+    return h;
+}
+
+static int revoked_index_entry_cmp(const void *a, const void *b)
+{
+    const REVOKED_INDEX_ENTRY *ea = a, *eb = b;
+
+    if (ea->key != eb->key)
+        return ea->key < eb->key ? -1 : 1;
+    return ea->pos < eb->pos ? -1 : ea->pos > eb->pos;
+}
+
+static int revoked_index_pos_cmp(const void *a, const void *b)
+{
+    const REVOKED_INDEX_ENTRY *ea = a, *eb = b;
+
+    return ea->pos < eb->pos ? -1 : ea->pos > eb->pos;
+}
+
+/* Returns the position of the first entry in |idx| with a hash of |key| */
+static int revoked_index_find(const struct x509_revoked_index_st *idx,
+                              uint64_t key)
+{
+    int lo = 0, hi = idx->num, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (idx->entries[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static struct x509_revoked_index_st *crl_revoked_index_alloc(int num)
+{
+    struct x509_revoked_index_st *idx;
+
+    if ((idx = OPENSSL_zalloc(sizeof(*idx))) == NULL)
+        return NULL;
+    if (num > 0) {
+        idx->entries = OPENSSL_zalloc(num * sizeof(*idx->entries));
+        if (idx->entries == NULL) {
+            OPENSSL_free(idx);
+            return NULL;
+        }
+    }
+    idx->num = num;
+    return idx;
+}
+
+static struct x509_revoked_index_st *crl_revoked_index_new(X509_CRL *crl)
+{
+    struct x509_revoked_index_st *idx;
+    X509_REVOKED *rev;
+    int i, num = sk_X509_REVOKED_num(crl->crl.revoked);
+
+    if ((idx = crl_revoked_index_alloc(num)) == NULL)
+        return NULL;
+    for (i = 0; i < num; i++) {
+        rev = sk_X509_REVOKED_value(crl->crl.revoked, i);
+        idx->entries[i].key = serial_hash(&rev->serialNumber);
+        idx->entries[i].pos = i;
+    }
+    if (num > 1)
+        qsort(idx->entries, num, sizeof(*idx->entries),
+              revoked_index_entry_cmp);
+    return idx;
+}
+
+/*
+ * Return the index of revoked entries, building it if this is the first
+ * lookup or if the stack has been changed since it was built. Functions which
+ * add or reorder entries drop the index, see ossl_x509_crl_revoked_changed();
+ * the size check catches callers which edit the stack from
+ * X509_CRL_get_REVOKED() directly. As the index only holds positions in the
+ * stack, a stale index can never refer to a freed entry.
+ */
+static const struct x509_revoked_index_st *crl_get0_revoked_index(X509_CRL *crl)
+{
+    struct x509_revoked_index_st *idx;
+    int num = sk_X509_REVOKED_num(crl->crl.revoked);
+
+    if (!CRYPTO_THREAD_read_lock(crl->lock))
+        return NULL;
+    idx = crl->revoked_index;
+    CRYPTO_THREAD_unlock(crl->lock);
+    if (idx != NULL && idx->num == num)
+        return idx;
+
+    if (!CRYPTO_THREAD_write_lock(crl->lock))
+        return NULL;
+    /* Another thread may have built it in the meantime */
+    idx = crl->revoked_index;
+    if (idx == NULL || idx->num != num) {
+        crl_revoked_index_free(idx);
+        idx = crl->revoked_index = crl_revoked_index_new(crl);
+    }
+    CRYPTO_THREAD_unlock(crl->lock);
+    return idx;
+}
+
+/*
+ * Read the identifier and length octets of the DER element at |*pp|, leaving
+ * |*pp| at its contents. Indefinite length encodings are not supported.
+ */
+static int der_get_header(const unsigned char **pp, const unsigned char *end,
+                          long *len, int *tag, int *xclass)
+{
+    return (ASN1_get_object(pp, len, tag, xclass, end - *pp) & 0x81) == 0;
+}
+
+/*
+ * Find the offsets of the |num| revoked entries in the cached encoding of the
+ * TBSCertList of |crl|. The list of entries is the first SEQUENCE after
+ * thisUpdate and the optional nextUpdate.
+ */
+static int crl_revoked_offsets(const X509_CRL *crl, int *offsets, int num)
+{
+    const unsigned char *der = crl->crl.enc.enc, *p = der, *next, *end;
+    long len;
+    int tag, xclass, seen_time = 0, i = 0;
+
+    end = der + crl->crl.enc.len;
+    if (!der_get_header(&p, end, &len, &tag, &xclass)
+            || tag != V_ASN1_SEQUENCE)
+        return 0;
+    end = p + len;
+    for (;;) {
+        if (p >= end)
+            return num == 0;
+        next = p;
+        if (!der_get_header(&next, end, &len, &tag, &xclass))
+            return 0;
+        if (xclass == V_ASN1_UNIVERSAL) {
+            if (tag == V_ASN1_UTCTIME || tag == V_ASN1_GENERALIZEDTIME)
+                seen_time = 1;
+            else if (tag == V_ASN1_SEQUENCE && seen_time)
+                break;
+        }
+        p = next + len;
+    }
+
+    p = next;
+    end = next + len;
+    while (p < end) {
+        if (i == num)
+            return 0;
+        offsets[i++] = (int)(p - der);
+        if (!der_get_header(&p, end, &len, &tag, &xclass)
+                || tag != V_ASN1_SEQUENCE)
+            return 0;
+        p += len;
+    }
+    return i == num;
+}
+
+/*
+ * Build the index of a compact CRL from its stack of entries, which must still
+ * match the cached encoding.
+ */
+static struct x509_revoked_index_st *crl_compact_index_new(X509_CRL *crl)
+{
+    struct x509_revoked_index_st *idx;
+    const GENERAL_NAMES *last = NULL;
+    X509_REVOKED *rev;
+    int *offsets = NULL;
+    int i, issuer = -1, num = sk_X509_REVOKED_num(crl->crl.revoked);
+
+    if (num > 0 && (offsets = OPENSSL_malloc(num * sizeof(*offsets))) == NULL)
+        return NULL;
+    if (!crl_revoked_offsets(crl, offsets, num)) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_INVALID_ARGUMENT);
+        OPENSSL_free(offsets);
+        return NULL;
+    }
+    if ((idx = crl_revoked_index_alloc(num)) == NULL) {
+        OPENSSL_free(offsets);
+        return NULL;
+    }
+    idx->compact = 1;
+    for (i = 0; i < num; i++) {
+        rev = sk_X509_REVOKED_value(crl->crl.revoked, i);
+        /*
+         * crl_set_issuers() gave each entry the last certificate issuer seen,
+         * and added each new one to crl->issuers in order.
+         */
+        if (rev->issuer != last) {
+            last = rev->issuer;
+            issuer++;
+        }
+        idx->entries[i].key = serial_hash(&rev->serialNumber);
+        idx->entries[i].pos = offsets[i];
+        idx->entries[i].issuer = last == NULL ? -1 : issuer;
+    }
+    OPENSSL_free(offsets);
+    if (num > 1)
+        qsort(idx->entries, num, sizeof(*idx->entries),
+              revoked_index_entry_cmp);
+    return idx;
+}
+
+/* Decode an entry of a compact CRL from the cached encoding */
+static X509_REVOKED *crl_compact_decode(X509_CRL *crl,
+                                        const REVOKED_INDEX_ENTRY *e)
+{
+    const unsigned char *p = crl->crl.enc.enc + e->pos;
+    ASN1_ENUMERATED *reason;
+    X509_REVOKED *rev;
+
+    rev = d2i_X509_REVOKED(NULL, &p, crl->crl.enc.len - e->pos);
+    if (rev == NULL)
+        return NULL;
+    if (e->issuer >= 0)
+        rev->issuer = sk_GENERAL_NAMES_value(crl->issuers, e->issuer);
+    /* An undecodable reason already marked the CRL invalid when it was loaded */
+    reason = X509_REVOKED_get_ext_d2i(rev, NID_crl_reason, NULL, NULL);
+    if (reason != NULL) {
+        rev->reason = ASN1_ENUMERATED_get(reason);
+        ASN1_ENUMERATED_free(reason);
+    } else {
+        rev->reason = CRL_REASON_NONE;
+    }
+    return rev;
+}
+
+/*
+ * Look up |serial| in a CRL without a stack of entries, which may be compact.
+ * Candidate entries are decoded, and kept, under the write lock.
+ */
+static int crl_compact_lookup(X509_CRL *crl, X509_REVOKED **ret,
+                              const ASN1_INTEGER *serial,
+                              const X509_NAME *issuer)
+{
+    struct x509_revoked_index_st *idx;
+    REVOKED_INDEX_ENTRY *e;
+    uint64_t key = serial_hash(serial);
+    int i, r = 0, write = 0;
+
+ again:
+    if (!(write ? CRYPTO_THREAD_write_lock(crl->lock)
+                : CRYPTO_THREAD_read_lock(crl->lock)))
+        return 0;
+    idx = crl->revoked_index;
+    if (idx == NULL || !idx->compact)
+        goto end;
+
+    /* Need to look for matching name */
+    for (i = revoked_index_find(idx, key);
+         i < idx->num && idx->entries[i].key == key; i++) {
+        e = &idx->entries[i];
+        if (e->rev == NULL) {
+            if (!write) {
+                CRYPTO_THREAD_unlock(crl->lock);
+                write = 1;
+                goto again;
+            }
+            if ((e->rev = crl_compact_decode(crl, e)) == NULL)
+                break;
+        }
+        if (ASN1_INTEGER_cmp(&e->rev->serialNumber, serial) != 0
+                || !crl_revoked_issuer_match(crl, issuer, e->rev))
+            continue;
+        if (ret != NULL)
+            *ret = e->rev;
+        r = e->rev->reason == CRL_REASON_REMOVE_FROM_CRL ? 2 : 1;
+        break;
+    }
+ end:
+    CRYPTO_THREAD_unlock(crl->lock);
+    return r;
+}
+
 static int def_crl_lookup(X509_CRL *crl,
                           X509_REVOKED **ret, const ASN1_INTEGER *serial,
                           const X509_NAME *issuer)
 {
-    X509_REVOKED rtmp, *rev;
-    int idx, num;
+    const struct x509_revoked_index_st *idx;
+    X509_REVOKED *rev;
+    uint64_t key;
+    int i;
 
     if (crl->crl.revoked == NULL)
-        return 0;
+        return crl_compact_lookup(crl, ret, serial, issuer);
 
-    /*
-     * Sort revoked into serial number order if not already sorted. Do this
-     * under a lock to avoid race condition.
-     */
-    if (!sk_X509_REVOKED_is_sorted(crl->crl.revoked)) {
-        if (!CRYPTO_THREAD_write_lock(crl->lock))
-            return 0;
-        sk_X509_REVOKED_sort(crl->crl.revoked);
-        CRYPTO_THREAD_unlock(crl->lock);
-    }
-    rtmp.serialNumber = *serial;
-    idx = sk_X509_REVOKED_find(crl->crl.revoked, &rtmp);
-    if (idx < 0)
+    if ((idx = crl_get0_revoked_index(crl)) == NULL)
         return 0;
+
     /* Need to look for matching name */
-    for (num = sk_X509_REVOKED_num(crl->crl.revoked); idx < num; idx++) {
-        rev = sk_X509_REVOKED_value(crl->crl.revoked, idx);
-        if (ASN1_INTEGER_cmp(&rev->serialNumber, serial))
-            return 0;
+    key = serial_hash(serial);
+    for (i = revoked_index_find(idx, key);
+         i < idx->num && idx->entries[i].key == key; i++) {
+        rev = sk_X509_REVOKED_value(crl->crl.revoked, idx->entries[i].pos);
+        if (rev == NULL || ASN1_INTEGER_cmp(&rev->serialNumber, serial))
+            continue;
         if (crl_revoked_issuer_match(crl, issuer, rev)) {
             if (ret)
                 *ret = rev;
@@ -471,6 +803,105 @@ static int def_crl_lookup(X509_CRL *crl,
     return 0;
 }
 
+/* Drop the index after entries have been added to or reordered in |crl| */
+void ossl_x509_crl_revoked_changed(X509_CRL *crl)
+{
+    if (!CRYPTO_THREAD_write_lock(crl->lock))
+        return;
+    crl_revoked_index_free(crl->revoked_index);
+    crl->revoked_index = NULL;
+    CRYPTO_THREAD_unlock(crl->lock);
+}
+
+static int crl_is_compact(X509_CRL *crl)
+{
+    int ret;
+
+    if (!CRYPTO_THREAD_read_lock(crl->lock))
+        return 0;
+    ret = crl->revoked_index != NULL && crl->revoked_index->compact;
+    CRYPTO_THREAD_unlock(crl->lock);
+    return ret;
+}
+
+int X509_CRL_compact(X509_CRL *crl)
+{
+    struct x509_revoked_index_st *idx;
+    int ok = 0;
+
+    if (!CRYPTO_THREAD_write_lock(crl->lock))
+        return 0;
+    if ((crl->revoked_index != NULL && crl->revoked_index->compact)
+            || sk_X509_REVOKED_num(crl->crl.revoked) <= 0) {
+        ok = 1;
+        goto end;
+    }
+    /*
+     * The entries are decoded again from the encoding, which must be current,
+     * and must have been decoded successfully to begin with.
+     */
+    if (crl->crl.enc.enc == NULL || crl->crl.enc.modified
+            || crl->crl.enc.len > INT_MAX
+            || (crl->flags & EXFLAG_INVALID) != 0) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_INVALID_ARGUMENT);
+        goto end;
+    }
+    if ((idx = crl_compact_index_new(crl)) == NULL)
+        goto end;
+    crl_revoked_index_free(crl->revoked_index);
+    crl->revoked_index = idx;
+    sk_X509_REVOKED_pop_free(crl->crl.revoked, X509_REVOKED_free);
+    crl->crl.revoked = NULL;
+    ok = 1;
+ end:
+    CRYPTO_THREAD_unlock(crl->lock);
+    return ok;
+}
+
+/*
+ * Turn a compact CRL back into one with a stack of entries, before the stack
+ * is handed out or the CRL is modified. Entries which have already been
+ * looked up are moved into the stack, so pointers to them remain valid.
+ */
+int ossl_x509_crl_expand(X509_CRL *crl)
+{
+    struct x509_revoked_index_st *idx;
+    STACK_OF(X509_REVOKED) *revoked = NULL;
+    int i, ok = 0;
+
+    if (!CRYPTO_THREAD_write_lock(crl->lock))
+        return 0;
+    idx = crl->revoked_index;
+    if (idx == NULL || !idx->compact) {
+        ok = 1;
+        goto end;
+    }
+    if ((revoked = sk_X509_REVOKED_new_reserve(X509_REVOKED_cmp,
+                                               idx->num)) == NULL)
+        goto end;
+    for (i = 0; i < idx->num; i++) {
+        REVOKED_INDEX_ENTRY *e = &idx->entries[i];
+
+        if (e->rev == NULL && (e->rev = crl_compact_decode(crl, e)) == NULL)
+            goto end;
+    }
+    /* Restore the original order of the entries */
+    qsort(idx->entries, idx->num, sizeof(*idx->entries),
+          revoked_index_pos_cmp);
+    for (i = 0; i < idx->num; i++)
+        (void)sk_X509_REVOKED_push(revoked, idx->entries[i].rev);
+    crl->crl.revoked = revoked;
+    revoked = NULL;
+    OPENSSL_free(idx->entries);
+    OPENSSL_free(idx);
+    crl->revoked_index = NULL;
+    ok = 1;
+ end:
+    CRYPTO_THREAD_unlock(crl->lock);
+    sk_X509_REVOKED_free(revoked);
+    return ok;
+}
+
 void X509_CRL_set_default_method(const X509_CRL_METHOD *meth)
 {
     if (meth == NULL)
@@ -216,6 +216,7 @@ struct evp_mac_st {
 
     OSSL_FUNC_mac_newctx_fn *newctx;
     OSSL_FUNC_mac_dupctx_fn *dupctx;
+    OSSL_FUNC_mac_copyctx_fn *copyctx;
     OSSL_FUNC_mac_freectx_fn *freectx;
     OSSL_FUNC_mac_init_fn *init;
     OSSL_FUNC_mac_update_fn *update;
@@ -284,8 +285,10 @@ struct evp_md_st {
     OSSL_FUNC_digest_final_fn *dfinal;
     OSSL_FUNC_digest_squeeze_fn *dsqueeze;
     OSSL_FUNC_digest_digest_fn *digest;
+    OSSL_FUNC_digest_digest_batch_fn *digest_batch;
     OSSL_FUNC_digest_freectx_fn *freectx;
     OSSL_FUNC_digest_dupctx_fn *dupctx;
+    OSSL_FUNC_digest_copyctx_fn *copyctx;
     OSSL_FUNC_digest_get_params_fn *get_params;
     OSSL_FUNC_digest_set_ctx_params_fn *set_ctx_params;
     OSSL_FUNC_digest_get_ctx_params_fn *get_ctx_params;
@@ -342,6 +345,7 @@ struct evp_cipher_st {
     OSSL_FUNC_cipher_cipher_fn *ccipher;
     OSSL_FUNC_cipher_freectx_fn *freectx;
     OSSL_FUNC_cipher_dupctx_fn *dupctx;
+    OSSL_FUNC_cipher_copyctx_fn *copyctx;
     OSSL_FUNC_cipher_get_params_fn *get_params;
     OSSL_FUNC_cipher_get_ctx_params_fn *get_ctx_params;
     OSSL_FUNC_cipher_set_ctx_params_fn *set_ctx_params;
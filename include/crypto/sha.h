@@ -19,5 +19,10 @@ int sha512_224_init(SHA512_CTX *);
 int sha512_256_init(SHA512_CTX *);
 int ossl_sha1_ctrl(SHA_CTX *ctx, int cmd, int mslen, void *ms);
 unsigned char *ossl_sha1(const unsigned char *d, size_t n, unsigned char *md);
+int ossl_sha1_batch(size_t n, const unsigned char *const in[],
+                    const size_t inl[], unsigned char *const out[]);
+int ossl_sha256_batch(size_t n, const unsigned char *const in[],
+                      const size_t inl[], unsigned char *const out[],
+                      size_t mdlen);
 
 #endif
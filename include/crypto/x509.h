@@ -116,6 +116,8 @@ struct X509_crl_st {
     ASN1_INTEGER *crl_number;
     ASN1_INTEGER *base_crl_number;
     STACK_OF(GENERAL_NAMES) *issuers;
+    /* Revoked entries indexed by serial number, built on first lookup */
+    struct x509_revoked_index_st *revoked_index;
     /* hash of CRL */
     unsigned char sha1_hash[SHA_DIGEST_LENGTH];
     /* alternative method to handle this CRL */
@@ -191,6 +193,7 @@ struct x509_st {
     STACK_OF(DIST_POINT) *crldp;
     STACK_OF(GENERAL_NAME) *altname;
     NAME_CONSTRAINTS *nc;
+    struct nc_matcher_st *nc_matcher;
 # ifndef OPENSSL_NO_RFC3779
     STACK_OF(IPAddressFamily) *rfc3779_addr;
     struct ASIdentifiers_st *rfc3779_asid;
@@ -199,6 +202,8 @@ struct x509_st {
     X509_CERT_AUX *aux;
     CRYPTO_RWLOCK *lock;
     volatile int ex_cached;
+    /* Set once sha1_hash is filled in or EXFLAG_NO_FINGERPRINT is set */
+    volatile int sha1_cached;
 
     /* Set on live certificates for authentication purposes */
     ASN1_OCTET_STRING *distinguishing_id;
@@ -278,6 +283,8 @@ struct x509_store_ctx_st {      /* X509_STORE_CTX */
     SSL_DANE *dane;
     /* signed via bare TA public key, rather than CA certificate */
     int bare_ta_signed;
+    /* Earliest nextUpdate of the CRLs used so far, 0 if none (for caching) */
+    time_t crl_expires;
     /* Raw Public Key */
     EVP_PKEY *rpk;
 
@@ -314,11 +321,17 @@ int ossl_a2i_ipadd(unsigned char *ipout, const char *ipasc);
 int ossl_x509_set1_time(int *modified, ASN1_TIME **ptm, const ASN1_TIME *tm);
 int ossl_x509_print_ex_brief(BIO *bio, X509 *cert, unsigned long neg_cflags);
 int ossl_x509v3_cache_extensions(X509 *x);
+int ossl_x509_cache_fingerprint(X509 *x);
+int ossl_x509_name_constraints_check(X509 *x, X509 *ca);
+int ossl_x509_name_constraints_check_CN(X509 *x, X509 *ca);
+void ossl_nc_matcher_free(struct nc_matcher_st *m);
 int ossl_x509_init_sig_info(X509 *x);
 
 int ossl_x509_set0_libctx(X509 *x, OSSL_LIB_CTX *libctx, const char *propq);
 int ossl_x509_crl_set0_libctx(X509_CRL *x, OSSL_LIB_CTX *libctx,
                               const char *propq);
+void ossl_x509_crl_revoked_changed(X509_CRL *crl);
+int ossl_x509_crl_expand(X509_CRL *crl);
 int ossl_x509_req_set0_libctx(X509_REQ *x, OSSL_LIB_CTX *libctx,
                               const char *propq);
 int ossl_asn1_item_digest_ex(const ASN1_ITEM *it, const EVP_MD *type,
@@ -44,6 +44,7 @@ int bread_conv(BIO *bio, char *data, size_t datal, size_t *read);
 # define BIO_CTRL_SET_KTLS_TX_SEND_CTRL_MSG     74
 # define BIO_CTRL_CLEAR_KTLS_TX_CTRL_MSG        75
 # define BIO_CTRL_SET_KTLS_TX_ZEROCOPY_SENDFILE 90
+# define BIO_CTRL_SET_KTLS_RX_EXPECT_NO_PAD     97
 
 /*
  * This is used with socket BIOs:
@@ -80,6 +81,8 @@ int bread_conv(BIO *bio, char *data, size_t datal, size_t *read);
      BIO_ctrl(b, BIO_CTRL_CLEAR_KTLS_TX_CTRL_MSG, 0, NULL)
 # define BIO_set_ktls_tx_zerocopy_sendfile(b) \
      BIO_ctrl(b, BIO_CTRL_SET_KTLS_TX_ZEROCOPY_SENDFILE, 0, NULL)
+# define BIO_set_ktls_rx_expect_no_pad(b) \
+     BIO_ctrl(b, BIO_CTRL_SET_KTLS_RX_EXPECT_NO_PAD, 0, NULL)
 
 /* Functions to allow the core to offer the CORE_BIO type to providers */
 OSSL_CORE_BIO *ossl_core_bio_new_from_bio(BIO *bio);
@@ -86,6 +86,12 @@ static ossl_inline int ktls_enable_tx_zerocopy_sendfile(int fd)
     return 0;
 }
 
+/* Not supported on FreeBSD */
+static ossl_inline int ktls_enable_rx_expect_no_pad(int fd)
+{
+    return 0;
+}
+
 /*
  * Send a TLS record using the tls_en provided in ktls_start and use
  * record_type instead of the default SSL3_RT_APPLICATION_DATA.
@@ -318,6 +324,24 @@ static ossl_inline int ktls_enable_tx_zerocopy_sendfile(int fd)
 #endif
 }
 
+/*
+ * The TLS_RX_EXPECT_NO_PAD socket option tells the kernel that the peer is not
+ * expected to pad TLS 1.3 records. This allows it to decrypt records straight
+ * into the buffer passed to recvmsg. If a padded record does arrive the kernel
+ * decrypts it again, so this only affects performance and never correctness.
+ */
+static ossl_inline int ktls_enable_rx_expect_no_pad(int fd)
+{
+#ifdef TLS_RX_EXPECT_NO_PAD
+    int enable = 1;
+
+    return setsockopt(fd, SOL_TLS, TLS_RX_EXPECT_NO_PAD,
+                      &enable, sizeof(enable)) ? 0 : 1;
+#else
+    return 0;
+#endif
+}
+
 /*
  * Send a TLS record using the crypto_info provided in ktls_start and use
  * record_type instead of the default SSL3_RT_APPLICATION_DATA.
@@ -37,6 +37,15 @@ void ossl_ackm_set_ack_deadline_callback(OSSL_ACKM *ackm,
                                                     void *arg),
                                          void *arg);
 
+/*
+ * Change the congestion controller the ACKM reports events to. This must only
+ * be done before any packets have been sent; the caller retains ownership of
+ * both the old and new congestion controller instances.
+ */
+void ossl_ackm_set_cc(OSSL_ACKM *ackm,
+                      const OSSL_CC_METHOD *cc_method,
+                      OSSL_CC_DATA *cc_data);
+
 /*
  * Configures the RX-side maximum ACK delay. This is the maximum amount of time
  * the peer is allowed to delay sending an ACK frame after receiving an
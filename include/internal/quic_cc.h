@@ -21,6 +21,13 @@ typedef struct ossl_cc_ack_info_st {
 
     /* The size in bytes of the packet being acknowledged. */
     size_t      tx_size;
+
+    /*
+     * The current smoothed RTT estimate (RFC 9002 s. 5.3), used to derive the
+     * pacing rate. Zero if no RTT sample has been taken yet, in which case
+     * transmission is not paced.
+     */
+    OSSL_TIME   smoothed_rtt;
 } OSSL_CC_ACK_INFO;
 
 typedef struct ossl_cc_loss_info_st {
@@ -136,7 +143,8 @@ struct ossl_cc_method_st {
      * Returns the amount of additional data (above and beyond the data
      * currently in flight) which can be sent in bytes. Returns 0 if no more
      * data can be sent at this time. The return value of this method
-     * can vary as time passes.
+     * can vary as time passes, for example because a pacer releases more
+     * of the congestion window.
      */
     uint64_t (*get_tx_allowance)(OSSL_CC_DATA *ccdata);
 
@@ -210,8 +218,34 @@ struct ossl_cc_method_st {
                   const OSSL_CC_ECN_INFO *info);
 };
 
+/*
+ * Diagnostic output locations bound with the bind_diagnostic() method, shared
+ * by the congestion controller implementations.
+ */
+typedef struct ossl_cc_diag_st {
+    size_t      *p_max_dgram_payload_len;
+    uint64_t    *p_cur_cwnd_size;
+    uint64_t    *p_min_cwnd_size;
+    uint64_t    *p_cur_bytes_in_flight;
+    uint32_t    *p_cur_state;
+} OSSL_CC_DIAG;
+
+/*
+ * Parses the parameters common to the set_input_params() methods. On success
+ * |*max_dgram_size| is the new maximum datagram payload size, or 0 if none
+ * was given.
+ */
+int ossl_cc_get_input_params(const OSSL_PARAM *params, size_t *max_dgram_size);
+int ossl_cc_diag_bind(OSSL_CC_DIAG *diag, OSSL_PARAM *params);
+void ossl_cc_diag_unbind(OSSL_CC_DIAG *diag, OSSL_PARAM *params);
+void ossl_cc_diag_update(const OSSL_CC_DIAG *diag, size_t max_dgram_size,
+                         uint64_t cwnd, uint64_t min_cwnd,
+                         uint64_t bytes_in_flight, uint32_t state);
+
 extern const OSSL_CC_METHOD ossl_cc_dummy_method;
 extern const OSSL_CC_METHOD ossl_cc_newreno_method;
+extern const OSSL_CC_METHOD ossl_cc_cubic_method;
+extern const OSSL_CC_METHOD ossl_cc_bbr_method;
 
 # endif
 
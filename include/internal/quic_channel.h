@@ -125,6 +125,9 @@ typedef struct quic_channel_args_st {
 
     /* Title to use for the qlog session, or NULL. */
     const char      *qlog_title;
+
+    /* Congestion control algorithm (SSL_VALUE_QUIC_CC_ALGORITHM_*). */
+    uint32_t        cc_algorithm;
 } QUIC_CHANNEL_ARGS;
 
 /* Represents the cause for a connection's termination. */
@@ -445,6 +448,15 @@ uint64_t ossl_quic_channel_get_max_idle_timeout_peer_request(const QUIC_CHANNEL
 /* Get the idle timeout actually negotiated. */
 uint64_t ossl_quic_channel_get_max_idle_timeout_actual(const QUIC_CHANNEL *ch);
 
+/*
+ * Changes the congestion control algorithm (SSL_VALUE_QUIC_CC_ALGORITHM_*).
+ * This can only be done before the channel is started. Returns 1 on success
+ * and 0 on failure.
+ */
+int ossl_quic_channel_set_cc_algorithm(QUIC_CHANNEL *ch, uint32_t alg);
+/* Get the congestion control algorithm in use. */
+uint32_t ossl_quic_channel_get_cc_algorithm(const QUIC_CHANNEL *ch);
+
 # endif
 
 #endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_QUIC_PACER_H
+# define OSSL_QUIC_PACER_H
+
+# include <openssl/ssl.h>
+# include "internal/time.h"
+
+# ifndef OPENSSL_NO_QUIC
+
+/*
+ * QUIC Pacer
+ * ==========
+ *
+ * A token bucket used by congestion controllers to spread the transmission of
+ * a congestion window over a round trip (RFC 9002 s. 7.7), rather than
+ * releasing it in a single burst. Tokens (bytes) accrue at the pacing rate up
+ * to a configured burst size. A datagram may be sent once at least one
+ * datagram's worth of tokens is available.
+ *
+ * A congestion controller embeds this structure and combines its allowance
+ * and deadline with those of the congestion window in its get_tx_allowance()
+ * and get_wakeup_deadline() methods. The QUIC TX packetiser therefore only
+ * sees a reduced allowance, and the channel tick deadline (and hence
+ * SSL_get_event_timeout()) reflects the next time the pacer will release a
+ * datagram.
+ */
+typedef struct ossl_quic_pacer_st {
+    uint64_t    rate;           /* Pacing rate in bytes/s, 0 if not pacing */
+    uint64_t    burst;          /* Maximum number of tokens */
+    uint64_t    tokens;         /* Currently available tokens */
+    size_t      quantum;        /* Tokens needed to send one datagram */
+    OSSL_TIME   last_update;    /* Time tokens were last credited */
+} OSSL_QUIC_PACER;
+
+/*
+ * RFC 9002 s. 7.7 suggests pacing at N * cwnd / smoothed_rtt with N = 1.25 so
+ * that pacing does not itself prevent the congestion window being filled.
+ */
+# define OSSL_QUIC_PACER_GAIN_NUM   5
+# define OSSL_QUIC_PACER_GAIN_DEN   4
+
+/* Initialises a pacer which does not (yet) limit transmission. */
+void ossl_quic_pacer_init(OSSL_QUIC_PACER *pacer);
+
+/*
+ * Returns the pacing rate in bytes/s for a given congestion window and RTT
+ * estimate, or 0 if smoothed_rtt is zero (no estimate available).
+ */
+uint64_t ossl_quic_pacer_rate_from_cwnd(uint64_t cwnd, OSSL_TIME smoothed_rtt);
+
+/*
+ * Updates the pacing rate. max_dgram_size is the size of a datagram, which is
+ * also the minimum burst; max_burst caps the burst size, which is otherwise
+ * the number of bytes released per millisecond. A rate of 0 disables pacing.
+ */
+void ossl_quic_pacer_set_rate(OSSL_QUIC_PACER *pacer, uint64_t rate,
+                              size_t max_dgram_size, uint64_t max_burst,
+                              OSSL_TIME now);
+
+/*
+ * Returns the number of bytes the pacer allows to be sent now. Returns
+ * UINT64_MAX if pacing is disabled and 0 if less than one datagram's worth
+ * of tokens is available.
+ */
+uint64_t ossl_quic_pacer_get_allowance(OSSL_QUIC_PACER *pacer, OSSL_TIME now);
+
+/*
+ * Returns the time at which one datagram's worth of tokens will be available.
+ * This is ossl_time_zero() if a datagram can be sent immediately.
+ */
+OSSL_TIME ossl_quic_pacer_get_deadline(OSSL_QUIC_PACER *pacer, OSSL_TIME now);
+
+/* Consumes tokens for num_bytes of transmitted data. */
+void ossl_quic_pacer_on_data_sent(OSSL_QUIC_PACER *pacer, uint64_t num_bytes,
+                                  OSSL_TIME now);
+
+# endif
+
+#endif
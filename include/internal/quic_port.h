@@ -28,8 +28,8 @@
  * QUIC_PORT.
  *
  * A QUIC port is responsible for managing a set of channels which all use the
- * same UDP socket, and (in future) for automatically creating new channels when
- * incoming connections are received.
+ * same UDP socket, and for automatically creating new channels when incoming
+ * connections are received, if it has been configured to allow them.
  *
  * In order to retain compatibility with QUIC_TSERVER, it also supports a point
  * of legacy compatibility where a caller can create an incoming (server role)
@@ -76,6 +76,31 @@ QUIC_CHANNEL *ossl_quic_port_create_outgoing(QUIC_PORT *port, SSL *tls);
  */
 QUIC_CHANNEL *ossl_quic_port_create_incoming(QUIC_PORT *port, SSL *tls);
 
+/*
+ * Allows or disallows the automatic creation of incoming (server role) channels
+ * when a new connection attempt is received. Incoming channels are placed on
+ * the port's accept queue, from which they can be popped by the caller; until
+ * then they are owned by the port, which frees them along with their handshake
+ * layer objects when it is freed.
+ */
+void ossl_quic_port_set_allow_incoming(QUIC_PORT *port, int allow);
+
+/*
+ * Pops the oldest incoming channel off the accept queue, or returns NULL if
+ * the queue is empty. Ownership of the channel and of its handshake layer
+ * object (see ossl_quic_channel_get0_ssl) passes to the caller.
+ */
+QUIC_CHANNEL *ossl_quic_port_pop_incoming(QUIC_PORT *port);
+
+/*
+ * Frees any channels on the accept queue which terminated (for example through
+ * idle timeout or a failed handshake) before the application accepted them.
+ */
+void ossl_quic_port_prune_incoming(QUIC_PORT *port);
+
+/* Returns the number of channels waiting on the accept queue. */
+size_t ossl_quic_port_get_num_incoming_channels(const QUIC_PORT *port);
+
 /*
  * Queries and Accessors
  * =====================
@@ -30,6 +30,8 @@ __owur int ossl_quic_read(SSL *s, void *buf, size_t len, size_t *readbytes);
 __owur int ossl_quic_peek(SSL *s, void *buf, size_t len, size_t *readbytes);
 __owur int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
                                  uint64_t flags, size_t *written);
+__owur int ossl_quic_writev(SSL *s, const SSL_IOVEC *iov, size_t iovcnt,
+                            size_t len, uint64_t flags, size_t *written);
 __owur int ossl_quic_write(SSL *s, const void *buf, size_t len, size_t *written);
 __owur long ossl_quic_ctrl(SSL *s, int cmd, long larg, void *parg);
 __owur long ossl_quic_ctx_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg);
@@ -45,6 +47,7 @@ int ossl_quic_renegotiate_check(SSL *ssl, int initok);
 
 typedef struct quic_conn_st QUIC_CONNECTION;
 typedef struct quic_xso_st QUIC_XSO;
+typedef struct quic_listener_st QUIC_LISTENER;
 
 int ossl_quic_do_handshake(SSL *s);
 void ossl_quic_set_connect_state(SSL *s);
@@ -85,6 +88,11 @@ __owur int ossl_quic_set_incoming_stream_policy(SSL *s, int policy,
                                                 uint64_t aec);
 __owur SSL *ossl_quic_accept_stream(SSL *s, uint64_t flags);
 __owur size_t ossl_quic_get_accept_stream_queue_len(SSL *s);
+__owur SSL *ossl_quic_new_listener(SSL_CTX *ctx, uint64_t flags);
+__owur int ossl_quic_listen(SSL *ssl);
+__owur SSL *ossl_quic_accept_connection(SSL *ssl, uint64_t flags);
+__owur size_t ossl_quic_get_accept_connection_queue_len(SSL *ssl);
+__owur SSL *ossl_quic_get0_listener(SSL *s);
 __owur int ossl_quic_get_value_uint(SSL *s, uint32_t class_, uint32_t id,
                                     uint64_t *value);
 __owur int ossl_quic_set_value_uint(SSL *s, uint32_t class_, uint32_t id,
@@ -146,6 +154,23 @@ int ossl_quic_set_diag_title(SSL_CTX *ctx, const char *title);
 int ossl_quic_conn_poll_events(SSL *ssl, uint64_t events, int do_tick,
                                uint64_t *revents);
 
+/*
+ * Returns the reactor which handles events for a QUIC SSL object. Objects
+ * returning the same reactor have their events handled together.
+ */
+QUIC_REACTOR *ossl_quic_get0_reactor(SSL *ssl);
+
+/*
+ * Retrieves what is needed to wait for new events on a QUIC SSL object: the
+ * network poll descriptors of the reactor it uses, whether network I/O is
+ * currently desired in each direction, and the (real time) deadline by which
+ * its events must next be handled.
+ */
+int ossl_quic_conn_get_poll_info(SSL *ssl,
+                                 BIO_POLL_DESCRIPTOR *rdesc, int *want_read,
+                                 BIO_POLL_DESCRIPTOR *wdesc, int *want_write,
+                                 OSSL_TIME *deadline);
+
 # endif
 
 #endif
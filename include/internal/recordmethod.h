@@ -61,12 +61,17 @@ typedef struct ossl_record_layer_st OSSL_RECORD_LAYER;
  * Template for creating a record. A record consists of the |type| of data it
  * will contain (e.g. alert, handshake, application data, etc) along with a
  * buffer of payload data in |buf| of length |buflen|.
+ *
+ * If |iov| is not NULL then the payload is not contiguous. It starts at |buf|,
+ * which points into the buffer described by |iov[0]|, and continues in the
+ * following |iov| entries until |buflen| bytes have been gathered.
  */
 struct ossl_record_template_st {
     unsigned char type;
     unsigned int version;
     const unsigned char *buf;
     size_t buflen;
+    const SSL_IOVEC *iov;
 };
 
 typedef struct ossl_record_template_st OSSL_RECORD_TEMPLATE;
@@ -69,6 +69,13 @@ uint64_t ossl_time2ticks(OSSL_TIME t)
     return t.t;
 }
 
+/* Convert time to milliseconds, rounding any fraction of a millisecond up */
+static ossl_unused ossl_inline
+uint64_t ossl_time2ms_roundup(OSSL_TIME t)
+{
+    return t.t / OSSL_TIME_MS + (t.t % OSSL_TIME_MS != 0);
+}
+
 /* Get current time */
 OSSL_TIME ossl_time_now(void);
 
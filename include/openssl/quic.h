@@ -30,6 +30,12 @@ __owur const SSL_METHOD *OSSL_QUIC_client_method(void);
  */
 __owur const SSL_METHOD *OSSL_QUIC_client_thread_method(void);
 
+/*
+ * Method used for QUIC server operation. SSL objects for this method are
+ * created using SSL_new_listener().
+ */
+__owur const SSL_METHOD *OSSL_QUIC_server_method(void);
+
 /*
  * QUIC transport error codes (RFC 9000 s. 20.1)
  */
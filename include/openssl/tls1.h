@@ -357,6 +357,16 @@ __owur int SSL_check_chain(SSL *s, X509 *x, EVP_PKEY *pk, STACK_OF(X509) *chain)
 # define SSL_CTX_get_tlsext_status_type(ssl) \
         SSL_CTX_ctrl(ssl,SSL_CTRL_GET_TLSEXT_STATUS_REQ_TYPE,0,NULL)
 
+# ifndef OPENSSL_NO_OCSP
+#  define SSL_OCSP_STAPLING_BACKGROUND 0x0001U
+
+__owur int SSL_CTX_enable_ocsp_stapling(SSL_CTX *ctx, uint64_t flags);
+int SSL_CTX_refresh_ocsp_stapling(SSL_CTX *ctx);
+__owur int SSL_CTX_add1_ocsp_stapling_response(SSL_CTX *ctx, X509 *cert,
+                                               const unsigned char *resp,
+                                               size_t resp_len);
+# endif
+
 # ifndef OPENSSL_NO_DEPRECATED_3_0
 #  define SSL_CTX_set_tlsext_ticket_key_cb(ssl, cb) \
         SSL_CTX_callback_ctrl(ssl,SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB,\
@@ -76,6 +76,15 @@ int ossl_prov_digest_load_from_params(PROV_DIGEST *pd,
                                       const OSSL_PARAM params[],
                                       OSSL_LIB_CTX *ctx);
 
+/*
+ * As ossl_prov_digest_load_from_params(), but for callers that have already
+ * located the "digest", "properties" and "engine" parameters.  Any of them
+ * may be NULL.
+ */
+int ossl_prov_digest_load(PROV_DIGEST *pd, const OSSL_PARAM *digest,
+                          const OSSL_PARAM *propq, const OSSL_PARAM *engine,
+                          OSSL_LIB_CTX *ctx);
+
 /* Reset the PROV_DIGEST fields and free any allocated digest reference */
 void ossl_prov_digest_reset(PROV_DIGEST *pd);
 
@@ -47,17 +47,14 @@ int ossl_prov_cipher_copy(PROV_CIPHER *dst, const PROV_CIPHER *src)
     return 1;
 }
 
-static int load_common(const OSSL_PARAM params[], const char **propquery,
-                       ENGINE **engine)
+static int load_common(const OSSL_PARAM *prop, const OSSL_PARAM *eng,
+                       const char **propquery, ENGINE **engine)
 {
-    const OSSL_PARAM *p;
-
     *propquery = NULL;
-    p = OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_PROPERTIES);
-    if (p != NULL) {
-        if (p->data_type != OSSL_PARAM_UTF8_STRING)
+    if (prop != NULL) {
+        if (prop->data_type != OSSL_PARAM_UTF8_STRING)
             return 0;
-        *propquery = p->data;
+        *propquery = prop->data;
     }
 
 #if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_ENGINE)
@@ -66,12 +63,11 @@ static int load_common(const OSSL_PARAM params[], const char **propquery,
     *engine = NULL;
     /* Inside the FIPS module, we don't support legacy ciphers */
 #if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_ENGINE)
-    p = OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_ENGINE);
-    if (p != NULL) {
-        if (p->data_type != OSSL_PARAM_UTF8_STRING)
+    if (eng != NULL) {
+        if (eng->data_type != OSSL_PARAM_UTF8_STRING)
             return 0;
         /* Get a structural reference */
-        *engine = ENGINE_by_id(p->data);
+        *engine = ENGINE_by_id(eng->data);
         if (*engine == NULL)
             return 0;
         /* Get a functional reference */
@@ -87,6 +83,15 @@ static int load_common(const OSSL_PARAM params[], const char **propquery,
     return 1;
 }
 
+static const OSSL_PARAM *locate_engine(const OSSL_PARAM params[])
+{
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_ENGINE)
+    return OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_ENGINE);
+#else
+    return NULL;
+#endif
+}
+
 int ossl_prov_cipher_load_from_params(PROV_CIPHER *pc,
                                       const OSSL_PARAM params[],
                                       OSSL_LIB_CTX *ctx)
@@ -97,7 +102,8 @@ int ossl_prov_cipher_load_from_params(PROV_CIPHER *pc,
     if (params == NULL)
         return 1;
 
-    if (!load_common(params, &propquery, &pc->engine))
+    if (!load_common(OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_PROPERTIES),
+                     locate_engine(params), &propquery, &pc->engine))
         return 0;
 
     p = OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_CIPHER);
@@ -172,32 +178,27 @@ const EVP_MD *ossl_prov_digest_fetch(PROV_DIGEST *pd, OSSL_LIB_CTX *libctx,
     return pd->md;
 }
 
-int ossl_prov_digest_load_from_params(PROV_DIGEST *pd,
-                                      const OSSL_PARAM params[],
-                                      OSSL_LIB_CTX *ctx)
+int ossl_prov_digest_load(PROV_DIGEST *pd, const OSSL_PARAM *digest,
+                          const OSSL_PARAM *propq, const OSSL_PARAM *engine,
+                          OSSL_LIB_CTX *ctx)
 {
-    const OSSL_PARAM *p;
     const char *propquery;
 
-    if (params == NULL)
-        return 1;
-
-    if (!load_common(params, &propquery, &pd->engine))
+    if (!load_common(propq, engine, &propquery, &pd->engine))
         return 0;
 
-    p = OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_DIGEST);
-    if (p == NULL)
+    if (digest == NULL)
         return 1;
-    if (p->data_type != OSSL_PARAM_UTF8_STRING)
+    if (digest->data_type != OSSL_PARAM_UTF8_STRING)
         return 0;
 
     ERR_set_mark();
-    ossl_prov_digest_fetch(pd, ctx, p->data, propquery);
+    ossl_prov_digest_fetch(pd, ctx, digest->data, propquery);
 #ifndef FIPS_MODULE /* Inside the FIPS module, we don't support legacy digests */
     if (pd->md == NULL) {
         const EVP_MD *md;
 
-        md = EVP_get_digestbyname(p->data);
+        md = EVP_get_digestbyname(digest->data);
         /* Do not use global EVP_MDs */
         if (md != NULL && md->origin != EVP_ORIG_GLOBAL)
             pd->md = md;
@@ -210,6 +211,20 @@ int ossl_prov_digest_load_from_params(PROV_DIGEST *pd,
     return pd->md != NULL;
 }
 
+int ossl_prov_digest_load_from_params(PROV_DIGEST *pd,
+                                      const OSSL_PARAM params[],
+                                      OSSL_LIB_CTX *ctx)
+{
+    const OSSL_PARAM *digest, *propq;
+
+    if (params == NULL)
+        return 1;
+
+    digest = OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_DIGEST);
+    propq = OSSL_PARAM_locate_const(params, OSSL_ALG_PARAM_PROPERTIES);
+    return ossl_prov_digest_load(pd, digest, propq, locate_engine(params), ctx);
+}
+
 const EVP_MD *ossl_prov_digest_md(const PROV_DIGEST *pd)
 {
     return pd->md;
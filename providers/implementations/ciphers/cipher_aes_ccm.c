@@ -53,6 +53,22 @@ static void *aes_ccm_dupctx(void *provctx)
     return dupctx;
 }
 
+static OSSL_FUNC_cipher_copyctx_fn aes_ccm_copyctx;
+static int aes_ccm_copyctx(void *vdst, void *vsrc)
+{
+    PROV_AES_CCM_CTX *dctx = vdst;
+    PROV_AES_CCM_CTX *sctx = vsrc;
+
+    if (!ossl_prov_is_running() || dctx == NULL || sctx == NULL)
+        return 0;
+    if (dctx == sctx)
+        return 1;
+
+    memcpy(dctx, sctx, sizeof(*dctx));
+    dctx->base.ccm_ctx.key = &dctx->ccm.ks.ks;
+    return 1;
+}
+
 static OSSL_FUNC_cipher_freectx_fn aes_ccm_freectx;
 static void aes_ccm_freectx(void *vctx)
 {
@@ -49,6 +49,28 @@ static void *aes_gcm_dupctx(void *provctx)
     return dctx;
 }
 
+/*
+ * Restore |vsrc| into the existing context |vdst|.  The context is flat, so
+ * this is a plain copy with the key schedule pointer redirected; the key
+ * schedule itself is not recomputed.
+ */
+static OSSL_FUNC_cipher_copyctx_fn aes_gcm_copyctx;
+static int aes_gcm_copyctx(void *vdst, void *vsrc)
+{
+    PROV_AES_GCM_CTX *dctx = vdst;
+    PROV_AES_GCM_CTX *sctx = vsrc;
+
+    if (!ossl_prov_is_running() || dctx == NULL || sctx == NULL)
+        return 0;
+    if (dctx == sctx)
+        return 1;
+
+    memcpy(dctx, sctx, sizeof(*dctx));
+    if (dctx->base.gcm.key != NULL)
+        dctx->base.gcm.key = &dctx->ks.ks;
+    return 1;
+}
+
 static OSSL_FUNC_cipher_freectx_fn aes_gcm_freectx;
 static void aes_gcm_freectx(void *vctx)
 {
@@ -21,6 +21,9 @@
 #include "prov/ciphercommon_aead.h"
 #include "prov/provider_ctx.h"
 #include "cipher_aes_gcm_siv.h"
+#include "internal/param_names.h"
+
+#include "prov/cipher_aes_gcm_siv.inc"
 
 static int ossl_aes_gcm_siv_set_ctx_params(void *vctx, const OSSL_PARAM params[]);
 
@@ -183,8 +186,11 @@ static int ossl_aes_gcm_siv_get_ctx_params(void *vctx, OSSL_PARAM params[])
 {
     PROV_AES_GCM_SIV_CTX *ctx = (PROV_AES_GCM_SIV_CTX *)vctx;
     OSSL_PARAM *p;
+    struct aes_gcm_siv_get_ctx_params_st plist;
+
+    aes_gcm_siv_get_ctx_params_decoder(params, &plist);
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = plist.tag;
     if (p != NULL && p->data_type == OSSL_PARAM_OCTET_STRING) {
         if (!ctx->enc || !ctx->generated_tag
                 || p->data_size != sizeof(ctx->tag)
@@ -193,12 +199,12 @@ static int ossl_aes_gcm_siv_get_ctx_params(void *vctx, OSSL_PARAM params[])
             return 0;
         }
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAGLEN);
+    p = plist.taglen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, sizeof(ctx->tag))) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = plist.keylen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->key_len)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
@@ -223,12 +229,15 @@ static int ossl_aes_gcm_siv_set_ctx_params(void *vctx, const OSSL_PARAM params[]
 {
     PROV_AES_GCM_SIV_CTX *ctx = (PROV_AES_GCM_SIV_CTX *)vctx;
     const OSSL_PARAM *p;
+    struct aes_gcm_siv_set_ctx_params_st plist;
     unsigned int speed = 0;
 
     if (params == NULL)
         return 1;
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    aes_gcm_siv_set_ctx_params_decoder(params, &plist);
+
+    p = plist.tag;
     if (p != NULL) {
         if (p->data_type != OSSL_PARAM_OCTET_STRING
                 || p->data_size != sizeof(ctx->user_tag)) {
@@ -240,7 +249,7 @@ static int ossl_aes_gcm_siv_set_ctx_params(void *vctx, const OSSL_PARAM params[]
             ctx->have_user_tag = 1;
         }
     }
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_SPEED);
+    p = plist.speed;
     if (p != NULL) {
         if (!OSSL_PARAM_get_uint(p, &speed)) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -248,7 +257,7 @@ static int ossl_aes_gcm_siv_set_ctx_params(void *vctx, const OSSL_PARAM params[]
         }
         ctx->speed = !!speed;
     }
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = plist.keylen;
     if (p != NULL) {
         size_t key_len;
 
@@ -21,6 +21,9 @@
 #include "prov/providercommon.h"
 #include "prov/ciphercommon_aead.h"
 #include "prov/provider_ctx.h"
+#include "internal/param_names.h"
+
+#include "prov/cipher_aes_siv.inc"
 
 #define siv_stream_update siv_cipher
 #define SIV_FLAGS AEAD_FLAGS
@@ -161,8 +164,11 @@ static int aes_siv_get_ctx_params(void *vctx, OSSL_PARAM params[])
     PROV_AES_SIV_CTX *ctx = (PROV_AES_SIV_CTX *)vctx;
     SIV128_CONTEXT *sctx = &ctx->siv;
     OSSL_PARAM *p;
+    struct aes_siv_get_ctx_params_st plist;
+
+    aes_siv_get_ctx_params_decoder(params, &plist);
 
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    p = plist.tag;
     if (p != NULL && p->data_type == OSSL_PARAM_OCTET_STRING) {
         if (!ctx->enc
             || p->data_size != ctx->taglen
@@ -171,12 +177,12 @@ static int aes_siv_get_ctx_params(void *vctx, OSSL_PARAM params[])
             return 0;
         }
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAGLEN);
+    p = plist.taglen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->taglen)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
     }
-    p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = plist.keylen;
     if (p != NULL && !OSSL_PARAM_set_size_t(p, ctx->keylen)) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SET_PARAMETER);
         return 0;
@@ -200,12 +206,15 @@ static int aes_siv_set_ctx_params(void *vctx, const OSSL_PARAM params[])
 {
     PROV_AES_SIV_CTX *ctx = (PROV_AES_SIV_CTX *)vctx;
     const OSSL_PARAM *p;
+    struct aes_siv_set_ctx_params_st plist;
     unsigned int speed = 0;
 
     if (params == NULL)
         return 1;
 
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TAG);
+    aes_siv_set_ctx_params_decoder(params, &plist);
+
+    p = plist.tag;
     if (p != NULL) {
         if (ctx->enc)
             return 1;
@@ -215,7 +224,7 @@ static int aes_siv_set_ctx_params(void *vctx, const OSSL_PARAM params[])
             return 0;
         }
     }
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_SPEED);
+    p = plist.speed;
     if (p != NULL) {
         if (!OSSL_PARAM_get_uint(p, &speed)) {
             ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_GET_PARAMETER);
@@ -223,7 +232,7 @@ static int aes_siv_set_ctx_params(void *vctx, const OSSL_PARAM params[])
         }
         ctx->hw->setspeed(ctx, (int)speed);
     }
-    p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_KEYLEN);
+    p = plist.keylen;
     if (p != NULL) {
         size_t keylen;
 
@@ -42,6 +42,23 @@ static void *aria_gcm_dupctx(void *provctx)
     return dctx;
 }
 
+static OSSL_FUNC_cipher_copyctx_fn aria_gcm_copyctx;
+static int aria_gcm_copyctx(void *vdst, void *vsrc)
+{
+    PROV_ARIA_GCM_CTX *dctx = vdst;
+    PROV_ARIA_GCM_CTX *sctx = vsrc;
+
+    if (!ossl_prov_is_running() || dctx == NULL || sctx == NULL)
+        return 0;
+    if (dctx == sctx)
+        return 1;
+
+    memcpy(dctx, sctx, sizeof(*dctx));
+    if (dctx->base.gcm.key != NULL)
+        dctx->base.gcm.key = &dctx->ks.ks;
+    return 1;
+}
+
 static OSSL_FUNC_cipher_freectx_fn aria_gcm_freectx;
 static void aria_gcm_freectx(void *vctx)
 {
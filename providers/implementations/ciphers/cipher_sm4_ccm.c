@@ -43,6 +43,23 @@ static void *sm4_ccm_dupctx(void *provctx)
     return dctx;
 }
 
+static OSSL_FUNC_cipher_copyctx_fn sm4_ccm_copyctx;
+static int sm4_ccm_copyctx(void *vdst, void *vsrc)
+{
+    PROV_SM4_CCM_CTX *dctx = vdst;
+    PROV_SM4_CCM_CTX *sctx = vsrc;
+
+    if (!ossl_prov_is_running() || dctx == NULL || sctx == NULL)
+        return 0;
+    if (dctx == sctx)
+        return 1;
+
+    memcpy(dctx, sctx, sizeof(*dctx));
+    if (dctx->base.ccm_ctx.key != NULL)
+        dctx->base.ccm_ctx.key = &dctx->ks.ks;
+    return 1;
+}
+
 static void sm4_ccm_freectx(void *vctx)
 {
     PROV_SM4_CCM_CTX *ctx = (PROV_SM4_CCM_CTX *)vctx;
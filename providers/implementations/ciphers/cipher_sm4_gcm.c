@@ -44,6 +44,23 @@ static void *sm4_gcm_dupctx(void *provctx)
     return dctx;
 }
 
+static OSSL_FUNC_cipher_copyctx_fn sm4_gcm_copyctx;
+static int sm4_gcm_copyctx(void *vdst, void *vsrc)
+{
+    PROV_SM4_GCM_CTX *dctx = vdst;
+    PROV_SM4_GCM_CTX *sctx = vsrc;
+
+    if (!ossl_prov_is_running() || dctx == NULL || sctx == NULL)
+        return 0;
+    if (dctx == sctx)
+        return 1;
+
+    memcpy(dctx, sctx, sizeof(*dctx));
+    if (dctx->base.gcm.key != NULL)
+        dctx->base.gcm.key = &dctx->ks.ks;
+    return 1;
+}
+
 static void sm4_gcm_freectx(void *vctx)
 {
     PROV_SM4_GCM_CTX *ctx = (PROV_SM4_GCM_CTX *)vctx;
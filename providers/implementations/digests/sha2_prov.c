@@ -56,21 +56,61 @@ static int sha1_set_ctx_params(void *vctx, const OSSL_PARAM params[])
     return 1;
 }
 
+/*
+ * Batch hashing of independent messages, multi-buffer where the platform
+ * has it (see crypto/sha/sha_batch.c)
+ */
+static OSSL_FUNC_digest_digest_batch_fn sha1_digest_batch;
+static OSSL_FUNC_digest_digest_batch_fn sha224_digest_batch;
+static OSSL_FUNC_digest_digest_batch_fn sha256_digest_batch;
+
+static int sha1_digest_batch(ossl_unused void *provctx, size_t n,
+                             const unsigned char *const in[],
+                             const size_t inl[], unsigned char *const out[],
+                             size_t outsz)
+{
+    return ossl_prov_is_running()
+           && outsz >= SHA_DIGEST_LENGTH
+           && ossl_sha1_batch(n, in, inl, out);
+}
+
+static int sha224_digest_batch(ossl_unused void *provctx, size_t n,
+                               const unsigned char *const in[],
+                               const size_t inl[], unsigned char *const out[],
+                               size_t outsz)
+{
+    return ossl_prov_is_running()
+           && outsz >= SHA224_DIGEST_LENGTH
+           && ossl_sha256_batch(n, in, inl, out, SHA224_DIGEST_LENGTH);
+}
+
+static int sha256_digest_batch(ossl_unused void *provctx, size_t n,
+                               const unsigned char *const in[],
+                               const size_t inl[], unsigned char *const out[],
+                               size_t outsz)
+{
+    return ossl_prov_is_running()
+           && outsz >= SHA256_DIGEST_LENGTH
+           && ossl_sha256_batch(n, in, inl, out, SHA256_DIGEST_LENGTH);
+}
+
 /* ossl_sha1_functions */
-IMPLEMENT_digest_functions_with_settable_ctx(
+IMPLEMENT_digest_functions_with_settable_ctx_and_batch(
     sha1, SHA_CTX, SHA_CBLOCK, SHA_DIGEST_LENGTH, SHA2_FLAGS,
     SHA1_Init, SHA1_Update, SHA1_Final,
-    sha1_settable_ctx_params, sha1_set_ctx_params)
+    sha1_settable_ctx_params, sha1_set_ctx_params, sha1_digest_batch)
 
 /* ossl_sha224_functions */
-IMPLEMENT_digest_functions(sha224, SHA256_CTX,
-                           SHA256_CBLOCK, SHA224_DIGEST_LENGTH, SHA2_FLAGS,
-                           SHA224_Init, SHA224_Update, SHA224_Final)
+IMPLEMENT_digest_functions_with_batch(sha224, SHA256_CTX,
+                                      SHA256_CBLOCK, SHA224_DIGEST_LENGTH,
+                                      SHA2_FLAGS, SHA224_Init, SHA224_Update,
+                                      SHA224_Final, sha224_digest_batch)
 
 /* ossl_sha256_functions */
-IMPLEMENT_digest_functions(sha256, SHA256_CTX,
-                           SHA256_CBLOCK, SHA256_DIGEST_LENGTH, SHA2_FLAGS,
-                           SHA256_Init, SHA256_Update, SHA256_Final)
+IMPLEMENT_digest_functions_with_batch(sha256, SHA256_CTX,
+                                      SHA256_CBLOCK, SHA256_DIGEST_LENGTH,
+                                      SHA2_FLAGS, SHA256_Init, SHA256_Update,
+                                      SHA256_Final, sha256_digest_batch)
 #ifndef FIPS_MODULE
 /* ossl_sha256_192_functions */
 IMPLEMENT_digest_functions(sha256_192, SHA256_CTX,
@@ -61,6 +61,9 @@ static int HKDF_Expand(const EVP_MD *evp_md,
                        const unsigned char *prk, size_t prk_len,
                        const unsigned char *info, size_t info_len,
                        unsigned char *okm, size_t okm_len);
+static int hkdf_expand_prepared(HMAC_CTX *hmac, size_t dig_len,
+                                const unsigned char *info, size_t info_len,
+                                unsigned char *okm, size_t okm_len);
 
 /* Settable context parameters that are common across HKDF and the TLS KDF */
 #define HKDF_COMMON_SETTABLES                                           \
@@ -87,6 +90,13 @@ typedef struct {
     size_t data_len;
     unsigned char *info;
     size_t info_len;
+    /*
+     * HMAC keyed with |key|, holding the hashed inner and outer pads.  It is
+     * set up on first use and kept until the key or digest changes, so that
+     * repeated expand operations with the same key skip the key setup.
+     */
+    HMAC_CTX *key_hmac;
+    int key_hmac_ready;
 } KDF_HKDF;
 
 static void *kdf_hkdf_new(void *provctx)
@@ -127,6 +137,7 @@ static void kdf_hkdf_reset(void *vctx)
     OPENSSL_clear_free(ctx->data, ctx->data_len);
     OPENSSL_clear_free(ctx->key, ctx->key_len);
     OPENSSL_clear_free(ctx->info, ctx->info_len);
+    HMAC_CTX_free(ctx->key_hmac);
     memset(ctx, 0, sizeof(*ctx));
     ctx->provctx = provctx;
 }
@@ -180,6 +191,35 @@ static size_t kdf_hkdf_size(KDF_HKDF *ctx)
     return sz;
 }
 
+/* Returns the HMAC keyed with ctx->key, preparing it if needed */
+static HMAC_CTX *kdf_hkdf_key_hmac(KDF_HKDF *ctx, const EVP_MD *md)
+{
+    if (ctx->key_hmac_ready)
+        return ctx->key_hmac;
+    if (ctx->key == NULL)
+        return NULL;
+
+    if (ctx->key_hmac == NULL && (ctx->key_hmac = HMAC_CTX_new()) == NULL)
+        return NULL;
+    if (!HMAC_Init_ex(ctx->key_hmac, ctx->key, ctx->key_len, md, NULL))
+        return NULL;
+    ctx->key_hmac_ready = 1;
+    return ctx->key_hmac;
+}
+
+static int kdf_hkdf_expand_with_key(KDF_HKDF *ctx, const EVP_MD *md,
+                                    const unsigned char *info, size_t info_len,
+                                    unsigned char *okm, size_t okm_len)
+{
+    HMAC_CTX *hmac;
+    int sz = EVP_MD_get_size(md);
+
+    if (sz <= 0 || (hmac = kdf_hkdf_key_hmac(ctx, md)) == NULL)
+        return 0;
+    return hkdf_expand_prepared(hmac, (size_t)sz, info, info_len,
+                                okm, okm_len);
+}
+
 static int kdf_hkdf_derive(void *vctx, unsigned char *key, size_t keylen,
                            const OSSL_PARAM params[])
 {
@@ -215,8 +255,8 @@ static int kdf_hkdf_derive(void *vctx, unsigned char *key, size_t keylen,
                             ctx->key, ctx->key_len, key, keylen);
 
     case EVP_KDF_HKDF_MODE_EXPAND_ONLY:
-        return HKDF_Expand(md, ctx->key, ctx->key_len, ctx->info,
-                           ctx->info_len, key, keylen);
+        return kdf_hkdf_expand_with_key(ctx, md, ctx->info, ctx->info_len,
+                                        key, keylen);
     }
 }
 
@@ -231,6 +271,9 @@ static int hkdf_common_set_ctx_params(KDF_HKDF *ctx, const OSSL_PARAM params[])
 
     if (!ossl_prov_digest_load_from_params(&ctx->digest, params, libctx))
         return 0;
+    if (OSSL_PARAM_locate_const(params, OSSL_KDF_PARAM_DIGEST) != NULL
+            || OSSL_PARAM_locate_const(params, OSSL_KDF_PARAM_PROPERTIES) != NULL)
+        ctx->key_hmac_ready = 0;
 
     if ((p = OSSL_PARAM_locate_const(params, OSSL_KDF_PARAM_MODE)) != NULL) {
         if (p->data_type == OSSL_PARAM_UTF8_STRING) {
@@ -259,6 +302,7 @@ static int hkdf_common_set_ctx_params(KDF_HKDF *ctx, const OSSL_PARAM params[])
     }
 
     if ((p = OSSL_PARAM_locate_const(params, OSSL_KDF_PARAM_KEY)) != NULL) {
+        ctx->key_hmac_ready = 0;
         OPENSSL_clear_free(ctx->key, ctx->key_len);
         ctx->key = NULL;
         if (!OSSL_PARAM_get_octet_string(p, (void **)&ctx->key, 0,
@@ -498,14 +542,35 @@ static int HKDF_Expand(const EVP_MD *evp_md,
 {
     HMAC_CTX *hmac;
     int ret = 0, sz;
-    unsigned int i;
-    unsigned char prev[EVP_MAX_MD_SIZE];
-    size_t done_len = 0, dig_len, n;
 
     sz = EVP_MD_get_size(evp_md);
     if (sz <= 0)
         return 0;
-    dig_len = (size_t)sz;
+
+    if ((hmac = HMAC_CTX_new()) == NULL)
+        return 0;
+
+    if (HMAC_Init_ex(hmac, prk, prk_len, evp_md, NULL))
+        ret = hkdf_expand_prepared(hmac, (size_t)sz, info, info_len,
+                                   okm, okm_len);
+
+    HMAC_CTX_free(hmac);
+    return ret;
+}
+
+/*
+ * HKDF-Expand with |hmac| already keyed with the PRK.  Every block restarts
+ * from the prepared pad states of |hmac|, which are left intact so that it
+ * can be used again.
+ */
+static int hkdf_expand_prepared(HMAC_CTX *hmac, size_t dig_len,
+                                const unsigned char *info, size_t info_len,
+                                unsigned char *okm, size_t okm_len)
+{
+    int ret = 0;
+    unsigned int i;
+    unsigned char prev[EVP_MAX_MD_SIZE];
+    size_t done_len = 0, n;
 
     /* calc: N = ceil(L/HashLen) */
     n = okm_len / dig_len;
@@ -515,21 +580,15 @@ static int HKDF_Expand(const EVP_MD *evp_md,
     if (n > 255 || okm == NULL)
         return 0;
 
-    if ((hmac = HMAC_CTX_new()) == NULL)
-        return 0;
-
-    if (!HMAC_Init_ex(hmac, prk, prk_len, evp_md, NULL))
-        goto err;
-
     for (i = 1; i <= n; i++) {
         size_t copy_len;
         const unsigned char ctr = i;
 
         /* calc: T(i) = HMAC-Hash(PRK, T(i - 1) | info | i) */
-        if (i > 1) {
-            if (!HMAC_Init_ex(hmac, NULL, 0, NULL, NULL))
-                goto err;
+        if (!HMAC_Init_ex(hmac, NULL, 0, NULL, NULL))
+            goto err;
 
+        if (i > 1) {
             if (!HMAC_Update(hmac, prev, dig_len))
                 goto err;
         }
@@ -555,7 +614,6 @@ static int HKDF_Expand(const EVP_MD *evp_md,
 
  err:
     OPENSSL_cleanse(prev, sizeof(prev));
-    HMAC_CTX_free(hmac);
     return ret;
 }
 
@@ -569,9 +627,11 @@ static int HKDF_Expand(const EVP_MD *evp_md,
  * Given a |secret|; a |label| of length |labellen|; and |data| of length
  * |datalen| (e.g. typically a hash of the handshake messages), derive a new
  * secret |outlen| bytes long and store it in the location pointed to be |out|.
- * The |data| value may be zero length. Returns 1 on success and 0 on failure.
+ * The |data| value may be zero length. If |hmac| is not NULL, it is already
+ * keyed with the secret and |key| is ignored. Returns 1 on success and 0 on
+ * failure.
  */
-static int prov_tls13_hkdf_expand(const EVP_MD *md,
+static int prov_tls13_hkdf_expand(const EVP_MD *md, HMAC_CTX *hmac,
                                   const unsigned char *key, size_t keylen,
                                   const unsigned char *prefix, size_t prefixlen,
                                   const unsigned char *label, size_t labellen,
@@ -601,6 +661,12 @@ static int prov_tls13_hkdf_expand(const EVP_MD *md,
         return 0;
     }
 
+    if (hmac != NULL) {
+        int sz = EVP_MD_get_size(md);
+
+        return sz > 0 && hkdf_expand_prepared(hmac, (size_t)sz, hkdflabel,
+                                              hkdflabellen, out, outlen);
+    }
     return HKDF_Expand(md, key, keylen, hkdflabel, hkdflabellen,
                        out, outlen);
 }
@@ -650,7 +716,7 @@ static int prov_tls13_hkdf_generate_secret(OSSL_LIB_CTX *libctx,
         EVP_MD_CTX_free(mctx);
 
         /* Generate the pre-extract secret */
-        if (!prov_tls13_hkdf_expand(md, prevsecret, mdlen,
+        if (!prov_tls13_hkdf_expand(md, NULL, prevsecret, mdlen,
                                     prefix, prefixlen, label, labellen,
                                     hash, mdlen, preextractsec, mdlen))
             return 0;
@@ -671,6 +737,7 @@ static int kdf_tls1_3_derive(void *vctx, unsigned char *key, size_t keylen,
 {
     KDF_HKDF *ctx = (KDF_HKDF *)vctx;
     const EVP_MD *md;
+    HMAC_CTX *hmac;
 
     if (!ossl_prov_is_running() || !kdf_tls1_3_set_ctx_params(ctx, params))
         return 0;
@@ -695,7 +762,10 @@ static int kdf_tls1_3_derive(void *vctx, unsigned char *key, size_t keylen,
                                                key, keylen);
 
     case EVP_KDF_HKDF_MODE_EXPAND_ONLY:
-        return prov_tls13_hkdf_expand(md, ctx->key, ctx->key_len,
+        hmac = kdf_hkdf_key_hmac(ctx, md);
+        if (hmac == NULL)
+            return 0;
+        return prov_tls13_hkdf_expand(md, hmac, ctx->key, ctx->key_len,
                                       ctx->prefix, ctx->prefix_len,
                                       ctx->label, ctx->label_len,
                                       ctx->data, ctx->data_len,
@@ -33,6 +33,7 @@
  */
 static OSSL_FUNC_mac_newctx_fn cmac_new;
 static OSSL_FUNC_mac_dupctx_fn cmac_dup;
+static OSSL_FUNC_mac_copyctx_fn cmac_copy;
 static OSSL_FUNC_mac_freectx_fn cmac_free;
 static OSSL_FUNC_mac_gettable_ctx_params_fn cmac_gettable_ctx_params;
 static OSSL_FUNC_mac_get_ctx_params_fn cmac_get_ctx_params;
@@ -98,6 +99,26 @@ static void *cmac_dup(void *vsrc)
     return dst;
 }
 
+/*
+ * Copy the state of |vsrc| into the existing context |vdst|.  The underlying
+ * cipher context is copied in place where the cipher supports it, so the key
+ * schedule is neither reallocated nor recomputed.
+ */
+static int cmac_copy(void *vdst, void *vsrc)
+{
+    struct cmac_data_st *src = vsrc;
+    struct cmac_data_st *dst = vdst;
+
+    if (!ossl_prov_is_running())
+        return 0;
+    if (dst == src)
+        return 1;
+
+    ossl_prov_cipher_reset(&dst->cipher);
+    return CMAC_CTX_copy(dst->ctx, src->ctx)
+           && ossl_prov_cipher_copy(&dst->cipher, &src->cipher);
+}
+
 static size_t cmac_size(void *vmacctx)
 {
     struct cmac_data_st *macctx = vmacctx;
@@ -223,6 +244,7 @@ static int cmac_set_ctx_params(void *vmacctx, const OSSL_PARAM params[])
 const OSSL_DISPATCH ossl_cmac_functions[] = {
     { OSSL_FUNC_MAC_NEWCTX, (void (*)(void))cmac_new },
     { OSSL_FUNC_MAC_DUPCTX, (void (*)(void))cmac_dup },
+    { OSSL_FUNC_MAC_COPYCTX, (void (*)(void))cmac_copy },
     { OSSL_FUNC_MAC_FREECTX, (void (*)(void))cmac_free },
     { OSSL_FUNC_MAC_INIT, (void (*)(void))cmac_init },
     { OSSL_FUNC_MAC_UPDATE, (void (*)(void))cmac_update },
@@ -22,12 +22,15 @@
 #include <openssl/hmac.h>
 
 #include "internal/ssl3_cbc.h"
+#include "internal/param_names.h"
 
 #include "prov/implementations.h"
 #include "prov/provider_ctx.h"
 #include "prov/provider_util.h"
 #include "prov/providercommon.h"
 
+#include "prov/hmac_prov.inc"
+
 /*
  * Forward declaration of everything implemented here.  This is not strictly
  * necessary for the compiler, but provides an assurance that the signatures
@@ -35,6 +38,7 @@
  */
 static OSSL_FUNC_mac_newctx_fn hmac_new;
 static OSSL_FUNC_mac_dupctx_fn hmac_dup;
+static OSSL_FUNC_mac_copyctx_fn hmac_copy;
 static OSSL_FUNC_mac_freectx_fn hmac_free;
 static OSSL_FUNC_mac_gettable_ctx_params_fn hmac_gettable_ctx_params;
 static OSSL_FUNC_mac_get_ctx_params_fn hmac_get_ctx_params;
@@ -125,6 +129,58 @@ static void *hmac_dup(void *vsrc)
     return dst;
 }
 
+/*
+ * Copy the state of |vsrc| into the existing context |vdst|.  When both use
+ * the same digest and key length, this reuses everything already allocated
+ * in |vdst|, so restoring a saved keyed state costs no more than copying the
+ * digest states.
+ */
+static int hmac_copy(void *vdst, void *vsrc)
+{
+    struct hmac_data_st *src = vsrc;
+    struct hmac_data_st *dst = vdst;
+    HMAC_CTX *ctx = dst->ctx;
+    PROV_DIGEST digest = dst->digest;
+    unsigned char *key = dst->key;
+    size_t keylen = dst->keylen;
+
+    if (!ossl_prov_is_running())
+        return 0;
+    if (dst == src)
+        return 1;
+
+    if (digest.md != src->digest.md || digest.alloc_md != src->digest.alloc_md
+        || digest.engine != src->digest.engine) {
+        ossl_prov_digest_reset(&dst->digest);
+        if (!ossl_prov_digest_copy(&dst->digest, &src->digest))
+            return 0;
+        digest = dst->digest;
+    }
+    if (src->key == NULL || keylen != src->keylen) {
+        OPENSSL_secure_clear_free(key, keylen);
+        key = NULL;
+        keylen = 0;
+        if (src->key != NULL) {
+            key = OPENSSL_secure_malloc(src->keylen > 0 ? src->keylen : 1);
+            if (key == NULL) {
+                dst->key = NULL;
+                dst->keylen = 0;
+                return 0;
+            }
+            keylen = src->keylen;
+        }
+    }
+    if (key != NULL)
+        memcpy(key, src->key, keylen);
+
+    *dst = *src;
+    dst->ctx = ctx;
+    dst->digest = digest;
+    dst->key = key;
+    dst->keylen = keylen;
+    return HMAC_CTX_copy(dst->ctx, src->ctx);
+}
+
 static size_t hmac_size(struct hmac_data_st *macctx)
 {
     return HMAC_size(macctx->ctx);
@@ -246,14 +302,15 @@ static const OSSL_PARAM *hmac_gettable_ctx_params(ossl_unused void *ctx,
 static int hmac_get_ctx_params(void *vmacctx, OSSL_PARAM params[])
 {
     struct hmac_data_st *macctx = vmacctx;
-    OSSL_PARAM *p;
+    struct hmac_get_ctx_params_st p;
 
-    if ((p = OSSL_PARAM_locate(params, OSSL_MAC_PARAM_SIZE)) != NULL
-            && !OSSL_PARAM_set_size_t(p, hmac_size(macctx)))
+    hmac_get_ctx_params_decoder(params, &p);
+
+    if (p.size != NULL && !OSSL_PARAM_set_size_t(p.size, hmac_size(macctx)))
         return 0;
 
-    if ((p = OSSL_PARAM_locate(params, OSSL_MAC_PARAM_BLOCK_SIZE)) != NULL
-            && !OSSL_PARAM_set_int(p, hmac_block_size(macctx)))
+    if (p.bsize != NULL
+            && !OSSL_PARAM_set_int(p.bsize, hmac_block_size(macctx)))
         return 0;
 
     return 1;
@@ -281,24 +338,26 @@ static int hmac_set_ctx_params(void *vmacctx, const OSSL_PARAM params[])
 {
     struct hmac_data_st *macctx = vmacctx;
     OSSL_LIB_CTX *ctx = PROV_LIBCTX_OF(macctx->provctx);
-    const OSSL_PARAM *p;
+    struct hmac_set_ctx_params_st p;
 
     if (params == NULL)
         return 1;
 
-    if (!ossl_prov_digest_load_from_params(&macctx->digest, params, ctx))
+    hmac_set_ctx_params_decoder(params, &p);
+
+    if (!ossl_prov_digest_load(&macctx->digest, p.digest, p.propq, p.engine,
+                               ctx))
         return 0;
 
-    if ((p = OSSL_PARAM_locate_const(params, OSSL_MAC_PARAM_KEY)) != NULL) {
-        if (p->data_type != OSSL_PARAM_OCTET_STRING)
+    if (p.key != NULL) {
+        if (p.key->data_type != OSSL_PARAM_OCTET_STRING)
             return 0;
-        if (!hmac_setkey(macctx, p->data, p->data_size))
+        if (!hmac_setkey(macctx, p.key->data, p.key->data_size))
             return 0;
     }
 
-    if ((p = OSSL_PARAM_locate_const(params,
-                                     OSSL_MAC_PARAM_TLS_DATA_SIZE)) != NULL) {
-        if (!OSSL_PARAM_get_size_t(p, &macctx->tls_data_size))
+    if (p.tlssize != NULL) {
+        if (!OSSL_PARAM_get_size_t(p.tlssize, &macctx->tls_data_size))
             return 0;
     }
     return 1;
@@ -307,6 +366,7 @@ static int hmac_set_ctx_params(void *vmacctx, const OSSL_PARAM params[])
 const OSSL_DISPATCH ossl_hmac_functions[] = {
     { OSSL_FUNC_MAC_NEWCTX, (void (*)(void))hmac_new },
     { OSSL_FUNC_MAC_DUPCTX, (void (*)(void))hmac_dup },
+    { OSSL_FUNC_MAC_COPYCTX, (void (*)(void))hmac_copy },
     { OSSL_FUNC_MAC_FREECTX, (void (*)(void))hmac_free },
     { OSSL_FUNC_MAC_INIT, (void (*)(void))hmac_init },
     { OSSL_FUNC_MAC_UPDATE, (void (*)(void))hmac_update },
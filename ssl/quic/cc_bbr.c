@@ -0,0 +1,707 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/nelem.h"
+#include "internal/quic_cc.h"
+#include "internal/quic_pacer.h"
+#include "internal/quic_types.h"
+#include "internal/safe_math.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+/*
+ * BBR-style Congestion Controller
+ * ===============================
+ *
+ * A model-based congestion controller following the structure of BBR
+ * (draft-cardwell-iccrg-bbr-congestion-control). Rather than reacting to loss
+ * alone, it estimates the bottleneck bandwidth (windowed maximum delivery
+ * rate) and the minimum RTT, paces at a multiple of the bandwidth estimate
+ * and bounds the amount of data in flight to a multiple of the estimated
+ * bandwidth-delay product (BDP).
+ *
+ * The OSSL_CC_METHOD interface does not carry per-packet delivery state, so
+ * delivery rate is sampled once per round trip, a round ending when a packet
+ * sent after the start of the round is acknowledged. As in BBRv2, loss and
+ * ECN signals lower an upper bound on data in flight (inflight_hi) which is
+ * then probed upwards again while in the PROBE_BW state.
+ */
+typedef enum {
+    BBR_STATE_STARTUP,
+    BBR_STATE_DRAIN,
+    BBR_STATE_PROBE_BW,
+    BBR_STATE_PROBE_RTT
+} BBR_STATE;
+
+/* Number of rounds over which the maximum delivery rate is taken. */
+#define BBR_BW_FILTER_LEN           10
+
+typedef struct ossl_cc_bbr_st {
+    /* Dependencies. */
+    OSSL_TIME   (*now_cb)(void *arg);
+    void        *now_cb_arg;
+
+    /* 'Constants' (which we allow to be configurable). */
+    uint64_t    k_init_wnd, k_min_wnd;
+
+    /* State. */
+    size_t      max_dgram_size;
+    uint64_t    bytes_in_flight, cong_wnd;
+    BBR_STATE   state;
+
+    /* Round trip counting and delivery rate sampling. */
+    uint64_t    delivered;          /* total bytes acknowledged */
+    uint64_t    round_count;
+    OSSL_TIME   round_start;        /* time the current round started */
+    uint64_t    round_start_delivered;
+    int         round_start_flag;   /* 1 on the first ACK of a new round */
+
+    /* Model. */
+    uint64_t    bw_filter[BBR_BW_FILTER_LEN]; /* per-round max, bytes/s */
+    uint64_t    btl_bw;             /* max of bw_filter */
+    OSSL_TIME   min_rtt;            /* infinite if no sample */
+    OSSL_TIME   min_rtt_stamp;
+    OSSL_TIME   smoothed_rtt;
+
+    /* Startup. */
+    int         filled_pipe;
+    uint64_t    full_bw;
+    uint32_t    full_bw_count;
+
+    /* PROBE_BW gain cycling. */
+    uint32_t    cycle_index;
+    OSSL_TIME   cycle_stamp;
+
+    /* PROBE_RTT. */
+    OSSL_TIME   probe_rtt_done_stamp; /* zero until inflight has drained */
+    uint64_t    prior_cwnd;
+
+    /* Loss response (BBRv2 style). */
+    uint64_t    inflight_hi;        /* UINT64_MAX if unbounded */
+    uint32_t    probe_up_rounds;
+    OSSL_TIME   cong_recovery_start_time;
+    int         processing_loss;
+    OSSL_TIME   tx_time_of_last_loss;
+    uint64_t    lost_in_event;
+
+    /* Gains for the current state, in 1/1000ths. */
+    uint32_t    pacing_gain, cwnd_gain;
+
+    OSSL_QUIC_PACER pacer;
+
+    /* Diagnostic output locations. */
+    OSSL_CC_DIAG diag;
+} OSSL_CC_BBR;
+
+#define MIN_MAX_INIT_WND_SIZE       14720  /* RFC 9002 s. 7.2 */
+
+#define BBR_GAIN_UNIT               1000
+#define BBR_STARTUP_GAIN            2885    /* 2/ln(2) */
+#define BBR_DRAIN_GAIN              347     /* 1/BBR_STARTUP_GAIN */
+#define BBR_CWND_GAIN               2000
+#define BBR_PROBE_RTT_CWND_PKTS     4
+#define BBR_PROBE_RTT_DURATION_MS   200
+#define BBR_MIN_RTT_WINDOW_MS       10000
+#define BBR_FULL_BW_THRESH          1250    /* 25% growth */
+#define BBR_FULL_BW_COUNT           3
+#define BBR_BETA                    700     /* inflight_hi reduction on loss */
+#define BBR_MAX_PROBE_UP_ROUNDS     10
+
+static const uint32_t bbr_pacing_gain_cycle[] = {
+    1250, 750, 1000, 1000, 1000, 1000, 1000, 1000
+};
+
+#define BBR_GAIN_CYCLE_LEN  OSSL_NELEM(bbr_pacing_gain_cycle)
+
+static void bbr_set_max_dgram_size(OSSL_CC_BBR *bbr,
+                                   size_t max_dgram_size);
+static void bbr_update_diag(OSSL_CC_BBR *bbr);
+static void bbr_update_pacing(OSSL_CC_BBR *bbr);
+
+static void bbr_reset(OSSL_CC_DATA *cc);
+
+static OSSL_CC_DATA *bbr_new(OSSL_TIME (*now_cb)(void *arg),
+                             void *now_cb_arg)
+{
+    OSSL_CC_BBR *bbr;
+
+    if ((bbr = OPENSSL_zalloc(sizeof(*bbr))) == NULL)
+        return NULL;
+
+    bbr->now_cb         = now_cb;
+    bbr->now_cb_arg     = now_cb_arg;
+
+    bbr_set_max_dgram_size(bbr, QUIC_MIN_INITIAL_DGRAM_LEN);
+    bbr_reset((OSSL_CC_DATA *)bbr);
+
+    return (OSSL_CC_DATA *)bbr;
+}
+
+static void bbr_free(OSSL_CC_DATA *cc)
+{
+    OPENSSL_free(cc);
+}
+
+static void bbr_set_max_dgram_size(OSSL_CC_BBR *bbr,
+                                   size_t max_dgram_size)
+{
+    size_t max_init_wnd;
+    int is_reduced = (max_dgram_size < bbr->max_dgram_size);
+
+    bbr->max_dgram_size = max_dgram_size;
+
+    max_init_wnd = 2 * max_dgram_size;
+    if (max_init_wnd < MIN_MAX_INIT_WND_SIZE)
+        max_init_wnd = MIN_MAX_INIT_WND_SIZE;
+
+    bbr->k_init_wnd = 10 * max_dgram_size;
+    if (bbr->k_init_wnd > max_init_wnd)
+        bbr->k_init_wnd = max_init_wnd;
+
+    bbr->k_min_wnd = BBR_PROBE_RTT_CWND_PKTS * max_dgram_size;
+
+    if (is_reduced)
+        bbr->cong_wnd = bbr->k_init_wnd;
+
+    bbr_update_pacing(bbr);
+    bbr_update_diag(bbr);
+}
+
+static void bbr_enter_startup(OSSL_CC_BBR *bbr)
+{
+    bbr->state          = BBR_STATE_STARTUP;
+    bbr->pacing_gain    = BBR_STARTUP_GAIN;
+    bbr->cwnd_gain      = BBR_STARTUP_GAIN;
+}
+
+static void bbr_reset(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+    size_t i;
+
+    bbr->cong_wnd               = bbr->k_init_wnd;
+    bbr->bytes_in_flight        = 0;
+
+    bbr->delivered              = 0;
+    bbr->round_count            = 0;
+    bbr->round_start            = ossl_time_zero();
+    bbr->round_start_delivered  = 0;
+    bbr->round_start_flag       = 0;
+
+    for (i = 0; i < BBR_BW_FILTER_LEN; ++i)
+        bbr->bw_filter[i] = 0;
+    bbr->btl_bw                 = 0;
+    bbr->min_rtt                = ossl_time_infinite();
+    bbr->min_rtt_stamp          = ossl_time_zero();
+    bbr->smoothed_rtt           = ossl_time_zero();
+
+    bbr->filled_pipe            = 0;
+    bbr->full_bw                = 0;
+    bbr->full_bw_count          = 0;
+
+    bbr->cycle_index            = 0;
+    bbr->cycle_stamp            = ossl_time_zero();
+
+    bbr->probe_rtt_done_stamp   = ossl_time_zero();
+    bbr->prior_cwnd             = 0;
+
+    bbr->inflight_hi            = UINT64_MAX;
+    bbr->probe_up_rounds        = 0;
+    bbr->cong_recovery_start_time = ossl_time_zero();
+    bbr->processing_loss        = 0;
+    bbr->tx_time_of_last_loss   = ossl_time_zero();
+    bbr->lost_in_event          = 0;
+
+    bbr_enter_startup(bbr);
+    ossl_quic_pacer_init(&bbr->pacer);
+}
+
+static int bbr_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+    size_t max_dgram_size;
+
+    if (!ossl_cc_get_input_params(params, &max_dgram_size))
+        return 0;
+    if (max_dgram_size != 0)
+        bbr_set_max_dgram_size(bbr, max_dgram_size);
+    return 1;
+}
+
+static int bbr_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    if (!ossl_cc_diag_bind(&bbr->diag, params))
+        return 0;
+
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    ossl_cc_diag_unbind(&bbr->diag, params);
+    return 1;
+}
+
+static void bbr_update_diag(OSSL_CC_BBR *bbr)
+{
+    static const char state_chars[] = { 'S', 'D', 'B', 'T' };
+
+    ossl_cc_diag_update(&bbr->diag, bbr->max_dgram_size, bbr->cong_wnd,
+                        bbr->k_min_wnd, bbr->bytes_in_flight,
+                        state_chars[bbr->state]);
+}
+
+/* Estimated BDP scaled by gain, or 0 if there is no estimate yet. */
+static uint64_t bbr_bdp(OSSL_CC_BBR *bbr, uint32_t gain)
+{
+    uint64_t bdp;
+    int err = 0;
+
+    if (bbr->btl_bw == 0 || ossl_time_is_infinite(bbr->min_rtt))
+        return 0;
+
+    bdp = safe_muldiv_u64(bbr->btl_bw, ossl_time2ticks(bbr->min_rtt),
+                          OSSL_TIME_SECOND, &err);
+    bdp = safe_muldiv_u64(bdp, gain, BBR_GAIN_UNIT, &err);
+    return err ? UINT64_MAX : bdp;
+}
+
+static void bbr_update_pacing(OSSL_CC_BBR *bbr)
+{
+    uint64_t rate;
+    int err = 0;
+
+    if (bbr->btl_bw > 0) {
+        rate = safe_muldiv_u64(bbr->btl_bw, bbr->pacing_gain, BBR_GAIN_UNIT,
+                               &err);
+        if (err)
+            rate = UINT64_MAX;
+    } else {
+        /* No bandwidth sample yet, so pace the initial window. */
+        rate = ossl_quic_pacer_rate_from_cwnd(bbr->cong_wnd, bbr->smoothed_rtt);
+        if (rate == 0 && bbr->pacer.rate == 0)
+            return;
+    }
+
+    ossl_quic_pacer_set_rate(&bbr->pacer, rate, bbr->max_dgram_size,
+                             bbr->k_init_wnd, bbr->now_cb(bbr->now_cb_arg));
+}
+
+static void bbr_update_round(OSSL_CC_BBR *bbr, const OSSL_CC_ACK_INFO *info,
+                             OSSL_TIME now)
+{
+    uint64_t elapsed, bw, delivered;
+    size_t i;
+    int err = 0;
+
+    bbr->round_start_flag = 0;
+    if (ossl_time_compare(info->tx_time, bbr->round_start) < 0)
+        return;
+
+    /*
+     * A packet sent after the round started has been acknowledged, so a full
+     * round trip has passed. The data delivered over that time is our
+     * delivery rate sample.
+     */
+    elapsed = ossl_time2ticks(ossl_time_subtract(now, bbr->round_start));
+    delivered = bbr->delivered - bbr->round_start_delivered;
+    if (bbr->round_count > 0 && elapsed > 0) {
+        bw = safe_muldiv_u64(delivered, OSSL_TIME_SECOND, elapsed, &err);
+        if (!err && bw > bbr->bw_filter[bbr->round_count % BBR_BW_FILTER_LEN])
+            bbr->bw_filter[bbr->round_count % BBR_BW_FILTER_LEN] = bw;
+    }
+
+    ++bbr->round_count;
+    bbr->round_start            = now;
+    bbr->round_start_delivered  = bbr->delivered;
+    bbr->round_start_flag       = 1;
+    bbr->bw_filter[bbr->round_count % BBR_BW_FILTER_LEN] = 0;
+
+    bbr->btl_bw = 0;
+    for (i = 0; i < BBR_BW_FILTER_LEN; ++i)
+        if (bbr->bw_filter[i] > bbr->btl_bw)
+            bbr->btl_bw = bbr->bw_filter[i];
+}
+
+static void bbr_check_full_pipe(OSSL_CC_BBR *bbr)
+{
+    if (bbr->filled_pipe || !bbr->round_start_flag || bbr->btl_bw == 0)
+        return;
+
+    if (bbr->btl_bw * BBR_GAIN_UNIT >= bbr->full_bw * BBR_FULL_BW_THRESH) {
+        bbr->full_bw        = bbr->btl_bw;
+        bbr->full_bw_count  = 0;
+        return;
+    }
+
+    if (++bbr->full_bw_count >= BBR_FULL_BW_COUNT)
+        bbr->filled_pipe = 1;
+}
+
+static void bbr_set_cycle(OSSL_CC_BBR *bbr, uint32_t cycle_index,
+                          OSSL_TIME now)
+{
+    bbr->cycle_index    = cycle_index % BBR_GAIN_CYCLE_LEN;
+    bbr->cycle_stamp    = now;
+    bbr->pacing_gain    = bbr_pacing_gain_cycle[bbr->cycle_index];
+}
+
+static void bbr_enter_probe_bw(OSSL_CC_BBR *bbr, OSSL_TIME now)
+{
+    bbr->state          = BBR_STATE_PROBE_BW;
+    bbr->cwnd_gain      = BBR_CWND_GAIN;
+    /* Start cruising; probe up after a full cycle. */
+    bbr_set_cycle(bbr, 1, now);
+}
+
+static void bbr_advance_cycle(OSSL_CC_BBR *bbr, OSSL_TIME now)
+{
+    if (ossl_time_is_infinite(bbr->min_rtt)
+        || ossl_time_compare(ossl_time_subtract(now, bbr->cycle_stamp),
+                             bbr->min_rtt) <= 0)
+        return;
+
+    /*
+     * Keep probing up until inflight reaches the probing target or a loss
+     * ends the phase early (see bbr_cong()).
+     */
+    if (bbr->cycle_index == 0
+        && bbr->bytes_in_flight < bbr_bdp(bbr, bbr_pacing_gain_cycle[0]))
+        return;
+
+    bbr_set_cycle(bbr, bbr->cycle_index + 1, now);
+}
+
+/*
+ * While probing for bandwidth, raise inflight_hi by an amount which doubles
+ * each round trip without loss (BBRv2 PROBE_UP).
+ */
+static void bbr_probe_inflight_hi(OSSL_CC_BBR *bbr)
+{
+    uint32_t shift;
+
+    if (bbr->inflight_hi == UINT64_MAX || bbr->cycle_index != 0
+        || !bbr->round_start_flag)
+        return;
+
+    shift = bbr->probe_up_rounds < BBR_MAX_PROBE_UP_ROUNDS
+        ? bbr->probe_up_rounds++ : BBR_MAX_PROBE_UP_ROUNDS;
+    bbr->inflight_hi += (uint64_t)bbr->max_dgram_size << shift;
+}
+
+static void bbr_update_state(OSSL_CC_BBR *bbr, OSSL_TIME now)
+{
+    bbr_check_full_pipe(bbr);
+
+    switch (bbr->state) {
+    case BBR_STATE_STARTUP:
+        if (bbr->filled_pipe) {
+            bbr->state          = BBR_STATE_DRAIN;
+            bbr->pacing_gain    = BBR_DRAIN_GAIN;
+            bbr->cwnd_gain      = BBR_STARTUP_GAIN;
+        }
+        break;
+
+    case BBR_STATE_DRAIN:
+        if (bbr->bytes_in_flight <= bbr_bdp(bbr, BBR_GAIN_UNIT))
+            bbr_enter_probe_bw(bbr, now);
+        break;
+
+    case BBR_STATE_PROBE_BW:
+        bbr_advance_cycle(bbr, now);
+        bbr_probe_inflight_hi(bbr);
+        break;
+
+    case BBR_STATE_PROBE_RTT:
+        if (ossl_time_is_zero(bbr->probe_rtt_done_stamp)) {
+            if (bbr->bytes_in_flight <= bbr->k_min_wnd)
+                bbr->probe_rtt_done_stamp
+                    = ossl_time_add(now,
+                                    ossl_ms2time(BBR_PROBE_RTT_DURATION_MS));
+        } else if (ossl_time_compare(now, bbr->probe_rtt_done_stamp) >= 0) {
+            bbr->min_rtt_stamp = now;
+            if (bbr->cong_wnd < bbr->prior_cwnd)
+                bbr->cong_wnd = bbr->prior_cwnd;
+            if (bbr->filled_pipe)
+                bbr_enter_probe_bw(bbr, now);
+            else
+                bbr_enter_startup(bbr);
+        }
+        break;
+    }
+}
+
+static void bbr_update_min_rtt(OSSL_CC_BBR *bbr, const OSSL_CC_ACK_INFO *info,
+                               OSSL_TIME now)
+{
+    OSSL_TIME rtt;
+    int expired;
+
+    if (ossl_time_compare(now, info->tx_time) <= 0)
+        return;
+
+    rtt = ossl_time_subtract(now, info->tx_time);
+    expired = !ossl_time_is_infinite(bbr->min_rtt)
+        && ossl_time_compare(ossl_time_subtract(now, bbr->min_rtt_stamp),
+                             ossl_ms2time(BBR_MIN_RTT_WINDOW_MS)) > 0;
+
+    if (ossl_time_compare(rtt, bbr->min_rtt) <= 0 || expired) {
+        bbr->min_rtt        = rtt;
+        bbr->min_rtt_stamp  = now;
+    }
+
+    /*
+     * If the minimum RTT has not been refreshed for a while, drain the queue
+     * to get a fresh measurement.
+     */
+    if (expired && bbr->state != BBR_STATE_PROBE_RTT) {
+        bbr->state                  = BBR_STATE_PROBE_RTT;
+        bbr->pacing_gain            = BBR_GAIN_UNIT;
+        bbr->cwnd_gain              = BBR_GAIN_UNIT;
+        bbr->prior_cwnd             = bbr->cong_wnd;
+        bbr->probe_rtt_done_stamp   = ossl_time_zero();
+    }
+}
+
+/*
+ * As for NewReno, we only treat ACKs as a signal that the window may grow if
+ * we were actually using a significant part of it.
+ */
+static int bbr_is_cong_limited(OSSL_CC_BBR *bbr)
+{
+    uint64_t wnd_rem;
+
+    if (bbr->bytes_in_flight >= bbr->cong_wnd)
+        return 1;
+
+    wnd_rem = bbr->cong_wnd - bbr->bytes_in_flight;
+    return (!bbr->filled_pipe && wnd_rem <= bbr->cong_wnd / 2)
+           || wnd_rem <= 3 * bbr->max_dgram_size;
+}
+
+static void bbr_update_cwnd(OSSL_CC_BBR *bbr, uint64_t acked)
+{
+    uint64_t target = bbr_bdp(bbr, bbr->cwnd_gain);
+
+    if (!bbr_is_cong_limited(bbr))
+        acked = 0;
+
+    if (target > 0)
+        /* Allow for delayed and aggregated ACKs. */
+        target += 3 * (uint64_t)bbr->max_dgram_size;
+
+    if (bbr->filled_pipe) {
+        bbr->cong_wnd += acked;
+        if (target > 0 && bbr->cong_wnd > target)
+            bbr->cong_wnd = target;
+    } else if (target == 0 || bbr->cong_wnd < target
+               || bbr->delivered < bbr->k_init_wnd) {
+        bbr->cong_wnd += acked;
+    }
+
+    if (bbr->cong_wnd > bbr->inflight_hi)
+        bbr->cong_wnd = bbr->inflight_hi;
+
+    if (bbr->state == BBR_STATE_PROBE_RTT && bbr->cong_wnd > bbr->k_min_wnd)
+        bbr->cong_wnd = bbr->k_min_wnd;
+
+    if (bbr->cong_wnd < bbr->k_min_wnd)
+        bbr->cong_wnd = bbr->k_min_wnd;
+}
+
+static uint64_t bbr_get_tx_allowance(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+    uint64_t cwnd_rem, paced;
+
+    if (bbr->bytes_in_flight >= bbr->cong_wnd)
+        return 0;
+
+    cwnd_rem = bbr->cong_wnd - bbr->bytes_in_flight;
+    paced = ossl_quic_pacer_get_allowance(&bbr->pacer,
+                                          bbr->now_cb(bbr->now_cb_arg));
+    return paced < cwnd_rem ? paced : cwnd_rem;
+}
+
+static OSSL_TIME bbr_get_wakeup_deadline(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    if (bbr->bytes_in_flight >= bbr->cong_wnd)
+        return ossl_time_infinite();
+
+    return ossl_quic_pacer_get_deadline(&bbr->pacer,
+                                        bbr->now_cb(bbr->now_cb_arg));
+}
+
+static int bbr_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    bbr->bytes_in_flight += num_bytes;
+    ossl_quic_pacer_on_data_sent(&bbr->pacer, num_bytes,
+                                 bbr->now_cb(bbr->now_cb_arg));
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_data_acked(OSSL_CC_DATA *cc,
+                             const OSSL_CC_ACK_INFO *info)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+    OSSL_TIME now = bbr->now_cb(bbr->now_cb_arg);
+
+    bbr->bytes_in_flight    -= info->tx_size;
+    bbr->delivered          += info->tx_size;
+
+    if (!ossl_time_is_zero(info->smoothed_rtt))
+        bbr->smoothed_rtt = info->smoothed_rtt;
+
+    bbr_update_round(bbr, info, now);
+    bbr_update_min_rtt(bbr, info, now);
+    bbr_update_state(bbr, now);
+    bbr_update_cwnd(bbr, info->tx_size);
+    bbr_update_pacing(bbr);
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+/*
+ * Responds to a congestion signal. BBR does not treat loss as a reliable
+ * signal of the path's capacity, but as in BBRv2, the amount of data in
+ * flight at the time of the loss is used to bound future inflight.
+ */
+static void bbr_cong(OSSL_CC_BBR *bbr, OSSL_TIME tx_time, uint64_t lost)
+{
+    OSSL_TIME now = bbr->now_cb(bbr->now_cb_arg);
+    uint64_t inflight_hi;
+    int err = 0;
+
+    if (ossl_time_compare(tx_time, bbr->cong_recovery_start_time) <= 0)
+        return;
+
+    bbr->cong_recovery_start_time = now;
+
+    inflight_hi = safe_muldiv_u64(bbr->bytes_in_flight + lost, BBR_BETA,
+                                  BBR_GAIN_UNIT, &err);
+    if (!err && inflight_hi < bbr->inflight_hi)
+        bbr->inflight_hi = inflight_hi;
+    if (bbr->inflight_hi < bbr->k_min_wnd)
+        bbr->inflight_hi = bbr->k_min_wnd;
+
+    bbr->probe_up_rounds = 0;
+
+    /* Stop probing up once we have found the limit. */
+    if (bbr->state == BBR_STATE_PROBE_BW && bbr->cycle_index == 0)
+        bbr_set_cycle(bbr, 1, now);
+
+    /* Loss during startup means we have found the limit of the path. */
+    if (bbr->state == BBR_STATE_STARTUP) {
+        bbr->filled_pipe = 1;
+        bbr_update_state(bbr, now);
+    }
+
+    if (bbr->cong_wnd > bbr->inflight_hi)
+        bbr->cong_wnd = bbr->inflight_hi;
+}
+
+static void bbr_flush(OSSL_CC_BBR *bbr, uint32_t flags)
+{
+    if (!bbr->processing_loss)
+        return;
+
+    bbr_cong(bbr, bbr->tx_time_of_last_loss, bbr->lost_in_event);
+
+    if ((flags & OSSL_CC_LOST_FLAG_PERSISTENT_CONGESTION) != 0) {
+        bbr->cong_wnd                   = bbr->k_min_wnd;
+        bbr->cong_recovery_start_time   = ossl_time_zero();
+    }
+
+    bbr->processing_loss    = 0;
+    bbr->lost_in_event      = 0;
+    bbr_update_pacing(bbr);
+    bbr_update_diag(bbr);
+}
+
+static int bbr_on_data_lost(OSSL_CC_DATA *cc,
+                            const OSSL_CC_LOSS_INFO *info)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    if (info->tx_size > bbr->bytes_in_flight)
+        return 0;
+
+    bbr->bytes_in_flight -= info->tx_size;
+
+    if (!bbr->processing_loss) {
+        if (ossl_time_compare(info->tx_time, bbr->tx_time_of_last_loss) <= 0)
+            goto out;
+
+        bbr->processing_loss = 1;
+    }
+
+    bbr->lost_in_event += info->tx_size;
+    bbr->tx_time_of_last_loss
+        = ossl_time_max(bbr->tx_time_of_last_loss, info->tx_time);
+
+out:
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_data_lost_finished(OSSL_CC_DATA *cc, uint32_t flags)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    bbr_flush(bbr, flags);
+    return 1;
+}
+
+static int bbr_on_data_invalidated(OSSL_CC_DATA *cc,
+                                   uint64_t num_bytes)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    bbr->bytes_in_flight -= num_bytes;
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_ecn(OSSL_CC_DATA *cc,
+                      const OSSL_CC_ECN_INFO *info)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    bbr->processing_loss        = 1;
+    bbr->tx_time_of_last_loss   = info->largest_acked_time;
+    bbr_flush(bbr, 0);
+    return 1;
+}
+
+const OSSL_CC_METHOD ossl_cc_bbr_method = {
+    bbr_new,
+    bbr_free,
+    bbr_reset,
+    bbr_set_input_params,
+    bbr_bind_diagnostic,
+    bbr_unbind_diagnostic,
+    bbr_get_tx_allowance,
+    bbr_get_wakeup_deadline,
+    bbr_on_data_sent,
+    bbr_on_data_acked,
+    bbr_on_data_lost,
+    bbr_on_data_lost_finished,
+    bbr_on_data_invalidated,
+    bbr_on_ecn,
+};
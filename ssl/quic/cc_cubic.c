@@ -0,0 +1,548 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_cc.h"
+#include "internal/quic_pacer.h"
+#include "internal/quic_types.h"
+#include "internal/safe_math.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+/*
+ * CUBIC Congestion Controller (RFC 9438)
+ * ======================================
+ *
+ * Slow start, loss detection and recovery periods are handled as in NewReno.
+ * In congestion avoidance, the window follows the cubic function
+ *
+ *   W_cubic(t) = C * (t - K)^3 + W_max
+ *
+ * where t is the time since the start of the current congestion avoidance
+ * epoch, W_max is the window just before the last reduction and K is the time
+ * taken to grow back to W_max. Because growth does not depend on the RTT, the
+ * window recovers far faster than NewReno's one datagram per RTT on paths with
+ * a large bandwidth-delay product. The Reno-friendly estimate W_est ensures we
+ * are never less aggressive than NewReno would be on short-RTT paths.
+ */
+typedef struct ossl_cc_cubic_st {
+    /* Dependencies. */
+    OSSL_TIME   (*now_cb)(void *arg);
+    void        *now_cb_arg;
+
+    /* 'Constants' (which we allow to be configurable). */
+    uint64_t    k_init_wnd, k_min_wnd;
+
+    /* State. */
+    size_t      max_dgram_size;
+    uint64_t    bytes_in_flight, cong_wnd, slow_start_thresh;
+    OSSL_TIME   cong_recovery_start_time;
+
+    /* Cubic state for the current congestion avoidance epoch. */
+    OSSL_TIME   epoch_start;    /* zero if no epoch has started */
+    uint64_t    w_max;          /* window before the last reduction */
+    uint64_t    k_ms;           /* time to reach w_max from epoch start */
+    uint64_t    w_est;          /* Reno-friendly window estimate */
+    uint64_t    cubic_acc, est_acc; /* fractional window increases */
+
+    /* Unflushed state during multiple on-loss calls. */
+    int         processing_loss; /* 1 if not flushed */
+    OSSL_TIME   tx_time_of_last_loss;
+
+    /* Pacing of the congestion window over the smoothed RTT. */
+    OSSL_QUIC_PACER pacer;
+    OSSL_TIME   smoothed_rtt;
+
+    /* Diagnostic state. */
+    int         in_congestion_recovery;
+
+    /* Diagnostic output locations. */
+    OSSL_CC_DIAG diag;
+} OSSL_CC_CUBIC;
+
+#define MIN_MAX_INIT_WND_SIZE    14720  /* RFC 9002 s. 7.2 */
+
+/* C = 0.4 (RFC 9438 s. 5.1) */
+#define CUBIC_C_NUM             4
+#define CUBIC_C_DEN             10
+/* beta_cubic = 0.7 (RFC 9438 s. 4.6) */
+#define CUBIC_BETA_NUM          7
+#define CUBIC_BETA_DEN          10
+/* alpha_cubic = 3 * (1 - beta) / (1 + beta) = 9 / 17 (RFC 9438 s. 4.3) */
+#define CUBIC_ALPHA_NUM         9
+#define CUBIC_ALPHA_DEN         17
+
+static void cubic_set_max_dgram_size(OSSL_CC_CUBIC *cu,
+                                     size_t max_dgram_size);
+static void cubic_update_diag(OSSL_CC_CUBIC *cu);
+static void cubic_update_pacing(OSSL_CC_CUBIC *cu);
+
+static void cubic_reset(OSSL_CC_DATA *cc);
+
+static OSSL_CC_DATA *cubic_new(OSSL_TIME (*now_cb)(void *arg),
+                               void *now_cb_arg)
+{
+    OSSL_CC_CUBIC *cu;
+
+    if ((cu = OPENSSL_zalloc(sizeof(*cu))) == NULL)
+        return NULL;
+
+    cu->now_cb          = now_cb;
+    cu->now_cb_arg      = now_cb_arg;
+
+    cubic_set_max_dgram_size(cu, QUIC_MIN_INITIAL_DGRAM_LEN);
+    cubic_reset((OSSL_CC_DATA *)cu);
+
+    return (OSSL_CC_DATA *)cu;
+}
+
+static void cubic_free(OSSL_CC_DATA *cc)
+{
+    OPENSSL_free(cc);
+}
+
+static void cubic_set_max_dgram_size(OSSL_CC_CUBIC *cu,
+                                     size_t max_dgram_size)
+{
+    size_t max_init_wnd;
+    int is_reduced = (max_dgram_size < cu->max_dgram_size);
+
+    cu->max_dgram_size = max_dgram_size;
+
+    max_init_wnd = 2 * max_dgram_size;
+    if (max_init_wnd < MIN_MAX_INIT_WND_SIZE)
+        max_init_wnd = MIN_MAX_INIT_WND_SIZE;
+
+    cu->k_init_wnd = 10 * max_dgram_size;
+    if (cu->k_init_wnd > max_init_wnd)
+        cu->k_init_wnd = max_init_wnd;
+
+    cu->k_min_wnd = 2 * max_dgram_size;
+
+    if (is_reduced)
+        cu->cong_wnd = cu->k_init_wnd;
+
+    cubic_update_pacing(cu);
+    cubic_update_diag(cu);
+}
+
+static void cubic_update_pacing(OSSL_CC_CUBIC *cu)
+{
+    uint64_t rate = ossl_quic_pacer_rate_from_cwnd(cu->cong_wnd,
+                                                   cu->smoothed_rtt);
+
+    if (rate == 0 && cu->pacer.rate == 0)
+        return;
+
+    ossl_quic_pacer_set_rate(&cu->pacer, rate, cu->max_dgram_size,
+                             cu->k_init_wnd, cu->now_cb(cu->now_cb_arg));
+}
+
+static void cubic_reset_epoch(OSSL_CC_CUBIC *cu)
+{
+    cu->epoch_start = ossl_time_zero();
+    cu->cubic_acc   = 0;
+    cu->est_acc     = 0;
+}
+
+static void cubic_reset(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->cong_wnd                    = cu->k_init_wnd;
+    cu->bytes_in_flight             = 0;
+    cu->slow_start_thresh           = UINT64_MAX;
+    cu->cong_recovery_start_time    = ossl_time_zero();
+
+    cu->w_max                       = 0;
+    cu->k_ms                        = 0;
+    cu->w_est                       = 0;
+    cubic_reset_epoch(cu);
+
+    cu->processing_loss         = 0;
+    cu->tx_time_of_last_loss    = ossl_time_zero();
+    cu->in_congestion_recovery  = 0;
+
+    cu->smoothed_rtt            = ossl_time_zero();
+    ossl_quic_pacer_init(&cu->pacer);
+}
+
+static int cubic_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+    size_t max_dgram_size;
+
+    if (!ossl_cc_get_input_params(params, &max_dgram_size))
+        return 0;
+    if (max_dgram_size != 0)
+        cubic_set_max_dgram_size(cu, max_dgram_size);
+    return 1;
+}
+
+static int cubic_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    if (!ossl_cc_diag_bind(&cu->diag, params))
+        return 0;
+
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    ossl_cc_diag_unbind(&cu->diag, params);
+    return 1;
+}
+
+static void cubic_update_diag(OSSL_CC_CUBIC *cu)
+{
+    uint32_t state;
+
+    if (cu->in_congestion_recovery)
+        state = 'R';
+    else if (cu->cong_wnd < cu->slow_start_thresh)
+        state = 'S';
+    else
+        state = 'A';
+
+    ossl_cc_diag_update(&cu->diag, cu->max_dgram_size, cu->cong_wnd,
+                        cu->k_min_wnd, cu->bytes_in_flight, state);
+}
+
+/* Integer cube root, rounded down. */
+static uint64_t cubic_cbrt(uint64_t x)
+{
+    uint64_t y = 0, b;
+    int s;
+
+    for (s = 63; s >= 0; s -= 3) {
+        y <<= 1;
+        b = 3 * y * (y + 1) + 1;
+        if ((x >> s) >= b) {
+            x -= b << s;
+            ++y;
+        }
+    }
+
+    return y;
+}
+
+/*
+ * Computes |W_cubic(t) - W_max| in bytes for a distance d_ms (in milliseconds)
+ * from K, i.e. C * mss * (d_ms / 1000)^3. Saturates on overflow.
+ */
+static uint64_t cubic_delta(OSSL_CC_CUBIC *cu, uint64_t d_ms)
+{
+    uint64_t v;
+    int err = 0;
+
+    v = safe_mul_u64(d_ms, d_ms, &err);
+    v = safe_mul_u64(v, d_ms, &err);
+    v = safe_muldiv_u64(v, (uint64_t)CUBIC_C_NUM * cu->max_dgram_size,
+                        (uint64_t)CUBIC_C_DEN * 1000000000, &err);
+    return err ? UINT64_MAX : v;
+}
+
+/* Starts a new congestion avoidance epoch (RFC 9438 s. 4.2). */
+static void cubic_start_epoch(OSSL_CC_CUBIC *cu, OSSL_TIME now)
+{
+    uint64_t v;
+    int err = 0;
+
+    cu->epoch_start = now;
+    cu->cubic_acc   = 0;
+    cu->est_acc     = 0;
+    cu->w_est       = cu->cong_wnd;
+
+    if (cu->w_max <= cu->cong_wnd) {
+        cu->w_max   = cu->cong_wnd;
+        cu->k_ms    = 0;
+        return;
+    }
+
+    /* K = cbrt((W_max - cwnd) / (C * mss)), in milliseconds. */
+    v = safe_muldiv_u64(cu->w_max - cu->cong_wnd,
+                        (uint64_t)CUBIC_C_DEN * 1000000000,
+                        (uint64_t)CUBIC_C_NUM * cu->max_dgram_size, &err);
+    cu->k_ms = cubic_cbrt(err ? UINT64_MAX : v);
+}
+
+/* Congestion avoidance window increase for tx_size newly acked bytes. */
+static void cubic_on_ack_ca(OSSL_CC_CUBIC *cu, uint64_t tx_size)
+{
+    OSSL_TIME now = cu->now_cb(cu->now_cb_arg);
+    uint64_t t_ms, delta, target, max_target, incr;
+    uint64_t alpha_num;
+
+    if (ossl_time_is_zero(cu->epoch_start))
+        cubic_start_epoch(cu, now);
+
+    /* Aim for the window one RTT from now (RFC 9438 s. 4.2). */
+    t_ms = ossl_time2ms(ossl_time_subtract(now, cu->epoch_start))
+           + ossl_time2ms(cu->smoothed_rtt);
+
+    if (t_ms < cu->k_ms) {
+        delta = cubic_delta(cu, cu->k_ms - t_ms);
+        target = delta < cu->w_max ? cu->w_max - delta : 0;
+    } else {
+        delta = cubic_delta(cu, t_ms - cu->k_ms);
+        target = delta < UINT64_MAX - cu->w_max ? cu->w_max + delta : UINT64_MAX;
+    }
+
+    /* Limit growth to 1.5x per RTT and never shrink in response to an ACK. */
+    max_target = cu->cong_wnd + cu->cong_wnd / 2;
+    if (target > max_target)
+        target = max_target;
+    if (target < cu->cong_wnd)
+        target = cu->cong_wnd;
+
+    /* cwnd += (target - cwnd) / cwnd per acked byte, without losing remainders. */
+    cu->cubic_acc += (target - cu->cong_wnd) * tx_size;
+    incr = cu->cubic_acc / cu->cong_wnd;
+    cu->cubic_acc -= incr * cu->cong_wnd;
+
+    /*
+     * Reno-friendly region (RFC 9438 s. 4.3). Once W_est exceeds W_max we
+     * grow at the same rate as NewReno.
+     */
+    alpha_num = cu->w_est >= cu->w_max ? CUBIC_ALPHA_DEN : CUBIC_ALPHA_NUM;
+    cu->est_acc += tx_size * cu->max_dgram_size * alpha_num / CUBIC_ALPHA_DEN;
+    if (cu->w_est > 0) {
+        cu->w_est   += cu->est_acc / cu->w_est;
+        cu->est_acc %= cu->w_est;
+    }
+
+    cu->cong_wnd += incr;
+    if (cu->w_est > cu->cong_wnd)
+        cu->cong_wnd = cu->w_est;
+}
+
+static int cubic_in_cong_recovery(OSSL_CC_CUBIC *cu, OSSL_TIME tx_time)
+{
+    return ossl_time_compare(tx_time, cu->cong_recovery_start_time) <= 0;
+}
+
+static void cubic_cong(OSSL_CC_CUBIC *cu, OSSL_TIME tx_time)
+{
+    int err = 0;
+
+    /* No reaction if already in a recovery period. */
+    if (cubic_in_cong_recovery(cu, tx_time))
+        return;
+
+    /* Start a new recovery period. */
+    cu->in_congestion_recovery = 1;
+    cu->cong_recovery_start_time = cu->now_cb(cu->now_cb_arg);
+
+    /*
+     * Fast convergence (RFC 9438 s. 4.7): if the window did not get back up to
+     * the previous W_max, release bandwidth for new flows by remembering a
+     * lower maximum.
+     */
+    if (cu->cong_wnd < cu->w_max)
+        cu->w_max = safe_muldiv_u64(cu->cong_wnd,
+                                    CUBIC_BETA_DEN + CUBIC_BETA_NUM,
+                                    2 * CUBIC_BETA_DEN, &err);
+    else
+        cu->w_max = cu->cong_wnd;
+
+    cu->slow_start_thresh
+        = safe_muldiv_u64(cu->cong_wnd, CUBIC_BETA_NUM, CUBIC_BETA_DEN, &err);
+
+    if (err) {
+        cu->w_max               = UINT64_MAX;
+        cu->slow_start_thresh   = UINT64_MAX;
+    }
+
+    cu->cong_wnd = cu->slow_start_thresh;
+    if (cu->cong_wnd < cu->k_min_wnd)
+        cu->cong_wnd = cu->k_min_wnd;
+
+    cubic_reset_epoch(cu);
+}
+
+static void cubic_flush(OSSL_CC_CUBIC *cu, uint32_t flags)
+{
+    if (!cu->processing_loss)
+        return;
+
+    cubic_cong(cu, cu->tx_time_of_last_loss);
+
+    if ((flags & OSSL_CC_LOST_FLAG_PERSISTENT_CONGESTION) != 0) {
+        cu->cong_wnd                    = cu->k_min_wnd;
+        cu->cong_recovery_start_time    = ossl_time_zero();
+        cubic_reset_epoch(cu);
+    }
+
+    cu->processing_loss = 0;
+    cubic_update_pacing(cu);
+    cubic_update_diag(cu);
+}
+
+static uint64_t cubic_get_tx_allowance(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+    uint64_t cwnd_rem, paced;
+
+    if (cu->bytes_in_flight >= cu->cong_wnd)
+        return 0;
+
+    cwnd_rem = cu->cong_wnd - cu->bytes_in_flight;
+    paced = ossl_quic_pacer_get_allowance(&cu->pacer,
+                                          cu->now_cb(cu->now_cb_arg));
+    return paced < cwnd_rem ? paced : cwnd_rem;
+}
+
+static OSSL_TIME cubic_get_wakeup_deadline(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    /* The window only grows in response to ACKs. */
+    if (cu->bytes_in_flight >= cu->cong_wnd)
+        return ossl_time_infinite();
+
+    return ossl_quic_pacer_get_deadline(&cu->pacer,
+                                        cu->now_cb(cu->now_cb_arg));
+}
+
+static int cubic_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->bytes_in_flight += num_bytes;
+    ossl_quic_pacer_on_data_sent(&cu->pacer, num_bytes,
+                                 cu->now_cb(cu->now_cb_arg));
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_is_cong_limited(OSSL_CC_CUBIC *cu)
+{
+    uint64_t wnd_rem;
+
+    if (cu->bytes_in_flight >= cu->cong_wnd)
+        return 1;
+
+    wnd_rem = cu->cong_wnd - cu->bytes_in_flight;
+
+    /* As for NewReno. */
+    return (cu->cong_wnd < cu->slow_start_thresh && wnd_rem <= cu->cong_wnd / 2)
+           || wnd_rem <= 3 * cu->max_dgram_size;
+}
+
+static int cubic_on_data_acked(OSSL_CC_DATA *cc,
+                               const OSSL_CC_ACK_INFO *info)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->bytes_in_flight -= info->tx_size;
+
+    if (!ossl_time_is_zero(info->smoothed_rtt))
+        cu->smoothed_rtt = info->smoothed_rtt;
+
+    /*
+     * Do not grow the window when the application is not using it
+     * (RFC 9438 s. 5.8). Growth of the cubic function is limited to 1.5x per
+     * RTT, so we do not jump ahead once we become congestion-limited again.
+     */
+    if (!cubic_is_cong_limited(cu))
+        goto out;
+
+    if (cubic_in_cong_recovery(cu, info->tx_time)) {
+        /* Congestion recovery, do nothing. */
+    } else if (cu->cong_wnd < cu->slow_start_thresh) {
+        /* Slow start. */
+        cu->cong_wnd += info->tx_size;
+        cu->in_congestion_recovery = 0;
+    } else {
+        /* Congestion avoidance. */
+        cubic_on_ack_ca(cu, info->tx_size);
+        cu->in_congestion_recovery = 0;
+    }
+
+out:
+    cubic_update_pacing(cu);
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_on_data_lost(OSSL_CC_DATA *cc,
+                              const OSSL_CC_LOSS_INFO *info)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    if (info->tx_size > cu->bytes_in_flight)
+        return 0;
+
+    cu->bytes_in_flight -= info->tx_size;
+
+    if (!cu->processing_loss) {
+        if (ossl_time_compare(info->tx_time, cu->tx_time_of_last_loss) <= 0)
+            /* Already reacted to a loss at or after this point. */
+            goto out;
+
+        cu->processing_loss = 1;
+    }
+
+    cu->tx_time_of_last_loss
+        = ossl_time_max(cu->tx_time_of_last_loss, info->tx_time);
+
+out:
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_on_data_lost_finished(OSSL_CC_DATA *cc, uint32_t flags)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cubic_flush(cu, flags);
+    return 1;
+}
+
+static int cubic_on_data_invalidated(OSSL_CC_DATA *cc,
+                                     uint64_t num_bytes)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->bytes_in_flight -= num_bytes;
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_on_ecn(OSSL_CC_DATA *cc,
+                        const OSSL_CC_ECN_INFO *info)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->processing_loss         = 1;
+    cu->tx_time_of_last_loss    = info->largest_acked_time;
+    cubic_flush(cu, 0);
+    return 1;
+}
+
+const OSSL_CC_METHOD ossl_cc_cubic_method = {
+    cubic_new,
+    cubic_free,
+    cubic_reset,
+    cubic_set_input_params,
+    cubic_bind_diagnostic,
+    cubic_unbind_diagnostic,
+    cubic_get_tx_allowance,
+    cubic_get_wakeup_deadline,
+    cubic_on_data_sent,
+    cubic_on_data_acked,
+    cubic_on_data_lost,
+    cubic_on_data_lost_finished,
+    cubic_on_data_invalidated,
+    cubic_on_ecn,
+};
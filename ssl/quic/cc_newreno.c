@@ -1,4 +1,5 @@
 #include "internal/quic_cc.h"
+#include "internal/quic_pacer.h"
 #include "internal/quic_types.h"
 #include "internal/safe_math.h"
 
@@ -23,24 +24,23 @@ typedef struct ossl_cc_newreno_st {
     int         processing_loss; /* 1 if not flushed */
     OSSL_TIME   tx_time_of_last_loss;
 
+    /* Pacing of the congestion window over the smoothed RTT. */
+    OSSL_QUIC_PACER pacer;
+    OSSL_TIME   smoothed_rtt;
+
     /* Diagnostic state. */
     int         in_congestion_recovery;
 
     /* Diagnostic output locations. */
-    size_t      *p_diag_max_dgram_payload_len;
-    uint64_t    *p_diag_cur_cwnd_size;
-    uint64_t    *p_diag_min_cwnd_size;
-    uint64_t    *p_diag_cur_bytes_in_flight;
-    uint32_t    *p_diag_cur_state;
+    OSSL_CC_DIAG diag;
 } OSSL_CC_NEWRENO;
 
 #define MIN_MAX_INIT_WND_SIZE    14720  /* RFC 9002 s. 7.2 */
 
-/* TODO(QUIC FUTURE): Pacing support. */
-
 static void newreno_set_max_dgram_size(OSSL_CC_NEWRENO *nr,
                                        size_t max_dgram_size);
 static void newreno_update_diag(OSSL_CC_NEWRENO *nr);
+static void newreno_update_pacing(OSSL_CC_NEWRENO *nr);
 
 static void newreno_reset(OSSL_CC_DATA *cc);
 
@@ -87,9 +87,27 @@ static void newreno_set_max_dgram_size(OSSL_CC_NEWRENO *nr,
     if (is_reduced)
         nr->cong_wnd = nr->k_init_wnd;
 
+    newreno_update_pacing(nr);
     newreno_update_diag(nr);
 }
 
+/*
+ * Recompute the pacing rate after a change to the congestion window, the RTT
+ * estimate or the datagram size. Bursts are limited to the initial window as
+ * recommended by RFC 9002 s. 7.7.
+ */
+static void newreno_update_pacing(OSSL_CC_NEWRENO *nr)
+{
+    uint64_t rate = ossl_quic_pacer_rate_from_cwnd(nr->cong_wnd,
+                                                   nr->smoothed_rtt);
+
+    if (rate == 0 && nr->pacer.rate == 0)
+        return;
+
+    ossl_quic_pacer_set_rate(&nr->pacer, rate, nr->max_dgram_size,
+                             nr->k_init_wnd, nr->now_cb(nr->now_cb_arg));
+}
+
 static void newreno_reset(OSSL_CC_DATA *cc)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
@@ -107,133 +125,55 @@ static void newreno_reset(OSSL_CC_DATA *cc)
     nr->processing_loss         = 0;
     nr->tx_time_of_last_loss    = ossl_time_zero();
     nr->in_congestion_recovery  = 0;
+
+    nr->smoothed_rtt            = ossl_time_zero();
+    ossl_quic_pacer_init(&nr->pacer);
 }
 
 static int newreno_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
-    const OSSL_PARAM *p;
-    size_t value;
-
-    p = OSSL_PARAM_locate_const(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN);
-    if (p != NULL) {
-        if (!OSSL_PARAM_get_size_t(p, &value))
-            return 0;
-        if (value < QUIC_MIN_INITIAL_DGRAM_LEN)
-            return 0;
-
-        newreno_set_max_dgram_size(nr, value);
-    }
-
-    return 1;
-}
-
-static int bind_diag(OSSL_PARAM *params, const char *param_name, size_t len,
-                     void **pp)
-{
-    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
+    size_t max_dgram_size;
 
-    *pp = NULL;
-
-    if (p == NULL)
-        return 1;
-
-    if (p->data_type != OSSL_PARAM_UNSIGNED_INTEGER
-        || p->data_size != len)
+    if (!ossl_cc_get_input_params(params, &max_dgram_size))
         return 0;
-
-    *pp = p->data;
+    if (max_dgram_size != 0)
+        newreno_set_max_dgram_size(nr, max_dgram_size);
     return 1;
 }
 
 static int newreno_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
-    size_t *new_p_max_dgram_payload_len;
-    uint64_t *new_p_cur_cwnd_size;
-    uint64_t *new_p_min_cwnd_size;
-    uint64_t *new_p_cur_bytes_in_flight;
-    uint32_t *new_p_cur_state;
-
-    if (!bind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
-                   sizeof(size_t), (void **)&new_p_max_dgram_payload_len)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
-                      sizeof(uint64_t), (void **)&new_p_cur_cwnd_size)
-        || !bind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
-                      sizeof(uint64_t), (void **)&new_p_min_cwnd_size)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
-                      sizeof(uint64_t), (void **)&new_p_cur_bytes_in_flight)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_STATE,
-                      sizeof(uint32_t), (void **)&new_p_cur_state))
-        return 0;
 
-    if (new_p_max_dgram_payload_len != NULL)
-        nr->p_diag_max_dgram_payload_len = new_p_max_dgram_payload_len;
-
-    if (new_p_cur_cwnd_size != NULL)
-        nr->p_diag_cur_cwnd_size = new_p_cur_cwnd_size;
-
-    if (new_p_min_cwnd_size != NULL)
-        nr->p_diag_min_cwnd_size = new_p_min_cwnd_size;
-
-    if (new_p_cur_bytes_in_flight != NULL)
-        nr->p_diag_cur_bytes_in_flight = new_p_cur_bytes_in_flight;
-
-    if (new_p_cur_state != NULL)
-        nr->p_diag_cur_state = new_p_cur_state;
+    if (!ossl_cc_diag_bind(&nr->diag, params))
+        return 0;
 
     newreno_update_diag(nr);
     return 1;
 }
 
-static void unbind_diag(OSSL_PARAM *params, const char *param_name,
-                        void **pp)
-{
-    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
-
-    if (p != NULL)
-        *pp = NULL;
-}
-
 static int newreno_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
 
-    unbind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
-                (void **)&nr->p_diag_max_dgram_payload_len);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
-                (void **)&nr->p_diag_cur_cwnd_size);
-    unbind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
-                (void **)&nr->p_diag_min_cwnd_size);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
-                (void **)&nr->p_diag_cur_bytes_in_flight);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_STATE,
-                (void **)&nr->p_diag_cur_state);
+    ossl_cc_diag_unbind(&nr->diag, params);
     return 1;
 }
 
 static void newreno_update_diag(OSSL_CC_NEWRENO *nr)
 {
-    if (nr->p_diag_max_dgram_payload_len != NULL)
-        *nr->p_diag_max_dgram_payload_len = nr->max_dgram_size;
-
-    if (nr->p_diag_cur_cwnd_size != NULL)
-        *nr->p_diag_cur_cwnd_size = nr->cong_wnd;
-
-    if (nr->p_diag_min_cwnd_size != NULL)
-        *nr->p_diag_min_cwnd_size = nr->k_min_wnd;
+    uint32_t state;
 
-    if (nr->p_diag_cur_bytes_in_flight != NULL)
-        *nr->p_diag_cur_bytes_in_flight = nr->bytes_in_flight;
+    if (nr->in_congestion_recovery)
+        state = 'R';
+    else if (nr->cong_wnd < nr->slow_start_thresh)
+        state = 'S';
+    else
+        state = 'A';
 
-    if (nr->p_diag_cur_state != NULL) {
-        if (nr->in_congestion_recovery)
-            *nr->p_diag_cur_state = 'R';
-        else if (nr->cong_wnd < nr->slow_start_thresh)
-            *nr->p_diag_cur_state = 'S';
-        else
-            *nr->p_diag_cur_state = 'A';
-    }
+    ossl_cc_diag_update(&nr->diag, nr->max_dgram_size, nr->cong_wnd,
+                        nr->k_min_wnd, nr->bytes_in_flight, state);
 }
 
 static int newreno_in_cong_recovery(OSSL_CC_NEWRENO *nr, OSSL_TIME tx_time)
@@ -281,31 +221,41 @@ static void newreno_flush(OSSL_CC_NEWRENO *nr, uint32_t flags)
     }
 
     nr->processing_loss = 0;
+    newreno_update_pacing(nr);
     newreno_update_diag(nr);
 }
 
 static uint64_t newreno_get_tx_allowance(OSSL_CC_DATA *cc)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
+    uint64_t cwnd_rem, paced;
 
     if (nr->bytes_in_flight >= nr->cong_wnd)
         return 0;
 
-    return nr->cong_wnd - nr->bytes_in_flight;
+    cwnd_rem = nr->cong_wnd - nr->bytes_in_flight;
+    paced = ossl_quic_pacer_get_allowance(&nr->pacer,
+                                          nr->now_cb(nr->now_cb_arg));
+    return paced < cwnd_rem ? paced : cwnd_rem;
 }
 
 static OSSL_TIME newreno_get_wakeup_deadline(OSSL_CC_DATA *cc)
 {
-    if (newreno_get_tx_allowance(cc) > 0) {
-        /* We have TX allowance now so wakeup immediately */
-        return ossl_time_zero();
-    } else {
+    OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
+
+    if (nr->bytes_in_flight >= nr->cong_wnd)
         /*
-         * The NewReno congestion controller does not vary its state in time,
-         * only in response to stimulus.
+         * The NewReno congestion window does not vary in time, only in
+         * response to stimulus.
          */
         return ossl_time_infinite();
-    }
+
+    /*
+     * There is room in the congestion window, so we can send as soon as the
+     * pacer allows it (immediately if we are not pacing).
+     */
+    return ossl_quic_pacer_get_deadline(&nr->pacer,
+                                        nr->now_cb(nr->now_cb_arg));
 }
 
 static int newreno_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
@@ -313,6 +263,8 @@ static int newreno_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
 
     nr->bytes_in_flight += num_bytes;
+    ossl_quic_pacer_on_data_sent(&nr->pacer, num_bytes,
+                                 nr->now_cb(nr->now_cb_arg));
     newreno_update_diag(nr);
     return 1;
 }
@@ -347,6 +299,9 @@ static int newreno_on_data_acked(OSSL_CC_DATA *cc,
      */
     nr->bytes_in_flight -= info->tx_size;
 
+    if (!ossl_time_is_zero(info->smoothed_rtt))
+        nr->smoothed_rtt = info->smoothed_rtt;
+
     /*
      * We use acknowledgement of data as a signal that we are not at channel
      * capacity and that it may be reasonable to increase the congestion window.
@@ -396,6 +351,7 @@ static int newreno_on_data_acked(OSSL_CC_DATA *cc,
     }
 
 out:
+    newreno_update_pacing(nr);
     newreno_update_diag(nr);
     return 1;
 }
@@ -985,6 +985,12 @@ static void ackm_on_pkts_acked(OSSL_ACKM *ackm, const OSSL_ACKM_TX_PKT *apkt)
     const OSSL_ACKM_TX_PKT *anext;
     QUIC_PN last_pn_acked = 0;
     OSSL_CC_ACK_INFO ainfo = {0};
+    OSSL_RTT_INFO rtt;
+
+    /* The RTT estimate has already been updated for this ACK frame */
+    ossl_statm_get_rtt_info(ackm->statm, &rtt);
+    if (!ossl_time_is_zero(rtt.latest_rtt))
+        ainfo.smoothed_rtt = rtt.smoothed_rtt;
 
     for (; apkt != NULL; apkt = anext) {
         if (apkt->is_inflight) {
@@ -1677,6 +1683,14 @@ void ossl_ackm_set_ack_deadline_callback(OSSL_ACKM *ackm,
     ackm->ack_deadline_cb_arg = arg;
 }
 
+void ossl_ackm_set_cc(OSSL_ACKM *ackm,
+                      const OSSL_CC_METHOD *cc_method,
+                      OSSL_CC_DATA *cc_data)
+{
+    ackm->cc_method = cc_method;
+    ackm->cc_data   = cc_data;
+}
+
 int ossl_ackm_mark_packet_pseudo_lost(OSSL_ACKM *ackm,
                                       int pkt_space, QUIC_PN pn)
 {
@@ -158,6 +158,20 @@ static QLOG *ch_get_qlog_cb(void *arg)
 
 #define DEFAULT_INIT_CONN_MAX_STREAMS           100
 
+static const OSSL_CC_METHOD *ch_get_cc_method(uint32_t alg)
+{
+    switch (alg) {
+    case SSL_VALUE_QUIC_CC_ALGORITHM_NEWRENO:
+        return &ossl_cc_newreno_method;
+    case SSL_VALUE_QUIC_CC_ALGORITHM_CUBIC:
+        return &ossl_cc_cubic_method;
+    case SSL_VALUE_QUIC_CC_ALGORITHM_BBR:
+        return &ossl_cc_bbr_method;
+    default:
+        return NULL;
+    }
+}
+
 static int ch_init(QUIC_CHANNEL *ch)
 {
     OSSL_QUIC_TX_PACKETISER_ARGS txp_args = {0};
@@ -239,7 +253,9 @@ static int ch_init(QUIC_CHANNEL *ch)
         goto err;
 
     ch->have_statm = 1;
-    ch->cc_method = &ossl_cc_newreno_method;
+    if ((ch->cc_method = ch_get_cc_method(ch->cc_algorithm)) == NULL)
+        goto err;
+
     if ((ch->cc_data = ch->cc_method->new(get_time, ch)) == NULL)
         goto err;
 
@@ -428,6 +444,7 @@ QUIC_CHANNEL *ossl_quic_channel_new(const QUIC_CHANNEL_ARGS *args)
     ch->tls         = args->tls;
     ch->lcidm       = args->lcidm;
     ch->srtm        = args->srtm;
+    ch->cc_algorithm = args->cc_algorithm;
 #ifndef OPENSSL_NO_QLOG
     ch->use_qlog    = args->use_qlog;
 
@@ -3698,6 +3715,39 @@ uint64_t ossl_quic_channel_get_max_idle_timeout_peer_request(const QUIC_CHANNEL
     return ch->max_idle_timeout_remote_req;
 }
 
+int ossl_quic_channel_set_cc_algorithm(QUIC_CHANNEL *ch, uint32_t alg)
+{
+    const OSSL_CC_METHOD *cc_method;
+    OSSL_CC_DATA *cc_data;
+
+    if (ch->state != QUIC_CHANNEL_STATE_IDLE)
+        return 0;
+
+    if ((cc_method = ch_get_cc_method(alg)) == NULL)
+        return 0;
+
+    if (alg == ch->cc_algorithm)
+        return 1;
+
+    if ((cc_data = cc_method->new(get_time, ch)) == NULL)
+        return 0;
+
+    /* Nothing has been sent yet, so there is no state to carry over. */
+    ossl_ackm_set_cc(ch->ackm, cc_method, cc_data);
+    ossl_quic_tx_packetiser_set_cc(ch->txp, cc_method, cc_data);
+    ch->cc_method->free(ch->cc_data);
+
+    ch->cc_method       = cc_method;
+    ch->cc_data         = cc_data;
+    ch->cc_algorithm    = alg;
+    return 1;
+}
+
+uint32_t ossl_quic_channel_get_cc_algorithm(const QUIC_CHANNEL *ch)
+{
+    return ch->cc_algorithm;
+}
+
 uint64_t ossl_quic_channel_get_max_idle_timeout_actual(const QUIC_CHANNEL *ch)
 {
     return ch->max_idle_timeout;
@@ -36,6 +36,12 @@ struct quic_channel_st {
      */
     OSSL_LIST_MEMBER(ch, struct quic_channel_st);
 
+    /*
+     * Incoming channels which have not yet been handed to the application are
+     * also kept on a second list by the QUIC_PORT, forming its accept queue.
+     */
+    OSSL_LIST_MEMBER(incoming_ch, struct quic_channel_st);
+
     /*
      * The associated TLS 1.3 connection data. Used to provide the handshake
      * layer; its 'network' side is plugged into the crypto stream for each EL
@@ -79,6 +85,7 @@ struct quic_channel_st {
     OSSL_STATM                      statm;
     OSSL_CC_DATA                    *cc_data;
     const OSSL_CC_METHOD            *cc_method;
+    uint32_t                        cc_algorithm;
     OSSL_ACKM                       *ackm;
 
     /* Record layers in the TX and RX directions. */
@@ -42,6 +42,9 @@ static int qc_blocking_mode(const QUIC_CONNECTION *qc);
 static int xso_blocking_mode(const QUIC_XSO *xso);
 static void qctx_maybe_autotick(QCTX *ctx);
 static int qctx_should_autotick(QCTX *ctx);
+static void ql_free(QUIC_LISTENER *ql);
+static void ql_set0_net_bio(QUIC_LISTENER *ql, BIO *net_bio, int for_write);
+static void ql_update_blocking_mode(QUIC_LISTENER *ql);
 
 /*
  * QUIC Front-End I/O API: Common Utilities
@@ -226,6 +229,10 @@ static int expect_quic(const SSL *s, QCTX *ctx)
         ctx->in_io      = 0;
         return 1;
 
+    case SSL_TYPE_QUIC_LISTENER:
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_UNSUPPORTED,
+                                           "not supported on a QUIC listener");
+
     default:
         return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
     }
@@ -359,6 +366,35 @@ static int quic_mutation_allowed(QUIC_CONNECTION *qc, int req_active)
     return 1;
 }
 
+static void ql_lock(QUIC_LISTENER *ql)
+{
+#if defined(OPENSSL_THREADS)
+    ossl_crypto_mutex_lock(ql->mutex);
+#endif
+}
+
+QUIC_NEEDS_LOCK
+static void ql_unlock(QUIC_LISTENER *ql)
+{
+#if defined(OPENSSL_THREADS)
+    ossl_crypto_mutex_unlock(ql->mutex);
+#endif
+}
+
+/*
+ * A connection accepted from a listener has no network BIOs of its own and
+ * uses those of the listener instead.
+ */
+static BIO *qc_get_net_rbio(const QUIC_CONNECTION *qc)
+{
+    return qc->listener != NULL ? qc->listener->net_rbio : qc->net_rbio;
+}
+
+static BIO *qc_get_net_wbio(const QUIC_CONNECTION *qc)
+{
+    return qc->listener != NULL ? qc->listener->net_wbio : qc->net_wbio;
+}
+
 /*
  * QUIC Front-End I/O API: Initialization
  * ======================================
@@ -383,6 +419,12 @@ SSL *ossl_quic_new(SSL_CTX *ctx)
     SSL *ssl_base = NULL;
     SSL_CONNECTION *sc = NULL;
 
+    if (ctx->method == OSSL_QUIC_server_method()) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED,
+                                    "use SSL_new_listener for QUIC servers");
+        return NULL;
+    }
+
     qc = OPENSSL_zalloc(sizeof(*qc));
     if (qc == NULL) {
         QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
@@ -421,7 +463,8 @@ SSL *ossl_quic_new(SSL_CTX *ctx)
         = (ssl_base->method == OSSL_QUIC_client_thread_method());
 #endif
 
-    qc->as_server       = 0; /* TODO(QUIC SERVER): add server support */
+    /* Server connections are only ever created by a listener. */
+    qc->as_server       = 0;
     qc->as_server_state = qc->as_server;
 
     qc->default_stream_mode     = SSL_DEFAULT_STREAM_MODE_AUTO_BIDI;
@@ -469,8 +512,14 @@ QUIC_TAKES_LOCK
 void ossl_quic_free(SSL *s)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
     int is_default;
 
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_free(ql);
+        return;
+    }
+
     /* We should never be called on anything but a QSO. */
     if (!expect_quic(s, &ctx))
         return;
@@ -549,6 +598,14 @@ void ossl_quic_free(SSL *s)
     SSL_free(ctx.qc->tls);
 
     ossl_quic_channel_free(ctx.qc->ch);
+
+    if (ctx.qc->listener != NULL) {
+        /* The engine, port and mutex belong to the listener. */
+        quic_unlock(ctx.qc);
+        SSL_free(&ctx.qc->listener->ssl);
+        return;
+    }
+
     ossl_quic_port_free(ctx.qc->port);
     ossl_quic_engine_free(ctx.qc->engine);
 
@@ -875,6 +932,12 @@ static void qc_update_blocking_mode(QUIC_CONNECTION *qc)
 void ossl_quic_conn_set0_net_rbio(SSL *s, BIO *net_rbio)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_set0_net_bio(ql, net_rbio, /*for_write=*/0);
+        return;
+    }
 
     if (!expect_quic(s, &ctx))
         return;
@@ -882,6 +945,12 @@ void ossl_quic_conn_set0_net_rbio(SSL *s, BIO *net_rbio)
     if (ctx.qc->net_rbio == net_rbio)
         return;
 
+    if (ctx.qc->listener != NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED,
+                                    "connection uses the network BIOs of its listener");
+        return;
+    }
+
     if (!ossl_quic_port_set_net_rbio(ctx.qc->port, net_rbio))
         return;
 
@@ -902,6 +971,12 @@ void ossl_quic_conn_set0_net_rbio(SSL *s, BIO *net_rbio)
 void ossl_quic_conn_set0_net_wbio(SSL *s, BIO *net_wbio)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_set0_net_bio(ql, net_wbio, /*for_write=*/1);
+        return;
+    }
 
     if (!expect_quic(s, &ctx))
         return;
@@ -909,6 +984,12 @@ void ossl_quic_conn_set0_net_wbio(SSL *s, BIO *net_wbio)
     if (ctx.qc->net_wbio == net_wbio)
         return;
 
+    if (ctx.qc->listener != NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED,
+                                    "connection uses the network BIOs of its listener");
+        return;
+    }
+
     if (!ossl_quic_port_set_net_wbio(ctx.qc->port, net_wbio))
         return;
 
@@ -929,26 +1010,38 @@ void ossl_quic_conn_set0_net_wbio(SSL *s, BIO *net_wbio)
 BIO *ossl_quic_conn_get_net_rbio(const SSL *s)
 {
     QCTX ctx;
+    const QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_CONST_SSL(s)) != NULL)
+        return ql->net_rbio;
 
     if (!expect_quic(s, &ctx))
         return NULL;
 
-    return ctx.qc->net_rbio;
+    return qc_get_net_rbio(ctx.qc);
 }
 
 BIO *ossl_quic_conn_get_net_wbio(const SSL *s)
 {
     QCTX ctx;
+    const QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_CONST_SSL(s)) != NULL)
+        return ql->net_wbio;
 
     if (!expect_quic(s, &ctx))
         return NULL;
 
-    return ctx.qc->net_wbio;
+    return qc_get_net_wbio(ctx.qc);
 }
 
 int ossl_quic_conn_get_blocking_mode(const SSL *s)
 {
     QCTX ctx;
+    const QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_CONST_SSL(s)) != NULL)
+        return ql->blocking;
 
     if (!expect_quic(s, &ctx))
         return 0;
@@ -964,6 +1057,23 @@ int ossl_quic_conn_set_blocking_mode(SSL *s, int blocking)
 {
     int ret = 0;
     QCTX ctx;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_lock(ql);
+        ossl_quic_port_update_poll_descriptors(ql->port);
+        if (blocking
+            && !(ossl_quic_reactor_can_poll_r(ossl_quic_engine_get0_reactor(ql->engine))
+                 && ossl_quic_reactor_can_poll_w(ossl_quic_engine_get0_reactor(ql->engine)))) {
+            ql_unlock(ql);
+            return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_UNSUPPORTED, NULL);
+        }
+
+        ql->desires_blocking = (blocking != 0);
+        ql_update_blocking_mode(ql);
+        ql_unlock(ql);
+        return 1;
+    }
 
     if (!expect_quic(s, &ctx))
         return 0;
@@ -1060,6 +1170,14 @@ QUIC_TAKES_LOCK
 int ossl_quic_handle_events(SSL *s)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_lock(ql);
+        ossl_quic_reactor_tick(ossl_quic_engine_get0_reactor(ql->engine), 0);
+        ql_unlock(ql);
+        return 1;
+    }
 
     if (!expect_quic(s, &ctx))
         return 0;
@@ -1077,20 +1195,9 @@ int ossl_quic_handle_events(SSL *s)
  * immediately. If no timeout is currently active, *is_infinite is set to 1 and
  * the value of *tv is undefined.
  */
-QUIC_TAKES_LOCK
-int ossl_quic_get_event_timeout(SSL *s, struct timeval *tv, int *is_infinite)
+static void deadline_to_timeval(OSSL_TIME deadline, OSSL_TIME now,
+                                struct timeval *tv, int *is_infinite)
 {
-    QCTX ctx;
-    OSSL_TIME deadline = ossl_time_infinite();
-
-    if (!expect_quic(s, &ctx))
-        return 0;
-
-    quic_lock(ctx.qc);
-
-    deadline
-        = ossl_quic_reactor_get_tick_deadline(ossl_quic_channel_get_reactor(ctx.qc->ch));
-
     if (ossl_time_is_infinite(deadline)) {
         *is_infinite = 1;
 
@@ -1100,13 +1207,39 @@ int ossl_quic_get_event_timeout(SSL *s, struct timeval *tv, int *is_infinite)
          */
         tv->tv_sec  = 1000000;
         tv->tv_usec = 0;
+        return;
+    }
 
-        quic_unlock(ctx.qc);
+    *tv = ossl_time_to_timeval(ossl_time_subtract(deadline, now));
+    *is_infinite = 0;
+}
+
+QUIC_TAKES_LOCK
+int ossl_quic_get_event_timeout(SSL *s, struct timeval *tv, int *is_infinite)
+{
+    QCTX ctx;
+    QUIC_LISTENER *ql;
+    OSSL_TIME deadline = ossl_time_infinite();
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_lock(ql);
+        deadline
+            = ossl_quic_reactor_get_tick_deadline(ossl_quic_engine_get0_reactor(ql->engine));
+        deadline_to_timeval(deadline, ossl_quic_engine_get_time(ql->engine),
+                            tv, is_infinite);
+        ql_unlock(ql);
         return 1;
     }
 
-    *tv = ossl_time_to_timeval(ossl_time_subtract(deadline, get_time(ctx.qc)));
-    *is_infinite = 0;
+    if (!expect_quic(s, &ctx))
+        return 0;
+
+    quic_lock(ctx.qc);
+
+    deadline
+        = ossl_quic_reactor_get_tick_deadline(ossl_quic_channel_get_reactor(ctx.qc->ch));
+    deadline_to_timeval(deadline, get_time(ctx.qc), tv, is_infinite);
+
     quic_unlock(ctx.qc);
     return 1;
 }
@@ -1115,30 +1248,46 @@ int ossl_quic_get_event_timeout(SSL *s, struct timeval *tv, int *is_infinite)
 int ossl_quic_get_rpoll_descriptor(SSL *s, BIO_POLL_DESCRIPTOR *desc)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
+    BIO *net_rbio;
 
-    if (!expect_quic(s, &ctx))
-        return 0;
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        net_rbio = ql->net_rbio;
+    } else {
+        if (!expect_quic(s, &ctx))
+            return 0;
 
-    if (desc == NULL || ctx.qc->net_rbio == NULL)
-        return QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_PASSED_INVALID_ARGUMENT,
-                                       NULL);
+        net_rbio = qc_get_net_rbio(ctx.qc);
+    }
+
+    if (desc == NULL || net_rbio == NULL)
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                           NULL);
 
-    return BIO_get_rpoll_descriptor(ctx.qc->net_rbio, desc);
+    return BIO_get_rpoll_descriptor(net_rbio, desc);
 }
 
 /* SSL_get_wpoll_descriptor */
 int ossl_quic_get_wpoll_descriptor(SSL *s, BIO_POLL_DESCRIPTOR *desc)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
+    BIO *net_wbio;
 
-    if (!expect_quic(s, &ctx))
-        return 0;
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        net_wbio = ql->net_wbio;
+    } else {
+        if (!expect_quic(s, &ctx))
+            return 0;
 
-    if (desc == NULL || ctx.qc->net_wbio == NULL)
-        return QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_PASSED_INVALID_ARGUMENT,
-                                       NULL);
+        net_wbio = qc_get_net_wbio(ctx.qc);
+    }
 
-    return BIO_get_wpoll_descriptor(ctx.qc->net_wbio, desc);
+    if (desc == NULL || net_wbio == NULL)
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                           NULL);
+
+    return BIO_get_wpoll_descriptor(net_wbio, desc);
 }
 
 /* SSL_net_read_desired */
@@ -1147,6 +1296,14 @@ int ossl_quic_get_net_read_desired(SSL *s)
 {
     QCTX ctx;
     int ret;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_lock(ql);
+        ret = ossl_quic_reactor_net_read_desired(ossl_quic_engine_get0_reactor(ql->engine));
+        ql_unlock(ql);
+        return ret;
+    }
 
     if (!expect_quic(s, &ctx))
         return 0;
@@ -1163,6 +1320,14 @@ int ossl_quic_get_net_write_desired(SSL *s)
 {
     int ret;
     QCTX ctx;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL) {
+        ql_lock(ql);
+        ret = ossl_quic_reactor_net_write_desired(ossl_quic_engine_get0_reactor(ql->engine));
+        ql_unlock(ql);
+        return ret;
+    }
 
     if (!expect_quic(s, &ctx))
         return 0;
@@ -1587,7 +1752,7 @@ static int quic_do_handshake(QCTX *ctx)
         return -1; /* Non-protocol error */
     }
 
-    if (qc->net_rbio == NULL || qc->net_wbio == NULL) {
+    if (qc_get_net_rbio(qc) == NULL || qc_get_net_wbio(qc) == NULL) {
         /* Need read and write BIOs. */
         QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_BIO_NOT_SET, NULL);
         return -1; /* Non-protocol error */
@@ -2200,13 +2365,34 @@ static void quic_post_write(QUIC_XSO *xso, int did_append,
         ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(xso->conn->ch), 0);
 }
 
-struct quic_write_again_args {
-    QUIC_XSO            *xso;
+/*
+ * The data passed to a write call. This is either the single buffer |buf| or,
+ * for SSL_writev(), the |iovcnt| buffers in |iov|. Positions within the data
+ * are given as offsets from the start of the whole write.
+ */
+typedef struct quic_write_src_st {
     const unsigned char *buf;
-    size_t              len;
-    size_t              total_written;
-    int                 err;
-    uint64_t            flags;
+    const SSL_IOVEC     *iov;
+    size_t              iovcnt;
+} QUIC_WRITE_SRC;
+
+/*
+ * Returns a pointer identifying the write for the purposes of detecting a
+ * retry with a different buffer.
+ */
+static const unsigned char *quic_write_src_id(const QUIC_WRITE_SRC *src)
+{
+    return src->iov != NULL ? (const unsigned char *)src->iov : src->buf;
+}
+
+struct quic_write_again_args {
+    QUIC_XSO             *xso;
+    const QUIC_WRITE_SRC *src;
+    size_t               off;
+    size_t               len;
+    size_t               total_written;
+    int                  err;
+    uint64_t             flags;
 };
 
 /*
@@ -2240,17 +2426,19 @@ static int sstream_ensure_spare(QUIC_SSTREAM *sstream, uint64_t spare)
 }
 
 /*
- * Append to a QUIC_STREAM's QUIC_SSTREAM, ensuring buffer space is expanded
- * as needed according to flow control.
+ * Append |len| bytes starting |off| bytes into |src| to a QUIC_STREAM's
+ * QUIC_SSTREAM, ensuring buffer space is expanded as needed according to flow
+ * control.
  */
 QUIC_NEEDS_LOCK
-static int xso_sstream_append(QUIC_XSO *xso, const unsigned char *buf,
-                              size_t len, size_t *actual_written)
+static int xso_sstream_append(QUIC_XSO *xso, const QUIC_WRITE_SRC *src,
+                              size_t off, size_t len, size_t *actual_written)
 {
     QUIC_SSTREAM *sstream = xso->stream->sstream;
     uint64_t cur = ossl_quic_sstream_get_cur_size(sstream);
     uint64_t cwm = ossl_quic_txfc_get_cwm(&xso->stream->txfc);
     uint64_t permitted = (cwm >= cur ? cwm - cur : 0);
+    size_t i, n, consumed;
 
     if (len > permitted)
         len = (size_t)permitted;
@@ -2258,7 +2446,36 @@ static int xso_sstream_append(QUIC_XSO *xso, const unsigned char *buf,
     if (!sstream_ensure_spare(sstream, len))
         return 0;
 
-    return ossl_quic_sstream_append(sstream, buf, len, actual_written);
+    if (src->iov == NULL)
+        return ossl_quic_sstream_append(sstream, src->buf + off, len,
+                                        actual_written);
+
+    *actual_written = 0;
+    for (i = 0; i < src->iovcnt && len > 0; i++) {
+        if (off >= src->iov[i].len) {
+            off -= src->iov[i].len;
+            continue;
+        }
+
+        n = src->iov[i].len - off;
+        if (n > len)
+            n = len;
+
+        if (!ossl_quic_sstream_append(sstream,
+                                      (const unsigned char *)src->iov[i].data
+                                      + off, n, &consumed))
+            return *actual_written > 0;
+
+        *actual_written += consumed;
+        if (consumed < n)
+            /* Buffer full */
+            break;
+
+        len -= n;
+        off = 0;
+    }
+
+    return 1;
 }
 
 QUIC_NEEDS_LOCK
@@ -2279,13 +2496,14 @@ static int quic_write_again(void *arg)
         return -2;
 
     args->err = ERR_R_INTERNAL_ERROR;
-    if (!xso_sstream_append(args->xso, args->buf, args->len, &actual_written))
+    if (!xso_sstream_append(args->xso, args->src, args->off, args->len,
+                            &actual_written))
         return -2;
 
     quic_post_write(args->xso, actual_written > 0,
                     args->len == actual_written, args->flags, 0);
 
-    args->buf           += actual_written;
+    args->off           += actual_written;
     args->len           -= actual_written;
     args->total_written += actual_written;
 
@@ -2298,8 +2516,8 @@ static int quic_write_again(void *arg)
 }
 
 QUIC_NEEDS_LOCK
-static int quic_write_blocking(QCTX *ctx, const void *buf, size_t len,
-                               uint64_t flags, size_t *written)
+static int quic_write_blocking(QCTX *ctx, const QUIC_WRITE_SRC *src,
+                               size_t len, uint64_t flags, size_t *written)
 {
     int res;
     QUIC_XSO *xso = ctx->xso;
@@ -2307,7 +2525,7 @@ static int quic_write_blocking(QCTX *ctx, const void *buf, size_t len,
     size_t actual_written = 0;
 
     /* First make a best effort to append as much of the data as possible. */
-    if (!xso_sstream_append(xso, buf, len, &actual_written)) {
+    if (!xso_sstream_append(xso, src, 0, len, &actual_written)) {
         /* Stream already finished or allocation error. */
         *written = 0;
         return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2327,7 +2545,8 @@ static int quic_write_blocking(QCTX *ctx, const void *buf, size_t len,
      * it is freed up.
      */
     args.xso            = xso;
-    args.buf            = (const unsigned char *)buf + actual_written;
+    args.src            = src;
+    args.off            = actual_written;
     args.len            = len - actual_written;
     args.total_written  = 0;
     args.err            = ERR_R_INTERNAL_ERROR;
@@ -2369,13 +2588,13 @@ static void aon_write_finish(QUIC_XSO *xso)
 }
 
 QUIC_NEEDS_LOCK
-static int quic_write_nonblocking_aon(QCTX *ctx, const void *buf,
+static int quic_write_nonblocking_aon(QCTX *ctx, const QUIC_WRITE_SRC *src,
                                       size_t len, uint64_t flags,
                                       size_t *written)
 {
     QUIC_XSO *xso = ctx->xso;
-    const void *actual_buf;
-    size_t actual_len, actual_written = 0;
+    const unsigned char *buf = quic_write_src_id(src);
+    size_t actual_off, actual_len, actual_written = 0;
     int accept_moving_buffer
         = ((xso->ssl_mode & SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER) != 0);
 
@@ -2393,16 +2612,17 @@ static int quic_write_nonblocking_aon(QCTX *ctx, const void *buf,
              */
             return QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_BAD_WRITE_RETRY, NULL);
 
-        actual_buf = (unsigned char *)buf + xso->aon_buf_pos;
+        actual_off = xso->aon_buf_pos;
         actual_len = len - xso->aon_buf_pos;
         assert(actual_len > 0);
     } else {
-        actual_buf = buf;
+        actual_off = 0;
         actual_len = len;
     }
 
     /* First make a best effort to append as much of the data as possible. */
-    if (!xso_sstream_append(xso, actual_buf, actual_len, &actual_written)) {
+    if (!xso_sstream_append(xso, src, actual_off, actual_len,
+                            &actual_written)) {
         /* Stream already finished or allocation error. */
         *written = 0;
         return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2458,13 +2678,14 @@ static int quic_write_nonblocking_aon(QCTX *ctx, const void *buf,
 }
 
 QUIC_NEEDS_LOCK
-static int quic_write_nonblocking_epw(QCTX *ctx, const void *buf, size_t len,
-                                      uint64_t flags, size_t *written)
+static int quic_write_nonblocking_epw(QCTX *ctx, const QUIC_WRITE_SRC *src,
+                                      size_t len, uint64_t flags,
+                                      size_t *written)
 {
     QUIC_XSO *xso = ctx->xso;
 
     /* Simple best effort operation. */
-    if (!xso_sstream_append(xso, buf, len, written)) {
+    if (!xso_sstream_append(xso, src, 0, len, written)) {
         /* Stream already finished or allocation error. */
         *written = 0;
         return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2523,7 +2744,7 @@ static int quic_validate_for_write(QUIC_XSO *xso, int *err)
 }
 
 QUIC_TAKES_LOCK
-int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
+static int quic_write_src(SSL *s, const QUIC_WRITE_SRC *src, size_t len,
                           uint64_t flags, size_t *written)
 {
     int ret;
@@ -2581,17 +2802,43 @@ int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
     }
 
     if (xso_blocking_mode(ctx.xso))
-        ret = quic_write_blocking(&ctx, buf, len, flags, written);
+        ret = quic_write_blocking(&ctx, src, len, flags, written);
     else if (partial_write)
-        ret = quic_write_nonblocking_epw(&ctx, buf, len, flags, written);
+        ret = quic_write_nonblocking_epw(&ctx, src, len, flags, written);
     else
-        ret = quic_write_nonblocking_aon(&ctx, buf, len, flags, written);
+        ret = quic_write_nonblocking_aon(&ctx, src, len, flags, written);
 
 out:
     quic_unlock(ctx.qc);
     return ret;
 }
 
+QUIC_TAKES_LOCK
+int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
+                          uint64_t flags, size_t *written)
+{
+    QUIC_WRITE_SRC src;
+
+    src.buf     = buf;
+    src.iov     = NULL;
+    src.iovcnt  = 0;
+
+    return quic_write_src(s, &src, len, flags, written);
+}
+
+QUIC_TAKES_LOCK
+int ossl_quic_writev(SSL *s, const SSL_IOVEC *iov, size_t iovcnt,
+                     size_t len, uint64_t flags, size_t *written)
+{
+    QUIC_WRITE_SRC src;
+
+    src.buf     = NULL;
+    src.iov     = iov;
+    src.iovcnt  = iovcnt;
+
+    return quic_write_src(s, &src, len, flags, written);
+}
+
 QUIC_TAKES_LOCK
 int ossl_quic_write(SSL *s, const void *buf, size_t len, size_t *written)
 {
@@ -3393,6 +3640,53 @@ err:
     return ret;
 }
 
+QUIC_TAKES_LOCK
+static int qc_getset_cc_algorithm(QCTX *ctx, uint32_t class_,
+                                  uint64_t *p_value_out, uint64_t *p_value_in)
+{
+    int ret = 0;
+    uint64_t value_out = 0;
+
+    quic_lock(ctx->qc);
+
+    if (class_ != SSL_VALUE_CLASS_GENERIC) {
+        QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_UNSUPPORTED_CONFIG_VALUE_CLASS,
+                                    NULL);
+        goto err;
+    }
+
+    if (p_value_in != NULL) {
+        switch (*p_value_in) {
+        case SSL_VALUE_QUIC_CC_ALGORITHM_NEWRENO:
+        case SSL_VALUE_QUIC_CC_ALGORITHM_CUBIC:
+        case SSL_VALUE_QUIC_CC_ALGORITHM_BBR:
+            break;
+        default:
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+                                        NULL);
+            goto err;
+        }
+
+        if (ctx->qc->started
+            || !ossl_quic_channel_set_cc_algorithm(ctx->qc->ch,
+                                                   (uint32_t)*p_value_in)) {
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_FEATURE_NOT_RENEGOTIABLE,
+                                        NULL);
+            goto err;
+        }
+    }
+
+    value_out = ossl_quic_channel_get_cc_algorithm(ctx->qc->ch);
+
+    ret = 1;
+err:
+    quic_unlock(ctx->qc);
+    if (ret && p_value_out != NULL)
+        *p_value_out = value_out;
+
+    return ret;
+}
+
 QUIC_TAKES_LOCK
 static int qc_get_stream_write_buf_stat(QCTX *ctx, uint32_t class_,
                                         uint64_t *p_value_out,
@@ -3482,6 +3776,9 @@ int ossl_quic_get_value_uint(SSL *s, uint32_t class_, uint32_t id,
         return qc_get_stream_write_buf_stat(&ctx, class_, value,
                                             ossl_quic_sstream_get_buffer_avail);
 
+    case SSL_VALUE_QUIC_CC_ALGORITHM:
+        return qc_getset_cc_algorithm(&ctx, class_, value, NULL);
+
     default:
         return QUIC_RAISE_NON_NORMAL_ERROR(&ctx,
                                            SSL_R_UNSUPPORTED_CONFIG_VALUE, NULL);
@@ -3506,6 +3803,9 @@ int ossl_quic_set_value_uint(SSL *s, uint32_t class_, uint32_t id,
     case SSL_VALUE_EVENT_HANDLING_MODE:
         return qc_getset_event_handling(&ctx, class_, NULL, &value);
 
+    case SSL_VALUE_QUIC_CC_ALGORITHM:
+        return qc_getset_cc_algorithm(&ctx, class_, NULL, &value);
+
     default:
         return QUIC_RAISE_NON_NORMAL_ERROR(&ctx,
                                            SSL_R_UNSUPPORTED_CONFIG_VALUE, NULL);
@@ -3916,6 +4216,341 @@ int ossl_quic_get_key_update_type(const SSL *s)
     return SSL_KEY_UPDATE_NONE;
 }
 
+/*
+ * QUIC Front-End I/O API: Listeners
+ * =================================
+ *
+ *         SSL_new_listener                    => ossl_quic_new_listener
+ *         SSL_listen                          => ossl_quic_listen
+ *         SSL_accept_connection               => ossl_quic_accept_connection
+ *         SSL_get_accept_connection_queue_len => ossl_quic_get_accept_connection_queue_len
+ *         SSL_get0_listener                   => ossl_quic_get0_listener
+ *
+ * A listener owns a QUIC_ENGINE and a single multi-connection QUIC_PORT. The
+ * port demultiplexes incoming datagrams to channels by destination connection
+ * ID and creates a new channel for each new connection attempt; these are held
+ * in the port's incoming queue until the application accepts them, at which
+ * point they are wrapped in a QCSO sharing the listener's engine, port and
+ * mutex.
+ */
+
+static QUIC_LISTENER *expect_quic_listener(const SSL *s)
+{
+    QUIC_LISTENER *ql = QUIC_LISTENER_FROM_SSL((SSL *)s);
+
+    if (ql == NULL)
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                    "QUIC listener required");
+
+    return ql;
+}
+
+static void ql_free(QUIC_LISTENER *ql)
+{
+    /* Frees any connections which were never accepted. */
+    ossl_quic_port_free(ql->port);
+    ossl_quic_engine_free(ql->engine);
+
+    BIO_free_all(ql->net_rbio);
+    BIO_free_all(ql->net_wbio);
+
+#if defined(OPENSSL_THREADS)
+    ossl_crypto_mutex_free(&ql->mutex);
+#endif
+
+    /* Note: SSL_free calls OPENSSL_free(ql) for us */
+}
+
+QUIC_NEEDS_LOCK
+static void ql_update_blocking_mode(QUIC_LISTENER *ql)
+{
+    QUIC_REACTOR *rtor = ossl_quic_engine_get0_reactor(ql->engine);
+
+    ql->blocking = ql->desires_blocking
+        && ossl_quic_reactor_can_poll_r(rtor)
+        && ossl_quic_reactor_can_poll_w(rtor);
+}
+
+QUIC_TAKES_LOCK
+static void ql_set0_net_bio(QUIC_LISTENER *ql, BIO *net_bio, int for_write)
+{
+    BIO **pbio = for_write ? &ql->net_wbio : &ql->net_rbio;
+    int ok;
+
+    ql_lock(ql);
+
+    if (*pbio == net_bio) {
+        ql_unlock(ql);
+        return;
+    }
+
+    ok = for_write ? ossl_quic_port_set_net_wbio(ql->port, net_bio)
+                   : ossl_quic_port_set_net_rbio(ql->port, net_bio);
+    if (ok) {
+        BIO_free_all(*pbio);
+        *pbio = net_bio;
+
+        if (net_bio != NULL)
+            BIO_set_nbio(net_bio, 1); /* best effort autoconfig */
+
+        ossl_quic_port_update_poll_descriptors(ql->port); /* best effort */
+        ql_update_blocking_mode(ql);
+    }
+
+    ql_unlock(ql);
+}
+
+/* SSL_new_listener */
+SSL *ossl_quic_new_listener(SSL_CTX *ctx, uint64_t flags)
+{
+    QUIC_LISTENER *ql = NULL;
+    QUIC_ENGINE_ARGS engine_args = {0};
+    QUIC_PORT_ARGS port_args = {0};
+
+    if (ctx->method != OSSL_QUIC_server_method()) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                    "SSL_CTX must use OSSL_QUIC_server_method");
+        return NULL;
+    }
+
+    if (flags != 0) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT, NULL);
+        return NULL;
+    }
+
+    ql = OPENSSL_zalloc(sizeof(*ql));
+    if (ql == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
+        return NULL;
+    }
+
+#if defined(OPENSSL_THREADS)
+    if ((ql->mutex = ossl_crypto_mutex_new()) == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
+        OPENSSL_free(ql);
+        return NULL;
+    }
+#endif
+
+    if (!ossl_ssl_init(&ql->ssl, ctx, ctx->method, SSL_TYPE_QUIC_LISTENER)) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+#if defined(OPENSSL_THREADS)
+        ossl_crypto_mutex_free(&ql->mutex);
+#endif
+        OPENSSL_free(ql);
+        return NULL;
+    }
+
+    engine_args.libctx  = ctx->libctx;
+    engine_args.propq   = ctx->propq;
+    engine_args.mutex   = ql->mutex;
+    ql->engine = ossl_quic_engine_new(&engine_args);
+    if (ql->engine == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+        goto err;
+    }
+
+    port_args.channel_ctx   = ctx;
+    port_args.is_multi_conn = 1;
+    ql->port = ossl_quic_engine_create_port(ql->engine, &port_args);
+    if (ql->port == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+        goto err;
+    }
+
+    ql->desires_blocking = 1;
+    return &ql->ssl;
+
+err:
+    SSL_free(&ql->ssl);
+    return NULL;
+}
+
+QUIC_NEEDS_LOCK
+static int ql_listen(QUIC_LISTENER *ql)
+{
+    if (ql->listening)
+        return 1;
+
+    if (ql->net_rbio == NULL || ql->net_wbio == NULL)
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, SSL_R_BIO_NOT_SET, NULL);
+
+    ossl_quic_port_set_allow_incoming(ql->port, 1);
+    ql->listening = 1;
+    return 1;
+}
+
+/* SSL_listen */
+QUIC_TAKES_LOCK
+int ossl_quic_listen(SSL *ssl)
+{
+    QUIC_LISTENER *ql;
+    int ret;
+
+    if ((ql = expect_quic_listener(ssl)) == NULL)
+        return 0;
+
+    ql_lock(ql);
+    ret = ql_listen(ql);
+    ql_unlock(ql);
+    return ret;
+}
+
+static int wait_for_incoming_conn(void *arg)
+{
+    QUIC_LISTENER *ql = arg;
+
+    if (!ossl_quic_port_is_running(ql->port))
+        /* If the port is no longer running, stop. */
+        return -1;
+
+    ossl_quic_port_prune_incoming(ql->port);
+    return ossl_quic_port_get_num_incoming_channels(ql->port) > 0;
+}
+
+/*
+ * Wrap an incoming channel popped from the listener's port in a new QCSO. On
+ * success the QCSO takes ownership of the channel and its TLS object.
+ */
+QUIC_NEEDS_LOCK
+static QUIC_CONNECTION *create_qc_from_incoming_conn(QUIC_LISTENER *ql,
+                                                     QUIC_CHANNEL *ch)
+{
+    QUIC_CONNECTION *qc;
+    SSL_CTX *ctx = ql->ssl.ctx;
+
+    qc = OPENSSL_zalloc(sizeof(*qc));
+    if (qc == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
+        return NULL;
+    }
+
+    /* The QCSO holds a reference to its listener. */
+    if (!SSL_up_ref(&ql->ssl)) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+        OPENSSL_free(qc);
+        return NULL;
+    }
+
+    if (!ossl_ssl_init(&qc->ssl, ctx, ctx->method, SSL_TYPE_QUIC_CONNECTION)) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+        SSL_free(&ql->ssl);
+        OPENSSL_free(qc);
+        return NULL;
+    }
+
+    qc->listener        = ql;
+    qc->engine          = ql->engine;
+    qc->port            = ql->port;
+    qc->mutex           = ql->mutex;
+    qc->ch              = ch;
+    qc->tls             = ossl_quic_channel_get0_ssl(ch);
+
+    qc->started         = 1;
+    qc->as_server       = 1;
+    qc->as_server_state = 1;
+
+    qc->default_stream_mode     = SSL_DEFAULT_STREAM_MODE_AUTO_BIDI;
+    qc->default_ssl_mode        = ctx->mode;
+    qc->default_ssl_options     = ctx->options & OSSL_QUIC_PERMITTED_OPTIONS;
+    qc->desires_blocking        = ql->desires_blocking;
+    qc->blocking                = 0;
+    qc->incoming_stream_policy  = SSL_INCOMING_STREAM_POLICY_AUTO;
+    qc->last_error              = SSL_ERROR_NONE;
+
+    ossl_quic_channel_set_msg_callback(ch, ctx->msg_callback, &qc->ssl);
+    ossl_quic_channel_set_msg_callback_arg(ch, ctx->msg_callback_arg);
+
+    qc_update_reject_policy(qc);
+    qc_update_blocking_mode(qc);
+    return qc;
+}
+
+/* SSL_accept_connection */
+QUIC_TAKES_LOCK
+SSL *ossl_quic_accept_connection(SSL *ssl, uint64_t flags)
+{
+    QUIC_LISTENER *ql;
+    QUIC_CHANNEL *ch;
+    QUIC_CONNECTION *qc = NULL;
+    int ret;
+
+    if ((ql = expect_quic_listener(ssl)) == NULL)
+        return NULL;
+
+    ql_lock(ql);
+
+    /* Accepting implies listening. */
+    if (!ql_listen(ql))
+        goto out;
+
+    /* Never hand out connections which died while waiting to be accepted. */
+    ossl_quic_port_prune_incoming(ql->port);
+    ch = ossl_quic_port_pop_incoming(ql->port);
+    if (ch == NULL) {
+        if (ql->blocking && (flags & SSL_ACCEPT_CONNECTION_NO_BLOCK) == 0) {
+            ossl_quic_engine_set_inhibit_tick(ql->engine, 0);
+            ret = ossl_quic_reactor_block_until_pred(ossl_quic_engine_get0_reactor(ql->engine),
+                                                     wait_for_incoming_conn, ql,
+                                                     0, ql->mutex);
+            if (ret < 1) {
+                QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR,
+                                            "listener is no longer running");
+                goto out;
+            }
+        } else {
+            ossl_quic_reactor_tick(ossl_quic_engine_get0_reactor(ql->engine), 0);
+        }
+
+        ossl_quic_port_prune_incoming(ql->port);
+        ch = ossl_quic_port_pop_incoming(ql->port);
+        if (ch == NULL)
+            goto out;
+    }
+
+    qc = create_qc_from_incoming_conn(ql, ch);
+    if (qc == NULL) {
+        SSL_free(ossl_quic_channel_get0_ssl(ch));
+        ossl_quic_channel_free(ch);
+    }
+
+out:
+    ql_unlock(ql);
+    return qc != NULL ? &qc->ssl : NULL;
+}
+
+/* SSL_get_accept_connection_queue_len */
+QUIC_TAKES_LOCK
+size_t ossl_quic_get_accept_connection_queue_len(SSL *ssl)
+{
+    QUIC_LISTENER *ql;
+    size_t v;
+
+    if ((ql = expect_quic_listener(ssl)) == NULL)
+        return 0;
+
+    ql_lock(ql);
+    ossl_quic_port_prune_incoming(ql->port);
+    v = ossl_quic_port_get_num_incoming_channels(ql->port);
+    ql_unlock(ql);
+    return v;
+}
+
+/* SSL_get0_listener */
+SSL *ossl_quic_get0_listener(SSL *s)
+{
+    QCTX ctx;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(s)) != NULL)
+        return &ql->ssl;
+
+    if (!expect_quic(s, &ctx))
+        return NULL;
+
+    return ctx.qc->listener != NULL ? &ctx.qc->listener->ssl : NULL;
+}
+
 /*
  * QUIC Front-End I/O API: SSL_CTX Management
  * ==========================================
@@ -4089,8 +4724,30 @@ int ossl_quic_conn_poll_events(SSL *ssl, uint64_t events, int do_tick,
                                uint64_t *p_revents)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
     uint64_t revents = 0;
 
+    if ((ql = QUIC_LISTENER_FROM_SSL(ssl)) != NULL) {
+        ql_lock(ql);
+
+        if (do_tick)
+            ossl_quic_reactor_tick(ossl_quic_engine_get0_reactor(ql->engine), 0);
+
+        if ((events & SSL_POLL_EVENT_IC) != 0) {
+            ossl_quic_port_prune_incoming(ql->port);
+            if (ossl_quic_port_get_num_incoming_channels(ql->port) > 0)
+                revents |= SSL_POLL_EVENT_IC;
+        }
+
+        if ((events & SSL_POLL_EVENT_EL) != 0
+            && !ossl_quic_port_is_running(ql->port))
+            revents |= SSL_POLL_EVENT_EL;
+
+        ql_unlock(ql);
+        *p_revents = revents;
+        return 1;
+    }
+
     if (!expect_quic(ssl, &ctx))
         return 0;
 
@@ -4150,6 +4807,72 @@ int ossl_quic_conn_poll_events(SSL *ssl, uint64_t events, int do_tick,
     return 1;
 }
 
+QUIC_REACTOR *ossl_quic_get0_reactor(SSL *ssl)
+{
+    QCTX ctx;
+    QUIC_LISTENER *ql;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(ssl)) != NULL)
+        return ossl_quic_engine_get0_reactor(ql->engine);
+
+    if (!expect_quic(ssl, &ctx))
+        return NULL;
+
+    return ossl_quic_channel_get_reactor(ctx.qc->ch);
+}
+
+/*
+ * Converts a deadline expressed in the time base of a QUIC engine, which may be
+ * overridden for testing, into one expressed in real time.
+ */
+static OSSL_TIME deadline_to_real_time(OSSL_TIME deadline, OSSL_TIME now)
+{
+    if (ossl_time_is_infinite(deadline))
+        return deadline;
+
+    return ossl_time_add(ossl_time_now(), ossl_time_subtract(deadline, now));
+}
+
+QUIC_TAKES_LOCK
+int ossl_quic_conn_get_poll_info(SSL *ssl,
+                                 BIO_POLL_DESCRIPTOR *rdesc, int *want_read,
+                                 BIO_POLL_DESCRIPTOR *wdesc, int *want_write,
+                                 OSSL_TIME *deadline)
+{
+    QCTX ctx;
+    QUIC_LISTENER *ql;
+    QUIC_REACTOR *rtor;
+
+    if ((ql = QUIC_LISTENER_FROM_SSL(ssl)) != NULL) {
+        ql_lock(ql);
+        rtor = ossl_quic_engine_get0_reactor(ql->engine);
+        *rdesc      = *ossl_quic_reactor_get_poll_r(rtor);
+        *wdesc      = *ossl_quic_reactor_get_poll_w(rtor);
+        *want_read  = ossl_quic_reactor_net_read_desired(rtor);
+        *want_write = ossl_quic_reactor_net_write_desired(rtor);
+        *deadline
+            = deadline_to_real_time(ossl_quic_reactor_get_tick_deadline(rtor),
+                                    ossl_quic_engine_get_time(ql->engine));
+        ql_unlock(ql);
+        return 1;
+    }
+
+    if (!expect_quic(ssl, &ctx))
+        return 0;
+
+    quic_lock(ctx.qc);
+    rtor = ossl_quic_channel_get_reactor(ctx.qc->ch);
+    *rdesc      = *ossl_quic_reactor_get_poll_r(rtor);
+    *wdesc      = *ossl_quic_reactor_get_poll_w(rtor);
+    *want_read  = ossl_quic_reactor_net_read_desired(rtor);
+    *want_write = ossl_quic_reactor_net_write_desired(rtor);
+    *deadline
+        = deadline_to_real_time(ossl_quic_reactor_get_tick_deadline(rtor),
+                                get_time(ctx.qc));
+    quic_unlock(ctx.qc);
+    return 1;
+}
+
 /*
  * Internal Testing APIs
  * =====================
@@ -137,6 +137,13 @@ struct quic_conn_st {
     /* The QUIC port representing the QUIC listener and socket. */
     QUIC_PORT                       *port;
 
+    /*
+     * If this connection was accepted from a listener, the listener. We hold a
+     * reference to it, and the engine, port and mutex above belong to it rather
+     * than to us.
+     */
+    QUIC_LISTENER                   *listener;
+
     /*
      * The QUIC channel providing the core QUIC connection implementation. Note
      * that this is not instantiated until we actually start trying to do the
@@ -245,6 +252,41 @@ struct quic_conn_st {
     int                             last_error;
 };
 
+/*
+ * QUIC listener SSL object (QLSO) type. This represents a QUIC_PORT which
+ * accepts incoming connections on a single network BIO pair. Each accepted
+ * connection is returned to the application as a QCSO which shares the
+ * listener's engine, port and mutex.
+ */
+struct quic_listener_st {
+    /* SSL object common header. */
+    struct ssl_st                   ssl;
+
+    /* The QUIC engine representing the QUIC event domain. */
+    QUIC_ENGINE                     *engine;
+
+    /* The QUIC port representing the UDP socket we listen on. */
+    QUIC_PORT                       *port;
+
+    /*
+     * The mutex used to synchronise access to the engine and everything under
+     * it, including accepted connections. We own this.
+     */
+    CRYPTO_MUTEX                    *mutex;
+
+    /* The network read and write BIOs. */
+    BIO                             *net_rbio, *net_wbio;
+
+    /* Has SSL_listen been called (explicitly or implicitly)? */
+    unsigned int                    listening               : 1;
+
+    /* Do blocking operations (i.e. SSL_accept_connection) block? */
+    unsigned int                    blocking                : 1;
+
+    /* Does the application want blocking mode? */
+    unsigned int                    desires_blocking        : 1;
+};
+
 /* Internal calls to the QUIC CSM which come from various places. */
 int ossl_quic_conn_on_handshake_confirmed(QUIC_CONNECTION *qc);
 
@@ -268,7 +310,8 @@ int ossl_quic_trace(int write_p, int version, int content_type,
 #  define OSSL_QUIC_ANY_VERSION 0xFFFFF
 #  define IS_QUIC_METHOD(m) \
     ((m) == OSSL_QUIC_client_method() || \
-     (m) == OSSL_QUIC_client_thread_method())
+     (m) == OSSL_QUIC_client_thread_method() || \
+     (m) == OSSL_QUIC_server_method())
 #  define IS_QUIC_CTX(ctx)          IS_QUIC_METHOD((ctx)->method)
 
 #  define QUIC_CONNECTION_FROM_SSL_int(ssl, c)   \
@@ -286,6 +329,12 @@ int ossl_quic_trace(int write_p, int version, int content_type,
            ? (c QUIC_XSO *)((QUIC_CONNECTION *)(ssl))->default_xso  \
            : NULL))))
 
+#  define QUIC_LISTENER_FROM_SSL_int(ssl, c)     \
+     ((ssl) == NULL ? NULL                       \
+      : ((ssl)->type == SSL_TYPE_QUIC_LISTENER   \
+         ? (c QUIC_LISTENER *)(ssl)              \
+         : NULL))
+
 #  define SSL_CONNECTION_FROM_QUIC_SSL_int(ssl, c)               \
      ((ssl) == NULL ? NULL                                       \
       : ((ssl)->type == SSL_TYPE_QUIC_CONNECTION                 \
@@ -294,10 +343,12 @@ int ossl_quic_trace(int write_p, int version, int content_type,
 
 #  define IS_QUIC(ssl) ((ssl) != NULL                                   \
                         && ((ssl)->type == SSL_TYPE_QUIC_CONNECTION     \
-                            || (ssl)->type == SSL_TYPE_QUIC_XSO))
+                            || (ssl)->type == SSL_TYPE_QUIC_XSO         \
+                            || (ssl)->type == SSL_TYPE_QUIC_LISTENER))
 # else
 #  define QUIC_CONNECTION_FROM_SSL_int(ssl, c) NULL
 #  define QUIC_XSO_FROM_SSL_int(ssl, c) NULL
+#  define QUIC_LISTENER_FROM_SSL_int(ssl, c) NULL
 #  define SSL_CONNECTION_FROM_QUIC_SSL_int(ssl, c) NULL
 #  define IS_QUIC(ssl) 0
 #  define IS_QUIC_CTX(ctx) 0
@@ -308,6 +359,10 @@ int ossl_quic_trace(int write_p, int version, int content_type,
     QUIC_CONNECTION_FROM_SSL_int(ssl, SSL_CONNECTION_NO_CONST)
 # define QUIC_CONNECTION_FROM_CONST_SSL(ssl) \
     QUIC_CONNECTION_FROM_SSL_int(ssl, const)
+# define QUIC_LISTENER_FROM_SSL(ssl) \
+    QUIC_LISTENER_FROM_SSL_int(ssl, SSL_CONNECTION_NO_CONST)
+# define QUIC_LISTENER_FROM_CONST_SSL(ssl) \
+    QUIC_LISTENER_FROM_SSL_int(ssl, const)
 # define QUIC_XSO_FROM_SSL(ssl) \
     QUIC_XSO_FROM_SSL_int(ssl, SSL_CONNECTION_NO_CONST)
 # define QUIC_XSO_FROM_CONST_SSL(ssl) \
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_pacer.h"
+#include "internal/safe_math.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+void ossl_quic_pacer_init(OSSL_QUIC_PACER *pacer)
+{
+    pacer->rate         = 0;
+    pacer->burst        = 0;
+    pacer->tokens       = 0;
+    pacer->quantum      = 0;
+    pacer->last_update  = ossl_time_zero();
+}
+
+uint64_t ossl_quic_pacer_rate_from_cwnd(uint64_t cwnd, OSSL_TIME smoothed_rtt)
+{
+    uint64_t rtt = ossl_time2ticks(smoothed_rtt), rate;
+    int err = 0;
+
+    if (rtt == 0)
+        return 0;
+
+    rate = safe_muldiv_u64(cwnd, OSSL_TIME_SECOND, rtt, &err);
+    if (!err)
+        rate = safe_muldiv_u64(rate, OSSL_QUIC_PACER_GAIN_NUM,
+                               OSSL_QUIC_PACER_GAIN_DEN, &err);
+    return err ? UINT64_MAX : rate;
+}
+
+/* Credit tokens for the time elapsed since the last update. */
+static void pacer_refill(OSSL_QUIC_PACER *pacer, OSSL_TIME now)
+{
+    uint64_t elapsed, credit;
+    int err = 0;
+
+    if (ossl_time_compare(now, pacer->last_update) <= 0)
+        return;
+
+    elapsed = ossl_time2ticks(ossl_time_subtract(now, pacer->last_update));
+    credit = safe_muldiv_u64(elapsed, pacer->rate, OSSL_TIME_SECOND, &err);
+    if (err || credit >= pacer->burst - pacer->tokens) {
+        pacer->tokens       = pacer->burst;
+        pacer->last_update  = now;
+    } else if (credit > 0) {
+        /*
+         * Only advance the clock when at least one byte was credited, so that
+         * fractional credit is not lost at low rates.
+         */
+        pacer->tokens       += credit;
+        pacer->last_update  = now;
+    }
+}
+
+void ossl_quic_pacer_set_rate(OSSL_QUIC_PACER *pacer, uint64_t rate,
+                              size_t max_dgram_size, uint64_t max_burst,
+                              OSSL_TIME now)
+{
+    uint64_t burst;
+    int was_pacing = (pacer->rate != 0);
+
+    if (rate == 0) {
+        ossl_quic_pacer_init(pacer);
+        return;
+    }
+
+    /* Credit tokens earned at the old rate before switching to the new one. */
+    if (was_pacing)
+        pacer_refill(pacer, now);
+
+    burst = rate / 1000;
+    if (burst > max_burst)
+        burst = max_burst;
+    if (burst < 2 * (uint64_t)max_dgram_size)
+        burst = 2 * (uint64_t)max_dgram_size;
+
+    pacer->rate     = rate;
+    pacer->burst    = burst;
+    pacer->quantum  = max_dgram_size;
+
+    if (!was_pacing) {
+        /* Start with a full bucket. */
+        pacer->tokens       = burst;
+        pacer->last_update  = now;
+    } else if (pacer->tokens > burst) {
+        pacer->tokens = burst;
+    }
+}
+
+uint64_t ossl_quic_pacer_get_allowance(OSSL_QUIC_PACER *pacer, OSSL_TIME now)
+{
+    if (pacer->rate == 0)
+        return UINT64_MAX;
+
+    pacer_refill(pacer, now);
+    return pacer->tokens >= pacer->quantum ? pacer->tokens : 0;
+}
+
+OSSL_TIME ossl_quic_pacer_get_deadline(OSSL_QUIC_PACER *pacer, OSSL_TIME now)
+{
+    uint64_t need, ticks;
+    int err = 0;
+
+    if (ossl_quic_pacer_get_allowance(pacer, now) > 0)
+        return ossl_time_zero();
+
+    /* Round up so that we do not wake up just before the tokens arrive. */
+    need = pacer->quantum - pacer->tokens;
+    ticks = safe_muldiv_u64(need, OSSL_TIME_SECOND, pacer->rate, &err);
+    if (err)
+        return ossl_time_infinite();
+
+    return ossl_time_add(pacer->last_update, ossl_ticks2time(ticks + 1));
+}
+
+void ossl_quic_pacer_on_data_sent(OSSL_QUIC_PACER *pacer, uint64_t num_bytes,
+                                  OSSL_TIME now)
+{
+    if (pacer->rate == 0)
+        return;
+
+    pacer_refill(pacer, now);
+    pacer->tokens = num_bytes < pacer->tokens ? pacer->tokens - num_bytes : 0;
+}
@@ -22,6 +22,13 @@
  */
 #define INIT_DCID_LEN                   8
 
+/*
+ * Maximum number of incoming connections which may be waiting to be accepted
+ * by the application. Further connection attempts are ignored until the
+ * application catches up; the peer will retransmit its Initial.
+ */
+#define DEFAULT_MAX_INCOMING            1024
+
 static int port_init(QUIC_PORT *port);
 static void port_cleanup(QUIC_PORT *port);
 static OSSL_TIME get_time(void *arg);
@@ -30,6 +37,7 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
 static void port_rx_pre(QUIC_PORT *port);
 
 DEFINE_LIST_OF_IMPL(ch, QUIC_CHANNEL);
+DEFINE_LIST_OF_IMPL(incoming_ch, QUIC_CHANNEL);
 DEFINE_LIST_OF_IMPL(port, QUIC_PORT);
 
 QUIC_PORT *ossl_quic_port_new(const QUIC_PORT_ARGS *args)
@@ -89,6 +97,7 @@ static int port_init(QUIC_PORT *port)
 
     port->rx_short_dcid_len = (unsigned char)rx_short_dcid_len;
     port->tx_init_dcid_len  = INIT_DCID_LEN;
+    port->max_incoming      = DEFAULT_MAX_INCOMING;
     port->state             = QUIC_PORT_STATE_RUNNING;
 
     ossl_list_port_insert_tail(&port->engine->port_list, port);
@@ -102,6 +111,16 @@ err:
 
 static void port_cleanup(QUIC_PORT *port)
 {
+    QUIC_CHANNEL *ch;
+
+    /* Incoming channels nobody accepted are still ours. */
+    while ((ch = ossl_quic_port_pop_incoming(port)) != NULL) {
+        SSL *tls = ossl_quic_channel_get0_ssl(ch);
+
+        ossl_quic_channel_free(ch);
+        SSL_free(tls);
+    }
+
     assert(ossl_list_ch_num(&port->channel_list) == 0);
 
     ossl_quic_demux_free(port->demux);
@@ -316,6 +335,8 @@ static QUIC_CHANNEL *port_make_channel(QUIC_PORT *port, SSL *tls, int is_server)
     if (args.tls == NULL)
         return NULL;
 
+    args.cc_algorithm = args.tls->ctx->quic_cc_algorithm;
+
 #ifndef OPENSSL_NO_QLOG
     args.use_qlog   = 1; /* disabled if env not set */
     args.qlog_title = args.tls->ctx->qlog_title;
@@ -329,6 +350,12 @@ static QUIC_CHANNEL *port_make_channel(QUIC_PORT *port, SSL *tls, int is_server)
         return NULL;
     }
 
+    /*
+     * A channel created after the port's network BIOs were set (e.g. for an
+     * incoming connection) must be told about the write BIO here, as it was not
+     * on our channel list when ossl_quic_port_set_net_wbio() was called.
+     */
+    ossl_qtx_set_bio(ch->qtx, port->net_wbio);
     return ch;
 }
 
@@ -349,6 +376,46 @@ QUIC_CHANNEL *ossl_quic_port_create_incoming(QUIC_PORT *port, SSL *tls)
     return ch;
 }
 
+void ossl_quic_port_set_allow_incoming(QUIC_PORT *port, int allow)
+{
+    port->allow_incoming = (allow != 0);
+    if (port->allow_incoming)
+        port->is_server = 1;
+}
+
+QUIC_CHANNEL *ossl_quic_port_pop_incoming(QUIC_PORT *port)
+{
+    QUIC_CHANNEL *ch;
+
+    ch = ossl_list_incoming_ch_head(&port->incoming_list);
+    if (ch != NULL)
+        ossl_list_incoming_ch_remove(&port->incoming_list, ch);
+
+    return ch;
+}
+
+void ossl_quic_port_prune_incoming(QUIC_PORT *port)
+{
+    QUIC_CHANNEL *ch, *cnext;
+
+    LIST_FOREACH_DELSAFE(ch, cnext, incoming_ch, &port->incoming_list) {
+        SSL *tls;
+
+        if (!ossl_quic_channel_is_terminated(ch))
+            continue;
+
+        ossl_list_incoming_ch_remove(&port->incoming_list, ch);
+        tls = ossl_quic_channel_get0_ssl(ch);
+        ossl_quic_channel_free(ch);
+        SSL_free(tls);
+    }
+}
+
+size_t ossl_quic_port_get_num_incoming_channels(const QUIC_PORT *port)
+{
+    return ossl_list_incoming_ch_num(&port->incoming_list);
+}
+
 /*
  * QUIC Port: Ticker-Mutator
  * =========================
@@ -431,6 +498,9 @@ static void port_on_new_conn(QUIC_PORT *port, const BIO_ADDR *peer,
                              const QUIC_CONN_ID *dcid,
                              QUIC_CHANNEL **new_ch)
 {
+    QUIC_CHANNEL *ch;
+    SSL *tls;
+
     if (port->tserver_ch != NULL) {
         /* Specially assign to existing channel */
         if (!ossl_quic_channel_on_new_conn(port->tserver_ch, peer, scid, dcid))
@@ -440,6 +510,34 @@ static void port_on_new_conn(QUIC_PORT *port, const BIO_ADDR *peer,
         port->tserver_ch = NULL;
         return;
     }
+
+    if (!port->allow_incoming)
+        return;
+
+    /*
+     * Channels which terminated while waiting to be accepted do not count
+     * against the queue limit.
+     */
+    ossl_quic_port_prune_incoming(port);
+    if (ossl_list_incoming_ch_num(&port->incoming_list) >= port->max_incoming)
+        return;
+
+    /*
+     * Create a new channel for the connection. It starts handshaking straight
+     * away and sits on the accept queue until the application pops it.
+     */
+    if ((ch = port_make_channel(port, NULL, /*is_server=*/1)) == NULL)
+        return;
+
+    if (!ossl_quic_channel_on_new_conn(ch, peer, scid, dcid)) {
+        tls = ossl_quic_channel_get0_ssl(ch);
+        ossl_quic_channel_free(ch);
+        SSL_free(tls);
+        return;
+    }
+
+    ossl_list_incoming_ch_insert_tail(&port->incoming_list, ch);
+    *new_ch = ch;
 }
 
 static int port_try_handle_stateless_reset(QUIC_PORT *port, const QUIC_URXE *e)
@@ -517,14 +615,12 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
 
     /*
      * If we have an incoming packet which doesn't match any existing connection
-     * we assume this is an attempt to make a new connection. Currently we
-     * require our caller to have precreated a latent 'incoming' channel via
-     * TSERVER which then gets turned into the new connection.
-     *
-     * TODO(QUIC SERVER): In the future we will construct channels dynamically
-     * in this case.
+     * we assume this is an attempt to make a new connection. Either our caller
+     * has precreated a latent 'incoming' channel via TSERVER which then gets
+     * turned into the new connection, or we construct a channel dynamically if
+     * the port is listening.
      */
-    if (port->tserver_ch == NULL)
+    if (port->tserver_ch == NULL && !port->allow_incoming)
         goto undesirable;
 
     /*
@@ -26,6 +26,7 @@
  * Other components should not include this header.
  */
 DECLARE_LIST_OF(ch, QUIC_CHANNEL);
+DECLARE_LIST_OF(incoming_ch, QUIC_CHANNEL);
 
 /* A port is always in one of the following states: */
 enum {
@@ -62,6 +63,16 @@ struct quic_port_st {
     /* List of all child channels. */
     OSSL_LIST(ch)                   channel_list;
 
+    /*
+     * Incoming channels created in response to new connection attempts which
+     * have not yet been popped by the application. Every channel on this list
+     * is also on channel_list.
+     */
+    OSSL_LIST(incoming_ch)          incoming_list;
+
+    /* Maximum length of incoming_list before new connections are ignored. */
+    size_t                          max_incoming;
+
     /* Special TSERVER channel. To be removed in the future. */
     QUIC_CHANNEL                    *tserver_ch;
 
@@ -91,6 +102,11 @@ struct quic_port_st {
     /* Does this port allow incoming connections? */
     unsigned int                    is_server                       : 1;
 
+    /*
+     * Are new channels created automatically for incoming connection attempts?
+     */
+    unsigned int                    allow_incoming                  : 1;
+
     /* Are we on the QUIC_ENGINE linked list of ports? */
     unsigned int                    on_engine_list                  : 1;
 };
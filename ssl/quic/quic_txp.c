@@ -617,6 +617,14 @@ int ossl_quic_tx_packetiser_set_peer(OSSL_QUIC_TX_PACKETISER *txp,
     return 1;
 }
 
+void ossl_quic_tx_packetiser_set_cc(OSSL_QUIC_TX_PACKETISER *txp,
+                                    const OSSL_CC_METHOD *cc_method,
+                                    OSSL_CC_DATA *cc_data)
+{
+    txp->args.cc_method = cc_method;
+    txp->args.cc_data   = cc_data;
+}
+
 void ossl_quic_tx_packetiser_set_ack_tx_cb(OSSL_QUIC_TX_PACKETISER *txp,
                                            void (*cb)(const OSSL_QUIC_FRAME_ACK *ack,
                                                       uint32_t pn_space,
@@ -286,15 +286,15 @@ int ktls_configure_crypto(OSSL_LIB_CTX *libctx, int version, const EVP_CIPHER *c
 
 #endif /* OPENSSL_SYS_LINUX */
 
-static int ktls_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
-                                 unsigned char *key, size_t keylen,
-                                 unsigned char *iv, size_t ivlen,
-                                 unsigned char *mackey, size_t mackeylen,
-                                 const EVP_CIPHER *ciph,
-                                 size_t taglen,
-                                 int mactype,
-                                 const EVP_MD *md,
-                                 COMP_METHOD *comp)
+static int ktls_int_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
+                                     unsigned char *key, size_t keylen,
+                                     unsigned char *iv, size_t ivlen,
+                                     unsigned char *mackey, size_t mackeylen,
+                                     const EVP_CIPHER *ciph,
+                                     size_t taglen,
+                                     int mactype,
+                                     const EVP_MD *md,
+                                     COMP_METHOD *comp)
 {
     ktls_crypto_info_t crypto_info;
 
@@ -342,9 +342,53 @@ static int ktls_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
          */
         BIO_set_ktls_tx_zerocopy_sendfile(rl->bio);
 
+    if (rl->direction == OSSL_RECORD_DIRECTION_READ
+            && rl->version == TLS1_3_VERSION)
+        /*
+         * Ignore errors. Telling the kernel that we don't expect padded
+         * records lets it decrypt straight into our read buffer. Kernels that
+         * don't support this just carry on decrypting via their own buffers.
+         */
+        BIO_set_ktls_rx_expect_no_pad(rl->bio);
+
     return OSSL_RECORD_RETURN_SUCCESS;
 }
 
+static int ktls_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
+                                 unsigned char *key, size_t keylen,
+                                 unsigned char *iv, size_t ivlen,
+                                 unsigned char *mackey, size_t mackeylen,
+                                 const EVP_CIPHER *ciph,
+                                 size_t taglen,
+                                 int mactype,
+                                 const EVP_MD *md,
+                                 COMP_METHOD *comp)
+{
+    int ret, rekey;
+
+    /*
+     * If the socket is already offloaded in this direction then this is a TLS
+     * 1.3 KeyUpdate and the kernel's crypto state gets replaced in place.
+     * Kernels with rekey support pause the offloaded direction after the
+     * KeyUpdate message until the new keys arrive.
+     */
+    rekey = rl->direction == OSSL_RECORD_DIRECTION_WRITE
+            ? BIO_get_ktls_send(rl->bio) : BIO_get_ktls_recv(rl->bio);
+
+    ret = ktls_int_set_crypto_state(rl, level, key, keylen, iv, ivlen, mackey,
+                                    mackeylen, ciph, taglen, mactype, md, comp);
+
+    /*
+     * We can't fall back to another record layer once the kernel owns this
+     * direction of the socket: it would carry on protecting records with the
+     * old keys. This happens if the running kernel does not support rekeying.
+     */
+    if (rekey && ret == OSSL_RECORD_RETURN_NON_FATAL_ERR)
+        return OSSL_RECORD_RETURN_FATAL;
+
+    return ret;
+}
+
 static int ktls_read_n(OSSL_RECORD_LAYER *rl, size_t n, size_t max, int extend,
                        int clearold, size_t *readbytes)
 {
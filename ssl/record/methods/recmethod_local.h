@@ -293,8 +293,13 @@ struct ossl_record_layer_st {
     /* cryptographic state */
     EVP_CIPHER_CTX *enc_ctx;
 
-    /* TLSv1.3 MAC ctx, only used with integrity-only cipher */
+    /*
+     * Keyed MAC ctx: TLSv1.3 integrity-only ciphers and TLSv1.0-1.2 HMAC.
+     * It is never used directly, each record restores |mac_work| from it so
+     * the key is only set up once.
+     */
     EVP_MAC_CTX *mac_ctx;
+    EVP_MAC_CTX *mac_work;
 
     /* Explicit IV length */
     size_t eivlen;
@@ -410,6 +415,7 @@ int ossl_set_tls_provider_parameters(OSSL_RECORD_LAYER *rl,
                                      const EVP_MD *md);
 
 int tls_increment_sequence_ctr(OSSL_RECORD_LAYER *rl);
+EVP_MAC_CTX *tls_restore_mac_ctx(OSSL_RECORD_LAYER *rl);
 int tls_alloc_buffers(OSSL_RECORD_LAYER *rl);
 int tls_free_buffers(OSSL_RECORD_LAYER *rl);
 
@@ -518,6 +524,8 @@ int tls_post_encryption_processing_default(OSSL_RECORD_LAYER *rl,
                                            OSSL_RECORD_TEMPLATE *thistempl,
                                            WPACKET *thispkt,
                                            TLS_RL_RECORD *thiswr);
+void tls_copy_template_data(const OSSL_RECORD_TEMPLATE *templ,
+                            unsigned char *out);
 int tls_write_records_default(OSSL_RECORD_LAYER *rl,
                               OSSL_RECORD_TEMPLATE *templates,
                               size_t numtempl);
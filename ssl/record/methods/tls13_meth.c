@@ -183,7 +183,7 @@ static int tls13_cipher(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *recs,
     if (rl->mac_ctx != NULL) {
         int ret = 0;
 
-        if ((mac_ctx = EVP_MAC_CTX_dup(rl->mac_ctx)) == NULL
+        if ((mac_ctx = tls_restore_mac_ctx(rl)) == NULL
             || !EVP_MAC_update(mac_ctx, nonce, nonce_len)
             || !EVP_MAC_update(mac_ctx, recheader, sizeof(recheader))
             || !EVP_MAC_update(mac_ctx, rec->input, rec->length)
@@ -201,7 +201,6 @@ static int tls13_cipher(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *recs,
         }
         ret = 1;
     end_mac:
-        EVP_MAC_CTX_free(mac_ctx);
         return ret;
     }
 
@@ -405,6 +404,221 @@ static int tls13_add_record_padding(OSSL_RECORD_LAYER *rl,
     return 1;
 }
 
+/*
+ * The maximum number of records sealed by a single call to
+ * tls13_write_records_batch().
+ */
+#define TLS13_BATCH_MAX_RECORDS 8
+
+/*
+ * Determine whether a write of |len| bytes split into fragments of |fraglen|
+ * bytes can be sealed using tls13_write_records_batch(). Only AES-GCM and
+ * ChaCha20-Poly1305 are supported since they accept the plaintext in several
+ * EVP_CipherUpdate() calls, so the inner content type byte can be sealed
+ * without first copying the record payload into the write buffer.
+ */
+static int tls13_is_batch_capable(OSSL_RECORD_LAYER *rl, uint8_t type,
+                                  size_t len, size_t fraglen)
+{
+    const EVP_CIPHER *cipher;
+
+    if (type != SSL3_RT_APPLICATION_DATA
+            || fraglen == 0
+            || len < 4 * fraglen
+            || rl->enc_ctx == NULL
+            || rl->mac_ctx != NULL
+            || rl->msg_callback != NULL
+            || rl->padding != NULL
+            || rl->block_padding > 0)
+        return 0;
+
+    cipher = EVP_CIPHER_CTX_get0_cipher(rl->enc_ctx);
+    if (cipher == NULL)
+        return 0;
+
+    return EVP_CIPHER_get_mode(cipher) == EVP_CIPH_GCM_MODE
+           || EVP_CIPHER_get_nid(cipher) == NID_chacha20_poly1305;
+}
+
+static size_t tls13_get_max_records(OSSL_RECORD_LAYER *rl, uint8_t type,
+                                    size_t len, size_t maxfrag,
+                                    size_t *preffrag)
+{
+    if (tls13_is_batch_capable(rl, type, len, *preffrag)) {
+        size_t numrecs = len / *preffrag;
+
+        return numrecs < TLS13_BATCH_MAX_RECORDS ? numrecs
+                                                 : TLS13_BATCH_MAX_RECORDS;
+    }
+
+    return tls_get_max_records_default(rl, type, len, maxfrag, preffrag);
+}
+
+/*
+ * Encrypt the payload of |templ| to |out|, taking it from each of the
+ * application's buffers in turn if it is not contiguous.
+ */
+static int tls13_encrypt_template_data(EVP_CIPHER_CTX *enc_ctx,
+                                       const OSSL_RECORD_TEMPLATE *templ,
+                                       unsigned char *out, size_t *outlen)
+{
+    const SSL_IOVEC *iov = templ->iov;
+    const unsigned char *in = templ->buf;
+    size_t n, left = templ->buflen;
+    int lenu;
+
+    *outlen = 0;
+    while (left > 0) {
+        n = left;
+        if (iov != NULL
+                && (size_t)((const unsigned char *)iov->data + iov->len - in) < n)
+            n = (const unsigned char *)iov->data + iov->len - in;
+
+        if (n > 0) {
+            if (EVP_CipherUpdate(enc_ctx, out + *outlen, &lenu, in,
+                                 (int)n) <= 0)
+                return 0;
+            *outlen += lenu;
+        }
+
+        left -= n;
+        if (left > 0) {
+            iov++;
+            in = iov->data;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Seal all of the records in |templates| into a single contiguous write
+ * buffer, so that they are sent with one BIO_write() call. The plaintext is
+ * encrypted directly from the template buffers.
+ *
+ * Returns 1 on success, 0 if batching isn't suitable (non-fatal error), or
+ * -1 on fatal error.
+ */
+static int tls13_write_records_batch_int(OSSL_RECORD_LAYER *rl,
+                                         OSSL_RECORD_TEMPLATE *templates,
+                                         size_t numtempl)
+{
+    EVP_CIPHER_CTX *enc_ctx = rl->enc_ctx;
+    unsigned char *nonce = rl->nonce, *out;
+    size_t i, j, totlen = 0, buflen, nonce_len, offset, reclen, datalen;
+    int ivlen, lenu, lenf, outl;
+    TLS_BUFFER *wb;
+
+    if (numtempl < 2 || numtempl > TLS13_BATCH_MAX_RECORDS)
+        return 0;
+
+    for (i = 0; i < numtempl; i++) {
+        if (templates[i].type != templates[0].type
+                || templates[i].version != templates[0].version)
+            return 0;
+        totlen += templates[i].buflen;
+    }
+
+    if (!tls13_is_batch_capable(rl, templates[0].type, totlen,
+                                templates[0].buflen))
+        return 0;
+
+    ivlen = EVP_CIPHER_CTX_get_iv_length(enc_ctx);
+    if (ivlen < SEQ_NUM_SIZE) {
+        RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+        return -1;
+    }
+    nonce_len = (size_t)ivlen;
+    offset = nonce_len - SEQ_NUM_SIZE;
+
+    /*
+     * Size the write buffer for the largest possible batch rather than for
+     * this one, so that consecutive batches of different sizes reuse it. As
+     * for multiblock writes, it will be reallocated by the next non-batched
+     * write since its size will differ.
+     */
+    totlen += numtempl * (SSL3_RT_HEADER_LENGTH + 1 + rl->taglen);
+    buflen = TLS13_BATCH_MAX_RECORDS
+             * (SSL3_RT_HEADER_LENGTH + rl->max_frag_len + 1 + rl->taglen);
+    if (buflen < totlen)
+        buflen = totlen;
+    if (!tls_setup_write_buffer(rl, 1, buflen, buflen)) {
+        /* RLAYERfatal() already called */
+        return -1;
+    }
+    wb = &rl->wbuf[0];
+    out = wb->buf;
+
+    for (i = 0; i < numtempl; i++) {
+        unsigned char ctype = templates[i].type;
+        unsigned char *hdr = out;
+
+        reclen = templates[i].buflen + 1 + rl->taglen;
+        hdr[0] = SSL3_RT_APPLICATION_DATA;
+        hdr[1] = (unsigned char)(templates[i].version >> 8);
+        hdr[2] = (unsigned char)templates[i].version;
+        hdr[3] = (unsigned char)(reclen >> 8);
+        hdr[4] = (unsigned char)reclen;
+        out += SSL3_RT_HEADER_LENGTH;
+
+        memcpy(nonce, rl->iv, offset);
+        for (j = 0; j < SEQ_NUM_SIZE; j++)
+            nonce[offset + j] = rl->iv[offset + j] ^ rl->sequence[j];
+
+        if (!tls_increment_sequence_ctr(rl)) {
+            /* RLAYERfatal already called */
+            return -1;
+        }
+
+        if (EVP_CipherInit_ex(enc_ctx, NULL, NULL, NULL, nonce, 1) <= 0
+                || EVP_CipherUpdate(enc_ctx, NULL, &lenu, hdr,
+                                    SSL3_RT_HEADER_LENGTH) <= 0
+                || !tls13_encrypt_template_data(enc_ctx, &templates[i], out,
+                                                &datalen)
+                || EVP_CipherUpdate(enc_ctx, out + datalen, &outl,
+                                    &ctype, 1) <= 0
+                || EVP_CipherFinal_ex(enc_ctx, out + datalen + outl,
+                                      &lenf) <= 0
+                || datalen + (size_t)outl + (size_t)lenf
+                   != templates[i].buflen + 1
+                || EVP_CIPHER_CTX_ctrl(enc_ctx, EVP_CTRL_AEAD_GET_TAG,
+                                       (int)rl->taglen,
+                                       out + templates[i].buflen + 1) <= 0) {
+            RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+            return -1;
+        }
+        out += reclen;
+    }
+
+    wb->type = templates[0].type;
+    wb->offset = 0;
+    wb->left = totlen;
+
+    return 1;
+}
+
+static int tls13_write_records_batch(OSSL_RECORD_LAYER *rl,
+                                     OSSL_RECORD_TEMPLATE *templates,
+                                     size_t numtempl)
+{
+    int ret;
+
+    ret = tls13_write_records_batch_int(rl, templates, numtempl);
+    if (ret < 0) {
+        /* RLAYERfatal already called */
+        return 0;
+    }
+    if (ret == 0) {
+        /* Batching wasn't suitable so just do a standard write */
+        if (!tls_write_records_default(rl, templates, numtempl)) {
+            /* RLAYERfatal already called */
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 const struct record_functions_st tls_1_3_funcs = {
     tls13_set_crypto_state,
     tls13_cipher,
@@ -414,8 +628,8 @@ const struct record_functions_st tls_1_3_funcs = {
     tls_get_more_records,
     tls13_validate_record_header,
     tls13_post_process_record,
-    tls_get_max_records_default,
-    tls_write_records_default,
+    tls13_get_max_records,
+    tls13_write_records_batch,
     tls_allocate_write_buffers_default,
     tls_initialise_write_packets_default,
     tls13_get_record_type,
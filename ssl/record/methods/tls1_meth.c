@@ -16,6 +16,29 @@
 #include "../record_local.h"
 #include "recmethod_local.h"
 
+static int tls1_setup_hmac_ctx(OSSL_RECORD_LAYER *rl,
+                               const unsigned char *mackey, size_t mackeylen,
+                               const EVP_MD *md)
+{
+    EVP_MAC *mac;
+    OSSL_PARAM params[3], *p = params;
+
+    mac = EVP_MAC_fetch(rl->libctx, "HMAC", rl->propq);
+    if (mac == NULL || (rl->mac_ctx = EVP_MAC_CTX_new(mac)) == NULL) {
+        EVP_MAC_free(mac);
+        return 0;
+    }
+    EVP_MAC_free(mac);
+
+    *p++ = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                            (char *)EVP_MD_get0_name(md), 0);
+    if (rl->propq != NULL)
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_PROPERTIES,
+                                                (char *)rl->propq, 0);
+    *p = OSSL_PARAM_construct_end();
+    return EVP_MAC_init(rl->mac_ctx, mackey, mackeylen, params);
+}
+
 static int tls1_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
                                  unsigned char *key, size_t keylen,
                                  unsigned char *iv, size_t ivlen,
@@ -82,6 +105,17 @@ static int tls1_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
             return OSSL_RECORD_RETURN_FATAL;
         }
         EVP_PKEY_free(mac_key);
+
+        /*
+         * For HMAC also keep a keyed EVP_MAC_CTX.  Its inner and outer pad
+         * states are computed once here and each record only restores them,
+         * see tls1_mac().
+         */
+        if (mactype == EVP_PKEY_HMAC
+                && !tls1_setup_hmac_ctx(rl, mackey, mackeylen, md)) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_INTERNAL_ERROR);
+            return OSSL_RECORD_RETURN_FATAL;
+        }
     }
 
     if (EVP_CIPHER_get_mode(ciph) == EVP_CIPH_GCM_MODE) {
@@ -468,6 +502,7 @@ static int tls1_mac(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *rec, unsigned char *md
     EVP_MD_CTX *hash;
     size_t md_size;
     EVP_MD_CTX *hmac = NULL, *mac_ctx;
+    EVP_MAC_CTX *prepared = NULL;
     unsigned char header[13];
     int t;
     int ret = 0;
@@ -479,7 +514,12 @@ static int tls1_mac(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *rec, unsigned char *md
         return 0;
     md_size = t;
 
-    if (rl->stream_mac) {
+    if (rl->mac_ctx != NULL) {
+        /* HMAC: start from the precomputed pad states, no copy of |hash| */
+        if ((prepared = tls_restore_mac_ctx(rl)) == NULL)
+            goto end;
+        mac_ctx = hash;
+    } else if (rl->stream_mac) {
         mac_ctx = hash;
     } else {
         hmac = EVP_MD_CTX_new();
@@ -490,6 +530,7 @@ static int tls1_mac(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *rec, unsigned char *md
     }
 
     if (!rl->isdtls
+            && prepared == NULL
             && rl->tlstree
             && EVP_MD_CTX_ctrl(mac_ctx, EVP_MD_CTRL_TLSTREE, 0, seq) <= 0)
         goto end;
@@ -520,15 +561,25 @@ static int tls1_mac(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *rec, unsigned char *md
                                            &rec->orig_len);
         *p++ = OSSL_PARAM_construct_end();
 
-        if (!EVP_PKEY_CTX_set_params(EVP_MD_CTX_get_pkey_ctx(mac_ctx),
-                                     tls_hmac_params))
+        if (prepared != NULL) {
+            if (!EVP_MAC_CTX_set_params(prepared, tls_hmac_params))
+                goto end;
+        } else if (!EVP_PKEY_CTX_set_params(EVP_MD_CTX_get_pkey_ctx(mac_ctx),
+                                            tls_hmac_params)) {
             goto end;
+        }
     }
 
-    if (EVP_DigestSignUpdate(mac_ctx, header, sizeof(header)) <= 0
-        || EVP_DigestSignUpdate(mac_ctx, rec->input, rec->length) <= 0
-        || EVP_DigestSignFinal(mac_ctx, md, &md_size) <= 0)
+    if (prepared != NULL) {
+        if (!EVP_MAC_update(prepared, header, sizeof(header))
+            || !EVP_MAC_update(prepared, rec->input, rec->length)
+            || !EVP_MAC_final(prepared, md, &md_size, md_size))
+            goto end;
+    } else if (EVP_DigestSignUpdate(mac_ctx, header, sizeof(header)) <= 0
+               || EVP_DigestSignUpdate(mac_ctx, rec->input, rec->length) <= 0
+               || EVP_DigestSignFinal(mac_ctx, md, &md_size) <= 0) {
         goto end;
+    }
 
     OSSL_TRACE_BEGIN(TLS) {
         BIO_printf(trc_out, "seq:\n");
@@ -621,6 +672,7 @@ int tls1_initialise_write_packets(OSSL_RECORD_LAYER *rl,
         prefixtempl->buf = NULL;
         prefixtempl->version = templates[0].version;
         prefixtempl->buflen = 0;
+        prefixtempl->iov = NULL;
         prefixtempl->type = SSL3_RT_APPLICATION_DATA;
 
         wb = &bufs[0];
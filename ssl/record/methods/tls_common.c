@@ -1449,6 +1449,7 @@ static void tls_int_free(OSSL_RECORD_LAYER *rl)
 
     EVP_CIPHER_CTX_free(rl->enc_ctx);
     EVP_MAC_CTX_free(rl->mac_ctx);
+    EVP_MAC_CTX_free(rl->mac_work);
     EVP_MD_CTX_free(rl->md_ctx);
 #ifndef OPENSSL_NO_COMP
     COMP_CTX_free(rl->compctx);
@@ -1541,6 +1542,36 @@ size_t tls_get_max_records(OSSL_RECORD_LAYER *rl, uint8_t type, size_t len,
     return rl->funcs->get_max_records(rl, type, len, maxfrag, preffrag);
 }
 
+/*
+ * Copy the payload described by |templ| to |out|, gathering it from the
+ * application's buffers if it is not contiguous.
+ */
+void tls_copy_template_data(const OSSL_RECORD_TEMPLATE *templ,
+                            unsigned char *out)
+{
+    const SSL_IOVEC *iov = templ->iov;
+    size_t n, left = templ->buflen;
+
+    if (iov == NULL) {
+        if (left > 0)
+            memcpy(out, templ->buf, left);
+        return;
+    }
+
+    n = (const unsigned char *)iov->data + iov->len - templ->buf;
+    memcpy(out, templ->buf, n);
+    out += n;
+    left -= n;
+    while (left > 0) {
+        iov++;
+        n = iov->len < left ? iov->len : left;
+        if (n > 0)
+            memcpy(out, iov->data, n);
+        out += n;
+        left -= n;
+    }
+}
+
 int tls_allocate_write_buffers_default(OSSL_RECORD_LAYER *rl,
                                          OSSL_RECORD_TEMPLATE *templates,
                                          size_t numtempl,
@@ -1816,16 +1847,32 @@ int tls_write_records_default(OSSL_RECORD_LAYER *rl,
 
         /* first we compress */
         if (rl->compctx != NULL) {
-            if (!tls_do_compress(rl, thiswr)
+            unsigned char *gathered = NULL;
+            int compressed;
+
+            /* The compressor needs its input in a single buffer */
+            if (thistempl->iov != NULL) {
+                gathered = OPENSSL_malloc(thistempl->buflen);
+                if (gathered == NULL) {
+                    RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_CRYPTO_LIB);
+                    goto err;
+                }
+                tls_copy_template_data(thistempl, gathered);
+                TLS_RL_RECORD_set_input(thiswr, gathered);
+            }
+            compressed = tls_do_compress(rl, thiswr);
+            OPENSSL_free(gathered);
+            if (!compressed
                     || !WPACKET_allocate_bytes(thispkt, thiswr->length, NULL)) {
                 RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, SSL_R_COMPRESSION_FAILURE);
                 goto err;
             }
         } else if (compressdata != NULL) {
-            if (!WPACKET_memcpy(thispkt, thiswr->input, thiswr->length)) {
+            if (!WPACKET_allocate_bytes(thispkt, thiswr->length, NULL)) {
                 RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
                 goto err;
             }
+            tls_copy_template_data(thistempl, compressdata);
             TLS_RL_RECORD_reset_input(&wr[j]);
         }
 
@@ -2089,6 +2136,22 @@ int tls_increment_sequence_ctr(OSSL_RECORD_LAYER *rl)
     return 1;
 }
 
+/*
+ * Returns a MAC ctx ready to MAC the next record: |rl->mac_work| restored
+ * from the keyed |rl->mac_ctx|.  The key setup is not repeated and after the
+ * first record no allocation takes place.
+ */
+EVP_MAC_CTX *tls_restore_mac_ctx(OSSL_RECORD_LAYER *rl)
+{
+    if (rl->mac_work == NULL) {
+        rl->mac_work = EVP_MAC_CTX_dup(rl->mac_ctx);
+        return rl->mac_work;
+    }
+    if (!EVP_MAC_CTX_copy(rl->mac_work, rl->mac_ctx))
+        return NULL;
+    return rl->mac_work;
+}
+
 int tls_alloc_buffers(OSSL_RECORD_LAYER *rl)
 {
     if (rl->direction == OSSL_RECORD_DIRECTION_WRITE) {
@@ -85,6 +85,8 @@ static int tls_write_records_multiblock_int(OSSL_RECORD_LAYER *rl,
     for (i = 1; i < numtempl; i++) {
         if (templates[i - 1].type != templates[i].type
                 || templates[i - 1].buflen != templates[i].buflen
+                || templates[i - 1].iov != NULL
+                || templates[i].iov != NULL
                 || templates[i - 1].buf + templates[i - 1].buflen
                    != templates[i].buf)
             return 0;
@@ -261,6 +261,40 @@ static int tls_write_check_pending(SSL_CONNECTION *s, uint8_t type,
     return 1;
 }
 
+/*
+ * Set up |tmpl| to hold the |len| bytes found |off| bytes into the data being
+ * written. That data is either the contiguous buffer |buf| or, if |iov| is not
+ * NULL, the |iovcnt| buffers passed to SSL_writev().
+ */
+static void rlayer_set_template_data(OSSL_RECORD_TEMPLATE *tmpl,
+                                     const unsigned char *buf,
+                                     const SSL_IOVEC *iov, size_t iovcnt,
+                                     size_t off, size_t len)
+{
+    size_t i;
+
+    tmpl->buflen = len;
+    tmpl->iov = NULL;
+
+    if (iov == NULL) {
+        tmpl->buf = buf + off;
+        return;
+    }
+
+    for (i = 0; i < iovcnt && off >= iov[i].len; i++)
+        off -= iov[i].len;
+
+    if (i == iovcnt) {
+        /* Can only happen for an empty record at the end of the data */
+        tmpl->buf = NULL;
+        return;
+    }
+
+    tmpl->buf = (const unsigned char *)iov[i].data + off;
+    if (iov[i].len - off < len)
+        tmpl->iov = &iov[i];
+}
+
 /*
  * Call this to write data in records of type 'type' It will return <= 0 if
  * not all data has been sent or non-blocking IO.
@@ -275,10 +309,14 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
     SSL_CONNECTION *s = SSL_CONNECTION_FROM_SSL_ONLY(ssl);
     OSSL_RECORD_TEMPLATE tmpls[SSL_MAX_PIPELINES];
     unsigned int recversion;
+    const SSL_IOVEC *wiov;
 
     if (s == NULL)
         return -1;
 
+    /* Only application data can come from SSL_writev() */
+    wiov = (type == SSL3_RT_APPLICATION_DATA) ? s->rlayer.wiov : NULL;
+
     s->rwstate = SSL_NOTHING;
     tot = s->rlayer.wnum;
     /*
@@ -435,8 +473,10 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             for (j = 0; j < maxpipes; j++) {
                 tmpls[j].type = type;
                 tmpls[j].version = recversion;
-                tmpls[j].buf = &(buf[tot]) + (j * split_send_fragment);
-                tmpls[j].buflen = split_send_fragment;
+                rlayer_set_template_data(&tmpls[j], buf, wiov,
+                                         s->rlayer.wiovcnt,
+                                         tot + j * split_send_fragment,
+                                         split_send_fragment);
             }
             /* Remember how much data we are going to be sending */
             s->rlayer.wpend_tot = maxpipes * split_send_fragment;
@@ -453,8 +493,9 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             for (j = 0; j < maxpipes; j++) {
                 tmpls[j].type = type;
                 tmpls[j].version = recversion;
-                tmpls[j].buf = &(buf[tot]) + lensofar;
-                tmpls[j].buflen = tmppipelen;
+                rlayer_set_template_data(&tmpls[j], buf, wiov,
+                                         s->rlayer.wiovcnt, tot + lensofar,
+                                         tmppipelen);
                 lensofar += tmppipelen;
                 if (j + 1 == remain)
                     tmppipelen--;
@@ -463,6 +504,20 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             s->rlayer.wpend_tot = n;
         }
 
+        /*
+         * With KTLS the record layer hands the application's buffer straight
+         * to the kernel, so a record cannot span more than one of the buffers
+         * passed to SSL_writev(). The kernel does its own record framing in
+         * any case, so just write up to the end of the current buffer.
+         */
+        if (tmpls[0].iov != NULL && maxpipes == 1
+                && BIO_get_ktls_send(s->wbio)) {
+            tmpls[0].buflen = (const unsigned char *)tmpls[0].iov->data
+                              + tmpls[0].iov->len - tmpls[0].buf;
+            tmpls[0].iov = NULL;
+            s->rlayer.wpend_tot = tmpls[0].buflen;
+        }
+
         i = HANDLE_RLAYER_WRITE_RETURN(s,
             s->rlayer.wrlmethod->write_records(s->rlayer.wrl, tmpls, maxpipes));
         if (i <= 0) {
@@ -104,6 +104,12 @@ typedef struct record_layer_st {
     size_t wpend_tot;
     uint8_t wpend_type;
     const unsigned char *wpend_buf;
+    /*
+     * Application data buffers for the SSL_writev() call in progress, or NULL
+     * if the data being written is contiguous
+     */
+    const SSL_IOVEC *wiov;
+    size_t wiovcnt;
 
     /* Count of the number of consecutive warning alerts received */
     unsigned int alert_count;
@@ -0,0 +1,306 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <limits.h>
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include "poll_builder.h"
+
+#if defined(RIO_POLL_METHOD_SELECT)
+
+int ossl_rio_poll_builder_init(RIO_POLL_BUILDER *rpb)
+{
+    FD_ZERO(&rpb->rfd);
+    FD_ZERO(&rpb->wfd);
+    FD_ZERO(&rpb->efd);
+    FD_ZERO(&rpb->rfd_out);
+    FD_ZERO(&rpb->wfd_out);
+    FD_ZERO(&rpb->efd_out);
+    rpb->hwm_fd = -1;
+    return 1;
+}
+
+void ossl_rio_poll_builder_cleanup(RIO_POLL_BUILDER *rpb)
+{
+}
+
+void ossl_rio_poll_builder_reset(RIO_POLL_BUILDER *rpb)
+{
+    ossl_rio_poll_builder_init(rpb);
+}
+
+int ossl_rio_poll_builder_is_empty(const RIO_POLL_BUILDER *rpb)
+{
+    return rpb->hwm_fd < 0;
+}
+
+int ossl_rio_poll_builder_add_fd(RIO_POLL_BUILDER *rpb, int fd,
+                                 int want_read, int want_write)
+{
+    if (fd < 0)
+        return 0;
+
+# ifndef OPENSSL_SYS_WINDOWS
+    /*
+     * On Windows there is no relevant limit to the magnitude of a fd value. On
+     * *NIX the fd_set uses a bitmap and we must check the limit.
+     */
+    if (fd >= FD_SETSIZE) {
+        ERR_raise_data(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT,
+                       "FD too large for select()");
+        return 0;
+    }
+# endif
+
+    if (want_read)
+        openssl_fdset(fd, &rpb->rfd);
+    if (want_write)
+        openssl_fdset(fd, &rpb->wfd);
+
+    /* Always check for error conditions. */
+    openssl_fdset(fd, &rpb->efd);
+
+    if (fd > rpb->hwm_fd)
+        rpb->hwm_fd = fd;
+
+    return 1;
+}
+
+int ossl_rio_poll_builder_poll(RIO_POLL_BUILDER *rpb, OSSL_TIME deadline)
+{
+    struct timeval tv, *ptv;
+    int pres;
+
+    do {
+        rpb->rfd_out = rpb->rfd;
+        rpb->wfd_out = rpb->wfd;
+        rpb->efd_out = rpb->efd;
+
+        /*
+         * select expects a timeout, not a deadline, so do the conversion.
+         * Update for each call to ensure the correct value is used if we repeat
+         * due to EINTR.
+         */
+        if (ossl_time_is_infinite(deadline)) {
+            ptv = NULL;
+        } else {
+            /* ossl_time_subtract saturates to zero. */
+            tv  = ossl_time_to_timeval(ossl_time_subtract(deadline,
+                                                          ossl_time_now()));
+            ptv = &tv;
+        }
+
+        pres = select(rpb->hwm_fd + 1, &rpb->rfd_out, &rpb->wfd_out,
+                      &rpb->efd_out, ptv);
+    } while (pres == -1 && get_last_socket_error_is_eintr());
+
+    if (pres < 0) {
+        ERR_raise_data(ERR_LIB_SYS, get_last_socket_error(),
+                       "calling select()");
+        return 0;
+    }
+
+    return 1;
+}
+
+int ossl_rio_poll_builder_get_revents(const RIO_POLL_BUILDER *rpb, int fd,
+                                      int *readable, int *writable)
+{
+    int err;
+
+    /* FD_ISSET does not take a const fd_set on all platforms. */
+    RIO_POLL_BUILDER *r = (RIO_POLL_BUILDER *)rpb;
+
+    if (fd < 0 || !FD_ISSET(fd, &r->efd))
+        return 0;
+
+    err         = FD_ISSET(fd, &r->efd_out);
+    *readable   = err || FD_ISSET(fd, &r->rfd_out);
+    *writable   = err || FD_ISSET(fd, &r->wfd_out);
+    return 1;
+}
+
+#else
+
+/* Initial number of distinct FDs we have room for. */
+# define RIO_POLL_INIT_ALLOC    16
+
+/* Fibonacci hashing of an FD into a table of size 2**n. */
+static ossl_inline size_t fd_hash(int fd, size_t mask)
+{
+    return (size_t)((uint32_t)fd * UINT32_C(2654435769)) & mask;
+}
+
+int ossl_rio_poll_builder_init(RIO_POLL_BUILDER *rpb)
+{
+    rpb->pfd        = NULL;
+    rpb->pfd_num    = 0;
+    rpb->pfd_alloc  = 0;
+    rpb->idx        = NULL;
+    rpb->idx_alloc  = 0;
+    return 1;
+}
+
+void ossl_rio_poll_builder_cleanup(RIO_POLL_BUILDER *rpb)
+{
+    OPENSSL_free(rpb->pfd);
+    OPENSSL_free(rpb->idx);
+    rpb->pfd        = NULL;
+    rpb->idx        = NULL;
+    rpb->pfd_num    = 0;
+    rpb->pfd_alloc  = 0;
+    rpb->idx_alloc  = 0;
+}
+
+void ossl_rio_poll_builder_reset(RIO_POLL_BUILDER *rpb)
+{
+    if (rpb->idx != NULL)
+        memset(rpb->idx, 0, rpb->idx_alloc * sizeof(*rpb->idx));
+
+    rpb->pfd_num = 0;
+}
+
+int ossl_rio_poll_builder_is_empty(const RIO_POLL_BUILDER *rpb)
+{
+    return rpb->pfd_num == 0;
+}
+
+/* Returns a pointer to the hash table slot for fd, which may be empty. */
+static size_t *find_slot(const RIO_POLL_BUILDER *rpb, int fd)
+{
+    size_t mask = rpb->idx_alloc - 1, i = fd_hash(fd, mask);
+
+    while (rpb->idx[i] != 0 && rpb->pfd[rpb->idx[i] - 1].fd != fd)
+        i = (i + 1) & mask;
+
+    return &rpb->idx[i];
+}
+
+/*
+ * Ensure there is room for one more FD. The hash table is kept at most half
+ * full so that probe sequences stay short.
+ */
+static int ensure_space(RIO_POLL_BUILDER *rpb)
+{
+    struct pollfd *pfd;
+    size_t *idx, new_alloc, i;
+
+    if (rpb->pfd_num < rpb->pfd_alloc)
+        return 1;
+
+    new_alloc = rpb->pfd_alloc == 0 ? RIO_POLL_INIT_ALLOC : rpb->pfd_alloc * 2;
+    if (new_alloc > SIZE_MAX / (2 * sizeof(size_t))) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    /*
+     * Allocate the new index first, and only update the builder once both
+     * allocations have succeeded, so that a failure leaves it as it was.
+     */
+    idx = OPENSSL_zalloc(2 * new_alloc * sizeof(*idx));
+    if (idx == NULL)
+        return 0;
+
+    pfd = OPENSSL_realloc(rpb->pfd, new_alloc * sizeof(*pfd));
+    if (pfd == NULL) {
+        OPENSSL_free(idx);
+        return 0;
+    }
+
+    rpb->pfd        = pfd;
+    rpb->pfd_alloc  = new_alloc;
+    OPENSSL_free(rpb->idx);
+    rpb->idx        = idx;
+    rpb->idx_alloc  = 2 * new_alloc;
+
+    for (i = 0; i < rpb->pfd_num; ++i)
+        *find_slot(rpb, rpb->pfd[i].fd) = i + 1;
+
+    return 1;
+}
+
+int ossl_rio_poll_builder_add_fd(RIO_POLL_BUILDER *rpb, int fd,
+                                 int want_read, int want_write)
+{
+    size_t *slot;
+    short events = (want_read ? POLLIN : 0) | (want_write ? POLLOUT : 0);
+
+    if (fd < 0)
+        return 0;
+
+    if (rpb->idx_alloc > 0) {
+        slot = find_slot(rpb, fd);
+        if (*slot != 0) {
+            rpb->pfd[*slot - 1].events |= events;
+            return 1;
+        }
+    }
+
+    if (!ensure_space(rpb))
+        return 0;
+
+    slot = find_slot(rpb, fd);
+    rpb->pfd[rpb->pfd_num].fd       = fd;
+    rpb->pfd[rpb->pfd_num].events   = events;
+    rpb->pfd[rpb->pfd_num].revents  = 0;
+    *slot = ++rpb->pfd_num;
+    return 1;
+}
+
+int ossl_rio_poll_builder_poll(RIO_POLL_BUILDER *rpb, OSSL_TIME deadline)
+{
+    int pres, timeout_ms;
+    uint64_t ms;
+
+    do {
+        if (ossl_time_is_infinite(deadline)) {
+            timeout_ms = -1;
+        } else {
+            /*
+             * ossl_time_subtract saturates to zero. Round up, so that a
+             * deadline less than a millisecond away does not turn into a
+             * zero timeout and a busy loop until the deadline passes.
+             */
+            ms = ossl_time2ms_roundup(ossl_time_subtract(deadline,
+                                                         ossl_time_now()));
+            timeout_ms = ms > INT_MAX ? INT_MAX : (int)ms;
+        }
+
+        pres = poll(rpb->pfd, rpb->pfd_num, timeout_ms);
+    } while (pres == -1 && get_last_socket_error_is_eintr());
+
+    if (pres < 0) {
+        ERR_raise_data(ERR_LIB_SYS, get_last_socket_error(),
+                       "calling poll()");
+        return 0;
+    }
+
+    return 1;
+}
+
+int ossl_rio_poll_builder_get_revents(const RIO_POLL_BUILDER *rpb, int fd,
+                                      int *readable, int *writable)
+{
+    const struct pollfd *pfd;
+    size_t slot;
+    int err;
+
+    if (fd < 0 || rpb->idx_alloc == 0 || (slot = *find_slot(rpb, fd)) == 0)
+        return 0;
+
+    pfd         = &rpb->pfd[slot - 1];
+    err         = (pfd->revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+    *readable   = err || (pfd->revents & POLLIN) != 0;
+    *writable   = err || (pfd->revents & POLLOUT) != 0;
+    return 1;
+}
+
+#endif
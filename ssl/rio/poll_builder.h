@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+#ifndef OSSL_RIO_POLL_BUILDER_H
+# define OSSL_RIO_POLL_BUILDER_H
+
+# include "internal/common.h"
+# include "internal/sockets.h"
+# include "internal/time.h"
+
+/*
+ * RIO_POLL_BUILDER
+ * ================
+ *
+ * RIO_POLL_BUILDER provides support for accumulating a set of file descriptors
+ * and the readiness events of interest on each of them, and then blocking until
+ * one of them becomes ready or a deadline passes. It abstracts over the OS
+ * polling mechanism (poll(2) where available, otherwise select(2)).
+ *
+ * A file descriptor may be added more than once, in which case the interest
+ * sets are merged. This is the common case when many QUIC connections share a
+ * single UDP socket, and means the cost of the wait is proportional to the
+ * number of distinct file descriptors rather than the number of objects being
+ * polled.
+ */
+# if defined(OPENSSL_SYS_WINDOWS) || !defined(POLLIN)
+#  define RIO_POLL_METHOD_SELECT
+# endif
+
+typedef struct rio_poll_builder_st {
+# if defined(RIO_POLL_METHOD_SELECT)
+    fd_set          rfd, wfd, efd;
+    fd_set          rfd_out, wfd_out, efd_out;
+    int             hwm_fd;
+# else
+    struct pollfd   *pfd;
+    size_t          pfd_num, pfd_alloc;
+
+    /* Open addressing hash table mapping an FD to (its index in pfd) + 1. */
+    size_t          *idx;
+    size_t          idx_alloc;
+# endif
+} RIO_POLL_BUILDER;
+
+int ossl_rio_poll_builder_init(RIO_POLL_BUILDER *rpb);
+void ossl_rio_poll_builder_cleanup(RIO_POLL_BUILDER *rpb);
+
+/*
+ * Remove all FDs from the set, keeping any allocations for reuse by the next
+ * round of calls to ossl_rio_poll_builder_add_fd.
+ */
+void ossl_rio_poll_builder_reset(RIO_POLL_BUILDER *rpb);
+
+/* Returns 1 if no FDs have been added since the last reset. */
+int ossl_rio_poll_builder_is_empty(const RIO_POLL_BUILDER *rpb);
+
+/*
+ * Add an FD to the set to be polled, expressing interest in readability and/or
+ * writability. Error conditions are always reported. Returns 1 on success.
+ */
+int ossl_rio_poll_builder_add_fd(RIO_POLL_BUILDER *rpb, int fd,
+                                 int want_read, int want_write);
+
+/*
+ * Block until at least one of the added FDs is ready or the deadline passes.
+ * A deadline of ossl_time_zero() polls without blocking. Returns 1 on success,
+ * including if the deadline passed, and 0 on failure.
+ */
+int ossl_rio_poll_builder_poll(RIO_POLL_BUILDER *rpb, OSSL_TIME deadline);
+
+/*
+ * After a successful call to ossl_rio_poll_builder_poll, determine the
+ * readiness of an FD previously added. An FD which has an error condition is
+ * reported as both readable and writable so that the condition is noticed by
+ * the next I/O call. Returns 0 if the FD was not added.
+ */
+int ossl_rio_poll_builder_get_revents(const RIO_POLL_BUILDER *rpb, int fd,
+                                      int *readable, int *writable);
+
+#endif
@@ -7,10 +7,13 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <string.h>
 #include "internal/common.h"
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include "../ssl_local.h"
+#include "poll_builder.h"
+#include "internal/quic_ssl.h"
 
 #define ITEM_N(items, stride, n) \
     (*(SSL_POLL_ITEM *)((char *)(items) + (n)*(stride)))
@@ -33,6 +36,138 @@
         FAIL_FROM(i + 1);                                                   \
     } while (0)
 
+#ifndef OPENSSL_NO_QUIC
+
+/*
+ * Set of the QUIC reactors whose events have been handled in the current round
+ * of polling. A reactor shared by many polled objects, such as all of the
+ * streams of a connection or all of the connections accepted from a listener,
+ * is thereby only ticked once per round.
+ */
+typedef struct reactor_set_st {
+    const QUIC_REACTOR  **slot;
+    size_t              num, alloc;
+} REACTOR_SET;
+
+static size_t reactor_hash(const QUIC_REACTOR *rtor, size_t mask)
+{
+    uint64_t v = (uint64_t)(uintptr_t)rtor;
+
+    return (size_t)((v * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & mask;
+}
+
+static const QUIC_REACTOR **reactor_set_find(const QUIC_REACTOR **slot,
+                                             size_t alloc,
+                                             const QUIC_REACTOR *rtor)
+{
+    size_t mask = alloc - 1, i = reactor_hash(rtor, mask);
+
+    while (slot[i] != NULL && slot[i] != rtor)
+        i = (i + 1) & mask;
+
+    return &slot[i];
+}
+
+/* Returns 1 if rtor was added, 0 if it was already present or -1 on error. */
+static int reactor_set_add(REACTOR_SET *set, const QUIC_REACTOR *rtor)
+{
+    const QUIC_REACTOR **slot, **p;
+    size_t i, new_alloc;
+
+    /* Keep the table at most half full. */
+    if (2 * (set->num + 1) > set->alloc) {
+        new_alloc = set->alloc == 0 ? 16 : set->alloc * 2;
+        slot = OPENSSL_zalloc(new_alloc * sizeof(*slot));
+        if (slot == NULL)
+            return -1;
+
+        for (i = 0; i < set->alloc; ++i)
+            if (set->slot[i] != NULL)
+                *reactor_set_find(slot, new_alloc, set->slot[i]) = set->slot[i];
+
+        OPENSSL_free(set->slot);
+        set->slot   = slot;
+        set->alloc  = new_alloc;
+    }
+
+    p = reactor_set_find(set->slot, set->alloc, rtor);
+    if (*p != NULL)
+        return 0;
+
+    *p = rtor;
+    ++set->num;
+    return 1;
+}
+
+static void reactor_set_reset(REACTOR_SET *set)
+{
+    if (set->slot != NULL)
+        memset(set->slot, 0, set->alloc * sizeof(*set->slot));
+
+    set->num = 0;
+}
+
+/*
+ * Adds the network poll descriptors of a QUIC SSL object to the poll builder
+ * and lowers *deadline to the point by which the object next needs its events
+ * to be handled. Descriptors of type NONE (e.g. a connection which has not yet
+ * been started) contribute only a deadline.
+ */
+static int poll_add_quic(RIO_POLL_BUILDER *rpb, SSL *ssl, OSSL_TIME *deadline)
+{
+    BIO_POLL_DESCRIPTOR rdesc, wdesc;
+    int want_read, want_write;
+    OSSL_TIME obj_deadline;
+
+    if (!ossl_quic_conn_get_poll_info(ssl, &rdesc, &want_read,
+                                      &wdesc, &want_write, &obj_deadline))
+        return 0;
+
+    *deadline = ossl_time_min(*deadline, obj_deadline);
+
+    if (rdesc.type == BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD) {
+        if (!ossl_rio_poll_builder_add_fd(rpb, rdesc.value.fd, want_read, 0))
+            return 0;
+    } else if (rdesc.type != BIO_POLL_DESCRIPTOR_TYPE_NONE) {
+        ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                       "SSL_poll can only block on QUIC SSL objects using "
+                       "socket network BIOs");
+        return 0;
+    }
+
+    if (wdesc.type == BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD) {
+        if (!ossl_rio_poll_builder_add_fd(rpb, wdesc.value.fd, 0, want_write))
+            return 0;
+    } else if (wdesc.type != BIO_POLL_DESCRIPTOR_TYPE_NONE) {
+        ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                       "SSL_poll can only block on QUIC SSL objects using "
+                       "socket network BIOs");
+        return 0;
+    }
+
+    return 1;
+}
+
+#endif
+
+static int is_quic_item(const SSL_POLL_ITEM *item)
+{
+    if (item->desc.type != BIO_POLL_DESCRIPTOR_TYPE_SSL
+        || item->desc.value.ssl == NULL)
+        return 0;
+
+    switch (item->desc.value.ssl->type) {
+#ifndef OPENSSL_NO_QUIC
+    case SSL_TYPE_QUIC_CONNECTION:
+    case SSL_TYPE_QUIC_XSO:
+    case SSL_TYPE_QUIC_LISTENER:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
 int SSL_poll(SSL_POLL_ITEM *items,
              size_t num_items,
              size_t stride,
@@ -40,85 +175,195 @@ int SSL_poll(SSL_POLL_ITEM *items,
              uint64_t flags,
              size_t *p_result_count)
 {
-    int ok = 1;
+    int ok = 1, readable, writable;
     size_t i, result_count = 0;
     SSL_POLL_ITEM *item;
     SSL *ssl;
     uint64_t revents;
-    ossl_unused uint64_t events;
-    ossl_unused int do_tick = ((flags & SSL_POLL_FLAG_NO_HANDLE_EVENTS) == 0);
+    uint64_t events;
+    int do_tick = ((flags & SSL_POLL_FLAG_NO_HANDLE_EVENTS) == 0);
     int is_immediate
         = (timeout != NULL
            && timeout->tv_sec == 0 && timeout->tv_usec == 0);
-
-    /*
-     * Prevent calls which use SSL_poll functionality which is not currently
-     * supported.
-     */
-    if (!is_immediate) {
-        ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                       "SSL_poll does not currently support blocking "
-                       "operation");
-        FAIL_FROM(0);
-    }
+    OSSL_TIME deadline, wait_deadline;
+    RIO_POLL_BUILDER rpb;
+#ifndef OPENSSL_NO_QUIC
+    REACTOR_SET ticked = {0};
+    int rv;
+#endif
 
     /* Trivial case. */
     if (num_items == 0)
         goto out;
 
-    /* Poll current state of each item. */
-    for (i = 0; i < num_items; ++i) {
-        item    = &ITEM_N(items, stride, i);
-        events  = item->events;
-        revents = 0;
-
-        switch (item->desc.type) {
-        case BIO_POLL_DESCRIPTOR_TYPE_SSL:
-            ssl = item->desc.value.ssl;
-            if (ssl == NULL)
-                /* NULL items are no-ops and have revents reported as 0 */
-                break;
+    deadline = timeout == NULL
+        ? ossl_time_infinite()
+        : ossl_time_add(ossl_time_now(), ossl_time_from_timeval(*timeout));
+
+    ossl_rio_poll_builder_init(&rpb);
+
+    for (;;) {
+        ossl_rio_poll_builder_reset(&rpb);
+        result_count  = 0;
+        wait_deadline = deadline;
 
-            switch (ssl->type) {
 #ifndef OPENSSL_NO_QUIC
-            case SSL_TYPE_QUIC_CONNECTION:
-            case SSL_TYPE_QUIC_XSO:
-                if (!ossl_quic_conn_poll_events(ssl, events, do_tick, &revents))
+        /*
+         * Handle events on every QUIC item before determining the readiness of
+         * any of them, as handling the events of one object can change the
+         * state of another object sharing its reactor.
+         */
+        if (do_tick) {
+            reactor_set_reset(&ticked);
+
+            for (i = 0; i < num_items; ++i) {
+                item = &ITEM_N(items, stride, i);
+                item->revents = 0;
+                if (!is_quic_item(item))
+                    continue;
+
+                rv = reactor_set_add(&ticked,
+                                     ossl_quic_get0_reactor(item->desc.value.ssl));
+                if (rv < 0)
+                    FAIL_FROM(0);
+
+                if (rv > 0
+                    && !ossl_quic_conn_poll_events(item->desc.value.ssl, 0, 1,
+                                                   &revents))
                     /* above call raises ERR */
                     FAIL_ITEM(i);
+            }
+        }
+#endif
 
-                if (revents != 0)
-                    ++result_count;
+        /*
+         * Determine the current state of each item. Unless the call is
+         * immediate, also gather the sockets and deadlines we need to wait on
+         * should no item be ready. Sockets shared by many QUIC objects are only
+         * waited on once.
+         */
+        for (i = 0; i < num_items; ++i) {
+            item    = &ITEM_N(items, stride, i);
+            events  = item->events;
+            revents = 0;
 
-                break;
+            switch (item->desc.type) {
+            case BIO_POLL_DESCRIPTOR_TYPE_SSL:
+                ssl = item->desc.value.ssl;
+                if (ssl == NULL)
+                    /* NULL items are no-ops and have revents reported as 0 */
+                    break;
+
+                switch (ssl->type) {
+#ifndef OPENSSL_NO_QUIC
+                case SSL_TYPE_QUIC_CONNECTION:
+                case SSL_TYPE_QUIC_XSO:
+                case SSL_TYPE_QUIC_LISTENER:
+                    if (!ossl_quic_conn_poll_events(ssl, events, 0, &revents))
+                        /* above call raises ERR */
+                        FAIL_ITEM(i);
+
+                    if (revents != 0)
+                        ++result_count;
+
+                    /*
+                     * Without handling events a QUIC object cannot change state
+                     * as a result of network activity, so there is nothing to
+                     * wait for on its behalf.
+                     */
+                    if (!is_immediate && do_tick && result_count == 0
+                        && !poll_add_quic(&rpb, ssl, &wait_deadline))
+                        FAIL_ITEM(i);
+
+                    break;
 #endif
 
+                default:
+                    ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                                   "SSL_poll currently only supports QUIC SSL "
+                                   "objects");
+                    FAIL_ITEM(i);
+                }
+                break;
+            case BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD:
+                if (!ossl_rio_poll_builder_add_fd(&rpb, item->desc.value.fd,
+                                                  (events & SSL_POLL_EVENT_R) != 0,
+                                                  (events & SSL_POLL_EVENT_W) != 0))
+                    FAIL_ITEM(i);
+
+                break;
             default:
                 ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                               "SSL_poll currently only supports QUIC SSL "
-                               "objects");
+                               "SSL_poll does not support unknown poll "
+                               "descriptor type %d", item->desc.type);
                 FAIL_ITEM(i);
             }
-            break;
-        case BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD:
-            ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                           "SSL_poll currently does not support polling "
-                           "sockets");
-            FAIL_ITEM(i);
-        default:
-            ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                           "SSL_poll does not support unknown poll descriptor "
-                           "type %d", item->desc.type);
-            FAIL_ITEM(i);
+
+            item->revents = revents;
         }
+        /*
+         * Wait for readiness. If something is already ready we still poll any
+         * socket items, but without blocking.
+         */
+        if (is_immediate || result_count > 0)
+            wait_deadline = ossl_time_zero();
 
-        item->revents = revents;
-    }
+        if (ossl_rio_poll_builder_is_empty(&rpb)) {
+            if (ossl_time_is_infinite(wait_deadline)) {
+                ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                               "SSL_poll has nothing to wait for and no "
+                               "timeout was given");
+                FAIL_FROM(0);
+            }
 
-    /* TODO(QUIC POLLING): Blocking mode */
-    /* TODO(QUIC POLLING): Support for polling FDs */
+            /*
+             * Nothing to poll; just sleep until the deadline, if any. Round
+             * up, as for poll(), so a deadline less than a millisecond away
+             * does not become a busy loop.
+             */
+            if (!ossl_time_is_zero(wait_deadline))
+                OSSL_sleep(ossl_time2ms_roundup(
+                               ossl_time_subtract(wait_deadline,
+                                                  ossl_time_now())));
+        } else if (!ossl_rio_poll_builder_poll(&rpb, wait_deadline)) {
+            FAIL_FROM(0);
+        }
+
+        for (i = 0; i < num_items; ++i) {
+            item = &ITEM_N(items, stride, i);
+            if (item->desc.type != BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD
+                || !ossl_rio_poll_builder_get_revents(&rpb, item->desc.value.fd,
+                                                      &readable, &writable))
+                continue;
+
+            revents = 0;
+            if (readable)
+                revents |= SSL_POLL_EVENT_R;
+            if (writable)
+                revents |= SSL_POLL_EVENT_W;
+
+            item->revents = revents & item->events;
+            if (item->revents != 0)
+                ++result_count;
+        }
+
+        if (result_count > 0 || is_immediate
+            || ossl_time_compare(ossl_time_now(), deadline) >= 0)
+            break;
+
+        /*
+         * Either a socket became ready or a QUIC object reached its deadline,
+         * so go around again to handle events and see if any item is now ready.
+         */
+    }
 
 out:
+    if (num_items > 0)
+        ossl_rio_poll_builder_cleanup(&rpb);
+#ifndef OPENSSL_NO_QUIC
+    OPENSSL_free(ticked.slot);
+#endif
+
     if (p_result_count != NULL)
         *p_result_count = result_count;
 
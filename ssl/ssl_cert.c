@@ -257,6 +257,8 @@ void ssl_cert_clear_certs(CERT *c)
             cpk->cert_comp_used = 0;
         }
 #endif
+        ssl_cert_msg_free(cpk->cert_msg);
+        cpk->cert_msg = NULL;
     }
 }
 
@@ -289,6 +291,127 @@ void ssl_cert_free(CERT *c)
     OPENSSL_free(c);
 }
 
+/*
+ * Encode the certificate_list for |x| followed by |chain| in both the TLSv1.2
+ * and the TLSv1.3 form. Each certificate is only DER encoded once.
+ */
+SSL_CERT_MSG *ssl_cert_msg_new(X509 *x, STACK_OF(X509) *chain)
+{
+    SSL_CERT_MSG *msg;
+    WPACKET pkt12, pkt13;
+    unsigned char *der;
+    size_t total = 0;
+    int i, len, num = chain == NULL ? 0 : sk_X509_num(chain);
+
+    for (i = -1; i < num; i++) {
+        len = i2d_X509(i < 0 ? x : sk_X509_value(chain, i), NULL);
+        if (len <= 0) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_X509_LIB);
+            return NULL;
+        }
+        total += 3 + (size_t)len;
+    }
+
+    if ((msg = OPENSSL_zalloc(sizeof(*msg))) == NULL)
+        return NULL;
+    if (!CRYPTO_NEW_REF(&msg->references, 1)) {
+        OPENSSL_free(msg);
+        return NULL;
+    }
+    msg->tls12_len = total;
+    msg->tls13_len = total + 2 * (size_t)(num + 1);
+    msg->tls12 = OPENSSL_malloc(msg->tls12_len);
+    msg->tls13 = OPENSSL_malloc(msg->tls13_len);
+    if (msg->tls12 == NULL || msg->tls13 == NULL)
+        goto err;
+    if ((chain != NULL && (msg->chain = X509_chain_up_ref(chain)) == NULL)
+            || !X509_up_ref(x)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_X509_LIB);
+        goto err;
+    }
+    msg->x509 = x;
+
+    if (!WPACKET_init_static_len(&pkt12, msg->tls12, msg->tls12_len, 0))
+        goto err;
+    if (!WPACKET_init_static_len(&pkt13, msg->tls13, msg->tls13_len, 0)) {
+        WPACKET_cleanup(&pkt12);
+        goto err;
+    }
+    for (i = -1; i < num; i++) {
+        unsigned char *p;
+        X509 *cert = i < 0 ? x : sk_X509_value(chain, i);
+
+        len = i2d_X509(cert, NULL);
+        if (!WPACKET_sub_allocate_bytes_u24(&pkt12, len, &der))
+            break;
+        p = der;
+        if (i2d_X509(cert, &p) != len
+                || !WPACKET_sub_memcpy_u24(&pkt13, der, len)
+                /* Empty certificate extensions */
+                || !WPACKET_put_bytes_u16(&pkt13, 0))
+            break;
+    }
+    if (i < num || !WPACKET_finish(&pkt12) || !WPACKET_finish(&pkt13)) {
+        WPACKET_cleanup(&pkt12);
+        WPACKET_cleanup(&pkt13);
+        ERR_raise(ERR_LIB_SSL, ERR_R_INTERNAL_ERROR);
+        goto err;
+    }
+    return msg;
+
+ err:
+    ssl_cert_msg_free(msg);
+    return NULL;
+}
+
+/* Check whether |msg| is the encoding of |x| followed by |chain| */
+int ssl_cert_msg_matches(const SSL_CERT_MSG *msg, X509 *x,
+                         STACK_OF(X509) *chain)
+{
+    int i, num = chain == NULL ? 0 : sk_X509_num(chain);
+
+    if (msg->x509 != x
+            || (msg->chain == NULL ? 0 : sk_X509_num(msg->chain)) != num)
+        return 0;
+    for (i = 0; i < num; i++)
+        if (sk_X509_value(msg->chain, i) != sk_X509_value(chain, i))
+            return 0;
+    return 1;
+}
+
+void ssl_cert_msg_free(SSL_CERT_MSG *msg)
+{
+    int i;
+
+    if (msg == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&msg->references, &i);
+    REF_PRINT_COUNT("SSL_CERT_MSG", msg);
+    if (i > 0)
+        return;
+    REF_ASSERT_ISNT(i < 0);
+
+    X509_free(msg->x509);
+    OSSL_STACK_OF_X509_free(msg->chain);
+    OPENSSL_free(msg->tls12);
+    OPENSSL_free(msg->tls13);
+    CRYPTO_FREE_REF(&msg->references);
+    OPENSSL_free(msg);
+}
+
+int ssl_cert_msg_up_ref(SSL_CERT_MSG *msg)
+{
+    int i;
+
+    if (CRYPTO_UP_REF(&msg->references, &i) <= 0)
+        return 0;
+
+    REF_PRINT_COUNT("SSL_CERT_MSG", msg);
+    REF_ASSERT_ISNT(i < 2);
+    return i > 1;
+}
+
 int ssl_cert_set0_chain(SSL_CONNECTION *s, SSL_CTX *ctx, STACK_OF(X509) *chain)
 {
     int i, r;
@@ -816,6 +816,7 @@ SSL *ossl_ssl_connection_new_int(SSL_CTX *ctx, const SSL_METHOD *method)
     s->ext.ocsp.exts = NULL;
     s->ext.ocsp.resp = NULL;
     s->ext.ocsp.resp_len = 0;
+    s->ext.ocsp.staple = NULL;
     SSL_CTX_up_ref(ctx);
     s->session_ctx = ctx;
     if (ctx->ext.ecpointformats) {
@@ -965,7 +966,7 @@ int SSL_is_tls(const SSL *s)
 int SSL_is_quic(const SSL *s)
 {
 #ifndef OPENSSL_NO_QUIC
-    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO)
+    if (IS_QUIC(s))
         return 1;
 #endif
     return 0;
@@ -1054,6 +1055,13 @@ int SSL_has_matching_session_id(const SSL *ssl, const unsigned char *id,
     r.session_id_length = id_len;
     memcpy(r.session_id, id, id_len);
 
+    if (sc->session_ctx->sess_cache != NULL) {
+        p = ossl_sess_cache_lookup(sc->session_ctx->sess_cache, sc->version,
+                                   id, id_len);
+        SSL_SESSION_free(p);
+        return (p != NULL);
+    }
+
     if (!CRYPTO_THREAD_read_lock(sc->session_ctx->lock))
         return 0;
     p = lh_SSL_SESSION_retrieve(sc->session_ctx->sessions, &r);
@@ -1448,6 +1456,9 @@ void ossl_ssl_connection_free(SSL *ssl)
     OPENSSL_free(s->ext.scts);
 #endif
     OPENSSL_free(s->ext.ocsp.resp);
+#ifndef OPENSSL_NO_OCSP
+    ossl_ssl_ocsp_staple_free(s->ext.ocsp.staple);
+#endif
     OPENSSL_free(s->ext.alpn);
     OPENSSL_free(s->ext.tls13_cookie);
     if (s->clienthello != NULL)
@@ -2486,6 +2497,83 @@ int SSL_peek_ex(SSL *s, void *buf, size_t num, size_t *readbytes)
     return ret;
 }
 
+/*
+ * Returns the application data record that SSL_read_borrow() exposes to the
+ * caller, or NULL if there isn't one.
+ */
+static TLS_RECORD *ssl_borrowed_record(SSL_CONNECTION *sc)
+{
+    TLS_RECORD *rr;
+
+    if (sc->rlayer.curr_rec >= sc->rlayer.num_recs)
+        return NULL;
+
+    rr = &sc->rlayer.tlsrecs[sc->rlayer.curr_rec];
+    if (rr->type != SSL3_RT_APPLICATION_DATA || rr->length == 0)
+        return NULL;
+
+    return rr;
+}
+
+int SSL_read_borrow(SSL *s, const unsigned char **data, size_t *len)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+    TLS_RECORD *rr;
+    unsigned char tmp;
+    size_t readbytes;
+
+    if (data == NULL || len == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    if (sc == NULL || SSL_CONNECTION_IS_DTLS(sc)) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_WRONG_SSL_VERSION);
+        return 0;
+    }
+
+    /*
+     * Peeking a single byte drives the handshake and processes any
+     * non-application data records in exactly the same way that SSL_read()
+     * would. On success the current record holds at least one byte of
+     * application data, which is returned in place.
+     */
+    if (ssl_peek_internal(s, &tmp, 1, &readbytes) <= 0)
+        return 0;
+
+    rr = ssl_borrowed_record(sc);
+    if (rr == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
+
+    *data = rr->data + rr->off;
+    *len = rr->length;
+    return 1;
+}
+
+int SSL_read_release(SSL *s, size_t len)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+    TLS_RECORD *rr;
+
+    if (sc == NULL || SSL_CONNECTION_IS_DTLS(sc)) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_WRONG_SSL_VERSION);
+        return 0;
+    }
+
+    if (len == 0)
+        return 1;
+
+    rr = ssl_borrowed_record(sc);
+    if (rr == NULL || len > rr->length) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    return ssl_release_record(sc, rr, len);
+}
+
 int ssl_write_internal(SSL *s, const void *buf, size_t num,
                        uint64_t flags, size_t *written)
 {
@@ -2648,6 +2736,57 @@ int SSL_write_ex2(SSL *s, const void *buf, size_t num, uint64_t flags,
     return ret;
 }
 
+int SSL_writev(SSL *s, const SSL_IOVEC *iov, size_t iovcnt, uint64_t flags,
+               size_t *written)
+{
+    SSL_CONNECTION *sc;
+    size_t i, num = 0;
+    int ret;
+
+    if (iov == NULL && iovcnt > 0) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].len > SIZE_MAX - num) {
+            ERR_raise(ERR_LIB_SSL, SSL_R_BAD_LENGTH);
+            return 0;
+        }
+        num += iov[i].len;
+    }
+
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC(s))
+        return ossl_quic_writev(s, iov, iovcnt, num, flags, written);
+#endif
+
+    sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+    if (sc == NULL || SSL_CONNECTION_IS_DTLS(sc)) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_WRONG_SSL_VERSION);
+        return 0;
+    }
+
+    /* The common case of a single buffer needs no special handling */
+    if (iovcnt == 1)
+        return SSL_write_ex2(s, iov[0].data, iov[0].len, flags, written);
+
+    /*
+     * The record layer picks up the individual buffers from |wiov|, and the
+     * |iov| array itself stands in for the write buffer when checking that
+     * a retried write is consistent with the original one.
+     */
+    sc->rlayer.wiov = iov;
+    sc->rlayer.wiovcnt = iovcnt;
+    ret = ssl_write_internal(s, iov, num, flags, written);
+    sc->rlayer.wiov = NULL;
+    sc->rlayer.wiovcnt = 0;
+
+    if (ret < 0)
+        ret = 0;
+    return ret;
+}
+
 int SSL_write_early_data(SSL *s, const void *buf, size_t num, size_t *written)
 {
     int ret, early_data_state;
@@ -3102,12 +3241,28 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
         return (long)ctx->session_cache_size;
     case SSL_CTRL_SET_SESS_CACHE_MODE:
         l = ctx->session_cache_mode;
+        if (((l ^ larg) & SSL_SESS_CACHE_SHARDED) != 0) {
+            /* Switching cache implementation, drop what the old one holds */
+            SSL_CTX_flush_sessions_ex(ctx, 0);
+            if ((larg & SSL_SESS_CACHE_SHARDED) != 0) {
+                ctx->sess_cache = ossl_sess_cache_new(ctx);
+                if (ctx->sess_cache == NULL) {
+                    ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+                    larg &= ~SSL_SESS_CACHE_SHARDED;
+                }
+            } else {
+                ossl_sess_cache_free(ctx->sess_cache);
+                ctx->sess_cache = NULL;
+            }
+        }
         ctx->session_cache_mode = larg;
         return l;
     case SSL_CTRL_GET_SESS_CACHE_MODE:
         return ctx->session_cache_mode;
 
     case SSL_CTRL_SESS_NUMBER:
+        if (ctx->sess_cache != NULL)
+            return (long)ossl_sess_cache_num(ctx->sess_cache);
         return lh_SSL_SESSION_num_items(ctx->sessions);
     case SSL_CTRL_SESS_CONNECT:
         return ssl_tsan_load(ctx, &ctx->stats.sess_connect);
@@ -3152,6 +3307,14 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
             return 0;
         ctx->max_pipelines = larg;
         return 1;
+    case SSL_CTRL_SET_QUIC_CC_ALGORITHM:
+        if (larg < SSL_VALUE_QUIC_CC_ALGORITHM_NEWRENO
+            || larg > SSL_VALUE_QUIC_CC_ALGORITHM_BBR)
+            return 0;
+        ctx->quic_cc_algorithm = (uint32_t)larg;
+        return 1;
+    case SSL_CTRL_GET_QUIC_CC_ALGORITHM:
+        return ctx->quic_cc_algorithm;
     case SSL_CTRL_CERT_FLAGS:
         return (ctx->cert->cert_flags |= larg);
     case SSL_CTRL_CLEAR_CERT_FLAGS:
@@ -4171,6 +4334,10 @@ void SSL_CTX_free(SSL_CTX *a)
 
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_SSL_CTX, a, &a->ex_data);
     lh_SSL_SESSION_free(a->sessions);
+    ossl_sess_cache_free(a->sess_cache);
+#ifndef OPENSSL_NO_OCSP
+    ossl_ssl_ocsp_stapling_free(a->ext.ocsp_stapling);
+#endif
     X509_STORE_free(a->cert_store);
 #ifndef OPENSSL_NO_CT
     CTLOG_STORE_free(a->ctlog_store);
@@ -7616,6 +7783,80 @@ size_t SSL_get_accept_stream_queue_len(SSL *s)
 #endif
 }
 
+SSL *SSL_new_listener(SSL_CTX *ctx, uint64_t flags)
+{
+    if (ctx == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return NULL;
+    }
+
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC_CTX(ctx))
+        return ossl_quic_new_listener(ctx, flags);
+#endif
+
+    ERR_raise_data(ERR_LIB_SSL, ERR_R_UNSUPPORTED,
+                   "listeners are only supported for QUIC");
+    return NULL;
+}
+
+int SSL_listen(SSL *s)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s))
+        return 0;
+
+    return ossl_quic_listen(s);
+#else
+    return 0;
+#endif
+}
+
+SSL *SSL_accept_connection(SSL *s, uint64_t flags)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s))
+        return NULL;
+
+    return ossl_quic_accept_connection(s, flags);
+#else
+    return NULL;
+#endif
+}
+
+size_t SSL_get_accept_connection_queue_len(SSL *s)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s))
+        return 0;
+
+    return ossl_quic_get_accept_connection_queue_len(s);
+#else
+    return 0;
+#endif
+}
+
+SSL *SSL_get0_listener(SSL *s)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s))
+        return NULL;
+
+    return ossl_quic_get0_listener(s);
+#else
+    return NULL;
+#endif
+}
+
+int SSL_is_listener(SSL *s)
+{
+#ifndef OPENSSL_NO_QUIC
+    return s != NULL && s->type == SSL_TYPE_QUIC_LISTENER;
+#else
+    return 0;
+#endif
+}
+
 int SSL_stream_reset(SSL *s,
                      const SSL_STREAM_RESET_ARGS *args,
                      size_t args_len)
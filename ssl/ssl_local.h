@@ -788,6 +788,20 @@ typedef struct {
     uint32_t amask; /* authmask corresponding to key type */
 } SSL_CERT_LOOKUP;
 
+/* Sharded session cache, see ssl_sess_cache.c */
+typedef struct ssl_sess_cache_st SSL_SESS_CACHE;
+
+/* OCSP stapling manager, see ssl_stapling.c */
+typedef struct ssl_ocsp_stapling_st SSL_OCSP_STAPLING;
+
+/* A verified OCSP response shared by the handshakes that staple it */
+typedef struct ssl_ocsp_staple_st {
+    CRYPTO_REF_COUNT references;
+    OSSL_TIME expires;          /* nextUpdate, or infinite if absent */
+    const unsigned char *der;
+    size_t der_len;
+} SSL_OCSP_STAPLE;
+
 /* flags values */
 # define TLS_GROUP_TYPE             0x0000000FU /* Mask for group type */
 # define TLS_GROUP_CURVE_PRIME      0x00000001U
@@ -816,6 +830,11 @@ struct ssl_ctx_st {
     size_t session_cache_size;
     struct ssl_session_st *session_cache_head;
     struct ssl_session_st *session_cache_tail;
+    /*
+     * Used instead of |sessions| and the list above when the cache mode
+     * includes SSL_SESS_CACHE_SHARDED, NULL otherwise.
+     */
+    SSL_SESS_CACHE *sess_cache;
     /*
      * This can have one of 2 values, ored together, SSL_SESS_CACHE_CLIENT,
      * SSL_SESS_CACHE_SERVER, Default is SSL_SESSION_CACHE_SERVER, which
@@ -1017,6 +1036,8 @@ struct ssl_ctx_st {
         void *status_arg;
         /* ext status type used for CSR extension (OCSP Stapling) */
         int status_type;
+        /* Cached OCSP responses, NULL unless stapling is enabled */
+        SSL_OCSP_STAPLING *ocsp_stapling;
         /* RFC 4366 Maximum Fragment Length Negotiation */
         uint8_t max_fragment_len_mode;
 
@@ -1188,6 +1209,9 @@ struct ssl_ctx_st {
 # ifndef OPENSSL_NO_QLOG
     char *qlog_title; /* Session title for qlog */
 # endif
+
+    /* QUIC congestion control algorithm (SSL_VALUE_QUIC_CC_ALGORITHM_*) */
+    uint32_t quic_cc_algorithm;
 };
 
 typedef struct cert_pkey_st CERT_PKEY;
@@ -1195,6 +1219,7 @@ typedef struct cert_pkey_st CERT_PKEY;
 #define SSL_TYPE_SSL_CONNECTION  0
 #define SSL_TYPE_QUIC_CONNECTION 1
 #define SSL_TYPE_QUIC_XSO        2
+#define SSL_TYPE_QUIC_LISTENER   3
 
 struct ssl_st {
     int type;
@@ -1588,6 +1613,8 @@ struct ssl_connection_st {
             /* OCSP response received or to be sent */
             unsigned char *resp;
             size_t resp_len;
+            /* Cached OCSP response to be sent if |resp| is NULL */
+            SSL_OCSP_STAPLE *staple;
         } ocsp;
 
         /* RFC4507 session ticket expected to be received or sent */
@@ -1976,6 +2003,28 @@ void OSSL_COMP_CERT_free(OSSL_COMP_CERT *c);
 int OSSL_COMP_CERT_up_ref(OSSL_COMP_CERT *c);
 # endif
 
+/*
+ * The certificate_list of a Certificate message as it is sent for a
+ * certificate and chain, with empty certificate extensions in the TLSv1.3
+ * form. It holds references to the certificates it was encoded from so that
+ * it can be checked against the chain a connection would send.
+ */
+typedef struct ssl_cert_msg_st {
+    X509 *x509;
+    STACK_OF(X509) *chain;
+    unsigned char *tls12;
+    size_t tls12_len;
+    unsigned char *tls13;
+    size_t tls13_len;
+    CRYPTO_REF_COUNT references;
+} SSL_CERT_MSG;
+
+SSL_CERT_MSG *ssl_cert_msg_new(X509 *x, STACK_OF(X509) *chain);
+int ssl_cert_msg_matches(const SSL_CERT_MSG *msg, X509 *x,
+                         STACK_OF(X509) *chain);
+void ssl_cert_msg_free(SSL_CERT_MSG *msg);
+int ssl_cert_msg_up_ref(SSL_CERT_MSG *msg);
+
 struct cert_pkey_st {
     X509 *x509;
     EVP_PKEY *privatekey;
@@ -1995,6 +2044,8 @@ struct cert_pkey_st {
     OSSL_COMP_CERT *comp_cert[TLSEXT_comp_cert_limit];
     int cert_comp_used;
 # endif
+    /* Encoded certificate_list, see ssl_get_cert_msg() */
+    SSL_CERT_MSG *cert_msg;
 };
 /* Retrieve Suite B flags */
 # define tls1_suiteb(s)  (s->cert->cert_flags & SSL_CERT_FLAG_SUITEB_128_LOS)
@@ -2950,6 +3001,24 @@ int ssl_srp_server_param_with_username_intern(SSL_CONNECTION *s, int *ad);
 
 void ssl_session_calculate_timeout(SSL_SESSION *ss);
 
+SSL_SESS_CACHE *ossl_sess_cache_new(SSL_CTX *ctx);
+void ossl_sess_cache_free(SSL_SESS_CACHE *cache);
+SSL_SESSION *ossl_sess_cache_lookup(SSL_SESS_CACHE *cache, int ssl_version,
+                                    const unsigned char *sess_id,
+                                    size_t sess_id_len);
+int ossl_sess_cache_add(SSL_SESS_CACHE *cache, SSL_SESSION *c,
+                        int update_time);
+int ossl_sess_cache_remove(SSL_SESS_CACHE *cache, SSL_SESSION *c);
+int ossl_sess_cache_lock_session(SSL_SESS_CACHE *cache, const SSL_SESSION *c);
+void ossl_sess_cache_unlock_session(SSL_SESS_CACHE *cache,
+                                    const SSL_SESSION *c);
+void ossl_sess_cache_flush(SSL_SESS_CACHE *cache, OSSL_TIME t, int all);
+size_t ossl_sess_cache_num(SSL_SESS_CACHE *cache);
+
+void ossl_ssl_ocsp_stapling_free(SSL_OCSP_STAPLING *st);
+SSL_OCSP_STAPLE *ossl_ssl_ocsp_stapling_get(SSL_OCSP_STAPLING *st, X509 *x);
+void ossl_ssl_ocsp_staple_free(SSL_OCSP_STAPLE *staple);
+
 # else /* OPENSSL_UNIT_TEST */
 
 #  define ssl_init_wbio_buffer SSL_test_functions()->p_ssl_init_wbio_buffer
@@ -504,17 +504,22 @@ SSL_SESSION *lookup_sess_in_cache(SSL_CONNECTION *s,
         if (!ossl_assert(sess_id_len <= SSL_MAX_SSL_SESSION_ID_LENGTH))
             return NULL;
 
-        memcpy(data.session_id, sess_id, sess_id_len);
-        data.session_id_length = sess_id_len;
+        if (s->session_ctx->sess_cache != NULL) {
+            ret = ossl_sess_cache_lookup(s->session_ctx->sess_cache,
+                                         s->version, sess_id, sess_id_len);
+        } else {
+            memcpy(data.session_id, sess_id, sess_id_len);
+            data.session_id_length = sess_id_len;
 
-        if (!CRYPTO_THREAD_read_lock(s->session_ctx->lock))
-            return NULL;
-        ret = lh_SSL_SESSION_retrieve(s->session_ctx->sessions, &data);
-        if (ret != NULL) {
-            /* don't allow other threads to steal it: */
-            SSL_SESSION_up_ref(ret);
+            if (!CRYPTO_THREAD_read_lock(s->session_ctx->lock))
+                return NULL;
+            ret = lh_SSL_SESSION_retrieve(s->session_ctx->sessions, &data);
+            if (ret != NULL) {
+                /* don't allow other threads to steal it: */
+                SSL_SESSION_up_ref(ret);
+            }
+            CRYPTO_THREAD_unlock(s->session_ctx->lock);
         }
-        CRYPTO_THREAD_unlock(s->session_ctx->lock);
         if (ret == NULL)
             ssl_tsan_counter(s->session_ctx, &s->session_ctx->stats.sess_miss);
     }
@@ -721,6 +726,13 @@ int SSL_CTX_add_session(SSL_CTX *ctx, SSL_SESSION *c)
     int ret = 0;
     SSL_SESSION *s;
 
+    if (ctx->sess_cache != NULL) {
+        /* Adjust last used time, the sharded cache has no ordered list */
+        return ossl_sess_cache_add(ctx->sess_cache, c,
+                                   (ctx->session_cache_mode
+                                    & SSL_SESS_CACHE_UPDATE_TIME) != 0) == 1;
+    }
+
     /*
      * add just 1 reference count for the SSL_CTX's session cache even though
      * it has two ways of access: each session is in a doubly linked list and
@@ -814,6 +826,13 @@ static int remove_session_lock(SSL_CTX *ctx, SSL_SESSION *c, int lck)
     int ret = 0;
 
     if ((c != NULL) && (c->session_id_length != 0)) {
+        if (ctx->sess_cache != NULL) {
+            ret = ossl_sess_cache_remove(ctx->sess_cache, c);
+            c->not_resumable = 1;
+            if (ctx->remove_session_cb != NULL)
+                ctx->remove_session_cb(ctx, c);
+            return ret;
+        }
         if (lck) {
             if (!CRYPTO_THREAD_write_lock(ctx->lock))
                 return 0;
@@ -926,7 +945,15 @@ long SSL_SESSION_set_timeout(SSL_SESSION *s, long t)
 
     if (s == NULL || t < 0)
         return 0;
-    if (s->owner != NULL) {
+    if (s->owner != NULL && s->owner->sess_cache != NULL) {
+        SSL_SESS_CACHE *cache = s->owner->sess_cache;
+
+        if (!ossl_sess_cache_lock_session(cache, s))
+            return 0;
+        s->timeout = new_timeout;
+        ssl_session_calculate_timeout(s);
+        ossl_sess_cache_unlock_session(cache, s);
+    } else if (s->owner != NULL) {
         if (!CRYPTO_THREAD_write_lock(s->owner->lock))
             return 0;
         s->timeout = new_timeout;
@@ -967,7 +994,15 @@ time_t SSL_SESSION_set_time_ex(SSL_SESSION *s, time_t t)
 
     if (s == NULL)
         return 0;
-    if (s->owner != NULL) {
+    if (s->owner != NULL && s->owner->sess_cache != NULL) {
+        SSL_SESS_CACHE *cache = s->owner->sess_cache;
+
+        if (!ossl_sess_cache_lock_session(cache, s))
+            return 0;
+        s->time = new_time;
+        ssl_session_calculate_timeout(s);
+        ossl_sess_cache_unlock_session(cache, s);
+    } else if (s->owner != NULL) {
         if (!CRYPTO_THREAD_write_lock(s->owner->lock))
             return 0;
         s->time = new_time;
@@ -1207,6 +1242,11 @@ void SSL_CTX_flush_sessions_ex(SSL_CTX *s, time_t t)
     unsigned long i;
     const OSSL_TIME timeout = ossl_time_from_time_t(t);
 
+    if (s->sess_cache != NULL) {
+        ossl_sess_cache_flush(s->sess_cache, timeout, t == 0);
+        return;
+    }
+
     if (!CRYPTO_THREAD_write_lock(s->lock))
         return;
 
@@ -0,0 +1,465 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Sharded server side session cache (SSL_SESS_CACHE_SHARDED).
+ *
+ * The classic cache keeps every session in a single LHASH plus a doubly
+ * linked list ordered by timeout, both protected by the SSL_CTX lock, so
+ * every lookup and insert on every thread contends on the same lock.
+ *
+ * Here the session id space is split over a fixed number of shards, each
+ * with its own hash table and its own read/write lock.  Lookups only ever
+ * take a shard read lock, so concurrent resumptions of different sessions
+ * proceed in parallel.  There is no global timeout list: instead each shard
+ * keeps its entries in a dense "clock" ring.  Lookups set a second-chance
+ * bit on the entry they hit, and when a shard needs room the clock hand
+ * sweeps the ring, evicting expired or unreferenced entries and clearing
+ * the bit on the rest.  Inserts also advance the hand a few steps so that
+ * expired sessions are reclaimed incrementally.
+ */
+
+#include <string.h>
+#include <openssl/lhash.h>
+#include "internal/tsan_assist.h"
+#include "ssl_local.h"
+
+#define SESS_CACHE_SHARDS_LOG   4
+#define SESS_CACHE_SHARDS       (1 << SESS_CACHE_SHARDS_LOG)
+
+/* Number of ring slots examined for expired sessions on every insert */
+#define SESS_CACHE_SWEEP_STEP   4
+
+typedef struct sess_cache_entry_st {
+    SSL_SESSION *sess;
+    /* Copy of the lookup key taken when the entry was added */
+    int ssl_version;
+    size_t session_id_length;
+    unsigned char session_id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+    /* Position of this entry in the owning shard's clock ring */
+    size_t slot;
+    /* Second chance bit, set by readers without the write lock */
+    TSAN_QUALIFIER int referenced;
+    /* Link and flag used once the entry has been unlinked, see shard_evict */
+    struct sess_cache_entry_st *next_dead;
+    int notify;
+} SESS_CACHE_ENTRY;
+
+DEFINE_LHASH_OF_EX(SESS_CACHE_ENTRY);
+
+typedef struct {
+    CRYPTO_RWLOCK *lock;
+    LHASH_OF(SESS_CACHE_ENTRY) *entries;
+    /* The clock ring, only touched with the write lock held */
+    SESS_CACHE_ENTRY **ring;
+    size_t ring_len;
+    size_t ring_cap;
+    size_t hand;
+} SESS_CACHE_SHARD;
+
+struct ssl_sess_cache_st {
+    SSL_CTX *ctx;
+    SESS_CACHE_SHARD shards[SESS_CACHE_SHARDS];
+};
+
+static unsigned long sess_id_hash(const unsigned char *id, size_t id_len)
+{
+    unsigned long h = 2166136261UL;
+    size_t i;
+
+    /* FNV-1a, so that ids differing only in their tail still spread out */
+    for (i = 0; i < id_len; i++) {
+        h ^= id[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static unsigned long sess_cache_entry_hash(const SESS_CACHE_ENTRY *e)
+{
+    return sess_id_hash(e->session_id, e->session_id_length);
+}
+
+static int sess_cache_entry_cmp(const SESS_CACHE_ENTRY *a,
+                                const SESS_CACHE_ENTRY *b)
+{
+    if (a->ssl_version != b->ssl_version)
+        return 1;
+    if (a->session_id_length != b->session_id_length)
+        return 1;
+    return memcmp(a->session_id, b->session_id, a->session_id_length);
+}
+
+static SESS_CACHE_SHARD *shard_for(SSL_SESS_CACHE *cache,
+                                   const SESS_CACHE_ENTRY *key)
+{
+    unsigned long h = sess_cache_entry_hash(key);
+
+    /*
+     * The low bits select the LHASH bucket, so use the high bits of the
+     * 32 bit hash to pick the shard
+     */
+    return &cache->shards[(h >> (32 - SESS_CACHE_SHARDS_LOG))
+                          & (SESS_CACHE_SHARDS - 1)];
+}
+
+static int set_key(SESS_CACHE_ENTRY *key, int ssl_version,
+                   const unsigned char *id, size_t id_len)
+{
+    if (!ossl_assert(id_len <= sizeof(key->session_id)))
+        return 0;
+    key->ssl_version = ssl_version;
+    key->session_id_length = id_len;
+    memcpy(key->session_id, id, id_len);
+    return 1;
+}
+
+static ossl_inline int entry_timedout(OSSL_TIME t, const SESS_CACHE_ENTRY *e)
+{
+    return ossl_time_compare(t, e->sess->calc_timeout) > 0;
+}
+
+/*
+ * Unlinks |e| from its shard and queues it on |*dead|. The shard write lock
+ * must be held. The entries are released by sess_cache_release() once the
+ * lock has been dropped: the remove_session_cb may well call back into the
+ * cache, and the last SSL_SESSION_free() may run ex_data callbacks.
+ */
+static void shard_evict(SESS_CACHE_SHARD *shard, SESS_CACHE_ENTRY *e,
+                        int notify, SESS_CACHE_ENTRY **dead)
+{
+    size_t last = shard->ring_len - 1;
+
+    (void)lh_SESS_CACHE_ENTRY_delete(shard->entries, e);
+
+    /* Keep the ring dense by moving the last entry into the hole */
+    shard->ring[e->slot] = shard->ring[last];
+    shard->ring[e->slot]->slot = e->slot;
+    shard->ring[last] = NULL;
+    shard->ring_len = last;
+    if (shard->hand >= shard->ring_len)
+        shard->hand = 0;
+
+    e->sess->not_resumable = 1;
+    e->sess->owner = NULL;
+    e->notify = notify;
+    e->next_dead = *dead;
+    *dead = e;
+}
+
+/*
+ * Calls the remove_session_cb for, and drops the cache reference on, every
+ * entry queued by shard_evict(). No shard lock may be held.
+ */
+static void sess_cache_release(SSL_SESS_CACHE *cache, SESS_CACHE_ENTRY *dead)
+{
+    SESS_CACHE_ENTRY *next;
+
+    for (; dead != NULL; dead = next) {
+        next = dead->next_dead;
+        if (dead->notify && cache->ctx->remove_session_cb != NULL)
+            cache->ctx->remove_session_cb(cache->ctx, dead->sess);
+        SSL_SESSION_free(dead->sess);
+        OPENSSL_free(dead);
+    }
+}
+
+/*
+ * Advances the clock hand by up to |steps| slots, evicting every expired
+ * entry passed on the way. The shard write lock must be held.
+ */
+static void shard_sweep_expired(SESS_CACHE_SHARD *shard, OSSL_TIME now,
+                                size_t steps, SESS_CACHE_ENTRY **dead)
+{
+    SESS_CACHE_ENTRY *e;
+
+    while (steps-- > 0 && shard->ring_len > 0) {
+        e = shard->ring[shard->hand];
+        if (entry_timedout(now, e)) {
+            /* The hand now points at the entry moved into this slot */
+            shard_evict(shard, e, 1, dead);
+        } else if (++shard->hand >= shard->ring_len) {
+            shard->hand = 0;
+        }
+    }
+}
+
+/*
+ * Second chance eviction of a single entry: the hand clears the referenced
+ * bit of recently used entries and evicts the first expired or unreferenced
+ * one it finds. This terminates within two passes over the ring. The shard
+ * write lock must be held.
+ */
+static void shard_evict_one(SESS_CACHE_SHARD *shard, OSSL_TIME now,
+                            SESS_CACHE_ENTRY **dead)
+{
+    SESS_CACHE_ENTRY *e;
+
+    while (shard->ring_len > 0) {
+        e = shard->ring[shard->hand];
+        if (entry_timedout(now, e) || !tsan_load(&e->referenced)) {
+            shard_evict(shard, e, 1, dead);
+            return;
+        }
+        tsan_store(&e->referenced, 0);
+        if (++shard->hand >= shard->ring_len)
+            shard->hand = 0;
+    }
+}
+
+static size_t shard_capacity(SSL_SESS_CACHE *cache)
+{
+    size_t total = cache->ctx->session_cache_size;
+
+    if (total == 0)
+        return 0;
+    return (total + SESS_CACHE_SHARDS - 1) / SESS_CACHE_SHARDS;
+}
+
+static int shard_ring_push(SESS_CACHE_SHARD *shard, SESS_CACHE_ENTRY *e)
+{
+    SESS_CACHE_ENTRY **tmp;
+    size_t newcap;
+
+    if (shard->ring_len == shard->ring_cap) {
+        newcap = shard->ring_cap == 0 ? 16 : shard->ring_cap * 2;
+        tmp = OPENSSL_realloc(shard->ring, newcap * sizeof(*tmp));
+        if (tmp == NULL)
+            return 0;
+        shard->ring = tmp;
+        shard->ring_cap = newcap;
+    }
+    e->slot = shard->ring_len;
+    shard->ring[shard->ring_len++] = e;
+    return 1;
+}
+
+SSL_SESS_CACHE *ossl_sess_cache_new(SSL_CTX *ctx)
+{
+    SSL_SESS_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+    size_t i;
+
+    if (cache == NULL)
+        return NULL;
+
+    cache->ctx = ctx;
+    for (i = 0; i < SESS_CACHE_SHARDS; i++) {
+        cache->shards[i].lock = CRYPTO_THREAD_lock_new();
+        cache->shards[i].entries =
+            lh_SESS_CACHE_ENTRY_new(sess_cache_entry_hash,
+                                    sess_cache_entry_cmp);
+        if (cache->shards[i].lock == NULL
+                || cache->shards[i].entries == NULL) {
+            ossl_sess_cache_free(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+void ossl_sess_cache_free(SSL_SESS_CACHE *cache)
+{
+    SESS_CACHE_SHARD *shard;
+    size_t i, j;
+
+    if (cache == NULL)
+        return;
+
+    for (i = 0; i < SESS_CACHE_SHARDS; i++) {
+        shard = &cache->shards[i];
+        for (j = 0; j < shard->ring_len; j++) {
+            shard->ring[j]->sess->owner = NULL;
+            SSL_SESSION_free(shard->ring[j]->sess);
+            OPENSSL_free(shard->ring[j]);
+        }
+        OPENSSL_free(shard->ring);
+        lh_SESS_CACHE_ENTRY_free(shard->entries);
+        CRYPTO_THREAD_lock_free(shard->lock);
+    }
+    OPENSSL_free(cache);
+}
+
+SSL_SESSION *ossl_sess_cache_lookup(SSL_SESS_CACHE *cache, int ssl_version,
+                                    const unsigned char *sess_id,
+                                    size_t sess_id_len)
+{
+    SESS_CACHE_ENTRY key, *e;
+    SESS_CACHE_SHARD *shard;
+    SSL_SESSION *ret = NULL;
+
+    if (!set_key(&key, ssl_version, sess_id, sess_id_len))
+        return NULL;
+    shard = shard_for(cache, &key);
+
+    if (!CRYPTO_THREAD_read_lock(shard->lock))
+        return NULL;
+    e = lh_SESS_CACHE_ENTRY_retrieve(shard->entries, &key);
+    if (e != NULL) {
+        ret = e->sess;
+        /* don't allow other threads to steal it: */
+        SSL_SESSION_up_ref(ret);
+        /* Avoid dirtying the cache line if the bit is already set */
+        if (!tsan_load(&e->referenced))
+            tsan_store(&e->referenced, 1);
+    }
+    CRYPTO_THREAD_unlock(shard->lock);
+    return ret;
+}
+
+int ossl_sess_cache_add(SSL_SESS_CACHE *cache, SSL_SESSION *c,
+                        int update_time)
+{
+    SESS_CACHE_ENTRY *e, *old, *dead = NULL;
+    SESS_CACHE_SHARD *shard;
+    size_t cap = shard_capacity(cache);
+    OSSL_TIME now = ossl_time_now();
+    int ret = 1;
+
+    if ((e = OPENSSL_zalloc(sizeof(*e))) == NULL)
+        return -1;
+    if (!set_key(e, c->ssl_version, c->session_id, c->session_id_length)) {
+        OPENSSL_free(e);
+        return -1;
+    }
+    e->sess = c;
+    shard = shard_for(cache, e);
+
+    if (!CRYPTO_THREAD_write_lock(shard->lock)) {
+        OPENSSL_free(e);
+        return -1;
+    }
+
+    /* The time fields are protected by the lock of the owning shard */
+    if (update_time) {
+        c->time = now;
+        ssl_session_calculate_timeout(c);
+    }
+
+    old = lh_SESS_CACHE_ENTRY_retrieve(shard->entries, e);
+    if (old != NULL) {
+        if (old->sess == c) {
+            /* Already cached, nothing to do */
+            tsan_store(&old->referenced, 1);
+            CRYPTO_THREAD_unlock(shard->lock);
+            OPENSSL_free(e);
+            return 0;
+        }
+        /*
+         * A different session with the same id, e.g. two threads obtained
+         * the same session from an external cache. Replace it.
+         */
+        shard_evict(shard, old, 0, &dead);
+    }
+
+    shard_sweep_expired(shard, now, SESS_CACHE_SWEEP_STEP, &dead);
+    if (cap > 0) {
+        while (shard->ring_len >= cap) {
+            shard_evict_one(shard, now, &dead);
+            ssl_tsan_counter(cache->ctx, &cache->ctx->stats.sess_cache_full);
+        }
+    }
+
+    if (!shard_ring_push(shard, e)) {
+        OPENSSL_free(e);
+        ret = -1;
+        goto end;
+    }
+    (void)lh_SESS_CACHE_ENTRY_insert(shard->entries, e);
+    if (lh_SESS_CACHE_ENTRY_error(shard->entries)) {
+        shard->ring[--shard->ring_len] = NULL;
+        if (shard->hand >= shard->ring_len)
+            shard->hand = 0;
+        OPENSSL_free(e);
+        ret = -1;
+        goto end;
+    }
+    SSL_SESSION_up_ref(c);
+    c->owner = cache->ctx;
+ end:
+    CRYPTO_THREAD_unlock(shard->lock);
+    sess_cache_release(cache, dead);
+    return ret;
+}
+
+int ossl_sess_cache_remove(SSL_SESS_CACHE *cache, SSL_SESSION *c)
+{
+    SESS_CACHE_ENTRY key, *e, *dead = NULL;
+    SESS_CACHE_SHARD *shard;
+    int ret = 0;
+
+    if (!set_key(&key, c->ssl_version, c->session_id, c->session_id_length))
+        return 0;
+    shard = shard_for(cache, &key);
+
+    if (!CRYPTO_THREAD_write_lock(shard->lock))
+        return 0;
+    e = lh_SESS_CACHE_ENTRY_retrieve(shard->entries, &key);
+    if (e != NULL) {
+        shard_evict(shard, e, 0, &dead);
+        ret = 1;
+    }
+    CRYPTO_THREAD_unlock(shard->lock);
+    sess_cache_release(cache, dead);
+    return ret;
+}
+
+int ossl_sess_cache_lock_session(SSL_SESS_CACHE *cache, const SSL_SESSION *c)
+{
+    SESS_CACHE_ENTRY key;
+
+    if (!set_key(&key, c->ssl_version, c->session_id, c->session_id_length))
+        return 0;
+    return CRYPTO_THREAD_write_lock(shard_for(cache, &key)->lock);
+}
+
+void ossl_sess_cache_unlock_session(SSL_SESS_CACHE *cache,
+                                    const SSL_SESSION *c)
+{
+    SESS_CACHE_ENTRY key;
+
+    if (set_key(&key, c->ssl_version, c->session_id, c->session_id_length))
+        CRYPTO_THREAD_unlock(shard_for(cache, &key)->lock);
+}
+
+void ossl_sess_cache_flush(SSL_SESS_CACHE *cache, OSSL_TIME t, int all)
+{
+    SESS_CACHE_ENTRY *dead;
+    SESS_CACHE_SHARD *shard;
+    size_t i, j;
+
+    for (i = 0; i < SESS_CACHE_SHARDS; i++) {
+        shard = &cache->shards[i];
+        if (!CRYPTO_THREAD_write_lock(shard->lock))
+            continue;
+        dead = NULL;
+        /*
+         * Walk the ring backwards: eviction moves the last entry into the
+         * freed slot, and that entry has then already been examined.
+         */
+        for (j = shard->ring_len; j-- > 0;) {
+            if (all || entry_timedout(t, shard->ring[j]))
+                shard_evict(shard, shard->ring[j], 1, &dead);
+        }
+        CRYPTO_THREAD_unlock(shard->lock);
+        sess_cache_release(cache, dead);
+    }
+}
+
+size_t ossl_sess_cache_num(SSL_SESS_CACHE *cache)
+{
+    size_t i, n = 0;
+
+    for (i = 0; i < SESS_CACHE_SHARDS; i++) {
+        if (!CRYPTO_THREAD_read_lock(cache->shards[i].lock))
+            continue;
+        n += cache->shards[i].ring_len;
+        CRYPTO_THREAD_unlock(cache->shards[i].lock);
+    }
+    return n;
+}
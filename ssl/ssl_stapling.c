@@ -0,0 +1,636 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Server side OCSP stapling manager.
+ *
+ * For each certificate configured in an SSL_CTX the manager keeps the most
+ * recent verified OCSP response from the certificate's responder, refreshes
+ * it half way through its validity period, and hands it to handshakes that
+ * request certificate status.  Handshakes take a reference to the shared
+ * response rather than a copy, so stapling does not allocate per connection.
+ */
+
+#include <openssl/ocsp.h>
+#include <openssl/http.h>
+#include "ssl_local.h"
+#include "internal/thread_arch.h"
+
+#ifndef OPENSSL_NO_OCSP
+
+# ifndef OPENSSL_NO_THREAD_POOL
+#  define STAPLING_THREAD
+# endif
+
+/* Timeout for a request to a responder, in seconds */
+# define STAPLING_FETCH_TIMEOUT     30
+/* Longest wait for network I/O before checking for teardown, in seconds */
+# define STAPLING_POLL_INTERVAL     1
+/* Maximum length of a response from a responder */
+# define STAPLING_MAX_RESP_LEN      (100 * 1024)
+/* Permitted clock skew when checking the validity of a response */
+# define STAPLING_MAX_SKEW          300
+/* Delay before retrying after a failed fetch, in seconds */
+# define STAPLING_RETRY_DELAY       300
+/* Refresh interval for responses without a nextUpdate time, in seconds */
+# define STAPLING_DEFAULT_REFRESH   3600
+
+typedef struct {
+    X509 *cert;
+    X509 *issuer;
+    OCSP_CERTID *id;
+    X509_STORE *trust;          /* Trusts |issuer| for signing responses */
+    char *url;                  /* Responder, NULL if the cert has none */
+    SSL_OCSP_STAPLE *staple;    /* Current response, NULL if none yet */
+    OSSL_TIME refresh;          /* When to fetch a new response */
+} STAPLING_ENTRY;
+
+struct ssl_ocsp_stapling_st {
+    /* Protects the |staple| and |refresh| fields of the entries */
+    CRYPTO_RWLOCK *lock;
+    STAPLING_ENTRY entries[SSL_PKEY_NUM];
+    size_t num;
+# ifdef STAPLING_THREAD
+    CRYPTO_MUTEX *mutex;
+    CRYPTO_CONDVAR *cv;
+    CRYPTO_THREAD *thread;
+    int teardown;
+# endif
+};
+
+void ossl_ssl_ocsp_staple_free(SSL_OCSP_STAPLE *staple)
+{
+    int i;
+
+    if (staple == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&staple->references, &i);
+    if (i > 0)
+        return;
+    CRYPTO_FREE_REF(&staple->references);
+    OPENSSL_free(staple);
+}
+
+/* Convert |t| to an OSSL_TIME relative to |now| */
+static int stapling_time(OSSL_TIME *out, const ASN1_GENERALIZEDTIME *t,
+                         OSSL_TIME now)
+{
+    int days, secs;
+    int64_t diff;
+
+    if (!ASN1_TIME_diff(&days, &secs, NULL, t))
+        return 0;
+    diff = (int64_t)days * 86400 + secs;
+    if (diff >= 0)
+        *out = ossl_time_add(now, ossl_seconds2time(diff));
+    else
+        *out = ossl_time_subtract(now, ossl_seconds2time(-diff));
+    return 1;
+}
+
+/*
+ * Verify the DER encoded OCSP response |der| for the certificate of |e| and
+ * return it as a staple, setting |*refresh| to when it should be replaced.
+ */
+static SSL_OCSP_STAPLE *stapling_staple_new(STAPLING_ENTRY *e,
+                                            const unsigned char *der,
+                                            size_t der_len, OSSL_TIME *refresh)
+{
+    SSL_OCSP_STAPLE *staple = NULL;
+    OCSP_RESPONSE *rsp = NULL;
+    OCSP_BASICRESP *bs = NULL;
+    STACK_OF(X509) *certs = NULL;
+    ASN1_GENERALIZEDTIME *thisupd, *nextupd;
+    const unsigned char *p = der;
+    OSSL_TIME now = ossl_time_now(), start, expires;
+    int status, reason;
+
+    if (der_len > STAPLING_MAX_RESP_LEN
+            || (rsp = d2i_OCSP_RESPONSE(NULL, &p, (long)der_len)) == NULL
+            || p != der + der_len
+            || OCSP_response_status(rsp) != OCSP_RESPONSE_STATUS_SUCCESSFUL
+            || (bs = OCSP_response_get1_basic(rsp)) == NULL) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_INVALID_STATUS_RESPONSE);
+        goto err;
+    }
+
+    /*
+     * The response must be signed by the issuer, which is trusted directly,
+     * or by a responder it delegated to.
+     */
+    if ((certs = sk_X509_new_null()) == NULL
+            || !sk_X509_push(certs, e->issuer)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
+    if (OCSP_basic_verify(bs, certs, e->trust, OCSP_TRUSTOTHER) <= 0) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_INVALID_STATUS_RESPONSE);
+        goto err;
+    }
+    if (!OCSP_resp_find_status(bs, e->id, &status, &reason, NULL,
+                               &thisupd, &nextupd)
+            || status != V_OCSP_CERTSTATUS_GOOD
+            || !OCSP_check_validity(thisupd, nextupd, STAPLING_MAX_SKEW, -1)
+            || !stapling_time(&start, thisupd, now)
+            || (nextupd != NULL && !stapling_time(&expires, nextupd, now))) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_INVALID_STATUS_RESPONSE);
+        goto err;
+    }
+
+    /*
+     * Refresh half way through the validity period, but not so soon after
+     * getting the response that a responder serving stale responses would
+     * be hammered.
+     */
+    if (nextupd != NULL) {
+        *refresh = ossl_time_add(start,
+                                 ossl_time_divide(ossl_time_subtract(expires,
+                                                                     start),
+                                                  2));
+    } else {
+        expires = ossl_time_infinite();
+        *refresh = ossl_time_add(now,
+                                 ossl_seconds2time(STAPLING_DEFAULT_REFRESH));
+    }
+    *refresh = ossl_time_max(*refresh,
+                             ossl_time_add(now,
+                                           ossl_seconds2time(STAPLING_RETRY_DELAY)));
+
+    /* Keep the encoding in the same allocation as the staple */
+    if ((staple = OPENSSL_malloc(sizeof(*staple) + der_len)) == NULL)
+        goto err;
+    if (!CRYPTO_NEW_REF(&staple->references, 1)) {
+        OPENSSL_free(staple);
+        staple = NULL;
+        goto err;
+    }
+    memcpy(staple + 1, der, der_len);
+    staple->der = (const unsigned char *)(staple + 1);
+    staple->der_len = der_len;
+    staple->expires = expires;
+
+ err:
+    sk_X509_free(certs);
+    OCSP_BASICRESP_free(bs);
+    OCSP_RESPONSE_free(rsp);
+    return staple;
+}
+
+/* Replace the response of |e|, or schedule a retry if |staple| is NULL */
+static void stapling_set(SSL_OCSP_STAPLING *st, STAPLING_ENTRY *e,
+                         SSL_OCSP_STAPLE *staple, OSSL_TIME refresh)
+{
+    SSL_OCSP_STAPLE *old = NULL;
+
+    if (staple == NULL)
+        refresh = ossl_time_add(ossl_time_now(),
+                                ossl_seconds2time(STAPLING_RETRY_DELAY));
+    if (!CRYPTO_THREAD_write_lock(st->lock)) {
+        ossl_ssl_ocsp_staple_free(staple);
+        return;
+    }
+    if (staple != NULL) {
+        old = e->staple;
+        e->staple = staple;
+    }
+    e->refresh = refresh;
+    CRYPTO_THREAD_unlock(st->lock);
+    ossl_ssl_ocsp_staple_free(old);
+}
+
+/* Returns 1 if the background thread has been asked to stop */
+static int stapling_stopping(SSL_OCSP_STAPLING *st)
+{
+# ifdef STAPLING_THREAD
+    int ret;
+
+    /* Without a background thread there is nothing to stop */
+    if (st->mutex == NULL)
+        return 0;
+    ossl_crypto_mutex_lock(st->mutex);
+    ret = st->teardown;
+    ossl_crypto_mutex_unlock(st->mutex);
+    return ret;
+# else
+    return 0;
+# endif
+}
+
+/*
+ * Wait until |bio| is ready for the I/O it last attempted.  The wait is done
+ * in steps of at most STAPLING_POLL_INTERVAL, so that a request gives up soon
+ * after the manager starts being torn down.  Returns 0 if that happened, once
+ * |deadline| has passed, or on error.
+ */
+static int stapling_wait(SSL_OCSP_STAPLING *st, BIO *bio, time_t deadline)
+{
+    time_t now;
+    int rv;
+
+    do {
+        if (stapling_stopping(st) || (now = time(NULL)) >= deadline)
+            return 0;
+        ERR_set_mark();
+        rv = BIO_wait(bio, now + STAPLING_POLL_INTERVAL, 100);
+        if (rv == 0)
+            ERR_pop_to_mark();
+        else
+            ERR_clear_last_mark();
+    } while (rv == 0);
+    return rv > 0;
+}
+
+/*
+ * Fetch and verify a new response for |e| from its responder.  The request is
+ * done with non-blocking I/O so that it can be abandoned when the background
+ * thread is stopped, rather than making SSL_CTX_free() wait for the responder.
+ */
+static SSL_OCSP_STAPLE *stapling_fetch(SSL_OCSP_STAPLING *st,
+                                       STAPLING_ENTRY *e, OSSL_TIME *refresh)
+{
+    SSL_OCSP_STAPLE *staple = NULL;
+    OCSP_REQUEST *req = NULL;
+    OCSP_CERTID *id = NULL;
+    OSSL_HTTP_REQ_CTX *rctx = NULL;
+    BIO *reqbio = NULL, *cbio = NULL, *rspbio;
+    char *host = NULL, *port = NULL, *path = NULL;
+    time_t deadline = time(NULL) + STAPLING_FETCH_TIMEOUT;
+    unsigned char *data;
+    long len;
+    int use_ssl, rv;
+
+    if (!OSSL_HTTP_parse_url(e->url, &use_ssl, NULL, &host, &port, NULL,
+                             &path, NULL, NULL))
+        goto end;
+    /* Responders are plain HTTP, the responses are signed */
+    if (use_ssl) {
+        ERR_raise_data(ERR_LIB_SSL, ERR_R_UNSUPPORTED,
+                       "OCSP responder URL %s", e->url);
+        goto end;
+    }
+
+    if ((req = OCSP_REQUEST_new()) == NULL
+            || (id = OCSP_CERTID_dup(e->id)) == NULL)
+        goto end;
+    if (OCSP_request_add0_id(req, id) == NULL) {
+        OCSP_CERTID_free(id);
+        goto end;
+    }
+    if ((reqbio = ASN1_item_i2d_mem_bio(ASN1_ITEM_rptr(OCSP_REQUEST),
+                                        (const ASN1_VALUE *)req)) == NULL)
+        goto end;
+
+    if ((cbio = BIO_new_connect(host)) == NULL
+            || BIO_set_conn_port(cbio, port) <= 0
+            || BIO_set_nbio(cbio, 1) <= 0)
+        goto end;
+    while (BIO_do_connect(cbio) <= 0)
+        if (!BIO_should_retry(cbio) || !stapling_wait(st, cbio, deadline))
+            goto end;
+
+    /* Passing the connected BIO for reading too means it is used as is */
+    if ((rctx = OSSL_HTTP_open(host, port, NULL, NULL, 0, cbio, cbio,
+                               NULL, NULL, 0, 0)) == NULL
+            || !OSSL_HTTP_set1_request(rctx, path, NULL,
+                                       "application/ocsp-request", reqbio,
+                                       "application/ocsp-response", 1,
+                                       STAPLING_MAX_RESP_LEN, 0, 0))
+        goto end;
+    while ((rv = OSSL_HTTP_REQ_CTX_nbio(rctx)) == -1)
+        if (!stapling_wait(st, cbio, deadline))
+            goto end;
+    if (rv != 1
+            || (rspbio = OSSL_HTTP_REQ_CTX_get0_mem_bio(rctx)) == NULL
+            || (len = BIO_get_mem_data(rspbio, &data)) <= 0)
+        goto end;
+    staple = stapling_staple_new(e, data, (size_t)len, refresh);
+
+ end:
+    OSSL_HTTP_REQ_CTX_free(rctx);
+    BIO_free_all(cbio);
+    BIO_free(reqbio);
+    OCSP_REQUEST_free(req);
+    OPENSSL_free(host);
+    OPENSSL_free(port);
+    OPENSSL_free(path);
+    return staple;
+}
+
+/*
+ * Fetch new responses for the entries that are due a refresh.  Returns 0 if
+ * any of them failed.
+ */
+static int stapling_refresh(SSL_OCSP_STAPLING *st)
+{
+    SSL_OCSP_STAPLE *staple;
+    OSSL_TIME refresh = ossl_time_zero();
+    size_t i;
+    int due, ret = 1;
+
+    for (i = 0; i < st->num; i++) {
+        STAPLING_ENTRY *e = &st->entries[i];
+
+        if (stapling_stopping(st))
+            return 0;
+        if (e->url == NULL)
+            continue;
+        if (!CRYPTO_THREAD_read_lock(st->lock))
+            return 0;
+        due = e->staple == NULL
+            || ossl_time_compare(ossl_time_now(), e->refresh) >= 0;
+        CRYPTO_THREAD_unlock(st->lock);
+        if (!due)
+            continue;
+
+        staple = stapling_fetch(st, e, &refresh);
+        if (staple == NULL)
+            ret = 0;
+        stapling_set(st, e, staple, refresh);
+    }
+    return ret;
+}
+
+# ifdef STAPLING_THREAD
+/* Time of the next refresh that is due */
+static OSSL_TIME stapling_deadline(SSL_OCSP_STAPLING *st)
+{
+    OSSL_TIME deadline = ossl_time_infinite();
+    size_t i;
+
+    if (!CRYPTO_THREAD_read_lock(st->lock))
+        return ossl_time_add(ossl_time_now(),
+                             ossl_seconds2time(STAPLING_RETRY_DELAY));
+    for (i = 0; i < st->num; i++)
+        if (st->entries[i].url != NULL)
+            deadline = ossl_time_min(deadline, st->entries[i].refresh);
+    CRYPTO_THREAD_unlock(st->lock);
+    return deadline;
+}
+
+/* Main loop of the background refresh thread */
+static unsigned int stapling_thread_main(void *arg)
+{
+    SSL_OCSP_STAPLING *st = arg;
+    OSSL_TIME deadline;
+
+    ossl_crypto_mutex_lock(st->mutex);
+    while (!st->teardown) {
+        ossl_crypto_mutex_unlock(st->mutex);
+        (void)stapling_refresh(st);
+        deadline = stapling_deadline(st);
+        ossl_crypto_mutex_lock(st->mutex);
+
+        /* Spurious wakeups just cause an early check for due refreshes */
+        if (!st->teardown)
+            ossl_crypto_condvar_wait_timeout(st->cv, st->mutex, deadline);
+    }
+    ossl_crypto_mutex_unlock(st->mutex);
+    return 1;
+}
+
+static int stapling_thread_start(SSL_OCSP_STAPLING *st)
+{
+    if ((st->mutex = ossl_crypto_mutex_new()) == NULL
+            || (st->cv = ossl_crypto_condvar_new()) == NULL)
+        return 0;
+    st->thread = ossl_crypto_thread_native_start(stapling_thread_main, st, 1);
+    return st->thread != NULL;
+}
+
+static void stapling_thread_stop(SSL_OCSP_STAPLING *st)
+{
+    CRYPTO_THREAD_RETVAL rv;
+
+    if (st->thread != NULL) {
+        ossl_crypto_mutex_lock(st->mutex);
+        st->teardown = 1;
+        ossl_crypto_condvar_signal(st->cv);
+        ossl_crypto_mutex_unlock(st->mutex);
+        ossl_crypto_thread_native_join(st->thread, &rv);
+        ossl_crypto_thread_native_clean(st->thread);
+    }
+    ossl_crypto_condvar_free(&st->cv);
+    ossl_crypto_mutex_free(&st->mutex);
+}
+# endif
+
+void ossl_ssl_ocsp_stapling_free(SSL_OCSP_STAPLING *st)
+{
+    size_t i;
+
+    if (st == NULL)
+        return;
+
+# ifdef STAPLING_THREAD
+    stapling_thread_stop(st);
+# endif
+    for (i = 0; i < st->num; i++) {
+        STAPLING_ENTRY *e = &st->entries[i];
+
+        X509_free(e->cert);
+        X509_free(e->issuer);
+        OCSP_CERTID_free(e->id);
+        X509_STORE_free(e->trust);
+        OPENSSL_free(e->url);
+        ossl_ssl_ocsp_staple_free(e->staple);
+    }
+    CRYPTO_THREAD_lock_free(st->lock);
+    OPENSSL_free(st);
+}
+
+/* Look for the issuer of |cpk| in its chain and then in the cert store */
+static X509 *stapling_find_issuer(SSL_CTX *ctx, CERT_PKEY *cpk)
+{
+    STACK_OF(X509) *chain = cpk->chain != NULL ? cpk->chain : ctx->extra_certs;
+    X509_STORE_CTX *sctx;
+    X509 *issuer = NULL;
+    int i;
+
+    for (i = 0; i < sk_X509_num(chain); i++) {
+        X509 *x = sk_X509_value(chain, i);
+
+        if (X509_check_issued(x, cpk->x509) == X509_V_OK) {
+            if (!X509_up_ref(x))
+                return NULL;
+            return x;
+        }
+    }
+
+    if (ctx->cert_store == NULL
+            || (sctx = X509_STORE_CTX_new_ex(ctx->libctx, ctx->propq)) == NULL)
+        return NULL;
+    if (X509_STORE_CTX_init(sctx, ctx->cert_store, cpk->x509, NULL)
+            && X509_STORE_CTX_get1_issuer(&issuer, sctx, cpk->x509) <= 0)
+        issuer = NULL;
+    X509_STORE_CTX_free(sctx);
+    return issuer;
+}
+
+static int stapling_add_entry(SSL_OCSP_STAPLING *st, SSL_CTX *ctx,
+                              CERT_PKEY *cpk)
+{
+    STAPLING_ENTRY *e = &st->entries[st->num];
+    STACK_OF(OPENSSL_STRING) *urls;
+    EVP_MD *sha1;
+
+    /* A certificate status cannot be requested without the issuer */
+    if ((e->issuer = stapling_find_issuer(ctx, cpk)) == NULL)
+        return 1;
+    if (!X509_up_ref(cpk->x509)) {
+        X509_free(e->issuer);
+        e->issuer = NULL;
+        return 0;
+    }
+    e->cert = cpk->x509;
+    st->num++;
+
+    if ((sha1 = EVP_MD_fetch(ctx->libctx, "SHA1", ctx->propq)) == NULL)
+        return 0;
+    e->id = OCSP_cert_to_id(sha1, e->cert, e->issuer);
+    EVP_MD_free(sha1);
+    if (e->id == NULL
+            || (e->trust = X509_STORE_new()) == NULL
+            || !X509_STORE_add_cert(e->trust, e->issuer)
+            || !X509_STORE_set_flags(e->trust, X509_V_FLAG_PARTIAL_CHAIN))
+        return 0;
+
+    urls = X509_get1_ocsp(e->cert);
+    if (sk_OPENSSL_STRING_num(urls) > 0
+            && (e->url = OPENSSL_strdup(sk_OPENSSL_STRING_value(urls, 0)))
+               == NULL) {
+        X509_email_free(urls);
+        return 0;
+    }
+    X509_email_free(urls);
+    return 1;
+}
+
+int SSL_CTX_enable_ocsp_stapling(SSL_CTX *ctx, uint64_t flags)
+{
+    SSL_OCSP_STAPLING *st;
+    size_t i;
+
+    if ((flags & ~(uint64_t)SSL_OCSP_STAPLING_BACKGROUND) != 0) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+# ifndef STAPLING_THREAD
+    if ((flags & SSL_OCSP_STAPLING_BACKGROUND) != 0) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+        return 0;
+    }
+# endif
+
+    ossl_ssl_ocsp_stapling_free(ctx->ext.ocsp_stapling);
+    ctx->ext.ocsp_stapling = NULL;
+
+    if ((st = OPENSSL_zalloc(sizeof(*st))) == NULL)
+        return 0;
+    if ((st->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
+    for (i = 0; i < SSL_PKEY_NUM; i++) {
+        CERT_PKEY *cpk = &ctx->cert->pkeys[i];
+
+        if (cpk->x509 != NULL && !stapling_add_entry(st, ctx, cpk)) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_X509_LIB);
+            goto err;
+        }
+    }
+
+# ifdef STAPLING_THREAD
+    if ((flags & SSL_OCSP_STAPLING_BACKGROUND) != 0
+            && !stapling_thread_start(st)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_INIT_FAIL);
+        goto err;
+    }
+# endif
+
+    ctx->ext.ocsp_stapling = st;
+    return 1;
+
+ err:
+    ossl_ssl_ocsp_stapling_free(st);
+    return 0;
+}
+
+int SSL_CTX_refresh_ocsp_stapling(SSL_CTX *ctx)
+{
+    if (ctx->ext.ocsp_stapling == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+        return 0;
+    }
+    return stapling_refresh(ctx->ext.ocsp_stapling);
+}
+
+static STAPLING_ENTRY *stapling_find(SSL_OCSP_STAPLING *st, X509 *x)
+{
+    size_t i;
+
+    /* Connections normally share the X509 objects of the SSL_CTX */
+    for (i = 0; i < st->num; i++)
+        if (st->entries[i].cert == x)
+            return &st->entries[i];
+    for (i = 0; i < st->num; i++)
+        if (X509_cmp(st->entries[i].cert, x) == 0)
+            return &st->entries[i];
+    return NULL;
+}
+
+int SSL_CTX_add1_ocsp_stapling_response(SSL_CTX *ctx, X509 *cert,
+                                        const unsigned char *resp,
+                                        size_t resp_len)
+{
+    SSL_OCSP_STAPLING *st = ctx->ext.ocsp_stapling;
+    SSL_OCSP_STAPLE *staple;
+    STAPLING_ENTRY *e;
+    OSSL_TIME refresh;
+
+    if (st == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+        return 0;
+    }
+    if (cert == NULL || resp == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if ((e = stapling_find(st, cert)) == NULL) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_NO_CERTIFICATE_ASSIGNED);
+        return 0;
+    }
+    if ((staple = stapling_staple_new(e, resp, resp_len, &refresh)) == NULL)
+        return 0;
+    stapling_set(st, e, staple, refresh);
+    return 1;
+}
+
+/*
+ * Return a reference to the current response for |x|, or NULL if there is
+ * no unexpired one.
+ */
+SSL_OCSP_STAPLE *ossl_ssl_ocsp_stapling_get(SSL_OCSP_STAPLING *st, X509 *x)
+{
+    SSL_OCSP_STAPLE *staple = NULL;
+    STAPLING_ENTRY *e;
+    int i;
+
+    if ((e = stapling_find(st, x)) == NULL
+            || !CRYPTO_THREAD_read_lock(st->lock))
+        return NULL;
+    if (e->staple != NULL
+            && ossl_time_compare(ossl_time_now(), e->staple->expires) < 0
+            && CRYPTO_UP_REF(&e->staple->references, &i))
+        staple = e->staple;
+    CRYPTO_THREAD_unlock(st->lock);
+    return staple;
+}
+
+#endif
@@ -990,6 +990,94 @@ static int ssl_add_cert_to_wpacket(SSL_CONNECTION *s, WPACKET *pkt,
     return 1;
 }
 
+/*
+ * Whether a server must add any extensions to the entries of its TLSv1.3
+ * Certificate message on this connection
+ */
+static int ssl_cert_exts_needed(SSL_CONNECTION *s)
+{
+    custom_ext_methods *exts = &s->cert->custext;
+    size_t i;
+
+    if (!SSL_CONNECTION_IS_TLS13(s))
+        return 0;
+    if (s->ext.status_expected)
+        return 1;
+    for (i = 0; i < exts->meths_count; i++) {
+        custom_ext_method *meth = exts->meths + i;
+
+        if ((meth->context & SSL_EXT_TLS1_3_CERTIFICATE) != 0
+                && (meth->ext_flags & SSL_EXT_FLAG_RECEIVED) != 0)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Get the encoded certificate_list for |cpk| and |extra_certs|. It is looked
+ * for on |cpk| itself and then on the SSL_CTX certificate |cpk| was copied
+ * from, where connections share it under the SSL_CTX lock. A newly encoded
+ * list is stored on the SSL_CTX certificate if it has the same chain. The
+ * returned value is owned by |cpk|.
+ */
+static SSL_CERT_MSG *ssl_get_cert_msg(SSL_CONNECTION *s, CERT_PKEY *cpk,
+                                      STACK_OF(X509) *extra_certs)
+{
+    SSL_CTX *sctx = SSL_CONNECTION_GET_CTX(s);
+    CERT *ccert = sctx->cert;
+    CERT_PKEY *ctxcpk = NULL;
+    STACK_OF(X509) *ctxchain;
+    SSL_CERT_MSG *msg = NULL;
+    size_t idx;
+
+    if (cpk < s->cert->pkeys || cpk >= s->cert->pkeys + s->cert->ssl_pkey_num)
+        return NULL;
+    idx = cpk - s->cert->pkeys;
+    if (ccert != NULL && ccert != s->cert && idx < ccert->ssl_pkey_num)
+        ctxcpk = &ccert->pkeys[idx];
+
+    if (cpk->cert_msg != NULL
+            && ssl_cert_msg_matches(cpk->cert_msg, cpk->x509, extra_certs))
+        return cpk->cert_msg;
+
+    if (ctxcpk != NULL && CRYPTO_THREAD_read_lock(sctx->lock)) {
+        if (ctxcpk->cert_msg != NULL
+                && ssl_cert_msg_matches(ctxcpk->cert_msg, cpk->x509,
+                                        extra_certs)
+                && ssl_cert_msg_up_ref(ctxcpk->cert_msg))
+            msg = ctxcpk->cert_msg;
+        CRYPTO_THREAD_unlock(sctx->lock);
+    }
+
+    if (msg == NULL) {
+        /* Fall back to encoding the chain in place if this fails */
+        ERR_set_mark();
+        msg = ssl_cert_msg_new(cpk->x509, extra_certs);
+        ERR_pop_to_mark();
+        if (msg == NULL)
+            return NULL;
+
+        if (ctxcpk != NULL && ctxcpk->x509 == cpk->x509
+                && CRYPTO_THREAD_write_lock(sctx->lock)) {
+            ctxchain = ctxcpk->chain != NULL ? ctxcpk->chain
+                                             : sctx->extra_certs;
+            if (ssl_cert_msg_matches(msg, ctxcpk->x509, ctxchain)
+                    && (ctxcpk->cert_msg == NULL
+                        || !ssl_cert_msg_matches(ctxcpk->cert_msg,
+                                                 ctxcpk->x509, ctxchain))
+                    && ssl_cert_msg_up_ref(msg)) {
+                ssl_cert_msg_free(ctxcpk->cert_msg);
+                ctxcpk->cert_msg = msg;
+            }
+            CRYPTO_THREAD_unlock(sctx->lock);
+        }
+    }
+
+    ssl_cert_msg_free(cpk->cert_msg);
+    cpk->cert_msg = msg;
+    return msg;
+}
+
 /* Add certificate chain to provided WPACKET */
 static int ssl_add_cert_chain(SSL_CONNECTION *s, WPACKET *pkt, CERT_PKEY *cpk, int for_comp)
 {
@@ -998,6 +1086,7 @@ static int ssl_add_cert_chain(SSL_CONNECTION *s, WPACKET *pkt, CERT_PKEY *cpk, i
     STACK_OF(X509) *extra_certs;
     STACK_OF(X509) *chain = NULL;
     X509_STORE *chain_store;
+    SSL_CERT_MSG *msg;
     SSL_CTX *sctx = SSL_CONNECTION_GET_CTX(s);
 
     if (cpk == NULL || cpk->x509 == NULL)
@@ -1076,6 +1165,20 @@ static int ssl_add_cert_chain(SSL_CONNECTION *s, WPACKET *pkt, CERT_PKEY *cpk, i
                 SSLfatal(s, SSL_AD_INTERNAL_ERROR, i);
             return 0;
         }
+        /*
+         * A server sending no certificate extensions can copy a previously
+         * encoded list of the same certificates.
+         */
+        if (!for_comp && s->server && !ssl_cert_exts_needed(s)
+                && (msg = ssl_get_cert_msg(s, cpk, extra_certs)) != NULL) {
+            if (SSL_CONNECTION_IS_TLS13(s)
+                    ? !WPACKET_memcpy(pkt, msg->tls13, msg->tls13_len)
+                    : !WPACKET_memcpy(pkt, msg->tls12, msg->tls12_len)) {
+                SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+                return 0;
+            }
+            return 1;
+        }
         if (!ssl_add_cert_to_wpacket(s, pkt, x, 0, for_comp)) {
             /* SSLfatal() already called */
             return 0;
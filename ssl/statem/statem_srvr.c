@@ -2143,6 +2143,10 @@ static int tls_handle_status_request(SSL_CONNECTION *s)
     SSL_CTX *sctx = SSL_CONNECTION_GET_CTX(s);
 
     s->ext.status_expected = 0;
+#ifndef OPENSSL_NO_OCSP
+    ossl_ssl_ocsp_staple_free(s->ext.ocsp.staple);
+    s->ext.ocsp.staple = NULL;
+#endif
 
     /*
      * If status request then ask callback what to do. Note: this must be
@@ -2167,7 +2171,7 @@ static int tls_handle_status_request(SSL_CONNECTION *s)
                 /* We don't want to send a status request response */
             case SSL_TLSEXT_ERR_NOACK:
                 s->ext.status_expected = 0;
-                break;
+                return 1;
                 /* status request response should be sent */
             case SSL_TLSEXT_ERR_OK:
                 if (s->ext.ocsp.resp)
@@ -2182,6 +2186,19 @@ static int tls_handle_status_request(SSL_CONNECTION *s)
         }
     }
 
+#ifndef OPENSSL_NO_OCSP
+    /* Otherwise staple a cached response if the stapling manager has one */
+    if (s->ext.status_type == TLSEXT_STATUSTYPE_ocsp
+            && !s->ext.status_expected && sctx != NULL
+            && sctx->ext.ocsp_stapling != NULL && s->s3.tmp.cert != NULL
+            && s->s3.tmp.cert->x509 != NULL) {
+        s->ext.ocsp.staple = ossl_ssl_ocsp_stapling_get(sctx->ext.ocsp_stapling,
+                                                        s->s3.tmp.cert->x509);
+        if (s->ext.ocsp.staple != NULL)
+            s->ext.status_expected = 1;
+    }
+#endif
+
     return 1;
 }
 
@@ -4301,9 +4318,16 @@ CON_FUNC_RETURN tls_construct_new_session_ticket(SSL_CONNECTION *s, WPACKET *pkt
  */
 int tls_construct_cert_status_body(SSL_CONNECTION *s, WPACKET *pkt)
 {
+    const unsigned char *resp = s->ext.ocsp.resp;
+    size_t resp_len = s->ext.ocsp.resp_len;
+
+    /* A response set by the status callback takes precedence */
+    if (resp == NULL && s->ext.ocsp.staple != NULL) {
+        resp = s->ext.ocsp.staple->der;
+        resp_len = s->ext.ocsp.staple->der_len;
+    }
     if (!WPACKET_put_bytes_u8(pkt, s->ext.status_type)
-            || !WPACKET_sub_memcpy_u24(pkt, s->ext.ocsp.resp,
-                                       s->ext.ocsp.resp_len)) {
+            || !WPACKET_sub_memcpy_u24(pkt, resp, resp_len)) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
         return 0;
     }
@@ -452,6 +452,130 @@ static int test_bio_dgram(int idx)
                                bio_dgram_cases[idx].local);
 }
 
+/*
+ * Test segmentation offload. A batch containing runs of equally sized datagrams
+ * is sent and must be received as the same sequence of datagrams, whether it is
+ * segmented by the sender, coalesced for the receiver, or both.
+ */
+static const size_t seg_offload_sizes[] = {
+    200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 50,
+    300, 300, 300, 10, 1200, 1200, 1200, 1200
+};
+
+static int test_bio_dgram_seg_offload(int idx)
+{
+    int testresult = 0;
+    BIO *b1 = NULL, *b2 = NULL;
+    int fd1 = -1, fd2 = -1;
+    BIO_ADDR *addr1 = NULL, *addr2 = NULL, *addr3 = NULL;
+    struct in_addr ina;
+    union BIO_sock_info_u info1 = {0}, info2 = {0};
+    uint32_t tx_flags = 0, rx_flags = 0;
+    BIO_MSG tx_msg[OSSL_NELEM(seg_offload_sizes)];
+    BIO_MSG rx_msg[OSSL_NELEM(seg_offload_sizes)];
+    static unsigned char tx_buf[OSSL_NELEM(seg_offload_sizes)][1200];
+    static unsigned char rx_buf[OSSL_NELEM(seg_offload_sizes)][1500];
+    size_t i, num_processed = 0;
+
+    if (idx != 2)
+        tx_flags = BIO_DGRAM_SEG_OFFLOAD_TX;
+    if (idx != 1)
+        rx_flags = BIO_DGRAM_SEG_OFFLOAD_RX;
+
+    ina.s_addr = htonl(0x7f000001UL);
+
+    if (!TEST_ptr(addr1 = BIO_ADDR_new())
+        || !TEST_ptr(addr2 = BIO_ADDR_new())
+        || !TEST_ptr(addr3 = BIO_ADDR_new())
+        || !TEST_int_eq(BIO_ADDR_rawmake(addr1, AF_INET, &ina, sizeof(ina), 0), 1)
+        || !TEST_int_eq(BIO_ADDR_rawmake(addr2, AF_INET, &ina, sizeof(ina), 0), 1))
+        goto err;
+
+    fd1 = BIO_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, 0);
+    fd2 = BIO_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, 0);
+    if (!TEST_int_ge(fd1, 0) || !TEST_int_ge(fd2, 0))
+        goto err;
+
+    if (BIO_bind(fd1, addr1, 0) <= 0 || BIO_bind(fd2, addr2, 0) <= 0) {
+        testresult = TEST_skip("BIO_bind() failed");
+        goto err;
+    }
+
+    info1.addr = addr1;
+    info2.addr = addr2;
+    if (!TEST_int_gt(BIO_sock_info(fd1, BIO_SOCK_INFO_ADDRESS, &info1), 0)
+        || !TEST_int_gt(BIO_sock_info(fd2, BIO_SOCK_INFO_ADDRESS, &info2), 0))
+        goto err;
+
+    if (!TEST_ptr(b1 = BIO_new_dgram(fd1, 0))
+        || !TEST_ptr(b2 = BIO_new_dgram(fd2, 0)))
+        goto err;
+
+    if ((BIO_dgram_get_seg_offload_cap(b1) & tx_flags) != tx_flags
+        || (BIO_dgram_get_seg_offload_cap(b2) & rx_flags) != rx_flags
+        || !BIO_dgram_set_seg_offload(b1, tx_flags)
+        || !BIO_dgram_set_seg_offload(b2, rx_flags)) {
+        testresult = TEST_skip("segmentation offload not available");
+        goto err;
+    }
+
+    if (!TEST_uint_eq(BIO_dgram_get_seg_offload(b1), tx_flags)
+        || !TEST_uint_eq(BIO_dgram_get_seg_offload(b2), rx_flags))
+        goto err;
+
+    for (i = 0; i < OSSL_NELEM(seg_offload_sizes); ++i) {
+        memset(tx_buf[i], (int)i + 1, seg_offload_sizes[i]);
+        tx_msg[i].data      = tx_buf[i];
+        tx_msg[i].data_len  = seg_offload_sizes[i];
+        tx_msg[i].peer      = addr2;
+        tx_msg[i].local     = NULL;
+        tx_msg[i].flags     = 0;
+
+        rx_msg[i].data      = rx_buf[i];
+        rx_msg[i].data_len  = sizeof(rx_buf[i]);
+        rx_msg[i].peer      = NULL;
+        rx_msg[i].local     = NULL;
+        rx_msg[i].flags     = 0;
+    }
+    rx_msg[0].peer = addr3;
+
+    if (!TEST_true(do_sendmmsg(b1, tx_msg, OSSL_NELEM(tx_msg), 0,
+                               &num_processed))
+        || !TEST_size_t_eq(num_processed, OSSL_NELEM(tx_msg)))
+        goto err;
+
+    /*
+     * Receive a few datagrams first so that the rest are returned from what
+     * the BIO has already buffered where GRO is in use.
+     */
+    if (!TEST_true(do_recvmmsg(b2, rx_msg, 3, 0, &num_processed))
+        || !TEST_true(do_recvmmsg(b2, rx_msg + 3, OSSL_NELEM(rx_msg) - 3, 0,
+                                  &num_processed)))
+        goto err;
+
+    for (i = 0; i < OSSL_NELEM(seg_offload_sizes); ++i)
+        if (!TEST_mem_eq(rx_msg[i].data, rx_msg[i].data_len,
+                         tx_buf[i], seg_offload_sizes[i])
+            || !TEST_uint64_t_eq(rx_msg[i].flags, 0))
+            goto err;
+
+    if (!TEST_int_eq(compare_addr(addr3, addr1), 1))
+        goto err;
+
+    testresult = 1;
+err:
+    BIO_free(b1);
+    BIO_free(b2);
+    if (fd1 >= 0)
+        BIO_closesocket(fd1);
+    if (fd2 >= 0)
+        BIO_closesocket(fd2);
+    BIO_ADDR_free(addr1);
+    BIO_ADDR_free(addr2);
+    BIO_ADDR_free(addr3);
+    return testresult;
+}
+
 # if !defined(OPENSSL_NO_CHACHA)
 static int random_data(const uint32_t *key, uint8_t *data, size_t data_len, size_t offset)
 {
@@ -785,6 +909,7 @@ int setup_tests(void)
 
 #if !defined(OPENSSL_NO_DGRAM) && !defined(OPENSSL_NO_SOCK)
     ADD_ALL_TESTS(test_bio_dgram, OSSL_NELEM(bio_dgram_cases));
+    ADD_ALL_TESTS(test_bio_dgram_seg_offload, 3);
 # if !defined(OPENSSL_NO_CHACHA)
     ADD_ALL_TESTS(test_bio_dgram_pair, 3);
 # endif
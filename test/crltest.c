@@ -391,6 +391,248 @@ static int test_reuse_crl(void)
     return 1;
 }
 
+static int add_revoked(X509_CRL *crl, long serial)
+{
+    X509_REVOKED *rev = X509_REVOKED_new();
+    ASN1_INTEGER *ser = ASN1_INTEGER_new();
+    int ok = TEST_ptr(rev)
+        && TEST_ptr(ser)
+        && TEST_true(ASN1_INTEGER_set(ser, serial))
+        && TEST_true(X509_REVOKED_set_serialNumber(rev, ser))
+        && TEST_true(X509_CRL_add0_revoked(crl, rev));
+
+    ASN1_INTEGER_free(ser);
+    if (!ok)
+        X509_REVOKED_free(rev);
+    return ok;
+}
+
+static int is_revoked(X509_CRL *crl, long serial)
+{
+    ASN1_INTEGER *ser = ASN1_INTEGER_new();
+    X509_REVOKED *rev = NULL;
+    int ret = -1;
+
+    if (TEST_ptr(ser) && TEST_true(ASN1_INTEGER_set(ser, serial))) {
+        ret = X509_CRL_get0_by_serial(crl, &rev, ser);
+        if (ret == 1
+                && !TEST_int_eq(ASN1_INTEGER_cmp(
+                                    X509_REVOKED_get0_serialNumber(rev), ser),
+                                0))
+            ret = -1;
+    }
+    ASN1_INTEGER_free(ser);
+    return ret;
+}
+
+/*
+ * Look up serial numbers in a CRL with many entries, added in descending
+ * order, including after adding more entries.
+ */
+static int test_crl_lookup_by_serial(void)
+{
+    X509_CRL *crl = X509_CRL_new();
+    X509_REVOKED *rev = NULL;
+    ASN1_INTEGER *ser = NULL;
+    const ASN1_INTEGER *first;
+    long i, n = 1000;
+    int testresult = 0;
+
+    if (!TEST_ptr(crl))
+        return 0;
+    for (i = n; i > 0; i--)
+        if (!add_revoked(crl, 3 * i))
+            goto err;
+    if (!add_revoked(crl, -3))
+        goto err;
+
+    for (i = 1; i <= n; i++)
+        if (!TEST_int_eq(is_revoked(crl, 3 * i), 1)
+                || !TEST_int_eq(is_revoked(crl, 3 * i + 1), 0))
+            goto err;
+    if (!TEST_int_eq(is_revoked(crl, -3), 1)
+            || !TEST_int_eq(is_revoked(crl, 0), 0)
+            || !TEST_int_eq(is_revoked(crl, -6), 0))
+        goto err;
+
+    /* Lookups leave the entries in their original order */
+    first = X509_REVOKED_get0_serialNumber(
+                sk_X509_REVOKED_value(X509_CRL_get_REVOKED(crl), 0));
+    if (!TEST_long_eq(ASN1_INTEGER_get(first), 3 * n))
+        goto err;
+
+    if (!add_revoked(crl, 1)
+            || !TEST_int_eq(is_revoked(crl, 1), 1)
+            || !TEST_int_eq(is_revoked(crl, 3), 1)
+            || !TEST_int_eq(is_revoked(crl, 2), 0))
+        goto err;
+
+    /* Reordering the entries keeps lookups working */
+    if (!TEST_true(X509_CRL_sort(crl))
+            || !TEST_int_eq(is_revoked(crl, 3 * n), 1)
+            || !TEST_int_eq(is_revoked(crl, 1), 1))
+        goto err;
+
+    /*
+     * Replace an entry through the stack itself, leaving the number of
+     * entries unchanged. The index must not refer to the freed entry.
+     */
+    X509_REVOKED_free(sk_X509_REVOKED_pop(X509_CRL_get_REVOKED(crl)));
+    if (!TEST_ptr(rev = X509_REVOKED_new())
+            || !TEST_ptr(ser = ASN1_INTEGER_new())
+            || !TEST_true(ASN1_INTEGER_set(ser, 2))
+            || !TEST_true(X509_REVOKED_set_serialNumber(rev, ser))
+            || !TEST_true(sk_X509_REVOKED_push(X509_CRL_get_REVOKED(crl), rev)))
+        goto err;
+    rev = NULL;
+    if (!TEST_int_eq(is_revoked(crl, 3 * n), 0)
+            || !TEST_int_eq(is_revoked(crl, 3), 1))
+        goto err;
+
+    testresult = 1;
+ err:
+    X509_REVOKED_free(rev);
+    ASN1_INTEGER_free(ser);
+    X509_CRL_free(crl);
+    return testresult;
+}
+
+/* Returns the DER encoding of |crl|, or NULL on error */
+static unsigned char *crl_to_der(X509_CRL *crl, int *len)
+{
+    unsigned char *der = NULL;
+
+    if (!TEST_int_gt(*len = i2d_X509_CRL(crl, &der), 0))
+        return NULL;
+    return der;
+}
+
+/*
+ * Compact the CRLs used for verification, and a signed CRL with many entries,
+ * and check that lookups and their encoding are unaffected.
+ */
+static int test_compact_crl(void)
+{
+    X509_CRL *basic_crl = CRL_from_strings(kBasicCRL);
+    X509_CRL *revoked_crl = CRL_from_strings(kRevokedCRL);
+    X509_CRL *crl = NULL, *dup = NULL, *big = X509_CRL_new();
+    STACK_OF(X509_REVOKED) *revoked;
+    X509_REVOKED *rev;
+    const ASN1_INTEGER *ser;
+    X509_NAME *name = NULL;
+    ASN1_TIME *tm = NULL;
+    EVP_PKEY *pkey = NULL;
+    unsigned char *der = NULL, *der2 = NULL;
+    const unsigned char *p;
+    int len, len2, num;
+    long i, n = 1000;
+    int testresult = 0;
+
+    if (!TEST_ptr(basic_crl)
+            || !TEST_ptr(revoked_crl)
+            || !TEST_ptr(big)
+            || !TEST_ptr(der = crl_to_der(revoked_crl, &len))
+            || !TEST_ptr(revoked = X509_CRL_get_REVOKED(revoked_crl))
+            || !TEST_int_gt(num = sk_X509_REVOKED_num(revoked), 0)
+            || !TEST_true(X509_CRL_compact(basic_crl))
+            || !TEST_true(X509_CRL_compact(revoked_crl))
+            || !TEST_true(X509_CRL_compact(revoked_crl))
+            || !TEST_int_eq(verify(test_leaf, test_root,
+                                   make_CRL_stack(basic_crl, revoked_crl),
+                                   X509_V_FLAG_CRL_CHECK),
+                            X509_V_ERR_CERT_REVOKED)
+            || !TEST_ptr(der2 = crl_to_der(revoked_crl, &len2))
+            || !TEST_mem_eq(der, len, der2, len2))
+        goto err;
+
+    /* A duplicate stays compact, and expanding it restores all entries */
+    if (!TEST_ptr(dup = X509_CRL_dup(revoked_crl))
+            || !TEST_int_eq(verify(test_leaf, test_root,
+                                   make_CRL_stack(basic_crl, dup),
+                                   X509_V_FLAG_CRL_CHECK),
+                            X509_V_ERR_CERT_REVOKED)
+            || !TEST_int_eq(sk_X509_REVOKED_num(X509_CRL_get_REVOKED(dup)),
+                            num)
+            || !TEST_int_eq(verify(test_leaf, test_root,
+                                   make_CRL_stack(basic_crl, dup),
+                                   X509_V_FLAG_CRL_CHECK),
+                            X509_V_ERR_CERT_REVOKED))
+        goto err;
+
+    /* A CRL that does not match its encoding cannot be compacted */
+    if (!TEST_ptr(tm = ASN1_TIME_set(NULL, PARAM_TIME)))
+        goto err;
+    for (i = n; i > 0; i--)
+        if (!add_revoked(big, 3 * i))
+            goto err;
+    revoked = X509_CRL_get_REVOKED(big);
+    for (i = 0; i < n; i++) {
+        rev = sk_X509_REVOKED_value(revoked, i);
+        if (!TEST_true(X509_REVOKED_set_revocationDate(rev, tm)))
+            goto err;
+    }
+    if (!TEST_false(X509_CRL_compact(big)))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_ptr(name = X509_NAME_new())
+            || !TEST_true(X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                                     (unsigned char *)"CA",
+                                                     -1, -1, 0))
+            || !TEST_ptr(pkey = EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256"))
+            || !TEST_true(X509_CRL_set_version(big, X509_CRL_VERSION_2))
+            || !TEST_true(X509_CRL_set_issuer_name(big, name))
+            || !TEST_true(X509_CRL_set1_lastUpdate(big, tm))
+            || !TEST_true(X509_CRL_set1_nextUpdate(big, tm))
+            || !TEST_true(X509_CRL_sign(big, pkey, EVP_sha256())))
+        goto err;
+    OPENSSL_free(der);
+    if (!TEST_ptr(der = crl_to_der(big, &len)))
+        goto err;
+    p = der;
+    if (!TEST_ptr(crl = d2i_X509_CRL(NULL, &p, len))
+            || !TEST_true(X509_CRL_compact(crl)))
+        goto err;
+    for (i = 1; i <= n; i++)
+        if (!TEST_int_eq(is_revoked(crl, 3 * i), 1)
+                || !TEST_int_eq(is_revoked(crl, 3 * i + 1), 0))
+            goto err;
+
+    /* Expanding keeps the entries in their original order */
+    if (!TEST_ptr(revoked = X509_CRL_get_REVOKED(crl))
+            || !TEST_int_eq(sk_X509_REVOKED_num(revoked), n)
+            || !TEST_ptr(rev = sk_X509_REVOKED_value(revoked, 0))
+            || !TEST_ptr(ser = X509_REVOKED_get0_serialNumber(rev))
+            || !TEST_long_eq(ASN1_INTEGER_get(ser), 3 * n)
+            || !TEST_int_eq(is_revoked(crl, 3), 1)
+            || !TEST_int_eq(X509_CRL_verify(crl, pkey), 1))
+        goto err;
+
+    /* Signing a compact CRL encodes all of its entries again */
+    if (!TEST_true(X509_CRL_compact(crl))
+            || !TEST_true(X509_CRL_sign(crl, pkey, EVP_sha256()))
+            || !TEST_false(X509_CRL_compact(crl)))
+        goto err;
+    ERR_clear_error();
+    if (!TEST_int_eq(X509_CRL_verify(crl, pkey), 1)
+            || !TEST_int_eq(is_revoked(crl, 3 * n), 1))
+        goto err;
+
+    testresult = 1;
+ err:
+    OPENSSL_free(der);
+    OPENSSL_free(der2);
+    EVP_PKEY_free(pkey);
+    ASN1_TIME_free(tm);
+    X509_NAME_free(name);
+    X509_CRL_free(basic_crl);
+    X509_CRL_free(revoked_crl);
+    X509_CRL_free(dup);
+    X509_CRL_free(big);
+    X509_CRL_free(crl);
+    return testresult;
+}
+
 int setup_tests(void)
 {
     if (!TEST_ptr(test_root = X509_from_strings(kCRLTestRoot))
@@ -403,6 +645,8 @@ int setup_tests(void)
     ADD_TEST(test_known_critical_crl);
     ADD_ALL_TESTS(test_unknown_critical_crl, OSSL_NELEM(unknown_critical_crls));
     ADD_TEST(test_reuse_crl);
+    ADD_TEST(test_crl_lookup_by_serial);
+    ADD_TEST(test_compact_crl);
     return 1;
 }
 
@@ -5660,6 +5660,215 @@ static int test_invalid_ctx_for_digest(void)
     return ret;
 }
 
+static const char *mac_ctx_copy_algs[][2] = {
+    { "HMAC", OSSL_MAC_PARAM_DIGEST },
+    { "CMAC", OSSL_MAC_PARAM_CIPHER }
+};
+
+/*
+ * Save a keyed MAC context and restore it repeatedly, both into an existing
+ * context of the same MAC and into a context of a different MAC.
+ */
+static int test_mac_ctx_copy(int idx)
+{
+    static const unsigned char key[16] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+    };
+    static const char *msgs[] = { "first message", "second message" };
+    const char *alg = mac_ctx_copy_algs[idx][0];
+    char *sub = idx == 0 ? "SHA256" : "AES-128-CBC";
+    EVP_MAC *mac = NULL, *other = NULL;
+    EVP_MAC_CTX *ctx = NULL, *saved = NULL, *ref = NULL, *octx = NULL;
+    OSSL_PARAM params[2];
+    unsigned char out[EVP_MAX_MD_SIZE], exp[EVP_MAX_MD_SIZE];
+    size_t outlen, explen;
+    size_t i;
+    int testresult = 0;
+
+    params[0] = OSSL_PARAM_construct_utf8_string(mac_ctx_copy_algs[idx][1],
+                                                 sub, 0);
+    params[1] = OSSL_PARAM_construct_end();
+
+    if (!TEST_ptr(mac = EVP_MAC_fetch(testctx, alg, testpropq))
+            || !TEST_ptr(other = EVP_MAC_fetch(testctx, idx == 0 ? "CMAC"
+                                                                 : "HMAC",
+                                               testpropq))
+            || !TEST_ptr(ctx = EVP_MAC_CTX_new(mac))
+            || !TEST_ptr(saved = EVP_MAC_CTX_new(mac))
+            || !TEST_ptr(ref = EVP_MAC_CTX_new(mac))
+            || !TEST_ptr(octx = EVP_MAC_CTX_new(other))
+            || !TEST_true(EVP_MAC_init(ctx, key, sizeof(key), params))
+            || !TEST_true(EVP_MAC_CTX_copy(saved, ctx)))
+        goto err;
+
+    for (i = 0; i < OSSL_NELEM(msgs); i++) {
+        if (!TEST_true(EVP_MAC_init(ref, key, sizeof(key), params))
+                || !TEST_true(EVP_MAC_update(ref, (unsigned char *)msgs[i],
+                                             strlen(msgs[i])))
+                || !TEST_true(EVP_MAC_final(ref, exp, &explen, sizeof(exp))))
+            goto err;
+
+        if (!TEST_true(EVP_MAC_CTX_copy(ctx, saved))
+                || !TEST_true(EVP_MAC_update(ctx, (unsigned char *)msgs[i],
+                                             strlen(msgs[i])))
+                || !TEST_true(EVP_MAC_final(ctx, out, &outlen, sizeof(out)))
+                || !TEST_mem_eq(exp, explen, out, outlen))
+            goto err;
+
+        if (!TEST_true(EVP_MAC_CTX_copy(octx, saved))
+                || !TEST_ptr_eq(EVP_MAC_CTX_get0_mac(octx), mac)
+                || !TEST_true(EVP_MAC_update(octx, (unsigned char *)msgs[i],
+                                             strlen(msgs[i])))
+                || !TEST_true(EVP_MAC_final(octx, out, &outlen, sizeof(out)))
+                || !TEST_mem_eq(exp, explen, out, outlen))
+            goto err;
+    }
+    testresult = 1;
+ err:
+    EVP_MAC_CTX_free(ctx);
+    EVP_MAC_CTX_free(saved);
+    EVP_MAC_CTX_free(ref);
+    EVP_MAC_CTX_free(octx);
+    EVP_MAC_free(mac);
+    EVP_MAC_free(other);
+    return testresult;
+}
+
+static const char *cipher_ctx_copy_ciphers[] = {
+    "AES-128-GCM", "AES-128-CBC", "AES-256-CTR"
+};
+
+/*
+ * Save a keyed cipher context, then for each message restore it into an
+ * existing context and only supply a new IV.
+ */
+static int test_cipher_ctx_copy(int idx)
+{
+    static const unsigned char key[32] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+        0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+    };
+    static const unsigned char msg[40] = { 0 };
+    unsigned char iv[16] = { 0 };
+    unsigned char out[64], exp[64], tag[16], exptag[16];
+    int outlen, explen, len;
+    EVP_CIPHER *cipher = NULL;
+    EVP_CIPHER_CTX *ctx = NULL, *saved = NULL, *ref = NULL;
+    int aead, i;
+    int testresult = 0;
+
+    if (!TEST_ptr(cipher = EVP_CIPHER_fetch(testctx,
+                                            cipher_ctx_copy_ciphers[idx],
+                                            testpropq))
+            || !TEST_ptr(ctx = EVP_CIPHER_CTX_new())
+            || !TEST_ptr(saved = EVP_CIPHER_CTX_new())
+            || !TEST_ptr(ref = EVP_CIPHER_CTX_new())
+            || !TEST_true(EVP_EncryptInit_ex2(ctx, cipher, key, NULL, NULL))
+            || !TEST_true(EVP_EncryptInit_ex2(saved, cipher, NULL, NULL, NULL))
+            || !TEST_true(EVP_CIPHER_CTX_copy(saved, ctx)))
+        goto err;
+    aead = (EVP_CIPHER_get_flags(cipher) & EVP_CIPH_FLAG_AEAD_CIPHER) != 0;
+
+    for (i = 0; i < 3; i++) {
+        iv[0] = (unsigned char)i;
+
+        if (!TEST_true(EVP_EncryptInit_ex2(ref, cipher, key, iv, NULL))
+                || !TEST_true(EVP_EncryptUpdate(ref, exp, &explen, msg,
+                                                sizeof(msg)))
+                || !TEST_true(EVP_EncryptFinal_ex(ref, exp + explen, &len)))
+            goto err;
+        explen += len;
+        if (aead
+                && !TEST_int_gt(EVP_CIPHER_CTX_ctrl(ref, EVP_CTRL_AEAD_GET_TAG,
+                                                    sizeof(exptag), exptag), 0))
+            goto err;
+
+        if (!TEST_true(EVP_CIPHER_CTX_copy(ctx, saved))
+                || !TEST_true(EVP_CipherInit_ex2(ctx, NULL, NULL, iv, -1, NULL))
+                || !TEST_true(EVP_EncryptUpdate(ctx, out, &outlen, msg,
+                                                sizeof(msg)))
+                || !TEST_true(EVP_EncryptFinal_ex(ctx, out + outlen, &len)))
+            goto err;
+        outlen += len;
+        if (!TEST_mem_eq(exp, explen, out, outlen))
+            goto err;
+        if (aead
+                && (!TEST_int_gt(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+                                                     sizeof(tag), tag), 0)
+                    || !TEST_mem_eq(exptag, sizeof(exptag), tag, sizeof(tag))))
+            goto err;
+    }
+    testresult = 1;
+ err:
+    EVP_CIPHER_CTX_free(ctx);
+    EVP_CIPHER_CTX_free(saved);
+    EVP_CIPHER_CTX_free(ref);
+    EVP_CIPHER_free(cipher);
+    return testresult;
+}
+
+static const char *digest_batch_algs[] = {
+    "SHA1", "SHA2-224", "SHA2-256", "SHA2-512", "SHA3-256"
+};
+
+/*
+ * Lengths straddle the padding boundaries and the batches are not multiples
+ * of the lane count, so that every lane gets a mix of full and padding
+ * blocks.
+ */
+static int test_digest_batch(int idx)
+{
+    static const size_t lens[] = {
+        0, 1, 55, 56, 63, 64, 65, 119, 120, 127, 128, 129, 300, 1000, 4099,
+        0, 17, 2567, 64, 5000, 3
+    };
+    static const size_t counts[] = { OSSL_NELEM(lens), 9, 5, 1, 0 };
+    const unsigned char *in[OSSL_NELEM(lens)];
+    unsigned char *out[OSSL_NELEM(lens)];
+    unsigned char buf[5000 + OSSL_NELEM(lens)];
+    unsigned char md[OSSL_NELEM(lens)][EVP_MAX_MD_SIZE];
+    unsigned char exp[OSSL_NELEM(lens)][EVP_MAX_MD_SIZE];
+    unsigned int mdlen = 0, explen = 0;
+    EVP_MD *digest = NULL;
+    size_t i, j;
+    int testresult = 0;
+
+    if (!TEST_ptr(digest = EVP_MD_fetch(testctx, digest_batch_algs[idx],
+                                        testpropq)))
+        goto err;
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (unsigned char)(i * 7 + 3);
+    for (i = 0; i < OSSL_NELEM(lens); i++) {
+        /* Vary the alignment of the inputs too */
+        in[i] = buf + i;
+        out[i] = md[i];
+        if (!TEST_true(EVP_Digest(in[i], lens[i], exp[i], &explen, digest,
+                                  NULL)))
+            goto err;
+    }
+
+    for (j = 0; j < OSSL_NELEM(counts); j++) {
+        memset(md, 0, sizeof(md));
+        if (!TEST_true(EVP_DigestBatch(digest, counts[j], in, lens, out,
+                                       &mdlen))
+                || !TEST_uint_eq(mdlen, explen))
+            goto err;
+        for (i = 0; i < counts[j]; i++)
+            if (!TEST_mem_eq(md[i], mdlen, exp[i], explen)) {
+                TEST_info("message %zu of %zu, length %zu", i, counts[j],
+                          lens[i]);
+                goto err;
+            }
+    }
+    testresult = 1;
+ err:
+    EVP_MD_free(digest);
+    return testresult;
+}
+
 int setup_tests(void)
 {
     OPTION_CHOICE o;
@@ -5832,6 +6041,9 @@ int setup_tests(void)
 #endif
 
     ADD_TEST(test_invalid_ctx_for_digest);
+    ADD_ALL_TESTS(test_mac_ctx_copy, OSSL_NELEM(mac_ctx_copy_algs));
+    ADD_ALL_TESTS(test_cipher_ctx_copy, OSSL_NELEM(cipher_ctx_copy_ciphers));
+    ADD_ALL_TESTS(test_digest_batch, OSSL_NELEM(digest_batch_algs));
 
     return 1;
 }
@@ -473,6 +473,72 @@ static int test_kdf_hkdf_empty_salt(void)
     return ret;
 }
 
+static int do_hkdf_expand(EVP_KDF_CTX *kctx, char *digest, char *key,
+                          char *info, unsigned char *out, size_t outlen)
+{
+    OSSL_PARAM params[5], *p = params;
+
+    if (digest != NULL)
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST,
+                                                digest, 0);
+    *p++ = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_MODE,
+                                            "EXPAND_ONLY", 0);
+    if (key != NULL)
+        *p++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY,
+                                                 key, strlen(key));
+    *p++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO,
+                                             info, strlen(info));
+    *p = OSSL_PARAM_construct_end();
+    return EVP_KDF_derive(kctx, out, outlen, params) > 0;
+}
+
+/*
+ * Repeated expand operations on one context reuse the keyed HMAC state; make
+ * sure that changing the info, key or digest still gives fresh results.
+ */
+static int test_kdf_hkdf_expand_reuse(void)
+{
+    static const struct {
+        char *digest, *key, *info;
+    } steps[] = {
+        { "sha256", "prk-one", "info-a" },
+        { NULL, NULL, "info-b" },
+        { NULL, "prk-two", "info-b" },
+        { "sha384", NULL, "info-b" },
+        { NULL, NULL, "info-a" },
+    };
+    EVP_KDF_CTX *kctx = NULL, *fresh = NULL;
+    char *digest = NULL, *key = NULL;
+    unsigned char out[80], exp[80];
+    size_t i;
+    int ret = 0;
+
+    if (!TEST_ptr(kctx = get_kdfbyname(OSSL_KDF_NAME_HKDF)))
+        goto err;
+
+    for (i = 0; i < OSSL_NELEM(steps); i++) {
+        if (steps[i].digest != NULL)
+            digest = steps[i].digest;
+        if (steps[i].key != NULL)
+            key = steps[i].key;
+
+        EVP_KDF_CTX_free(fresh);
+        if (!TEST_ptr(fresh = get_kdfbyname(OSSL_KDF_NAME_HKDF))
+                || !TEST_true(do_hkdf_expand(fresh, digest, key,
+                                             steps[i].info, exp, sizeof(exp)))
+                || !TEST_true(do_hkdf_expand(kctx, steps[i].digest,
+                                             steps[i].key, steps[i].info,
+                                             out, sizeof(out)))
+                || !TEST_mem_eq(out, sizeof(out), exp, sizeof(exp)))
+            goto err;
+    }
+    ret = 1;
+ err:
+    EVP_KDF_CTX_free(kctx);
+    EVP_KDF_CTX_free(fresh);
+    return ret;
+}
+
 static OSSL_PARAM *construct_pbkdf1_params(char *pass, char *digest, char *salt,
     unsigned int *iter)
 {
@@ -2059,6 +2125,7 @@ int setup_tests(void)
     ADD_TEST(test_kdf_hkdf_empty_key);
     ADD_TEST(test_kdf_hkdf_1byte_key);
     ADD_TEST(test_kdf_hkdf_empty_salt);
+    ADD_TEST(test_kdf_hkdf_expand_reuse);
     ADD_TEST(test_kdf_hkdf_gettables);
     ADD_TEST(test_kdf_hkdf_gettables_expandonly);
     ADD_TEST(test_kdf_hkdf_gettables_no_digest);
@@ -603,6 +603,81 @@ err:
     return res;
 }
 
+static int count_up_ref(void *p)
+{
+    ++*(int *)p;
+    return 1;
+}
+
+static void count_down_ref(void *p)
+{
+    --*(int *)p;
+}
+
+static int cache_get_count(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
+                           int nid, const char *prop, void *expect)
+{
+    void *result = NULL;
+    int ret = ossl_method_store_cache_get(store, prov, nid, prop, &result);
+
+    if (ret)
+        count_down_ref(result);
+    return expect == NULL ? TEST_false(ret)
+                          : TEST_true(ret) && TEST_ptr_eq(result, expect);
+}
+
+/*
+ * Check that the per thread cache in front of the query cache doesn't return
+ * entries that were replaced or flushed, and drops its references.
+ */
+static int test_query_cache_thread(void)
+{
+    OSSL_METHOD_STORE *store;
+    OSSL_PROVIDER prov = { 1 };
+    int refs[3] = { 0, 0, 0 };
+    int res = 0;
+
+    if (!TEST_ptr(store = ossl_method_store_new(NULL))
+        || !add_property_names("n", NULL)
+        || !TEST_true(ossl_method_store_add(store, &prov, 1, "n=1", "abc",
+                                            &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_cache_set(store, &prov, 1, "", refs,
+                                                  &count_up_ref,
+                                                  &count_down_ref))
+        || !cache_get_count(store, &prov, 1, "", refs)
+        || !cache_get_count(store, &prov, 1, "", refs)
+        || !cache_get_count(store, &prov, 1, "n=1", NULL)
+        || !cache_get_count(store, NULL, 1, "", refs)
+        /* Replacing the entry invalidates the thread's copy */
+        || !TEST_true(ossl_method_store_cache_set(store, &prov, 1, "",
+                                                  refs + 1, &count_up_ref,
+                                                  &count_down_ref))
+        || !cache_get_count(store, &prov, 1, "", refs + 1)
+        || !cache_get_count(store, &prov, 1, "", refs + 1)
+        /* So does removing it */
+        || !TEST_true(ossl_method_store_cache_set(store, &prov, 1, "", NULL,
+                                                  &count_up_ref,
+                                                  &count_down_ref))
+        || !cache_get_count(store, &prov, 1, "", NULL)
+        || !TEST_true(ossl_method_store_cache_set(store, &prov, 1, "",
+                                                  refs + 2, &count_up_ref,
+                                                  &count_down_ref))
+        || !cache_get_count(store, &prov, 1, "", refs + 2)
+        || !TEST_int_gt(refs[2], 1)
+        /* Flushing drops the references held by the thread */
+        || !TEST_true(ossl_method_store_cache_flush_all(store))
+        || !TEST_int_eq(refs[2], 0)
+        || !cache_get_count(store, &prov, 1, "", NULL))
+        goto err;
+    res = 1;
+
+err:
+    ossl_method_store_free(store);
+    /* Nothing may be left referenced once the store is freed */
+    return res && TEST_int_eq(refs[0], 0) && TEST_int_eq(refs[1], 0)
+           && TEST_int_eq(refs[2], 0);
+}
+
 static int test_fips_mode(void)
 {
     int ret = 0;
@@ -699,6 +774,7 @@ int setup_tests(void)
     ADD_TEST(test_register_deregister);
     ADD_TEST(test_property);
     ADD_TEST(test_query_cache_stochastic);
+    ADD_TEST(test_query_cache_thread);
     ADD_TEST(test_fips_mode);
     ADD_ALL_TESTS(test_property_list_to_string, OSSL_NELEM(to_string_tests));
     return 1;
@@ -13,6 +13,7 @@
 #include "testutil.h"
 #include <openssl/ssl.h>
 #include "internal/quic_cc.h"
+#include "internal/quic_pacer.h"
 #include "internal/priority_queue.h"
 
 /*
@@ -33,6 +34,18 @@ static void step_time(uint32_t ms)
     fake_time = ossl_time_add(fake_time, ossl_ms2time(ms));
 }
 
+static const OSSL_CC_METHOD *cc_methods[] = {
+    &ossl_cc_newreno_method,
+    &ossl_cc_cubic_method,
+    &ossl_cc_bbr_method,
+};
+
+static const char *cc_method_names[] = {
+    "NewReno",
+    "CUBIC",
+    "BBR",
+};
+
 /*
  * Network Simulation
  * ==================
@@ -102,6 +115,13 @@ struct net_sim {
     PRIORITY_QUEUE_OF(NET_PKT) *pkts;
 
     uint64_t total_acked, total_lost; /* bytes */
+
+    /*
+     * If set, a smoothed RTT estimate is passed to the congestion controller
+     * with each acknowledgement, as the ACKM does, which enables pacing.
+     */
+    int report_rtt;
+    OSSL_TIME smoothed_rtt;
 };
 
 static int net_sim_init(struct net_sim *s,
@@ -119,6 +139,9 @@ static int net_sim_init(struct net_sim *s,
     s->total_acked      = 0;
     s->total_lost       = 0;
 
+    s->report_rtt       = 0;
+    s->smoothed_rtt     = ossl_time_zero();
+
     if (!TEST_ptr(s->pkts = ossl_pqueue_NET_PKT_new(net_pkt_cmp)))
         return 0;
 
@@ -249,6 +272,21 @@ static int net_sim_process_one(struct net_sim *s, int skip_forward)
         ack_info.tx_time = pkt->tx_time;
         ack_info.tx_size = pkt->size;
 
+        if (s->report_rtt) {
+            OSSL_TIME rtt = ossl_time_subtract(fake_time, pkt->tx_time);
+
+            /* RFC 9002 s. 5.3 */
+            if (ossl_time_is_zero(s->smoothed_rtt)) {
+                s->smoothed_rtt = rtt;
+            } else {
+                s->smoothed_rtt = ossl_time_multiply(s->smoothed_rtt, 7);
+                s->smoothed_rtt = ossl_time_divide(ossl_time_add(s->smoothed_rtt,
+                                                                 rtt), 8);
+            }
+
+            ack_info.smoothed_rtt = s->smoothed_rtt;
+        }
+
         if (!TEST_true(s->ccm->on_data_acked(s->cc, &ack_info)))
             return 0;
 
@@ -325,12 +363,12 @@ static int dump_state(const OSSL_CC_METHOD *ccm, OSSL_CC_DATA *cc,
  * capacity. The average estimated channel capacity should not be too far from
  * the actual channel capacity.
  */
-static int test_simulate(void)
+static int test_simulate(int idx)
 {
     int testresult = 0;
     int rc;
     int have_sim = 0;
-    const OSSL_CC_METHOD *ccm = &ossl_cc_newreno_method;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
     OSSL_CC_DATA *cc = NULL;
     size_t mdpl = 1472;
     uint64_t total_sent = 0, total_to_send, allowance;
@@ -480,11 +518,11 @@ err:
  *
  * Basic test of the congestion control APIs.
  */
-static int test_sanity(void)
+static int test_sanity(int idx)
 {
     int testresult = 0;
     OSSL_CC_DATA *cc = NULL;
-    const OSSL_CC_METHOD *ccm = &ossl_cc_newreno_method;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
     OSSL_CC_LOSS_INFO loss_info = {0};
     OSSL_CC_ACK_INFO ack_info = {0};
     uint64_t allowance, allowance2;
@@ -608,6 +646,212 @@ err:
     return testresult;
 }
 
+/*
+ * Pacing Test
+ * ===========
+ *
+ * Once an RTT estimate is available, the congestion window should be released
+ * at roughly cwnd/RTT rather than in a single burst, and the wakeup deadline
+ * should tell the caller when the next datagram may be sent.
+ */
+static int test_pacing(int idx)
+{
+    int testresult = 0;
+    OSSL_CC_DATA *cc = NULL;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
+    OSSL_CC_ACK_INFO ack_info = {0};
+    OSSL_PARAM params[2], *p = params;
+    size_t mdpl = 1200;
+    uint64_t cwnd = UINT64_MAX, burst = 0, sent = 0;
+    OSSL_TIME deadline, start;
+    int i;
+
+    fake_time = TIME_BASE;
+
+    if (!TEST_ptr(cc = ccm->new(fake_now, NULL)))
+        goto err;
+
+    *p++ = OSSL_PARAM_construct_size_t(OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
+                                       &mdpl);
+    *p++ = OSSL_PARAM_construct_end();
+    if (!TEST_true(ccm->set_input_params(cc, params)))
+        goto err;
+
+    p = params;
+    *p++ = OSSL_PARAM_construct_uint64(OSSL_CC_OPTION_CUR_CWND_SIZE, &cwnd);
+    *p++ = OSSL_PARAM_construct_end();
+    if (!TEST_true(ccm->bind_diagnostics(cc, params)))
+        goto err;
+
+    /* Without an RTT estimate the whole window may be sent at once. */
+    while (ccm->get_tx_allowance(cc) >= mdpl) {
+        if (!TEST_true(ccm->on_data_sent(cc, mdpl)))
+            goto err;
+        burst += mdpl;
+    }
+    if (!TEST_uint64_t_ge(burst + mdpl, cwnd)
+        || !TEST_true(ossl_time_is_infinite(ccm->get_wakeup_deadline(cc))))
+        goto err;
+
+    /* Acknowledge everything with a 100ms RTT. */
+    step_time(100);
+    ack_info.tx_time = TIME_BASE;
+    ack_info.tx_size = mdpl;
+    ack_info.smoothed_rtt = ossl_ms2time(100);
+    for (; burst > 0; burst -= mdpl)
+        if (!TEST_true(ccm->on_data_acked(cc, &ack_info)))
+            goto err;
+
+    /* Now the window should only be released a burst at a time. */
+    while (ccm->get_tx_allowance(cc) > 0) {
+        if (!TEST_true(ccm->on_data_sent(cc, mdpl)))
+            goto err;
+        burst += mdpl;
+    }
+    if (!TEST_uint64_t_lt(burst, cwnd))
+        goto err;
+
+    deadline = ccm->get_wakeup_deadline(cc);
+    if (!TEST_false(ossl_time_is_infinite(deadline))
+        || !TEST_uint64_t_gt(ossl_time2ticks(deadline),
+                             ossl_time2ticks(fake_time)))
+        goto err;
+
+    /*
+     * Follow the deadlines (staying within the window) and check the average
+     * rate is ~1.25 * cwnd/RTT.
+     */
+    start = fake_time;
+    for (i = 0; i < 10; ++i) {
+        deadline = ccm->get_wakeup_deadline(cc);
+        if (ossl_time_compare(deadline, fake_time) > 0)
+            fake_time = deadline;
+        if (!TEST_uint64_t_gt(ccm->get_tx_allowance(cc), 0)
+            || !TEST_true(ccm->on_data_sent(cc, mdpl)))
+            goto err;
+        sent += mdpl;
+    }
+
+    {
+        uint64_t elapsed_ms = ossl_time2ms(ossl_time_subtract(fake_time,
+                                                              start));
+        uint64_t expect_ms = sent * 100 * OSSL_QUIC_PACER_GAIN_DEN
+                             / (cwnd * OSSL_QUIC_PACER_GAIN_NUM);
+
+        TEST_info("paced %llu bytes in %llu ms (expected ~%llu ms)",
+                  (unsigned long long)sent, (unsigned long long)elapsed_ms,
+                  (unsigned long long)expect_ms);
+        if (!TEST_uint64_t_ge(elapsed_ms + 2, expect_ms)
+            || !TEST_uint64_t_le(elapsed_ms, expect_ms + 2))
+            goto err;
+    }
+
+    testresult = 1;
+err:
+    if (cc != NULL)
+        ccm->free(cc);
+
+    return testresult;
+}
+
+/*
+ * High-BDP Simulation Test
+ * ========================
+ *
+ * Simulates a long fat network (20 MB/s with a 200ms RTT) for a fixed period,
+ * sending whenever the congestion controller permits it and otherwise waiting
+ * for the next network event or pacer deadline. NewReno's window grows by only
+ * one datagram per RTT after a loss, so it leaves much of such a link unused;
+ * CUBIC and BBR should both do noticeably better. The simulated link has no
+ * buffering, so pacing bursts above the link rate are lost and none of the
+ * controllers can use the whole link.
+ */
+#define HIGH_BDP_CAPACITY       (2000 * 1000)   /* bytes in one-way pipe */
+#define HIGH_BDP_LATENCY        100             /* ms one-way */
+#define HIGH_BDP_DURATION       30              /* s */
+
+static int run_high_bdp(const OSSL_CC_METHOD *ccm, uint64_t *goodput)
+{
+    int testresult = 0, have_sim = 0;
+    OSSL_CC_DATA *cc = NULL;
+    struct net_sim sim;
+    OSSL_PARAM params[2], *p = params;
+    size_t mdpl = 1472;
+    OSSL_TIME end, next, deadline;
+    NET_PKT *pkt;
+
+    fake_time = TIME_BASE;
+    end = ossl_time_add(fake_time, ossl_seconds2time(HIGH_BDP_DURATION));
+
+    if (!TEST_ptr(cc = ccm->new(fake_now, NULL)))
+        goto err;
+
+    if (!TEST_true(net_sim_init(&sim, ccm, cc, HIGH_BDP_CAPACITY,
+                                HIGH_BDP_LATENCY)))
+        goto err;
+
+    have_sim = 1;
+    sim.report_rtt = 1;
+
+    *p++ = OSSL_PARAM_construct_size_t(OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
+                                       &mdpl);
+    *p++ = OSSL_PARAM_construct_end();
+
+    if (!TEST_true(ccm->set_input_params(cc, params)))
+        goto err;
+
+    while (ossl_time_compare(fake_time, end) < 0) {
+        while (ccm->get_tx_allowance(cc) >= mdpl)
+            if (!TEST_true(net_sim_send(&sim, mdpl)))
+                goto err;
+
+        /* Advance to the next network event or pacer deadline. */
+        pkt = ossl_pqueue_NET_PKT_peek(sim.pkts);
+        next = pkt != NULL ? pkt->next_time : ossl_time_infinite();
+        deadline = ccm->get_wakeup_deadline(cc);
+        if (ossl_time_compare(deadline, fake_time) > 0)
+            next = ossl_time_min(next, deadline);
+
+        if (!TEST_false(ossl_time_is_infinite(next)))
+            goto err;
+
+        fake_time = ossl_time_max(fake_time, next);
+        if (!TEST_int_gt(net_sim_process(&sim, 0), 0))
+            goto err;
+    }
+
+    *goodput = sim.total_acked / HIGH_BDP_DURATION;
+    testresult = 1;
+err:
+    if (have_sim)
+        net_sim_cleanup(&sim);
+
+    if (cc != NULL)
+        ccm->free(cc);
+
+    return testresult;
+}
+
+static int test_high_bdp(void)
+{
+    uint64_t goodput[OSSL_NELEM(cc_methods)];
+    uint64_t link_rate = HIGH_BDP_CAPACITY * 1000 / HIGH_BDP_LATENCY;
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(cc_methods); ++i) {
+        if (!TEST_true(run_high_bdp(cc_methods[i], &goodput[i])))
+            return 0;
+
+        TEST_info("%-8s %6llu kB/s (%3llu%% of link)", cc_method_names[i],
+                  (unsigned long long)(goodput[i] / 1000),
+                  (unsigned long long)(goodput[i] * 100 / link_rate));
+    }
+
+    /* CUBIC and BBR should make at least 10% better use of the link. */
+    return TEST_uint64_t_ge(goodput[1] * 10, goodput[0] * 11)
+        && TEST_uint64_t_ge(goodput[2] * 10, goodput[0] * 11);
+}
+
 int setup_tests(void)
 {
 
@@ -623,7 +867,9 @@ int setup_tests(void)
         "\"State\"\n");
 #endif
 
-    ADD_TEST(test_simulate);
-    ADD_TEST(test_sanity);
+    ADD_ALL_TESTS(test_simulate, OSSL_NELEM(cc_methods));
+    ADD_ALL_TESTS(test_sanity, OSSL_NELEM(cc_methods));
+    ADD_ALL_TESTS(test_pacing, OSSL_NELEM(cc_methods));
+    ADD_TEST(test_high_bdp);
     return 1;
 }
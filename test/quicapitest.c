@@ -813,6 +813,74 @@ err:
     return testresult;
 }
 
+/*
+ * Test 0: QUIC leaves UDP segmentation offload off on its network BIO
+ * Test 1: Offload enabled on the BIO by the application is kept
+ */
+static int test_quic_seg_offload(int idx)
+{
+    static const unsigned char alpn[] = { 8, 'o', 's', 's', 'l', 't', 'e', 's', 't' };
+    int testresult = 0;
+    SSL_CTX *ctx = NULL;
+    SSL *ssl = NULL;
+    BIO *bio = NULL;
+    BIO_ADDR *saddr = NULL;
+    union BIO_sock_info_u info;
+    struct in_addr ina;
+    int sfd = -1, cfd = -1;
+    uint32_t flags = 0;
+
+    ina.s_addr = htonl(INADDR_LOOPBACK);
+    if (!TEST_ptr(ctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method()))
+            || !TEST_ptr(ssl = SSL_new(ctx))
+            || !TEST_ptr(saddr = BIO_ADDR_new())
+            || !TEST_true(BIO_ADDR_rawmake(saddr, AF_INET, &ina, sizeof(ina), 0))
+            || !TEST_int_ge(sfd = BIO_socket(AF_INET, SOCK_DGRAM,
+                                             IPPROTO_UDP, 0), 0)
+            || !TEST_true(BIO_bind(sfd, saddr, 0)))
+        goto err;
+    info.addr = saddr;
+    if (!TEST_true(BIO_sock_info(sfd, BIO_SOCK_INFO_ADDRESS, &info))
+            || !TEST_int_ge(cfd = BIO_socket(AF_INET, SOCK_DGRAM,
+                                             IPPROTO_UDP, 0), 0))
+        goto err;
+    if (!TEST_ptr(bio = BIO_new_dgram(cfd, BIO_CLOSE))) {
+        BIO_closesocket(cfd);
+        goto err;
+    }
+    SSL_set_bio(ssl, bio, bio);
+
+    if (idx == 1) {
+        flags = BIO_dgram_get_seg_offload_cap(bio)
+                & (BIO_DGRAM_SEG_OFFLOAD_TX | BIO_DGRAM_SEG_OFFLOAD_RX);
+        if (flags == 0 || !BIO_dgram_set_seg_offload(bio, flags)) {
+            testresult = TEST_skip("UDP segmentation offload not supported");
+            goto err;
+        }
+    }
+
+    /* SSL_set_alpn_protos returns 0 for success! */
+    if (!TEST_false(SSL_set_alpn_protos(ssl, alpn, sizeof(alpn)))
+            || !TEST_true(SSL_set_blocking_mode(ssl, 0))
+            || !TEST_true(SSL_set1_initial_peer_addr(ssl, saddr)))
+        goto err;
+
+    /* There is no server, but this creates the channel and sends an Initial */
+    if (!TEST_int_le(SSL_connect(ssl), 0)
+            || !TEST_int_eq(SSL_get_error(ssl, 0), SSL_ERROR_WANT_READ)
+            || !TEST_uint_eq(BIO_dgram_get_seg_offload(bio), flags))
+        goto err;
+
+    testresult = 1;
+err:
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+    BIO_ADDR_free(saddr);
+    if (sfd >= 0)
+        BIO_closesocket(sfd);
+    return testresult;
+}
+
 #define MAXLOOPS    1000
 
 static int test_bio_ssl(void)
@@ -1665,6 +1733,187 @@ static int test_bw_limit(void)
     return testresult;
 }
 
+/*
+ * Test selection of the congestion control algorithm, and that a transfer
+ * completes with each algorithm.
+ */
+#define TEST_CC_TRANSFER_DATA_SIZE (256*1024)   /* 256 kBytes */
+static int test_quic_cc_algorithm(int idx)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    int testresult = 0;
+    unsigned char *msg = NULL, *recvbuf = NULL;
+    size_t sendlen = TEST_CC_TRANSFER_DATA_SIZE;
+    size_t recvlen = TEST_CC_TRANSFER_DATA_SIZE;
+    size_t written, readbytes;
+    uint64_t alg = UINT64_MAX;
+    int i;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_long_eq(SSL_CTX_get_quic_cc_algorithm(cctx),
+                             SSL_VALUE_QUIC_CC_ALGORITHM_NEWRENO)
+            || !TEST_false(SSL_CTX_set_quic_cc_algorithm(cctx,
+                               SSL_VALUE_QUIC_CC_ALGORITHM_BBR + 1))
+            || !TEST_true(SSL_CTX_set_quic_cc_algorithm(cctx, idx))
+            || !TEST_long_eq(SSL_CTX_get_quic_cc_algorithm(cctx), idx))
+        goto err;
+
+    if (!TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                             privkey, QTEST_FLAG_FAKE_TIME,
+                                             &qtserv, &clientquic, NULL,
+                                             NULL)))
+        goto err;
+
+    /* The connection inherits the algorithm from the SSL_CTX. */
+    if (!TEST_true(SSL_get_quic_cc_algorithm(clientquic, &alg))
+            || !TEST_uint64_t_eq(alg, (uint64_t)idx))
+        goto err;
+
+    /* It can be changed (and changed back) before the connection starts. */
+    if (!TEST_false(SSL_set_quic_cc_algorithm(clientquic,
+                                              SSL_VALUE_QUIC_CC_ALGORITHM_BBR + 1))
+            || !TEST_true(SSL_set_quic_cc_algorithm(clientquic, (idx + 1) % 3))
+            || !TEST_true(SSL_get_quic_cc_algorithm(clientquic, &alg))
+            || !TEST_uint64_t_eq(alg, (uint64_t)(idx + 1) % 3)
+            || !TEST_true(SSL_set_quic_cc_algorithm(clientquic, idx)))
+        goto err;
+
+    if (!TEST_ptr(msg = OPENSSL_zalloc(TEST_SINGLE_WRITE_SIZE))
+        || !TEST_ptr(recvbuf = OPENSSL_zalloc(TEST_SINGLE_WRITE_SIZE)))
+        goto err;
+
+    if (!TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    /* Once the connection has started the algorithm is fixed. */
+    if (!TEST_false(SSL_set_quic_cc_algorithm(clientquic, (idx + 1) % 3))
+            || !TEST_true(SSL_get_quic_cc_algorithm(clientquic, &alg))
+            || !TEST_uint64_t_eq(alg, (uint64_t)idx))
+        goto err;
+
+    for (i = 0; recvlen > 0; i++) {
+        if (!TEST_int_lt(i, 100000))
+            goto err;
+
+        qtest_add_time(1);
+
+        if (sendlen > 0) {
+            if (SSL_write_ex(clientquic, msg,
+                             sendlen > TEST_SINGLE_WRITE_SIZE ? TEST_SINGLE_WRITE_SIZE
+                                                              : sendlen,
+                             &written))
+                sendlen -= written;
+            else if (!TEST_int_eq(SSL_get_error(clientquic, 0),
+                                  SSL_ERROR_WANT_WRITE))
+                goto err;
+        } else {
+            SSL_handle_events(clientquic);
+        }
+
+        if (ossl_quic_tserver_read(qtserv, 0, recvbuf,
+                                   recvlen > TEST_SINGLE_WRITE_SIZE ? TEST_SINGLE_WRITE_SIZE
+                                                                    : recvlen,
+                                   &readbytes))
+            recvlen -= readbytes;
+
+        ossl_quic_tserver_tick(qtserv);
+    }
+
+    testresult = 1;
+ err:
+    OPENSSL_free(msg);
+    OPENSSL_free(recvbuf);
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test SSL_writev() on a QUIC stream. The write is large enough that it does
+ * not fit in the stream buffer in one go, so it must be retried.
+ */
+#define TEST_WRITEV_SEG_SIZE    40000
+
+static int test_quic_writev(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    int testresult = 0, i;
+    unsigned char *msg = NULL, *recvbuf = NULL;
+    SSL_IOVEC iov[4];
+    size_t j, total, written = 0, recvd = 0, readbytes;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_ptr(msg = OPENSSL_malloc(3 * TEST_WRITEV_SEG_SIZE))
+            || !TEST_ptr(recvbuf = OPENSSL_malloc(3 * TEST_WRITEV_SEG_SIZE)))
+        goto err;
+
+    for (j = 0; j < 3 * TEST_WRITEV_SEG_SIZE; j++)
+        msg[j] = (unsigned char)(j * 7);
+
+    /* Out of order and including an empty buffer */
+    iov[0].data = msg + TEST_WRITEV_SEG_SIZE;
+    iov[0].len  = TEST_WRITEV_SEG_SIZE;
+    iov[1].data = NULL;
+    iov[1].len  = 0;
+    iov[2].data = msg;
+    iov[2].len  = TEST_WRITEV_SEG_SIZE;
+    iov[3].data = msg + 2 * TEST_WRITEV_SEG_SIZE;
+    iov[3].len  = TEST_WRITEV_SEG_SIZE;
+    total = 3 * TEST_WRITEV_SEG_SIZE;
+
+    if (!TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                             privkey, 0, &qtserv,
+                                             &clientquic, NULL, NULL))
+            || !TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    for (i = 0; recvd < total; i++) {
+        if (!TEST_int_lt(i, 100000))
+            goto err;
+
+        if (written == 0) {
+            if (!SSL_writev(clientquic, iov, OSSL_NELEM(iov), 0, &written)
+                    && !TEST_int_eq(SSL_get_error(clientquic, 0),
+                                    SSL_ERROR_WANT_WRITE))
+                goto err;
+        } else {
+            SSL_handle_events(clientquic);
+        }
+
+        ossl_quic_tserver_tick(qtserv);
+        if (ossl_quic_tserver_read(qtserv, 0, recvbuf + recvd, total - recvd,
+                                   &readbytes))
+            recvd += readbytes;
+    }
+
+    if (!TEST_size_t_eq(written, total)
+            || !TEST_mem_eq(recvbuf, TEST_WRITEV_SEG_SIZE,
+                            msg + TEST_WRITEV_SEG_SIZE, TEST_WRITEV_SEG_SIZE)
+            || !TEST_mem_eq(recvbuf + TEST_WRITEV_SEG_SIZE,
+                            TEST_WRITEV_SEG_SIZE, msg, TEST_WRITEV_SEG_SIZE)
+            || !TEST_mem_eq(recvbuf + 2 * TEST_WRITEV_SEG_SIZE,
+                            TEST_WRITEV_SEG_SIZE,
+                            msg + 2 * TEST_WRITEV_SEG_SIZE,
+                            TEST_WRITEV_SEG_SIZE))
+        goto err;
+
+    testresult = 1;
+ err:
+    OPENSSL_free(msg);
+    OPENSSL_free(recvbuf);
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
 enum {
     TPARAM_OP_DUP,
     TPARAM_OP_DROP,
@@ -2175,6 +2424,300 @@ err:
     qtest_fault_free(qtf);
     return testresult;
 }
+
+static int listener_alpn_select_cb(SSL *ssl, const unsigned char **out,
+                                   unsigned char *outlen,
+                                   const unsigned char *in, unsigned int inlen,
+                                   void *arg)
+{
+    static const unsigned char alpn[] = {
+        8, 'o', 's', 's', 'l', 't', 'e', 's', 't'
+    };
+
+    if (SSL_select_next_proto((unsigned char **)out, outlen, alpn,
+                              sizeof(alpn), in, inlen) != OPENSSL_NPN_NEGOTIATED)
+        return SSL_TLSEXT_ERR_ALERT_FATAL;
+
+    return SSL_TLSEXT_ERR_OK;
+}
+
+#define LISTENER_NUM_CONNS  3
+
+/*
+ * Test that a single QUIC listener bound to one UDP socket can accept several
+ * concurrent connections, and that data sent on each of them arrives on the
+ * right connection.
+ */
+static int test_quic_listener(void)
+{
+    unsigned char alpn[] = { 8, 'o', 's', 's', 'l', 't', 'e', 's', 't' };
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *listener = NULL, *clients[LISTENER_NUM_CONNS] = {0};
+    SSL *conns[LISTENER_NUM_CONNS] = {0}, *conn;
+    BIO *bio;
+    BIO_ADDR *saddr = NULL;
+    union BIO_sock_info_u info;
+    struct in_addr ina;
+    int testresult = 0, sfd = -1, cfd, ret;
+    size_t i, nconnected = 0, naccepted = 0, nechoed = 0, ndone = 0;
+    size_t written, readbytes;
+    int connected[LISTENER_NUM_CONNS] = {0}, echoed[LISTENER_NUM_CONNS] = {0};
+    int done[LISTENER_NUM_CONNS] = {0};
+    char msg[LISTENER_NUM_CONNS][16], buf[64];
+    int abortctr;
+    SSL_POLL_ITEM items[2 * LISTENER_NUM_CONNS], item = {0};
+    static const struct timeval short_timeout = {0, 100000};
+    static const struct timeval timeout = {10, 0};
+    size_t result_count;
+
+    if (!TEST_ptr(sctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_server_method()))
+            || !TEST_ptr(cctx = SSL_CTX_new_ex(libctx, NULL,
+                                               OSSL_QUIC_client_method()))
+            || !TEST_int_eq(SSL_CTX_use_certificate_file(sctx, cert,
+                                                         SSL_FILETYPE_PEM), 1)
+            || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(sctx, privkey,
+                                                        SSL_FILETYPE_PEM), 1))
+        goto err;
+
+    SSL_CTX_set_alpn_select_cb(sctx, listener_alpn_select_cb, NULL);
+
+    /* Server connections can only be created via a listener */
+    if (!TEST_ptr_null(SSL_new(sctx))
+            || !TEST_ptr_null(SSL_new_listener(cctx, 0)))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_ptr(listener = SSL_new_listener(sctx, 0))
+            || !TEST_true(SSL_is_listener(listener))
+            || !TEST_true(SSL_is_quic(listener))
+            || !TEST_ptr_eq(SSL_get0_listener(listener), listener))
+        goto err;
+
+    /* Bind the listener to an ephemeral port on the loopback interface */
+    ina.s_addr = htonl(INADDR_LOOPBACK);
+    if (!TEST_ptr(saddr = BIO_ADDR_new())
+            || !TEST_true(BIO_ADDR_rawmake(saddr, AF_INET, &ina, sizeof(ina), 0))
+            || !TEST_int_ge(sfd = BIO_socket(AF_INET, SOCK_DGRAM,
+                                             IPPROTO_UDP, 0), 0)
+            || !TEST_true(BIO_bind(sfd, saddr, 0)))
+        goto err;
+
+    info.addr = saddr;
+    if (!TEST_true(BIO_sock_info(sfd, BIO_SOCK_INFO_ADDRESS, &info))
+            || !TEST_ptr(bio = BIO_new_dgram(sfd, BIO_CLOSE)))
+        goto err;
+    sfd = -1;
+    SSL_set_bio(listener, bio, bio);
+
+    if (!TEST_true(SSL_set_blocking_mode(listener, 0))
+            || !TEST_true(SSL_listen(listener)))
+        goto err;
+
+    for (i = 0; i < LISTENER_NUM_CONNS; i++) {
+        if (!TEST_ptr(clients[i] = SSL_new(cctx))
+                || !TEST_int_ge(cfd = BIO_socket(AF_INET, SOCK_DGRAM,
+                                                 IPPROTO_UDP, 0), 0))
+            goto err;
+
+        if (!TEST_ptr(bio = BIO_new_dgram(cfd, BIO_CLOSE))) {
+            BIO_closesocket(cfd);
+            goto err;
+        }
+        SSL_set_bio(clients[i], bio, bio);
+
+        /* SSL_set_alpn_protos returns 0 for success! */
+        if (!TEST_false(SSL_set_alpn_protos(clients[i], alpn, sizeof(alpn)))
+                || !TEST_true(SSL_set_blocking_mode(clients[i], 0))
+                || !TEST_true(SSL_set1_initial_peer_addr(clients[i], saddr)))
+            goto err;
+
+        BIO_snprintf(msg[i], sizeof(msg[i]), "conn %zu", i);
+    }
+
+    /* Handshake all of the clients and accept their connections */
+    for (abortctr = 0; nconnected < LISTENER_NUM_CONNS
+                       || naccepted < LISTENER_NUM_CONNS; abortctr++) {
+        if (!TEST_int_lt(abortctr, MAXLOOPS))
+            goto err;
+
+        for (i = 0; i < LISTENER_NUM_CONNS; i++) {
+            if (connected[i])
+                continue;
+
+            ret = SSL_connect(clients[i]);
+            if (ret == 1) {
+                connected[i] = 1;
+                nconnected++;
+            } else if (!TEST_int_eq(SSL_get_error(clients[i], ret),
+                                    SSL_ERROR_WANT_READ)) {
+                goto err;
+            }
+        }
+
+        if (!TEST_true(SSL_handle_events(listener)))
+            goto err;
+
+        while ((conn = SSL_accept_connection(listener, 0)) != NULL) {
+            if (!TEST_size_t_lt(naccepted, LISTENER_NUM_CONNS)) {
+                SSL_free(conn);
+                goto err;
+            }
+            conns[naccepted++] = conn;
+        }
+    }
+
+    if (!TEST_size_t_eq(SSL_get_accept_connection_queue_len(listener), 0))
+        goto err;
+
+    /* A blocking poll for another incoming connection times out */
+    item.desc   = SSL_as_poll_descriptor(listener);
+    item.events = SSL_POLL_EVENT_IC;
+    if (!TEST_true(SSL_poll(&item, 1, sizeof(item), &short_timeout, 0,
+                            &result_count))
+            || !TEST_size_t_eq(result_count, 0)
+            || !TEST_uint64_t_eq(item.revents, 0))
+        goto err;
+
+    for (i = 0; i < LISTENER_NUM_CONNS; i++)
+        if (!TEST_false(SSL_is_listener(conns[i]))
+                || !TEST_ptr_eq(SSL_get0_listener(conns[i]), listener)
+                || !TEST_ptr_null(SSL_get0_listener(clients[i]))
+                || !TEST_true(SSL_write_ex(clients[i], msg[i], strlen(msg[i]),
+                                           &written)))
+            goto err;
+
+    /*
+     * Echo each message back on the connection it arrived on, blocking in
+     * SSL_poll() until one of the connections is readable. The server side
+     * connections have no default stream until the client's stream arrives.
+     */
+    for (i = 0; i < LISTENER_NUM_CONNS; i++) {
+        items[2 * i].desc       = SSL_as_poll_descriptor(conns[i]);
+        items[2 * i].events     = SSL_POLL_EVENT_R | SSL_POLL_EVENT_ISB
+                                  | SSL_POLL_EVENT_EC;
+        items[2 * i + 1].desc   = SSL_as_poll_descriptor(clients[i]);
+        items[2 * i + 1].events = SSL_POLL_EVENT_R | SSL_POLL_EVENT_EC;
+    }
+
+    for (abortctr = 0; nechoed < LISTENER_NUM_CONNS
+                       || ndone < LISTENER_NUM_CONNS; abortctr++) {
+        if (!TEST_int_lt(abortctr, MAXLOOPS))
+            goto err;
+
+        if (!TEST_true(SSL_poll(items, OSSL_NELEM(items), sizeof(items[0]),
+                                &timeout, 0, &result_count))
+                || !TEST_size_t_gt(result_count, 0))
+            goto err;
+
+        for (i = 0; i < LISTENER_NUM_CONNS; i++) {
+            if (!echoed[i]
+                    && SSL_read_ex(conns[i], buf, sizeof(buf), &readbytes)) {
+                if (!TEST_true(SSL_write_ex(conns[i], buf, readbytes,
+                                            &written)))
+                    goto err;
+                echoed[i] = 1;
+                nechoed++;
+            }
+
+            if (!done[i]
+                    && SSL_read_ex(clients[i], buf, sizeof(buf), &readbytes)) {
+                if (!TEST_mem_eq(buf, readbytes, msg[i], strlen(msg[i])))
+                    goto err;
+                done[i] = 1;
+                ndone++;
+            }
+        }
+    }
+
+    testresult = 1;
+err:
+    /* Accepted connections keep the listener alive until they are freed */
+    SSL_free(listener);
+    for (i = 0; i < LISTENER_NUM_CONNS; i++) {
+        SSL_free(conns[i]);
+        SSL_free(clients[i]);
+    }
+    if (sfd >= 0)
+        BIO_closesocket(sfd);
+    BIO_ADDR_free(saddr);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return testresult;
+}
+
+/*
+ * Test that SSL_poll() can wait on plain sockets, including when a timeout is
+ * given and nothing is ready.
+ */
+static int test_ssl_poll_sock(void)
+{
+    int testresult = 0, afd = -1, bfd = -1;
+    BIO_ADDR *addr = NULL;
+    union BIO_sock_info_u info;
+    struct in_addr ina;
+    SSL_POLL_ITEM item = {0};
+    static const struct timeval zero_timeout = {0, 0};
+    static const struct timeval short_timeout = {0, 50000};
+    static const struct timeval timeout = {10, 0};
+    size_t result_count;
+    OSSL_TIME start;
+
+    ina.s_addr = htonl(INADDR_LOOPBACK);
+    if (!TEST_ptr(addr = BIO_ADDR_new())
+            || !TEST_true(BIO_ADDR_rawmake(addr, AF_INET, &ina, sizeof(ina), 0))
+            || !TEST_int_ge(afd = BIO_socket(AF_INET, SOCK_DGRAM,
+                                             IPPROTO_UDP, 0), 0)
+            || !TEST_int_ge(bfd = BIO_socket(AF_INET, SOCK_DGRAM,
+                                             IPPROTO_UDP, 0), 0)
+            || !TEST_true(BIO_bind(afd, addr, 0)))
+        goto err;
+
+    info.addr = addr;
+    if (!TEST_true(BIO_sock_info(afd, BIO_SOCK_INFO_ADDRESS, &info))
+            || !TEST_true(BIO_connect(bfd, addr, 0)))
+        goto err;
+
+    item.desc.type      = BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD;
+    item.desc.value.fd  = afd;
+    item.events         = SSL_POLL_EVENT_RW;
+
+    /* A fresh UDP socket is writable but not readable */
+    if (!TEST_true(SSL_poll(&item, 1, sizeof(item), &zero_timeout, 0,
+                            &result_count))
+            || !TEST_size_t_eq(result_count, 1)
+            || !TEST_uint64_t_eq(item.revents, SSL_POLL_EVENT_W))
+        goto err;
+
+    /* Waiting for readability times out */
+    item.events = SSL_POLL_EVENT_R;
+    start = ossl_time_now();
+    if (!TEST_true(SSL_poll(&item, 1, sizeof(item), &short_timeout, 0,
+                            &result_count))
+            || !TEST_size_t_eq(result_count, 0)
+            || !TEST_uint64_t_eq(item.revents, 0)
+            || !TEST_uint64_t_ge(ossl_time2ms(ossl_time_subtract(ossl_time_now(),
+                                                                 start)),
+                                 40))
+        goto err;
+
+    /* Once a datagram is sent, the socket becomes readable */
+    if (!TEST_int_eq(writesocket(bfd, "x", 1), 1)
+            || !TEST_true(SSL_poll(&item, 1, sizeof(item), &timeout, 0,
+                                   &result_count))
+            || !TEST_size_t_eq(result_count, 1)
+            || !TEST_uint64_t_eq(item.revents, SSL_POLL_EVENT_R))
+        goto err;
+
+    testresult = 1;
+err:
+    if (afd >= 0)
+        BIO_closesocket(afd);
+    if (bfd >= 0)
+        BIO_closesocket(bfd);
+    BIO_ADDR_free(addr);
+    return testresult;
+}
+
 /***********************************************************************************/
 
 OPT_TEST_DECLARE_USAGE("provider config certsdir datadir\n")
@@ -2256,6 +2799,7 @@ int setup_tests(void)
     ADD_TEST(test_quic_forbidden_apis);
     ADD_TEST(test_quic_forbidden_options);
     ADD_ALL_TESTS(test_quic_set_fd, 3);
+    ADD_ALL_TESTS(test_quic_seg_offload, 2);
     ADD_TEST(test_bio_ssl);
     ADD_TEST(test_back_pressure);
     ADD_TEST(test_multiple_dgrams);
@@ -2265,8 +2809,12 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_alpn, 2);
     ADD_ALL_TESTS(test_noisy_dgram, 2);
     ADD_TEST(test_bw_limit);
+    ADD_ALL_TESTS(test_quic_cc_algorithm, 3);
+    ADD_TEST(test_quic_writev);
     ADD_TEST(test_get_shutdown);
     ADD_ALL_TESTS(test_tparam, OSSL_NELEM(tparam_tests));
+    ADD_TEST(test_quic_listener);
+    ADD_TEST(test_ssl_poll_sock);
 
     return 1;
  err:
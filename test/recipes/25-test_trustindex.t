@@ -0,0 +1,64 @@
+#! /usr/bin/env perl
+# Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+use strict;
+use warnings;
+
+use OpenSSL::Test qw/:DEFAULT srctop_file/;
+
+setup("test_trustindex");
+
+plan tests => 9;
+
+my $root = srctop_file("test", "certs", "root-cert.pem");
+my $ca = srctop_file("test", "certs", "ca-cert.pem");
+my $ee = srctop_file("test", "certs", "ee-cert.pem");
+my $idx = "trust.idx";
+
+# Returns the number of entries in a trust index, or -1 if it is malformed
+sub check_index {
+    my $file = shift;
+    my $data;
+
+    open(my $fh, '<:raw', $file) or return -1;
+    { local $/; $data = <$fh>; }
+    close($fh);
+
+    my ($magic, $version, $num) = unpack("a8 N N", $data);
+    return -1 unless defined $num && $magic eq "OSSLTIDX" && $version == 1;
+
+    my $prev = 0;
+    my $end = 16 + 12 * $num;
+    for (my $i = 0; $i < $num; $i++) {
+        my ($hash, $off, $len) = unpack("N N N", substr($data, 16 + 12 * $i, 12));
+        # Sorted by name hash, certificates stored back to back after the table
+        return -1 if $hash < $prev || $off != $end;
+        $prev = $hash;
+        $end += $len;
+    }
+    return $end == length($data) ? $num : -1;
+}
+
+ok(run(app(["openssl", "trustindex", "-out", $idx, $root, $ca])),
+   "create a trust index");
+is(check_index($idx), 2, "trust index holds both certificates");
+ok(!-e "$idx.tmp", "temporary file is removed");
+
+ok(run(app(["openssl", "trustindex", "-out", $idx, $root, $ca, $ee])),
+   "replace an existing trust index");
+is(check_index($idx), 3, "replaced trust index holds all certificates");
+
+ok(!run(app(["openssl", "trustindex", "-out", $idx,
+             srctop_file("test", "certs", "nonexistent.pem")])),
+   "fail on a missing input file");
+is(check_index($idx), 3, "failure leaves the existing trust index intact");
+
+ok(!run(app(["openssl", "trustindex", $root])),
+   "fail without an output file");
+ok(!run(app(["openssl", "trustindex", "-out", $idx])),
+   "fail without input files");
@@ -1495,6 +1495,104 @@ static int test_ktls(int test)
                              cipher->cipher);
 }
 
+/*
+ * Test that a TLS 1.3 KeyUpdate keeps both directions offloaded to the kernel
+ * on both peers.
+ */
+static int test_ktls_key_update(int test)
+{
+    struct ktls_test_cipher *cipher = &ktls_test_ciphers[test];
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    SSL_CONNECTION *clientsc, *serversc;
+    int testresult = 0, cfd = -1, sfd = -1;
+    static const char msg[] = "Hello after KeyUpdate";
+    char buf[sizeof(msg)];
+    size_t written, readbytes;
+
+    if (cipher->tls_version != TLS1_3_VERSION)
+        return TEST_skip("KeyUpdate is a TLS 1.3 feature");
+
+    if (is_fips && strstr(cipher->cipher, "CHACHA") != NULL)
+        return TEST_skip("CHACHA is not supported in FIPS");
+
+    if (!TEST_true(create_test_sockets(&cfd, &sfd, SOCK_STREAM, NULL)))
+        goto end;
+
+    if (!ktls_chk_platform(cfd)) {
+        testresult = TEST_skip("Kernel does not support KTLS");
+        goto end;
+    }
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       TLS1_3_VERSION, TLS1_3_VERSION,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(SSL_CTX_set_ciphersuites(cctx, cipher->cipher))
+            || !TEST_true(SSL_CTX_set_ciphersuites(sctx, cipher->cipher))
+            || !TEST_true(create_ssl_objects2(sctx, cctx, &serverssl,
+                                              &clientssl, sfd, cfd))
+            || !TEST_ptr(clientsc = SSL_CONNECTION_FROM_SSL_ONLY(clientssl))
+            || !TEST_ptr(serversc = SSL_CONNECTION_FROM_SSL_ONLY(serverssl))
+            || !TEST_true(SSL_set_options(clientssl, SSL_OP_ENABLE_KTLS))
+            || !TEST_true(SSL_set_options(serverssl, SSL_OP_ENABLE_KTLS))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    if (!BIO_get_ktls_send(clientsc->wbio)
+            || !BIO_get_ktls_recv(serversc->rbio)) {
+        testresult = TEST_skip("KTLS not supported for cipher %s",
+                               cipher->cipher);
+        goto end;
+    }
+
+    /*
+     * The client updates its keys and asks the server to do the same. The
+     * server only sees the KeyUpdate when it next reads.
+     */
+    if (!TEST_true(SSL_key_update(clientssl, SSL_KEY_UPDATE_REQUESTED)))
+        goto end;
+
+    if (!SSL_write_ex(clientssl, msg, sizeof(msg), &written)) {
+        if (ERR_GET_REASON(ERR_peek_last_error())
+                == SSL_R_RECORD_LAYER_FAILURE) {
+            testresult = TEST_skip("Kernel does not support KTLS rekeying");
+            goto end;
+        }
+        TEST_error("SSL_write_ex() failed after KeyUpdate");
+        goto end;
+    }
+
+    if (!TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg, sizeof(msg))
+            || !TEST_true(SSL_write_ex(serverssl, msg, sizeof(msg), &written))
+            || !TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg, sizeof(msg)))
+        goto end;
+
+    /* Nothing should have dropped back to the userspace record layer */
+    if (!TEST_true(BIO_get_ktls_send(clientsc->wbio))
+            || !TEST_true(BIO_get_ktls_recv(serversc->rbio))
+            || !TEST_ptr_eq(clientsc->rlayer.wrlmethod,
+                            &ossl_ktls_record_method)
+            || !TEST_ptr_eq(serversc->rlayer.rrlmethod,
+                            &ossl_ktls_record_method))
+        goto end;
+
+    testresult = 1;
+end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    if (cfd != -1)
+        close(cfd);
+    if (sfd != -1)
+        close(sfd);
+    return testresult;
+}
+
 static int test_ktls_sendfile(int test)
 {
     struct ktls_test_cipher *cipher;
@@ -2022,6 +2120,423 @@ static int test_tlsext_status_type(void)
 }
 #endif
 
+#ifndef OPENSSL_NO_OCSP
+static unsigned char *stapled_resp = NULL;
+static int stapled_resp_len = 0;
+static int staple_received = 0;
+
+static int ocsp_staple_client_cb(SSL *s, void *arg)
+{
+    unsigned char *resp;
+    long len = SSL_get_tlsext_status_ocsp_resp(s, &resp);
+
+    ocsp_client_called = 1;
+    staple_received = len > 0 && len == stapled_resp_len
+                      && memcmp(resp, stapled_resp, len) == 0;
+    return 1;
+}
+
+/* Create a good OCSP response for |x| signed by |signer| */
+static int make_ocsp_response(X509 *x, X509 *issuer, X509 *signer,
+                              EVP_PKEY *key, unsigned char **der)
+{
+    OCSP_BASICRESP *bs = OCSP_BASICRESP_new();
+    OCSP_RESPONSE *rsp = NULL;
+    OCSP_CERTID *id = NULL;
+    EVP_MD *sha1 = EVP_MD_fetch(libctx, "SHA1", NULL);
+    EVP_MD_CTX *mctx = EVP_MD_CTX_new();
+    ASN1_TIME *thisupd = X509_gmtime_adj(NULL, 0);
+    ASN1_TIME *nextupd = X509_gmtime_adj(NULL, 24 * 3600);
+    int len = -1;
+
+    if (TEST_ptr(bs)
+            && TEST_ptr(sha1)
+            && TEST_ptr(mctx)
+            && TEST_ptr(id = OCSP_cert_to_id(sha1, x, issuer))
+            && TEST_ptr(thisupd)
+            && TEST_ptr(nextupd)
+            && TEST_ptr(OCSP_basic_add1_status(bs, id, V_OCSP_CERTSTATUS_GOOD,
+                                               0, NULL, thisupd, nextupd))
+            && TEST_true(EVP_DigestSignInit_ex(mctx, NULL, "SHA256", libctx,
+                                               NULL, key, NULL))
+            && TEST_true(OCSP_basic_sign_ctx(bs, signer, mctx, NULL, 0))
+            && TEST_ptr(rsp = OCSP_response_create(OCSP_RESPONSE_STATUS_SUCCESSFUL,
+                                                   bs)))
+        len = i2d_OCSP_RESPONSE(rsp, der);
+
+    OCSP_RESPONSE_free(rsp);
+    ASN1_TIME_free(nextupd);
+    ASN1_TIME_free(thisupd);
+    OCSP_CERTID_free(id);
+    EVP_MD_CTX_free(mctx);
+    EVP_MD_free(sha1);
+    OCSP_BASICRESP_free(bs);
+    return len;
+}
+
+/*
+ * Test that the OCSP stapling manager only accepts verified responses and
+ * staples them.
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3, with a background refresh thread
+ */
+static int test_ocsp_stapling(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    char *rootfile = test_mk_file_path(certsdir, "rootcert.pem");
+    char *rootkeyfile = test_mk_file_path(certsdir, "rootkey.pem");
+    X509 *root = NULL, *leaf = NULL;
+    EVP_PKEY *rootkey = NULL, *leafkey = NULL;
+    unsigned char *bad = NULL;
+    int badlen, testresult = 0;
+    uint64_t flags = 0;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (tst == 0)
+        return TEST_skip("TLSv1.2 is disabled");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (tst == 1)
+        return TEST_skip("TLSv1.3 is disabled");
+#endif
+#ifndef OPENSSL_NO_THREAD_POOL
+    /* The certificate has no responder, so the thread has nothing to do */
+    if (tst == 1)
+        flags = SSL_OCSP_STAPLING_BACKGROUND;
+#endif
+
+    if (!TEST_ptr(root = load_cert_pem(rootfile, libctx))
+            || !TEST_ptr(rootkey = load_pkey_pem(rootkeyfile, libctx))
+            || !TEST_ptr(leaf = load_cert_pem(cert, libctx))
+            || !TEST_ptr(leafkey = load_pkey_pem(privkey, libctx))
+            || !TEST_int_gt(stapled_resp_len = make_ocsp_response(leaf, root,
+                                                                  root, rootkey,
+                                                                  &stapled_resp),
+                            0)
+            || !TEST_int_gt(badlen = make_ocsp_response(leaf, root, leaf,
+                                                        leafkey, &bad),
+                            0))
+        goto end;
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), TLS1_VERSION,
+                                       tst == 0 ? TLS1_2_VERSION : 0,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(SSL_CTX_add1_chain_cert(sctx, root))
+            || !TEST_true(SSL_CTX_set_tlsext_status_type(cctx,
+                                                         TLSEXT_STATUSTYPE_ocsp)))
+        goto end;
+    SSL_CTX_set_tlsext_status_cb(cctx, ocsp_staple_client_cb);
+
+    if (!TEST_false(SSL_CTX_add1_ocsp_stapling_response(sctx, leaf,
+                                                        stapled_resp,
+                                                        stapled_resp_len))
+            || !TEST_true(SSL_CTX_enable_ocsp_stapling(sctx, flags)))
+        goto end;
+
+    /* Nothing is stapled until there is a response */
+    ocsp_client_called = staple_received = 0;
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_true(ocsp_client_called)
+            || !TEST_false(staple_received))
+        goto end;
+    SSL_shutdown(clientssl);
+    SSL_shutdown(serverssl);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    serverssl = clientssl = NULL;
+
+    /* A response that is not signed by the issuer is rejected */
+    if (!TEST_false(SSL_CTX_add1_ocsp_stapling_response(sctx, leaf, bad,
+                                                        badlen))
+            || !TEST_true(SSL_CTX_add1_ocsp_stapling_response(sctx, leaf,
+                                                              stapled_resp,
+                                                              stapled_resp_len)))
+        goto end;
+
+    ocsp_client_called = staple_received = 0;
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_true(ocsp_client_called)
+            || !TEST_true(staple_received))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    OPENSSL_free(bad);
+    OPENSSL_free(stapled_resp);
+    stapled_resp = NULL;
+    EVP_PKEY_free(leafkey);
+    EVP_PKEY_free(rootkey);
+    X509_free(leaf);
+    X509_free(root);
+    OPENSSL_free(rootkeyfile);
+    OPENSSL_free(rootfile);
+    return testresult;
+}
+
+# if !defined(OPENSSL_NO_THREAD_POOL) && !defined(OPENSSL_NO_SOCK)
+/* Create a certificate for |key| naming |url| as its OCSP responder */
+static X509 *make_cert_with_responder(X509 *issuer, EVP_PKEY *issuerkey,
+                                      EVP_PKEY *key, const char *url)
+{
+    X509 *x = X509_new_ex(libctx, NULL);
+    X509_EXTENSION *ext = NULL;
+    X509V3_CTX v3ctx;
+    char *aia = NULL;
+    size_t len = strlen("OCSP;URI:") + strlen(url) + 1;
+    int ok = 0;
+
+    if (!TEST_ptr(x)
+            || !TEST_ptr(aia = OPENSSL_malloc(len))
+            || !TEST_true(X509_set_version(x, X509_VERSION_3))
+            || !TEST_true(ASN1_INTEGER_set(X509_get_serialNumber(x), 2))
+            || !TEST_true(X509_set_issuer_name(x,
+                                               X509_get_subject_name(issuer)))
+            || !TEST_true(X509_NAME_add_entry_by_txt(X509_get_subject_name(x),
+                                                     "CN", MBSTRING_ASC,
+                                                     (unsigned char *)"stapling",
+                                                     -1, -1, 0))
+            || !TEST_ptr(X509_gmtime_adj(X509_getm_notBefore(x), 0))
+            || !TEST_ptr(X509_gmtime_adj(X509_getm_notAfter(x), 24 * 3600))
+            || !TEST_true(X509_set_pubkey(x, key)))
+        goto end;
+    BIO_snprintf(aia, len, "OCSP;URI:%s", url);
+    X509V3_set_ctx(&v3ctx, issuer, x, NULL, NULL, 0);
+    if (!TEST_ptr(ext = X509V3_EXT_conf_nid(NULL, &v3ctx, NID_info_access,
+                                            aia))
+            || !TEST_true(X509_add_ext(x, ext, -1))
+            || !TEST_int_gt(X509_sign(x, issuerkey, EVP_sha256()), 0))
+        goto end;
+    ok = 1;
+ end:
+    X509_EXTENSION_free(ext);
+    OPENSSL_free(aia);
+    if (!ok) {
+        X509_free(x);
+        x = NULL;
+    }
+    return x;
+}
+
+/*
+ * Test that freeing an SSL_CTX does not wait for the background thread's
+ * request to a responder which never answers.
+ */
+static int test_ocsp_stapling_teardown(void)
+{
+    SSL_CTX *sctx = NULL;
+    char *rootfile = test_mk_file_path(certsdir, "rootcert.pem");
+    char *rootkeyfile = test_mk_file_path(certsdir, "rootkey.pem");
+    X509 *root = NULL, *leaf = NULL;
+    EVP_PKEY *rootkey = NULL, *leafkey = NULL;
+    BIO_ADDRINFO *res = NULL;
+    union BIO_sock_info_u info = {0};
+    char *port = NULL, url[64];
+    int fd = -1, testresult = 0;
+    time_t start;
+
+    /* A responder which accepts connections (in the backlog) but is silent */
+    if (!TEST_true(BIO_lookup_ex("127.0.0.1", "0", BIO_LOOKUP_SERVER, AF_INET,
+                                 SOCK_STREAM, 0, &res))
+            || !TEST_int_ge(fd = BIO_socket(AF_INET, SOCK_STREAM, 0, 0), 0)
+            || !TEST_true(BIO_listen(fd, BIO_ADDRINFO_address(res), 0))
+            || !TEST_ptr(info.addr = BIO_ADDR_new())
+            || !TEST_true(BIO_sock_info(fd, BIO_SOCK_INFO_ADDRESS, &info))
+            || !TEST_ptr(port = BIO_ADDR_service_string(info.addr, 1)))
+        goto end;
+    BIO_snprintf(url, sizeof(url), "http://127.0.0.1:%s/", port);
+
+    if (!TEST_ptr(root = load_cert_pem(rootfile, libctx))
+            || !TEST_ptr(rootkey = load_pkey_pem(rootkeyfile, libctx))
+            || !TEST_ptr(leafkey = load_pkey_pem(privkey, libctx))
+            || !TEST_ptr(leaf = make_cert_with_responder(root, rootkey,
+                                                         leafkey, url))
+            || !TEST_ptr(sctx = SSL_CTX_new_ex(libctx, NULL,
+                                               TLS_server_method()))
+            || !TEST_true(SSL_CTX_use_certificate(sctx, leaf))
+            || !TEST_true(SSL_CTX_use_PrivateKey(sctx, leafkey))
+            || !TEST_true(SSL_CTX_add1_chain_cert(sctx, root))
+            || !TEST_true(SSL_CTX_enable_ocsp_stapling(sctx,
+                                                       SSL_OCSP_STAPLING_BACKGROUND)))
+        goto end;
+
+    /* Give the thread time to send its request */
+    OSSL_sleep(500);
+    start = time(NULL);
+    SSL_CTX_free(sctx);
+    sctx = NULL;
+    /* A fetch times out after 30 seconds, teardown must not wait for that */
+    if (!TEST_time_t_lt(time(NULL) - start, 10))
+        goto end;
+
+    testresult = 1;
+ end:
+    SSL_CTX_free(sctx);
+    if (fd >= 0)
+        BIO_closesocket(fd);
+    OPENSSL_free(port);
+    BIO_ADDR_free(info.addr);
+    BIO_ADDRINFO_free(res);
+    EVP_PKEY_free(leafkey);
+    EVP_PKEY_free(rootkey);
+    X509_free(leaf);
+    X509_free(root);
+    OPENSSL_free(rootkeyfile);
+    OPENSSL_free(rootfile);
+    return testresult;
+}
+# endif
+#endif
+
+#define CERT_MSG_EXT_TYPE 0xff10
+
+static int cert_msg_ext_parsed = 0;
+
+static int cert_msg_ext_add_cb(SSL *s, unsigned int ext_type,
+                               unsigned int context,
+                               const unsigned char **out, size_t *outlen,
+                               X509 *x, size_t chainidx, int *al, void *arg)
+{
+    static const unsigned char data[] = { 0x01 };
+
+    *out = data;
+    *outlen = sizeof(data);
+    return 1;
+}
+
+static int cert_msg_ext_parse_cb(SSL *s, unsigned int ext_type,
+                                 unsigned int context,
+                                 const unsigned char *in, size_t inlen,
+                                 X509 *x, size_t chainidx, int *al, void *arg)
+{
+    if (context == SSL_EXT_TLS1_3_CERTIFICATE)
+        cert_msg_ext_parsed++;
+    return 1;
+}
+
+/*
+ * Test that servers reuse the encoded certificate_list of their SSL_CTX
+ * certificates.
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3
+ * Test 2: TLSv1.3 with a certificate extension, which is not cached
+ * Test 3: TLSv1.3 with a connection specific chain
+ */
+static int test_cert_msg_cache(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    char *rootfile = test_mk_file_path(certsdir, "rootcert.pem");
+    X509 *root = NULL;
+    SSL_CERT_MSG *msg = NULL;
+    SSL_CONNECTION *sc;
+    CERT_PKEY *cpk;
+    int i, testresult = 0;
+    unsigned int context = SSL_EXT_CLIENT_HELLO | SSL_EXT_TLS1_3_CERTIFICATE;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (tst == 0)
+        return TEST_skip("TLSv1.2 is disabled");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (tst != 0)
+        return TEST_skip("No usable TLSv1.3");
+#endif
+
+    cert_msg_ext_parsed = 0;
+    if (!TEST_ptr(rootfile)
+            || !TEST_ptr(root = load_cert_pem(rootfile, libctx))
+            || !TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                              TLS_client_method(),
+                                              tst == 0 ? TLS1_2_VERSION
+                                                       : TLS1_3_VERSION,
+                                              tst == 0 ? TLS1_2_VERSION
+                                                       : TLS1_3_VERSION,
+                                              &sctx, &cctx, cert, privkey)))
+        goto end;
+    /* Chains built from the certificate store are not cached */
+    SSL_CTX_set_mode(sctx, SSL_MODE_NO_AUTO_CHAIN);
+    cpk = &sctx->cert->pkeys[SSL_PKEY_RSA];
+
+    if (tst == 2
+            && (!TEST_true(SSL_CTX_add_custom_ext(sctx, CERT_MSG_EXT_TYPE,
+                                                  context, cert_msg_ext_add_cb,
+                                                  NULL, NULL,
+                                                  cert_msg_ext_parse_cb, NULL))
+                || !TEST_true(SSL_CTX_add_custom_ext(cctx, CERT_MSG_EXT_TYPE,
+                                                     context,
+                                                     cert_msg_ext_add_cb, NULL,
+                                                     NULL,
+                                                     cert_msg_ext_parse_cb,
+                                                     NULL))))
+        goto end;
+
+    for (i = 0; i < 2; i++) {
+        if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                          NULL, NULL)))
+            goto end;
+        if (tst == 3 && i == 1
+                && !TEST_true(SSL_add1_chain_cert(serverssl, root)))
+            goto end;
+        if (!TEST_true(create_ssl_connection(serverssl, clientssl,
+                                             SSL_ERROR_NONE))
+                || !TEST_ptr(sc = SSL_CONNECTION_FROM_SSL(serverssl))
+                || !TEST_int_eq(X509_cmp(SSL_get0_peer_certificate(clientssl),
+                                         cpk->x509), 0)
+                || !TEST_int_eq(sk_X509_num(SSL_get_peer_cert_chain(clientssl)),
+                                tst == 3 && i == 1 ? 2 : 1))
+            goto end;
+
+        if (tst == 2) {
+            if (!TEST_ptr_null(cpk->cert_msg)
+                    || !TEST_int_eq(cert_msg_ext_parsed, i + 1))
+                goto end;
+        } else {
+            /* The first handshake encodes the list, later ones reuse it */
+            if (i == 0)
+                msg = cpk->cert_msg;
+            if (!TEST_ptr(msg)
+                    || !TEST_ptr_eq(cpk->cert_msg, msg))
+                goto end;
+            if (tst == 3 && i == 1) {
+                if (!TEST_ptr_ne(sc->cert->key->cert_msg, msg))
+                    goto end;
+            } else if (!TEST_ptr_eq(sc->cert->key->cert_msg, msg)) {
+                goto end;
+            }
+        }
+
+        SSL_shutdown(clientssl);
+        SSL_shutdown(serverssl);
+        SSL_free(serverssl);
+        SSL_free(clientssl);
+        serverssl = clientssl = NULL;
+    }
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    X509_free(root);
+    OPENSSL_free(rootfile);
+    return testresult;
+}
+
 #if !defined(OSSL_NO_USABLE_TLS1_3) || !defined(OPENSSL_NO_TLS1_2)
 static int new_called, remove_called, get_called;
 
@@ -8029,6 +8544,208 @@ static int test_ssl_pending(int tst)
     return testresult;
 }
 
+/*
+ * Test SSL_read_borrow() and SSL_read_release()
+ * Test 0: TLSv1.3 (if available)
+ * Test 1: TLSv1.2 (if available)
+ */
+static int test_ssl_read_borrow(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0;
+    const char msg1[] = "A test message";
+    const char msg2[] = "Another one";
+    const unsigned char *data, *data2;
+    unsigned char buf[2];
+    size_t written, len, len2, readbytes;
+    int maxver = TLS1_3_VERSION;
+
+    if (tst == 0) {
+#ifdef OSSL_NO_USABLE_TLS1_3
+        return TEST_skip("TLSv1.3 is not available");
+#endif
+    } else {
+#ifdef OPENSSL_NO_TLS1_2
+        return TEST_skip("TLSv1.2 is not available");
+#endif
+        maxver = TLS1_2_VERSION;
+    }
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), TLS1_VERSION,
+                                       maxver, &sctx, &cctx, cert, privkey))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                             &clientssl, NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    /* Nothing to borrow yet */
+    if (!TEST_false(SSL_read_borrow(clientssl, &data, &len))
+            || !TEST_int_eq(SSL_get_error(clientssl, 0), SSL_ERROR_WANT_READ)
+            || !TEST_false(SSL_read_release(clientssl, 1)))
+        goto end;
+    ERR_clear_error();
+
+    /* Send two separate records */
+    if (!TEST_true(SSL_write_ex(serverssl, msg1, sizeof(msg1), &written))
+            || !TEST_true(SSL_write_ex(serverssl, msg2, sizeof(msg2),
+                                       &written)))
+        goto end;
+
+    /* Borrowing does not consume anything */
+    if (!TEST_true(SSL_read_borrow(clientssl, &data, &len))
+            || !TEST_mem_eq(data, len, msg1, sizeof(msg1))
+            || !TEST_true(SSL_read_borrow(clientssl, &data2, &len2))
+            || !TEST_ptr_eq(data, data2)
+            || !TEST_size_t_eq(len, len2)
+            || !TEST_int_eq(SSL_pending(clientssl), (int)len))
+        goto end;
+
+    /* Consume part of the record and check the rest is still available */
+    if (!TEST_false(SSL_read_release(clientssl, len + 1)))
+        goto end;
+    ERR_clear_error();
+    if (!TEST_true(SSL_read_release(clientssl, 0))
+            || !TEST_true(SSL_read_release(clientssl, 4))
+            || !TEST_true(SSL_read_borrow(clientssl, &data, &len))
+            || !TEST_mem_eq(data, len, msg1 + 4, sizeof(msg1) - 4))
+        goto end;
+
+    /* Mix with ordinary reads */
+    if (!TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg1 + 4, sizeof(buf))
+            || !TEST_true(SSL_read_borrow(clientssl, &data, &len))
+            || !TEST_mem_eq(data, len, msg1 + 6, sizeof(msg1) - 6)
+            || !TEST_true(SSL_read_release(clientssl, len)))
+        goto end;
+
+    /* The next record is returned once the first is fully consumed */
+    if (!TEST_true(SSL_read_borrow(clientssl, &data, &len))
+            || !TEST_mem_eq(data, len, msg2, sizeof(msg2))
+            || !TEST_true(SSL_read_release(clientssl, len))
+            || !TEST_false(SSL_read_borrow(clientssl, &data, &len))
+            || !TEST_int_eq(SSL_get_error(clientssl, 0), SSL_ERROR_WANT_READ))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test SSL_writev()
+ * Test 0: TLSv1.3, small records so that records span buffers
+ * Test 1: TLSv1.2, small records so that records span buffers
+ * Test 2: TLSv1.3, default record size
+ * Test 3: TLSv1.2, default record size
+ */
+#define WRITEV_SEG_SIZE 3000
+
+static int test_ssl_writev(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0;
+    unsigned char *msg = NULL, *buf = NULL, *expected = NULL;
+    SSL_IOVEC iov[5];
+    size_t i, total = 0, written, readbytes, off = 0;
+    int maxver = (tst % 2 == 0) ? TLS1_3_VERSION : TLS1_2_VERSION;
+
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (maxver == TLS1_3_VERSION)
+        return TEST_skip("TLSv1.3 is not available");
+#endif
+#ifdef OPENSSL_NO_TLS1_2
+    if (maxver == TLS1_2_VERSION)
+        return TEST_skip("TLSv1.2 is not available");
+#endif
+
+    if (!TEST_ptr(msg = OPENSSL_malloc(4 * WRITEV_SEG_SIZE))
+            || !TEST_ptr(buf = OPENSSL_malloc(4 * WRITEV_SEG_SIZE))
+            || !TEST_ptr(expected = OPENSSL_malloc(4 * WRITEV_SEG_SIZE)))
+        goto end;
+    RAND_bytes(msg, 4 * WRITEV_SEG_SIZE);
+
+    /* Buffers of assorted sizes, out of order, including an empty one */
+    iov[0].data = msg + 3 * WRITEV_SEG_SIZE;
+    iov[0].len = 100;
+    iov[1].data = msg;
+    iov[1].len = WRITEV_SEG_SIZE;
+    iov[2].data = NULL;
+    iov[2].len = 0;
+    iov[3].data = msg + 2 * WRITEV_SEG_SIZE;
+    iov[3].len = WRITEV_SEG_SIZE;
+    iov[4].data = msg + WRITEV_SEG_SIZE + 1;
+    iov[4].len = 1;
+    for (i = 0; i < OSSL_NELEM(iov); i++) {
+        if (iov[i].len > 0)
+            memcpy(expected + total, iov[i].data, iov[i].len);
+        total += iov[i].len;
+    }
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), TLS1_VERSION,
+                                       maxver, &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if (tst < 2 && !TEST_true(SSL_CTX_set_max_send_fragment(cctx, 512)))
+        goto end;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    /* Degenerate cases */
+    if (!TEST_true(SSL_writev(clientssl, NULL, 0, 0, &written))
+            || !TEST_size_t_eq(written, 0)
+            || !TEST_true(SSL_writev(clientssl, &iov[1], 1, 0, &written))
+            || !TEST_size_t_eq(written, WRITEV_SEG_SIZE))
+        goto end;
+    while (off < WRITEV_SEG_SIZE) {
+        if (!TEST_true(SSL_read_ex(serverssl, buf + off,
+                                   WRITEV_SEG_SIZE - off, &readbytes)))
+            goto end;
+        off += readbytes;
+    }
+    if (!TEST_mem_eq(buf, off, msg, WRITEV_SEG_SIZE))
+        goto end;
+
+    if (!TEST_true(SSL_writev(clientssl, iov, OSSL_NELEM(iov), 0, &written))
+            || !TEST_size_t_eq(written, total))
+        goto end;
+
+    for (off = 0; off < total; off += readbytes) {
+        if (!TEST_true(SSL_read_ex(serverssl, buf + off, total - off,
+                                   &readbytes)))
+            goto end;
+    }
+    if (!TEST_mem_eq(buf, off, expected, total))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    OPENSSL_free(msg);
+    OPENSSL_free(buf);
+    OPENSSL_free(expected);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
 static struct {
     unsigned int maxprot;
     const char *clntciphers;
@@ -9311,6 +10028,99 @@ end:
 }
 #endif /* OPENSSL_NO_TLS1_2 */
 
+#ifndef OSSL_NO_USABLE_TLS1_3
+static const char *batch_write_ciphersuites[] = {
+    "TLS_AES_128_GCM_SHA256",
+    "TLS_AES_256_GCM_SHA384",
+    "TLS_CHACHA20_POLY1305_SHA256",
+    "TLS_AES_128_CCM_SHA256"
+};
+
+# define TLS13_BATCH_FRAGSIZE 512
+
+/*
+ * Test that a TLSv1.3 write large enough to be split into several records is
+ * sealed and received correctly. For AES-GCM and ChaCha20-Poly1305 the records
+ * are sealed in a batch, and for AES-CCM the standard write path is used.
+ * Test 4 repeats test 0 with block padding configured, which also disables
+ * batching.
+ */
+static int test_tls13_batch_write(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0;
+    /* Enough for several full batches and a short final record */
+    unsigned char msg[TLS13_BATCH_FRAGSIZE * 21 + 17];
+    unsigned char buf[sizeof(msg)], *p = buf;
+    size_t readbytes, written, len;
+    const char *suite = batch_write_ciphersuites[idx % 4];
+
+# ifdef OPENSSL_NO_CHACHA
+    if (strstr(suite, "CHACHA") != NULL) {
+        TEST_skip("ChaCha20-Poly1305 is not available");
+        return 1;
+    }
+# endif
+    if (is_fips && strstr(suite, "CHACHA") != NULL) {
+        TEST_skip("ChaCha20-Poly1305 is not available in the FIPS provider");
+        return 1;
+    }
+
+    RAND_bytes(msg, sizeof(msg));
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), TLS1_3_VERSION,
+                                       TLS1_3_VERSION, &sctx, &cctx, cert,
+                                       privkey))
+            || !TEST_true(SSL_CTX_set_ciphersuites(sctx, suite))
+            || !TEST_true(SSL_CTX_set_ciphersuites(cctx, suite))
+            || !TEST_true(SSL_CTX_set_max_send_fragment(sctx,
+                                                        TLS13_BATCH_FRAGSIZE)))
+        goto end;
+
+    if (idx == 4 && !TEST_true(SSL_CTX_set_block_padding(sctx, 64)))
+        goto end;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    if (!TEST_true(SSL_write_ex(serverssl, msg, sizeof(msg), &written))
+            || !TEST_size_t_eq(written, sizeof(msg)))
+        goto end;
+
+    len = written;
+    while (len > 0) {
+        if (!TEST_true(SSL_read_ex(clientssl, p, len, &readbytes))
+                || !TEST_size_t_le(readbytes, TLS13_BATCH_FRAGSIZE))
+            goto end;
+        p += readbytes;
+        len -= readbytes;
+    }
+    if (!TEST_mem_eq(msg, sizeof(msg), buf, sizeof(buf)))
+        goto end;
+
+    /* Check the connection is still usable in both directions */
+    if (!TEST_true(SSL_write_ex(clientssl, msg, sizeof(msg), &written))
+            || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf),
+                                      &readbytes))
+            || !TEST_mem_eq(msg, readbytes, buf, readbytes))
+        goto end;
+
+    testresult = 1;
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+#endif /* OSSL_NO_USABLE_TLS1_3 */
+
 static int test_session_timeout(int test)
 {
     /*
@@ -9554,6 +10364,170 @@ static int test_session_cache_overflow(int idx)
 }
 #endif /* !defined(OSSL_NO_USABLE_TLS1_3) || !defined(OPENSSL_NO_TLS1_2) */
 
+static int sharded_remove_cb_count = 0;
+static SSL_SESSION *sharded_remove_cb_other = NULL;
+
+/* Re-enters the cache, which must not be locked when this is called */
+static void sharded_remove_session_cb(SSL_CTX *ctx, SSL_SESSION *sess)
+{
+    SSL_SESSION *other = sharded_remove_cb_other;
+
+    sharded_remove_cb_count++;
+    (void)SSL_CTX_sess_number(ctx);
+    if (other != NULL && other != sess) {
+        sharded_remove_cb_other = NULL;
+        SSL_CTX_remove_session(ctx, other);
+    }
+}
+
+/*
+ * Test the sharded session cache
+ * Test 0: Adding, removing, eviction and timeouts
+ * Test 1: Server side resumption (TLSv1.2) from the sharded cache
+ */
+static int test_session_cache_sharded(int idx)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *serverssl = NULL, *clientssl = NULL;
+    SSL_SESSION *sess[3] = { NULL, NULL, NULL };
+    SSL_SESSION *csess = NULL;
+    time_t now = time(NULL);
+    size_t i;
+    int testresult = 0;
+
+    if (idx == 0) {
+        if (!TEST_ptr(sctx = SSL_CTX_new_ex(libctx, NULL, TLS_method())))
+            goto end;
+        SSL_CTX_set_session_cache_mode(sctx, SSL_SESS_CACHE_SERVER
+                                             | SSL_SESS_CACHE_SHARDED);
+        if (!TEST_long_eq(SSL_CTX_get_session_cache_mode(sctx),
+                          SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_SHARDED))
+            goto end;
+
+        for (i = 0; i < OSSL_NELEM(sess); i++) {
+            if (!TEST_ptr(sess[i] = SSL_SESSION_new()))
+                goto end;
+            sess[i]->session_id_length = SSL3_SSL_SESSION_ID_LENGTH;
+            memset(sess[i]->session_id, (int)i + 1,
+                   SSL3_SSL_SESSION_ID_LENGTH);
+            if (!TEST_time_t_ne(SSL_SESSION_set_time_ex(sess[i],
+                                                        now + 10 * i), 0)
+                    || !TEST_int_ne(SSL_SESSION_set_timeout(sess[i], TIMEOUT),
+                                    0)
+                    || !TEST_int_eq(SSL_CTX_add_session(sctx, sess[i]), 1))
+                goto end;
+        }
+
+        /* Adding again is a no-op */
+        if (!TEST_int_eq(SSL_CTX_add_session(sctx, sess[0]), 0)
+                || !TEST_long_eq(SSL_CTX_sess_number(sctx), 3))
+            goto end;
+
+        /* This should remove sess[0] only */
+        SSL_CTX_flush_sessions_ex(sctx, now + TIMEOUT + 1);
+        if (!TEST_long_eq(SSL_CTX_sess_number(sctx), 2)
+                || !TEST_true(SSL_CTX_remove_session(sctx, sess[1]))
+                || !TEST_false(SSL_CTX_remove_session(sctx, sess[1]))
+                || !TEST_long_eq(SSL_CTX_sess_number(sctx), 1))
+            goto end;
+
+        /* The remove callback may call back into the cache */
+        sess[0]->not_resumable = sess[1]->not_resumable = 0;
+        if (!TEST_int_eq(SSL_CTX_add_session(sctx, sess[0]), 1)
+                || !TEST_int_eq(SSL_CTX_add_session(sctx, sess[1]), 1))
+            goto end;
+        SSL_CTX_sess_set_remove_cb(sctx, sharded_remove_session_cb);
+        sharded_remove_cb_count = 0;
+        sharded_remove_cb_other = sess[1];
+        SSL_CTX_flush_sessions_ex(sctx, now + TIMEOUT + 1);
+        if (!TEST_int_eq(sharded_remove_cb_count, 2)
+                || !TEST_ptr_null(sharded_remove_cb_other)
+                || !TEST_long_eq(SSL_CTX_sess_number(sctx), 1))
+            goto end;
+        SSL_CTX_sess_set_remove_cb(sctx, NULL);
+
+        /* This should remove everything that is left */
+        SSL_CTX_flush_sessions_ex(sctx, 0);
+        if (!TEST_long_eq(SSL_CTX_sess_number(sctx), 0))
+            goto end;
+
+        /* A full shard evicts an older session to make room */
+        SSL_CTX_sess_set_cache_size(sctx, 1);
+        for (i = 0; i < OSSL_NELEM(sess); i++)
+            sess[i]->not_resumable = 0;
+        memset(sess[1]->session_id, 1, SSL3_SSL_SESSION_ID_LENGTH);
+        if (!TEST_int_eq(SSL_CTX_add_session(sctx, sess[0]), 1))
+            goto end;
+        for (i = 0; i < 256 && !sess[0]->not_resumable; i++) {
+            /* Find an id which lands in the same shard as sess[0] */
+            if (i == 1)
+                continue;
+            sess[1]->session_id[0] = (unsigned char)i;
+            if (!TEST_int_eq(SSL_CTX_add_session(sctx, sess[1]), 1))
+                goto end;
+            if (!sess[0]->not_resumable
+                    && !TEST_true(SSL_CTX_remove_session(sctx, sess[1])))
+                goto end;
+        }
+        if (!TEST_long_eq(SSL_CTX_sess_number(sctx), 1)
+                || !TEST_long_gt(SSL_CTX_sess_cache_full(sctx), 0)
+                || !TEST_true(sess[0]->not_resumable))
+            goto end;
+
+        /* Switching back to the classic cache drops the sharded one */
+        SSL_CTX_set_session_cache_mode(sctx, SSL_SESS_CACHE_SERVER);
+        if (!TEST_long_eq(SSL_CTX_sess_number(sctx), 0))
+            goto end;
+    } else {
+#ifdef OPENSSL_NO_TLS1_2
+        return TEST_skip("No TLSv1.2 available");
+#else
+        if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                           TLS_client_method(), TLS1_VERSION,
+                                           TLS1_2_VERSION, &sctx, &cctx, cert,
+                                           privkey))
+                || !TEST_true(SSL_CTX_set_options(sctx, SSL_OP_NO_TICKET)))
+            goto end;
+        SSL_CTX_set_session_cache_mode(sctx, SSL_SESS_CACHE_SERVER
+                                             | SSL_SESS_CACHE_SHARDED);
+
+        if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                          NULL, NULL))
+                || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                    SSL_ERROR_NONE))
+                || !TEST_ptr(csess = SSL_get1_session(clientssl))
+                || !TEST_long_eq(SSL_CTX_sess_number(sctx), 1)
+                || !TEST_true(SSL_has_matching_session_id(serverssl,
+                                                          csess->session_id,
+                                                          csess->session_id_length)))
+            goto end;
+
+        shutdown_ssl_connection(serverssl, clientssl);
+        serverssl = clientssl = NULL;
+
+        if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                          NULL, NULL))
+                || !TEST_true(SSL_set_session(clientssl, csess))
+                || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                    SSL_ERROR_NONE))
+                || !TEST_true(SSL_session_reused(serverssl))
+                || !TEST_long_eq(SSL_CTX_sess_hits(sctx), 1))
+            goto end;
+#endif
+    }
+
+    testresult = 1;
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    SSL_SESSION_free(csess);
+    for (i = 0; i < OSSL_NELEM(sess); i++)
+        SSL_SESSION_free(sess[i]);
+    return testresult;
+}
+
 /*
  * Test 0: Client sets servername and server acknowledges it (TLSv1.2)
  * Test 1: Client sets servername and server does not acknowledge it (TLSv1.2)
@@ -12496,6 +13470,7 @@ int setup_tests(void)
 # if !defined(OPENSSL_NO_TLS1_2) || !defined(OSSL_NO_USABLE_TLS1_3)
     ADD_ALL_TESTS(test_ktls, NUM_KTLS_TEST_CIPHERS * 4);
     ADD_ALL_TESTS(test_ktls_sendfile, NUM_KTLS_TEST_CIPHERS * 2);
+    ADD_ALL_TESTS(test_ktls_key_update, NUM_KTLS_TEST_CIPHERS);
 # endif
 #endif
     ADD_TEST(test_large_message_tls);
@@ -12507,7 +13482,12 @@ int setup_tests(void)
     ADD_TEST(test_cleanse_plaintext);
 #ifndef OPENSSL_NO_OCSP
     ADD_TEST(test_tlsext_status_type);
+    ADD_ALL_TESTS(test_ocsp_stapling, 2);
+# if !defined(OPENSSL_NO_THREAD_POOL) && !defined(OPENSSL_NO_SOCK)
+    ADD_TEST(test_ocsp_stapling_teardown);
+# endif
 #endif
+    ADD_ALL_TESTS(test_cert_msg_cache, 4);
     ADD_TEST(test_session_with_only_int_cache);
     ADD_TEST(test_session_with_only_ext_cache);
     ADD_TEST(test_session_with_both_cache);
@@ -12608,6 +13588,8 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_info_callback, 6);
 #endif
     ADD_ALL_TESTS(test_ssl_pending, 2);
+    ADD_ALL_TESTS(test_ssl_read_borrow, 2);
+    ADD_ALL_TESTS(test_ssl_writev, 4);
     ADD_ALL_TESTS(test_ssl_get_shared_ciphers, OSSL_NELEM(shared_ciphers_data));
     ADD_ALL_TESTS(test_ticket_callbacks, 20);
     ADD_ALL_TESTS(test_shutdown, 7);
@@ -12618,6 +13600,9 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_ca_names, 3);
 #ifndef OPENSSL_NO_TLS1_2
     ADD_ALL_TESTS(test_multiblock_write, OSSL_NELEM(multiblock_cipherlist_data));
+#endif
+#ifndef OSSL_NO_USABLE_TLS1_3
+    ADD_ALL_TESTS(test_tls13_batch_write, 5);
 #endif
     ADD_ALL_TESTS(test_servername, 10);
     ADD_TEST(test_unknown_sigalgs_groups);
@@ -12646,6 +13631,7 @@ int setup_tests(void)
     ADD_TEST(test_set_verify_cert_store_ssl_ctx);
     ADD_TEST(test_set_verify_cert_store_ssl);
     ADD_ALL_TESTS(test_session_timeout, 1);
+    ADD_ALL_TESTS(test_session_cache_sharded, 2);
 #if !defined(OSSL_NO_USABLE_TLS1_3) || !defined(OPENSSL_NO_TLS1_2)
     ADD_ALL_TESTS(test_session_cache_overflow, 4);
 #endif
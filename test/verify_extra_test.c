@@ -10,11 +10,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <openssl/crypto.h>
+#include <openssl/thread.h>
 #include <openssl/bio.h>
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 #include <openssl/pem.h>
 #include <openssl/err.h>
+#include "internal/nelem.h"
 #include "testutil.h"
 
 static const char *certs_dir;
@@ -25,6 +27,8 @@ static char *bad_f = NULL;
 static char *req_f = NULL;
 static char *sroot_cert = NULL;
 static char *ca_cert = NULL;
+static char *ca_expired = NULL;
+static char *ca_nonca = NULL;
 static char *ee_cert = NULL;
 
 #define load_cert_from_file(file) load_cert_pem(file, NULL)
@@ -290,6 +294,422 @@ static int test_purpose_any(void)
     return do_test_purpose(X509_PURPOSE_ANY, 1);
 }
 
+/*
+ * Verify ee-cert using a freshly loaded copy of ca-cert as the untrusted
+ * intermediate, and return a new reference to the intermediate in the
+ * resulting chain. A chain taken from the verification cache still refers
+ * to the copy used when it was first verified.
+ */
+static int verify_with_cache(X509_STORE *store, X509 *eecert, X509 **inter)
+{
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    STACK_OF(X509) *untrusted = sk_X509_new_null();
+    X509 *untrcert = load_cert_from_file(ca_cert);
+    int testresult = 0;
+
+    *inter = NULL;
+    if (!TEST_ptr(ctx)
+            || !TEST_ptr(untrusted)
+            || !TEST_ptr(untrcert)
+            || !TEST_true(sk_X509_push(untrusted, untrcert)))
+        goto err;
+    untrcert = NULL;
+
+    if (!TEST_true(X509_STORE_CTX_init(ctx, store, eecert, untrusted))
+            || !TEST_true(X509_STORE_CTX_set_purpose(ctx,
+                                                     X509_PURPOSE_SSL_SERVER))
+            || !TEST_int_eq(X509_verify_cert(ctx), 1)
+            || !TEST_int_eq(X509_STORE_CTX_get_error(ctx), X509_V_OK)
+            || !TEST_int_eq(sk_X509_num(X509_STORE_CTX_get0_chain(ctx)), 3))
+        goto err;
+
+    *inter = sk_X509_value(X509_STORE_CTX_get0_chain(ctx), 1);
+    if (!TEST_true(X509_up_ref(*inter))) {
+        *inter = NULL;
+        goto err;
+    }
+    testresult = 1;
+ err:
+    X509_STORE_CTX_free(ctx);
+    OSSL_STACK_OF_X509_free(untrusted);
+    X509_free(untrcert);
+    return testresult;
+}
+
+static int test_verify_cache(void)
+{
+    X509_STORE *store = X509_STORE_new();
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *trcert = load_cert_from_file(sroot_cert);
+    X509 *other = load_cert_from_file(root_f);
+    X509 *first = NULL, *second = NULL, *third = NULL, *fourth = NULL;
+    X509 *fifth = NULL;
+    int testresult = 0;
+
+    if (!TEST_ptr(store)
+            || !TEST_ptr(eecert)
+            || !TEST_ptr(trcert)
+            || !TEST_ptr(other)
+            || !TEST_true(X509_STORE_add_cert(store, trcert))
+            || !TEST_true(X509_STORE_set_verify_cache(store, 16, 3600)))
+        goto err;
+
+    /* The chain is stored on first use and returned by the next call */
+    if (!verify_with_cache(store, eecert, &first)
+            || !verify_with_cache(store, eecert, &second)
+            || !TEST_ptr_eq(first, second))
+        goto err;
+
+    /* Adding to the store invalidates existing entries */
+    if (!TEST_true(X509_STORE_add_cert(store, other))
+            || !verify_with_cache(store, eecert, &third)
+            || !TEST_ptr_ne(first, third))
+        goto err;
+
+    /* Disabling the cache means the chain is always built afresh */
+    if (!TEST_true(X509_STORE_set_verify_cache(store, 0, 0))
+            || !verify_with_cache(store, eecert, &fourth)
+            || !verify_with_cache(store, eecert, &fifth)
+            || !TEST_ptr_ne(fourth, fifth))
+        goto err;
+
+    testresult = 1;
+ err:
+    X509_free(first);
+    X509_free(second);
+    X509_free(third);
+    X509_free(fourth);
+    X509_free(fifth);
+    X509_free(eecert);
+    X509_free(trcert);
+    X509_free(other);
+    X509_STORE_free(store);
+    return testresult;
+}
+
+/*
+ * Look up certificates by subject and issuer in a store holding several CAs
+ * with the same name, one of them added twice.
+ */
+static int test_store_lookup_by_name(void)
+{
+    X509_STORE *store = X509_STORE_new();
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    X509 *root = load_cert_from_file(sroot_cert);
+    X509 *ca = load_cert_from_file(ca_cert);
+    X509 *expired = load_cert_from_file(ca_expired);
+    X509 *nonca = load_cert_from_file(ca_nonca);
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *issuer = NULL;
+    STACK_OF(X509) *certs = NULL;
+    STACK_OF(X509_OBJECT) *objs = NULL;
+    int testresult = 0;
+
+    if (!TEST_ptr(store)
+            || !TEST_ptr(ctx)
+            || !TEST_ptr(root)
+            || !TEST_ptr(ca)
+            || !TEST_ptr(expired)
+            || !TEST_ptr(nonca)
+            || !TEST_ptr(eecert)
+            || !TEST_true(X509_STORE_add_cert(store, root))
+            || !TEST_true(X509_STORE_add_cert(store, expired))
+            || !TEST_true(X509_STORE_add_cert(store, ca))
+            || !TEST_true(X509_STORE_add_cert(store, nonca))
+            || !TEST_true(X509_STORE_add_cert(store, ca))
+            || !TEST_ptr(objs = X509_STORE_get1_objects(store))
+            || !TEST_int_eq(sk_X509_OBJECT_num(objs), 4)
+            || !TEST_true(X509_STORE_CTX_init(ctx, store, eecert, NULL)))
+        goto err;
+
+    /* All certificates named "CA", without duplicates */
+    certs = X509_STORE_CTX_get1_certs(ctx, X509_get_issuer_name(eecert));
+    if (!TEST_ptr(certs)
+            || !TEST_int_eq(sk_X509_num(certs), 3))
+        goto err;
+    OSSL_STACK_OF_X509_free(certs);
+
+    /* Nothing by a name not in the store */
+    certs = X509_STORE_CTX_get1_certs(ctx, X509_get_subject_name(eecert));
+    if (!TEST_ptr(certs)
+            || !TEST_int_eq(sk_X509_num(certs), 0))
+        goto err;
+
+    /* The current issuer is preferred to the expired one added before it */
+    if (!TEST_int_eq(X509_STORE_CTX_get1_issuer(&issuer, ctx, eecert), 1)
+            || !TEST_int_eq(X509_cmp(issuer, ca), 0))
+        goto err;
+
+    testresult = 1;
+ err:
+    sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+    OSSL_STACK_OF_X509_free(certs);
+    X509_free(issuer);
+    X509_free(eecert);
+    X509_free(nonca);
+    X509_free(expired);
+    X509_free(ca);
+    X509_free(root);
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    return testresult;
+}
+
+static int write_trust_index(const char *file, const char **certfiles,
+                             size_t n)
+{
+    STACK_OF(X509) *certs = sk_X509_new_null();
+    BIO *out = NULL;
+    X509 *x;
+    size_t i;
+    int testresult = 0;
+
+    if (!TEST_ptr(certs))
+        return 0;
+    for (i = 0; i < n; i++)
+        if (!TEST_ptr(x = load_cert_from_file(certfiles[i]))
+                || !TEST_true(sk_X509_push(certs, x))) {
+            X509_free(x);
+            goto err;
+        }
+    if (!TEST_ptr(out = BIO_new_file(file, "wb"))
+            || !TEST_true(X509_trust_index_write(out, certs)))
+        goto err;
+    testresult = 1;
+ err:
+    BIO_free(out);
+    OSSL_STACK_OF_X509_free(certs);
+    return testresult;
+}
+
+/*
+ * Verify using trust anchors from a trust index, which are only added to the
+ * store when they are looked up.
+ */
+static int test_trust_index(void)
+{
+    static const char *idx_file = "verify_extra_test.idx";
+    const char *certfiles[2];
+    X509_STORE *store = X509_STORE_new();
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    X509_LOOKUP *lookup;
+    X509 *eecert = load_cert_from_file(ee_cert);
+    STACK_OF(X509_OBJECT) *objs = NULL;
+    BIO *bio = NULL;
+    int testresult = 0;
+
+    certfiles[0] = ca_cert;
+    certfiles[1] = sroot_cert;
+    if (!TEST_ptr(store)
+            || !TEST_ptr(ctx)
+            || !TEST_ptr(eecert)
+            || !write_trust_index(idx_file, certfiles, OSSL_NELEM(certfiles))
+            || !TEST_ptr(lookup =
+                         X509_STORE_add_lookup(store,
+                                               X509_LOOKUP_trust_index()))
+            || !TEST_int_eq(X509_LOOKUP_load_trust_index(lookup, idx_file), 1)
+            || !TEST_ptr(objs = X509_STORE_get1_objects(store))
+            || !TEST_int_eq(sk_X509_OBJECT_num(objs), 0))
+        goto err;
+    sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+    objs = NULL;
+
+    if (!TEST_true(X509_STORE_CTX_init(ctx, store, eecert, NULL))
+            || !TEST_true(X509_STORE_CTX_set_purpose(ctx,
+                                                     X509_PURPOSE_SSL_SERVER))
+            || !TEST_int_eq(X509_verify_cert(ctx), 1)
+            || !TEST_int_eq(sk_X509_num(X509_STORE_CTX_get0_chain(ctx)), 3)
+            || !TEST_ptr(objs = X509_STORE_get1_objects(store))
+            || !TEST_int_eq(sk_X509_OBJECT_num(objs), 2))
+        goto err;
+
+    /* A file which is not a trust index is rejected */
+    if (!TEST_ptr(bio = BIO_new_file(idx_file, "w"))
+            || !TEST_int_gt(BIO_puts(bio, "not a trust index\n"), 0))
+        goto err;
+    BIO_free(bio);
+    bio = NULL;
+    if (!TEST_int_eq(X509_LOOKUP_load_trust_index(lookup, idx_file), 0))
+        goto err;
+
+    testresult = 1;
+ err:
+    BIO_free(bio);
+    remove(idx_file);
+    sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+    X509_free(eecert);
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    return testresult;
+}
+
+static int write_hash_file(const char *file, X509 *x)
+{
+    BIO *out = BIO_new_file(file, "w");
+    int ret;
+
+    if (!TEST_ptr(out))
+        return 0;
+    /* An empty file is one that fails to load */
+    ret = x == NULL || TEST_true(PEM_write_bio_X509(out, x));
+    BIO_free(out);
+    return ret;
+}
+
+/*
+ * Check that failed lookups in a hashed directory are remembered when the
+ * directory cache is enabled, for as long as the directory doesn't change.
+ */
+static int test_dir_cache(void)
+{
+    X509_STORE *store = X509_STORE_new();
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    X509_LOOKUP *lookup;
+    X509 *ca = load_cert_from_file(ca_cert);
+    X509_OBJECT *obj = NULL;
+    X509_NAME *name;
+    char hashfile[16];
+    unsigned long h;
+    int ok, testresult = 0;
+
+    hashfile[0] = '\0';
+    if (!TEST_ptr(store)
+            || !TEST_ptr(ctx)
+            || !TEST_ptr(ca)
+            || !TEST_ptr(lookup = X509_STORE_add_lookup(store,
+                                                        X509_LOOKUP_hash_dir()))
+            || !TEST_true(X509_LOOKUP_add_dir(lookup, ".", X509_FILETYPE_PEM))
+            || !TEST_true(X509_LOOKUP_set_dir_cache_timeout(lookup, 3600))
+            || !TEST_true(X509_STORE_CTX_init(ctx, store, NULL, NULL)))
+        goto err;
+    name = X509_get_subject_name(ca);
+    h = X509_NAME_hash_ex(name, NULL, NULL, &ok);
+    if (!TEST_true(ok))
+        goto err;
+    BIO_snprintf(hashfile, sizeof(hashfile), "%08lx.0", h);
+
+    /*
+     * The directory is only trusted not to have changed once its modification
+     * time lies in the past.
+     */
+    if (!write_hash_file(hashfile, NULL))
+        goto err;
+    OSSL_sleep(1100);
+    if (!TEST_ptr_null(X509_STORE_CTX_get_obj_by_subject(ctx, X509_LU_X509,
+                                                         name)))
+        goto err;
+
+    /* Rewriting the file doesn't modify the directory, so it goes unnoticed */
+    if (!write_hash_file(hashfile, ca)
+            || !TEST_ptr_null(X509_STORE_CTX_get_obj_by_subject(ctx,
+                                                                X509_LU_X509,
+                                                                name)))
+        goto err;
+
+    /* Without the cache the file is looked at again */
+    if (!TEST_true(X509_LOOKUP_set_dir_cache_timeout(lookup, -1))
+            || !TEST_ptr(obj = X509_STORE_CTX_get_obj_by_subject(ctx,
+                                                                 X509_LU_X509,
+                                                                 name))
+            || !TEST_int_eq(X509_cmp(X509_OBJECT_get0_X509(obj), ca), 0))
+        goto err;
+
+    testresult = 1;
+ err:
+    if (hashfile[0] != '\0')
+        remove(hashfile);
+    X509_OBJECT_free(obj);
+    X509_free(ca);
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    return testresult;
+}
+
+static int verify_parallel(X509_STORE *store, X509 *eecert,
+                           STACK_OF(X509) *untrusted, int expected)
+{
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    int ret = 0;
+
+    if (!TEST_ptr(ctx)
+            || !TEST_true(X509_STORE_CTX_init(ctx, store, eecert, untrusted)))
+        goto err;
+    X509_STORE_CTX_set_flags(ctx, X509_V_FLAG_PARALLEL_VERIFY
+                                  | X509_V_FLAG_CHECK_SS_SIGNATURE);
+    if (expected == X509_V_OK) {
+        ret = TEST_int_eq(X509_verify_cert(ctx), 1)
+            && TEST_int_eq(sk_X509_num(X509_STORE_CTX_get0_chain(ctx)), 3);
+    } else {
+        /* Errors from checks in other threads end up in this thread */
+        ERR_clear_error();
+        ret = TEST_int_le(X509_verify_cert(ctx), 0)
+            && TEST_int_eq(X509_STORE_CTX_get_error(ctx), expected)
+            && TEST_int_eq(X509_STORE_CTX_get_error_depth(ctx), 0)
+            && TEST_ulong_ne(ERR_peek_error(), 0);
+        ERR_clear_error();
+    }
+ err:
+    X509_STORE_CTX_free(ctx);
+    return ret;
+}
+
+/*
+ * Verify a chain with its signatures checked in the thread pool, if there is
+ * one, and check that a bad signature is still reported at the right depth.
+ */
+static int test_parallel_verify(void)
+{
+    X509_STORE *store = X509_STORE_new();
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *cacert = load_cert_from_file(ca_cert);
+    X509 *trcert = load_cert_from_file(sroot_cert);
+    X509 *badcert = NULL;
+    STACK_OF(X509) *untrusted = sk_X509_new_null();
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    int len, testresult = 0;
+
+    if (!TEST_ptr(store)
+            || !TEST_ptr(eecert)
+            || !TEST_ptr(cacert)
+            || !TEST_ptr(trcert)
+            || !TEST_ptr(untrusted)
+            || !TEST_true(X509_STORE_add_cert(store, trcert))
+            || !TEST_true(sk_X509_push(untrusted, cacert)))
+        goto err;
+    cacert = NULL;
+
+    /*
+     * Without thread pool support, setting the maximum fails and the checks
+     * are done sequentially, which must give the same results.
+     */
+    (void)OSSL_set_max_threads(NULL, 2);
+    if (!verify_parallel(store, eecert, untrusted, X509_V_OK))
+        goto err;
+
+    /* The signature is at the end of the encoding */
+    if (!TEST_int_gt(len = i2d_X509(eecert, &der), 0))
+        goto err;
+    der[len - 1] ^= 1;
+    p = der;
+    if (!TEST_ptr(badcert = d2i_X509(NULL, &p, len))
+            || !verify_parallel(store, badcert, untrusted,
+                                X509_V_ERR_CERT_SIGNATURE_FAILURE))
+        goto err;
+
+    testresult = 1;
+ err:
+    (void)OSSL_set_max_threads(NULL, 0);
+    OPENSSL_free(der);
+    OSSL_STACK_OF_X509_free(untrusted);
+    X509_free(badcert);
+    X509_free(trcert);
+    X509_free(cacert);
+    X509_free(eecert);
+    X509_STORE_free(store);
+    return testresult;
+}
+
 OPT_TEST_DECLARE_USAGE("certs-dir\n")
 
 int setup_tests(void)
@@ -309,6 +729,8 @@ int setup_tests(void)
             || !TEST_ptr(req_f = test_mk_file_path(certs_dir, "sm2-csr.pem"))
             || !TEST_ptr(sroot_cert = test_mk_file_path(certs_dir, "sroot-cert.pem"))
             || !TEST_ptr(ca_cert = test_mk_file_path(certs_dir, "ca-cert.pem"))
+            || !TEST_ptr(ca_expired = test_mk_file_path(certs_dir, "ca-expired.pem"))
+            || !TEST_ptr(ca_nonca = test_mk_file_path(certs_dir, "ca-nonca.pem"))
             || !TEST_ptr(ee_cert = test_mk_file_path(certs_dir, "ee-cert.pem")))
         goto err;
 
@@ -322,6 +744,11 @@ int setup_tests(void)
     ADD_TEST(test_purpose_ssl_client);
     ADD_TEST(test_purpose_ssl_server);
     ADD_TEST(test_purpose_any);
+    ADD_TEST(test_verify_cache);
+    ADD_TEST(test_store_lookup_by_name);
+    ADD_TEST(test_trust_index);
+    ADD_TEST(test_dir_cache);
+    ADD_TEST(test_parallel_verify);
     return 1;
  err:
     cleanup_tests();
@@ -337,5 +764,7 @@ void cleanup_tests(void)
     OPENSSL_free(req_f);
     OPENSSL_free(sroot_cert);
     OPENSSL_free(ca_cert);
+    OPENSSL_free(ca_expired);
+    OPENSSL_free(ca_nonca);
     OPENSSL_free(ee_cert);
 }
@@ -14,8 +14,10 @@
 
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
+#include <openssl/pem.h>
 #include "testutil.h"
 #include "internal/nelem.h"
+#include "crypto/x509.h"
 
 /**********************************************************************
  *
@@ -172,9 +174,158 @@ static int test_a2i_ipaddress(int idx)
     return good;
 }
 
+static const char ee_cert_pem[] =
+    "-----BEGIN CERTIFICATE-----\n"
+    "MIIDIDCCAgigAwIBAgIBAjANBgkqhkiG9w0BAQsFADANMQswCQYDVQQDDAJDQTAg\n"
+    "Fw0xNjAxMTUwODE5NDlaGA8yMTE2MDExNjA4MTk0OVowGTEXMBUGA1UEAwwOc2Vy\n"
+    "dmVyLmV4YW1wbGUwggEiMA0GCSqGSIb3DQEBAQUAA4IBDwAwggEKAoIBAQCo/4lY\n"
+    "YYWu3tssD9Vz++K3qBt6dWAr1H08c3a1rt6TL38kkG3JHPSKOM2fooAWVsu0LLuT\n"
+    "5Rcf/w3GQ/4xNPgo2HXpo7uIgu+jcuJTYgVFTeAxl++qnRDSWA2eBp4yuxsIVl1l\n"
+    "Dz9mjsI2oBH/wFk1/Ukc3RxCMwZ4rgQ4I+XndWfTlK1aqUAfrFkQ9QzBZK1KxMY1\n"
+    "U7OWaoIbFYvRmavknm+UqtKW5Vf7jJFkijwkFsbSGb6CYBM7YrDtPh2zyvlr3zG5\n"
+    "ep5LR2inKcc/SuIiJ7TvkGPX79ByST5brbkb1Ctvhmjd1XMSuEPJ3EEPoqNGT4tn\n"
+    "iIQPYf55NB9KiR+3AgMBAAGjfTB7MB0GA1UdDgQWBBTnm+IqrYpsOst2UeWOB5gi\n"
+    "l+FzojAfBgNVHSMEGDAWgBS0ETPx1+Je91OeICIQT4YGvx/JXjAJBgNVHRMEAjAA\n"
+    "MBMGA1UdJQQMMAoGCCsGAQUFBwMBMBkGA1UdEQQSMBCCDnNlcnZlci5leGFtcGxl\n"
+    "MA0GCSqGSIb3DQEBCwUAA4IBAQBBtDxPYULl5b7VFC7/U0NgV8vTJk4zpPnUMMQ4\n"
+    "QF2AWDFAek8oLKrz18KQ8M/DEhDxgkaoeXEMLT6BJUEVNYuFEYHEDGarl0nMDRXL\n"
+    "xOgAExfz3Tf/pjsLaha5aWH7NyCSKWC+lYkIOJ/Kb/m/6QsDJoXsEC8AhrPfqJhz\n"
+    "UzsCoxIlaDWqawH4+S8bdeX0tvs2VtJk/WOJHxMqXra6kgI4fAgyvr2kIZHinQ3y\n"
+    "cgX40uAC38bwpE95kJ7FhSfQlE1Rt7sOspUj098Dd0RNDn2uKyOTxEqIELHfw4AX\n"
+    "O3XAzt8qDyho8nEd/xiQ6qgsQnvXa+hSRJw42g3/czVskxRx\n"
+    "-----END CERTIFICATE-----\n";
+
+static X509 *load_ee_cert(void)
+{
+    BIO *bio = BIO_new_mem_buf(ee_cert_pem, -1);
+    X509 *x = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+
+    BIO_free(bio);
+    return x;
+}
+
+/*
+ * Comparing certificates only needs their fingerprints, which must not cause
+ * the extensions to be decoded.
+ */
+static int test_lazy_extensions(void)
+{
+    X509 *a = load_ee_cert(), *b = load_ee_cert();
+    unsigned char md[SHA_DIGEST_LENGTH];
+    unsigned int len;
+    int ret = 0;
+
+    if (!TEST_ptr(a)
+            || !TEST_ptr(b)
+            || !TEST_int_eq(X509_cmp(a, b), 0)
+            || !TEST_true(a->sha1_cached)
+            || !TEST_true(b->sha1_cached)
+            || !TEST_int_eq(a->ex_flags & EXFLAG_SET, 0)
+            || !TEST_ptr_null(a->altname)
+            || !TEST_true(X509_digest(a, EVP_sha1(), md, &len))
+            || !TEST_mem_eq(md, len, a->sha1_hash, sizeof(a->sha1_hash)))
+        goto err;
+
+    /* A purpose check decodes them, and leaves the fingerprint alone */
+    if (!TEST_int_ne(X509_get_extension_flags(a) & EXFLAG_SET, 0)
+            || !TEST_ptr(a->altname)
+            || !TEST_int_eq(X509_cmp(a, b), 0)
+            || !TEST_mem_eq(md, len, a->sha1_hash, sizeof(a->sha1_hash)))
+        goto err;
+
+    ret = 1;
+ err:
+    X509_free(a);
+    X509_free(b);
+    return ret;
+}
+
+/* Certificate with the given extension, with its extensions cached */
+static X509 *make_ext_cert(int nid, const char *value)
+{
+    X509 *x = X509_new();
+    X509_EXTENSION *ext = X509V3_EXT_nconf_nid(NULL, NULL, nid, value);
+
+    if (!TEST_ptr(x)
+            || !TEST_ptr(ext)
+            || !TEST_true(X509_add_ext(x, ext, -1))
+            || !TEST_int_ne(X509_get_extension_flags(x) & EXFLAG_SET, 0)) {
+        X509_free(x);
+        x = NULL;
+    }
+    X509_EXTENSION_free(ext);
+    return x;
+}
+
+static const char nc_constraints[] =
+    "permitted;DNS:example.com,permitted;DNS:.example.org,"
+    "permitted;email:example.net,permitted;email:.example.net,"
+    "permitted;email:@mail.example.com,"
+    "permitted;IP:192.168.0.0/255.255.0.0,"
+    "permitted;IP:2001:db8::/ffff:ffff::,"
+    "excluded;DNS:bad.example.com,excluded;email:.bad.example.net,"
+    "excluded;IP:192.168.5.0/255.255.255.0";
+
+static const struct {
+    const char *name;
+    int result;
+} nc_tests[] = {
+    { "DNS:example.com", X509_V_OK },
+    { "DNS:www.EXAMPLE.com", X509_V_OK },
+    { "DNS:wwwexample.com", X509_V_ERR_PERMITTED_VIOLATION },
+    { "DNS:a.b.example.org", X509_V_OK },
+    { "DNS:example.org", X509_V_ERR_PERMITTED_VIOLATION },
+    { "DNS:bad.example.com", X509_V_ERR_EXCLUDED_VIOLATION },
+    { "DNS:x.Bad.example.com", X509_V_ERR_EXCLUDED_VIOLATION },
+    { "email:joe@example.net", X509_V_OK },
+    { "email:joe@sub.example.net", X509_V_OK },
+    { "email:joe@Mail.Example.com", X509_V_OK },
+    { "email:joe@x.bad.example.net", X509_V_ERR_EXCLUDED_VIOLATION },
+    { "email:joe@example.com", X509_V_ERR_PERMITTED_VIOLATION },
+    { "email:example.net", X509_V_ERR_UNSUPPORTED_NAME_SYNTAX },
+    { "IP:192.168.1.1", X509_V_OK },
+    { "IP:192.168.5.1", X509_V_ERR_EXCLUDED_VIOLATION },
+    { "IP:10.0.0.1", X509_V_ERR_PERMITTED_VIOLATION },
+    { "IP:2001:db8::1", X509_V_OK },
+    { "IP:2001:db9::1", X509_V_ERR_PERMITTED_VIOLATION },
+    { "URI:http://example.com/", X509_V_OK },
+};
+
+/*
+ * The compiled name constraints cached on the CA must give the same results
+ * as the generic matching.
+ */
+static int test_name_constraints(int idx)
+{
+    X509 *ca = make_ext_cert(NID_name_constraints, nc_constraints);
+    X509 *x = make_ext_cert(NID_subject_alt_name, nc_tests[idx].name);
+    int ret = 0;
+
+    if (!TEST_ptr(ca)
+            || !TEST_ptr(x)
+            || !TEST_ptr(ca->nc)
+            || !TEST_int_eq(NAME_CONSTRAINTS_check(x, ca->nc),
+                            nc_tests[idx].result)
+            || !TEST_ptr_null(ca->nc_matcher)
+            || !TEST_int_eq(ossl_x509_name_constraints_check(x, ca),
+                            nc_tests[idx].result)
+            || !TEST_ptr(ca->nc_matcher)
+            || !TEST_int_eq(ossl_x509_name_constraints_check(x, ca),
+                            nc_tests[idx].result))
+        goto err;
+
+    ret = 1;
+ err:
+    X509_free(x);
+    X509_free(ca);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_standard_exts);
     ADD_ALL_TESTS(test_a2i_ipaddress, OSSL_NELEM(a2i_ipaddress_tests));
+    ADD_TEST(test_lazy_extensions);
+    ADD_ALL_TESTS(test_name_constraints, OSSL_NELEM(nc_tests));
     return 1;
 }
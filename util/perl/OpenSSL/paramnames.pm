@@ -15,7 +15,8 @@ require Exporter;
 our @ISA = qw(Exporter);
 our @EXPORT_OK = qw(generate_public_macros
                     generate_internal_macros
-                    produce_decoder);
+                    produce_decoder
+                    produce_param_decoder);
 
 my $case_sensitive = 1;
 
@@ -692,3 +693,72 @@ sub produce_decoder {
     generate_code_from_trie(0, \%t);
     return $s;
 }
+
+# Resolve a parameter name, following aliases, to the name of the PIDX_
+# macro that its string is numbered by
+sub resolve_param {
+    my $name = shift;
+    my $val = $params{$name};
+
+    die "Unknown parameter name $name\n" if not defined $val;
+    return substr($val, 0, 1) eq '*' ? resolve_param(substr($val, 1)) : $name;
+}
+
+# Produce a decoder for the parameters of one provider function.
+#
+# The first argument is the base name of the generated code, and the rest
+# are pairs of a parameter name, without the OSSL_ prefix, and the name of
+# the field the matching OSSL_PARAM is stored in:
+#
+#   produce_param_decoder('hmac_set_ctx_params',
+#                         (['MAC_PARAM_KEY',  'key'],
+#                          ['MAC_PARAM_SIZE', 'size']));
+#
+# produces a structure "struct hmac_set_ctx_params_st" with a field for each
+# parameter and a function "hmac_set_ctx_params_decoder()" which fills it in
+# a single pass over a parameter array.  Like OSSL_PARAM_locate(), the first
+# of several parameters with the same name is used.
+sub produce_param_decoder {
+    my $name = shift;
+    my @pars = @_;
+    my %seen;
+    my $s = "";
+
+    $s .= "/* Machine generated by util/perl/OpenSSL/paramnames.pm */\n";
+    $s .= "struct ${name}_st {\n";
+    foreach my $par (@pars) {
+        my ($pname, $field) = @$par;
+        my $idx = resolve_param($pname);
+
+        die "Parameter $pname appears twice in $name\n"
+            if defined $seen{$idx};
+        $seen{$idx} = 1;
+        $s .= "    OSSL_PARAM *$field;\n";
+    }
+    $s .= "};\n\n";
+
+    $s .= "static ossl_unused void ${name}_decoder(const OSSL_PARAM *p,\n";
+    $s .= " " x length("static ossl_unused void ${name}_decoder(");
+    $s .= "struct ${name}_st *r)\n";
+    $s .= "{\n";
+    $s .= "    memset(r, 0, sizeof(*r));\n";
+    $s .= "    if (p == NULL)\n";
+    $s .= "        return;\n";
+    $s .= "    for (; p->key != NULL; p++) {\n";
+    $s .= "        switch (ossl_param_find_pidx(p->key)) {\n";
+    $s .= "        default:\n";
+    $s .= "            break;\n";
+    foreach my $par (@pars) {
+        my ($pname, $field) = @$par;
+
+        $s .= "        case PIDX_$pname:\n";
+        $s .= "            if (r->$field == NULL)\n";
+        $s .= "                r->$field = (OSSL_PARAM *)p;\n";
+        $s .= "            break;\n";
+    }
+    $s .= "        }\n";
+    $s .= "    }\n";
+    $s .= "}\n";
+    return $s;
+}
+